@@ -0,0 +1,57 @@
+/*
+   Copyright 2018 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+   BUMP ALLOCATOR FOR SHORT LIVED, VARIABLE SIZED BUFFERS.  ALLOCATIONS ARE
+   NEVER FREED ONE BY ONE: ARENA_REWIND() RECLAIMS EVERYTHING AT ONCE AND
+   KEEPS THE CHUNKS FOR REUSE, ARENA_FREE() GIVES THEM BACK.  NOT THREAD SAFE.
+*/
+
+#ifndef __INCLUDED_ARENA_H__
+#define __INCLUDED_ARENA_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct arena arena_t;
+
+/* CHUNKSZ IS THE SIZE OF EACH CHUNK GRABBED FROM MALLOC; 0 MEANS DEFAULT.
+   LARGER REQUESTS GET A CHUNK OF THEIR OWN. */
+arena_t *arena_init(size_t chunksz);
+
+void arena_free(arena_t *a);
+
+/* 16 BYTE ALIGNED; NULL IF MALLOC FAILS */
+void *arena_alloc(arena_t *a, size_t sz);
+
+void *arena_calloc(arena_t *a, size_t n, size_t sz);
+
+/* RECLAIM EVERY ALLOCATION, KEEP THE CHUNKS */
+void arena_rewind(arena_t *a);
+
+/* BYTES HANDED OUT SINCE THE LAST REWIND, CHUNKS HELD, AND CHUNK MALLOCS AND
+   ALLOCATIONS SINCE INIT */
+void arena_info(arena_t *a, size_t *used, int *nchunks,
+                unsigned long long *nmallocs, unsigned long long *nallocs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -146,6 +146,11 @@ DEF_ATTR(SQLBULKSZ, sqlbulksz, BYTES, 2 * 1024 * 1024,
 DEF_ATTR(
     ZLIBLEVEL, zlib_level, QUANTITY, 6,
     "If zlib compression is enabled, this determines the compression level.")
+DEF_ATTR(
+    ZSTDLEVEL, zstd_level, QUANTITY, 3,
+    "If zstd compression is enabled, this determines the compression level.")
+DEF_ATTR(ZSTDDICTSIZE, zstd_dict_size, BYTES, 16384,
+         "Size of the dictionary 'zstd train' builds for a table.")
 DEF_ATTR(ZTRACE, ztrace, QUANTITY, 0, NULL)
 DEF_ATTR(PANICLOGSNAP, paniclogsnap, BOOLEAN, 1, NULL)
 DEF_ATTR(UPDATEGENIDS, updategenids, BOOLEAN, 0, NULL)
@@ -243,6 +248,9 @@ DEF_ATTR(REPMETHODMAXSLEEP, repmethodmaxsleep, SECS, 300,
 DEF_ATTR(TEMPTABLE_MEM_THRESHOLD, temptable_mem_threshold, QUANTITY, 512,
          "If in-memory temp tables contain more than this many entries, spill "
          "them to disk.")
+DEF_ATTR(TEMPTABLE_MEM_BUDGET, temptable_mem_budget, BYTES, 0,
+         "Keep sorted temp tables in memory until they use this many bytes, "
+         "then spill them to a berkdb btree. 0 disables the in-memory engine.")
 DEF_ATTR(TEMPTABLE_CACHESZ, temptable_cachesz, BYTES, 262144,
          "Cache size for temporary tables. Temp tables do not share the "
          "database's main buffer pool.")
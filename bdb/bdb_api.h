@@ -133,6 +133,15 @@ struct bdb_queue_stats {
 
     unsigned n_logical_gets;
     unsigned n_physical_gets;
+
+    /* queuedb: items added and consumed by transactions committed here (ie.
+     * while master), and the total and worst time in seconds a consumed item
+     * sat in the queue */
+    uint64_t n_adds;
+    uint64_t n_consumes;
+    uint64_t consume_wait_sec;
+    unsigned max_consume_wait_sec;
+    unsigned n_batch_gets;
 };
 
 /* This is identical to bb_berkdb_thread_stats in db.h */
@@ -295,7 +304,8 @@ enum COMPRESS {
     BDB_COMPRESS_ZLIB = 1,
     BDB_COMPRESS_RLE8 = 2,
     BDB_COMPRESS_CRLE = 3,
-    BDB_COMPRESS_LZ4 = 4
+    BDB_COMPRESS_LZ4 = 4,
+    BDB_COMPRESS_ZSTD = 5
 };
 
 int bdb_compr2algo(const char *a);
@@ -833,6 +843,9 @@ int bdb_lite_exact_fetch_alloc(bdb_state_type *bdb_handle, void *key,
 int bdb_lite_exact_fetch_tran(bdb_state_type *bdb_state, tran_type *tran,
                               void *key, void *fnddta, int maxlen, int *fndlen,
                               int *bdberr);
+int bdb_lite_exact_fetch_rmw_tran(bdb_state_type *bdb_state, tran_type *tran,
+                                  void *key, void *fnddta, int maxlen,
+                                  int *fndlen, int *bdberr);
 int bdb_lite_exact_var_fetch(bdb_state_type *bdb_handle, void *key,
                              void **fnddta, int *fndlen, int *bdberr);
 int bdb_lite_exact_var_fetch_tran(bdb_state_type *bdb_state, tran_type *tran,
@@ -894,6 +907,14 @@ int bdb_queue_get(bdb_state_type *bdb_state, int consumer,
                   struct bdb_queue_cursor *fndcursor, unsigned int *epoch,
                   int *bdberr);
 
+/* queuedb only: like bdb_queue_get, but walk a single cursor to return up to
+ * max items after prevcursor in fnd[] (each for the caller to free) and their
+ * sizes in fnddtalen[].  Sets *nfnd to the number found; finding none is
+ * BDBERR_FETCH_DTA, as for bdb_queue_get. */
+int bdb_queue_get_batch(bdb_state_type *bdb_state, int consumer,
+                        const struct bdb_queue_cursor *prevcursor, int max,
+                        void **fnd, size_t *fnddtalen, int *nfnd, int *bdberr);
+
 /* Get the genid of a queue item that was retrieved by bdb_queue_get() */
 unsigned long long bdb_queue_item_genid(const void *dta);
 
@@ -1206,6 +1227,20 @@ void bdb_stripe_done(bdb_state_type *bdb_state);
 
 int bdb_count(bdb_state_type *bdb_state, int *bdberr);
 
+/* maintained row counts */
+int bdb_rowcount(bdb_state_type *bdb_state, int64_t *count);
+int bdb_rowcount_enable(bdb_state_type *bdb_state, tran_type *tran, int enable,
+                        int *bdberr);
+void bdb_rowcount_load(bdb_state_type *bdb_state, tran_type *tran);
+int bdb_rowcount_flush(tran_type *tran, int *bdberr);
+
+/* zstd with a dictionary trained on the table's own rows */
+void bdb_zstd_load(bdb_state_type *bdb_state, tran_type *tran);
+unsigned int bdb_zstd_dictid(bdb_state_type *bdb_state);
+int bdb_zstd_get_dict(unsigned int dictid, const void **dict, size_t *dictlen);
+int bdb_zstd_add_dict(bdb_state_type *bdb_state, tran_type *tran, void *dict,
+                      size_t dictlen, unsigned int *dictid, int *bdberr);
+
 struct bdb_temp_hash *bdb_temp_hash_create(bdb_state_type *bdb_state,
                                            char *tmpname, int *bdberr);
 struct bdb_temp_hash *bdb_temp_hash_create_cache(bdb_state_type *bdb_state,
@@ -1537,6 +1572,8 @@ void bdb_get_rep_stats(bdb_state_type *bdb_state,
                        unsigned long long *msgs_sent,
                        unsigned long long *txns_applied,
                        unsigned long long *retry, int *max_retry);
+void bdb_get_rep_apply_lag(bdb_state_type *bdb_state, int64_t *lag,
+                           int64_t *apply_ms);
 
 int bdb_get_index_filename(bdb_state_type *bdb_state, int ixnum, char *nameout,
                            int namelen, int *bdberr);
@@ -1768,7 +1805,7 @@ int bdb_get_lock_counters(bdb_state_type *bdb_state, int64_t *deadlocks, int64_t
                           int64_t *requests);
 
 int bdb_get_bpool_counters(bdb_state_type *bdb_state, int64_t *bpool_hits,
-                           int64_t *bpool_misses);
+                           int64_t *bpool_misses, int64_t *bpool_ghost_hits);
 
 int bdb_master_should_reject(bdb_state_type *bdb_state);
 
@@ -1936,6 +1973,28 @@ int bdb_table_version_delete(bdb_state_type *bdb_state, tran_type *tran,
 int bdb_table_version_select(const char *name, tran_type *tran,
                              unsigned long long *version, int *bdberr);
 
+/* llmeta row counts, see bdb_rowcount_enable */
+int bdb_get_rowcount(const char *tblname, tran_type *tran, int64_t *count,
+                     int *bdberr);
+int bdb_set_rowcount(const char *tblname, tran_type *tran, int64_t count,
+                     int *bdberr);
+int bdb_add_rowcount(const char *tblname, tran_type *tran, int64_t delta,
+                     int *bdberr);
+int bdb_del_rowcount(const char *tblname, tran_type *tran, int *bdberr);
+
+/* llmeta zstd dictionaries, see bdb_zstd_add_dict */
+int bdb_get_zstd_dict_highest(tran_type *tran, unsigned int *dictid,
+                              int *bdberr);
+int bdb_get_zstd_dict(tran_type *tran, unsigned int dictid, void **dict,
+                      int *dictlen, int *bdberr);
+int bdb_put_zstd_dict(tran_type *tran, unsigned int dictid, const void *dict,
+                      int dictlen, int *bdberr);
+int bdb_get_table_zstd_dict(const char *tblname, tran_type *tran,
+                            unsigned int *dictid, int *bdberr);
+int bdb_set_table_zstd_dict(const char *tblname, tran_type *tran,
+                            unsigned int dictid, int *bdberr);
+int bdb_del_table_zstd_dict(const char *tblname, tran_type *tran, int *bdberr);
+
 void bdb_send_analysed_table_to_master(bdb_state_type *bdb_state, char *table);
 /* get list of queues */
 int bdb_llmeta_get_queues(char **queue_names, size_t max_queues,
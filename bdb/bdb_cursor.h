@@ -199,4 +199,17 @@ int bdb_get_context_from_lsn(bdb_state_type *bdb_state, void *lsnp,
 
 int bdb_direct_count(bdb_cursor_ifn_t *, int ixnum, int64_t *count);
 
+/* Called for every record of a data stripe with its genid, the record with its
+ * ondisk header removed (decompressed if needed) and the schema version it was
+ * written with.  Returning non-zero stops the scan on every stripe. */
+typedef int (*bdb_stripe_scan_f)(void *arg, unsigned long long genid,
+                                 void *dta, int dtalen, uint8_t ver);
+
+/* Walk every data stripe of the cursor's table, with a thread per stripe if
+ * 'parallel' is set; fnargs[i] is passed to fn for the records of stripe i.
+ * Returns 0 once all stripes are done, 1 if a callback stopped the scan,
+ * BDBERR_DEADLOCK or -1. */
+int bdb_stripe_scan(bdb_cursor_ifn_t *, bdb_stripe_scan_f fn, void **fnargs,
+                    int parallel);
+
 #endif
@@ -448,6 +448,16 @@ struct tran_tag {
     /* Set to 1 if this is a schema change txn */
     int schema_change_txn;
 
+    /* pending row count changes for tables with maintained counts */
+    struct bdb_rowcount_delta *rowcount_deltas;
+    int n_rowcount_deltas;
+    int alloc_rowcount_deltas;
+
+    /* queuedb adds and consumes, counted in the queue stats on commit */
+    struct bdb_queue_tran_stats *queue_stats;
+    int n_queue_stats;
+    int alloc_queue_stats;
+
     /* cache the versions of dta files to catch schema changes and fastinits */
     int table_version_cache_sz;
     unsigned long long *table_version_cache;
@@ -990,6 +1000,12 @@ struct bdb_state_tag {
 
     signed char instant_schema_change;
 
+    /* set if llmeta holds a maintained row count for this table */
+    signed char rowcount_tracked;
+
+    /* zstd dictionary new rows are compressed with, 0 for none */
+    unsigned int zstd_dictid;
+
     signed char rep_handle_dead;
 
     /* keep this as an int, it's read locklessly */
@@ -1260,6 +1276,12 @@ int bdb_unpack(bdb_state_type *bdb_state, const void *from, size_t fromlen,
 int bdb_retrieve_updateid(bdb_state_type *bdb_state, const void *from,
                           size_t fromlen);
 
+/* zstd_dict.c */
+int bdb_zstd_compress(bdb_state_type *bdb_state, const void *from,
+                      size_t fromlen, void *to, size_t tolen);
+int bdb_zstd_decompress(const void *from, size_t fromlen, void *to,
+                        size_t tolen);
+
 int ip_updates_enabled_sc(bdb_state_type *bdb_state);
 int ip_updates_enabled(bdb_state_type *bdb_state);
 
@@ -1314,6 +1336,16 @@ int ll_dta_add(bdb_state_type *bdb_state, unsigned long long genid, DB *dbp,
                tran_type *tran, int dtafile, int dtastripe, DBT *dbt_key,
                DBT *dbt_data, int flags);
 
+/* maintained row counts, see count.c */
+void bdb_rowcount_track(bdb_state_type *bdb_state, tran_type *tran, int delta);
+void bdb_rowcount_merge(tran_type *child);
+void bdb_rowcount_discard(tran_type *tran);
+
+/* queuedb stats of a transaction, see queuedb.c */
+void bdb_queuedb_stats_merge(tran_type *child);
+void bdb_queuedb_stats_commit(tran_type *tran);
+void bdb_queuedb_stats_discard(tran_type *tran);
+
 int ll_dta_upd(bdb_state_type *bdb_state, int rrn, unsigned long long oldgenid,
                unsigned long long *newgenid, DB *dbp, tran_type *tran,
                int dtafile, int dtastripe, int participantstripid,
@@ -44,6 +44,7 @@
 #include <list.h>
 #include <ctrace.h>
 #include <logmsg.h>
+#include <comdb2_atomic.h>
 
 #ifdef NEWSI_STAT
 #include <time.h>
@@ -65,6 +66,7 @@ struct bdb_osql_trn {
     LISTC_T(bdb_osql_log_t) bkfill_list; /* backfill list */
     int cancelled; /* set if resource limitation forced this to abort */
     bdb_osql_log_t *last_reg; /* last registered log */
+    int pglogs_reader; /* counted in pglogs_readers */
 };
 
 /**
@@ -238,6 +240,48 @@ int bdb_is_timestamp_recoverable(bdb_state_type *bdb_state, int32_t timestamp)
 
 unsigned int bdb_osql_trn_count = 0;
 
+/* With lazy_pglogs on, commits only queue the page lsns that snapshot and
+ * AS OF readers use to rebuild older page images while at least one such
+ * transaction is registered.  The queues, and the AS OF history built from
+ * them, then have gaps: pglogs_complete_lsn is the latest commit when the
+ * queueing last resumed, and an AS OF reader that would have to go back
+ * further than that is refused with BDBERR_NO_LOG.  A plain snapshot only
+ * undoes commits past its birth lsn, and transactions it backfills commit
+ * after it registered, so it never needs what was skipped. */
+int gbl_lazy_pglogs = 0;
+static int pglogs_readers = 0;
+static int pglogs_skipped = 0;
+static DB_LSN pglogs_complete_lsn = {0};
+
+/* Called by a commit once its lsn is published; 0 if it can skip queueing */
+int bdb_osql_trn_pglogs_needed(void)
+{
+    if (!gbl_lazy_pglogs || ATOMIC_ADD(pglogs_readers, 0) > 0)
+        return 1;
+    pglogs_skipped = 1;
+    return 0;
+}
+
+/* Called holding trn_repo_mtx, before the reader takes its start lsn: any
+ * commit past that lsn sees the reader and queues its pages */
+static void pglogs_reader_enter(bdb_state_type *bdb_state, DB_LSN *complete)
+{
+    if (ATOMIC_ADD(pglogs_readers, 1) == 1 &&
+        (gbl_lazy_pglogs || pglogs_skipped)) {
+        bdb_get_commit_genid_generation(bdb_state, &pglogs_complete_lsn, NULL);
+        pglogs_skipped = 0;
+    }
+    *complete = pglogs_complete_lsn;
+}
+
+static void pglogs_reader_leave(bdb_osql_trn_t *trn)
+{
+    if (trn->pglogs_reader) {
+        ATOMIC_ADD(pglogs_readers, -1);
+        trn->pglogs_reader = 0;
+    }
+}
+
 int request_durable_lsn_from_master(bdb_state_type *bdb_state, 
         uint32_t *durable_file, uint32_t *durable_offset, uint32_t *durable_gen);
 
@@ -258,6 +302,7 @@ bdb_osql_trn_t *bdb_osql_trn_register(bdb_state_type *bdb_state,
     int rc = 0, durable_lsns = bdb_state->attr->durable_lsns;
     bdb_state_type *parent;
     DB_LSN durable_lsn = {0};
+    DB_LSN complete_lsn = {0};
     uint32_t durable_gen = 0;
     int backfill_required = 0;
     struct bfillhndl *bkfill_hndl = NULL;
@@ -366,6 +411,12 @@ bdb_osql_trn_t *bdb_osql_trn_register(bdb_state_type *bdb_state,
 
     listc_init(&trn->bkfill_list, offsetof(bdb_osql_log_t, lnk));
 
+    if (gbl_new_snapisol && (shadow_tran->tranclass == TRANCLASS_SNAPISOL ||
+                             shadow_tran->tranclass == TRANCLASS_SERIALIZABLE)) {
+        pglogs_reader_enter(parent, &complete_lsn);
+        trn->pglogs_reader = 1;
+    }
+
     /* Set while holding the trn_repo lock */
     shadow_tran->startgenid = bdb_get_commit_genid_generation(
         bdb_state, &shadow_tran->snapy_commit_lsn,
@@ -396,6 +447,7 @@ bdb_osql_trn_t *bdb_osql_trn_register(bdb_state_type *bdb_state,
             logmsg(LOGMSG_ERROR, 
                     "%s:%d failed to create backfill active trans, rc %d\n",
                     __func__, __LINE__, rc);
+            pglogs_reader_leave(trn);
             free(trn);
             trn = NULL;
             goto done;
@@ -474,6 +526,15 @@ done:
                 }
             }
 
+            if (!rc && trn->pglogs_reader &&
+                shadow_tran->asof_lsn.file != 0 &&
+                log_compare(&shadow_tran->asof_lsn, &complete_lsn) < 0) {
+                /* lazy_pglogs: the history does not go back this far */
+                shadow_tran->asof_lsn.file = 0;
+                shadow_tran->asof_lsn.offset = 1;
+                rc = -1;
+            }
+
             if (shadow_tran->asof_lsn.file != 0 &&
                 shadow_tran->asof_lsn.offset != 1) {
                 int counter = 0;
@@ -539,6 +600,7 @@ done:
             logmsg(LOGMSG_ERROR, "fail to backfill %d %d\n", rc, *bdberr);
             pthread_mutex_lock(&trn_repo_mtx);
             listc_rfl(&trn_repo->trns, trn);
+            pglogs_reader_leave(trn);
             pthread_mutex_destroy(&trn->log_mtx);
             free(trn);
             pthread_mutex_unlock(&trn_repo_mtx);
@@ -571,6 +633,7 @@ int bdb_osql_trn_unregister(bdb_osql_trn_t *trn, int *bdberr)
         listc_rfl(&trn_repo->trns, trn);
     else
         exit = 1;
+    pglogs_reader_leave(trn);
 
     /*
     fprintf( stderr, "%d %s:%d UNregistered %p\n",
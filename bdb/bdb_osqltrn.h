@@ -93,6 +93,13 @@ void bdb_set_gbl_recoverable_lsn(void *lsn, int32_t timestamp);
  */
 int bdb_osql_trn_count_clients(int *count, int lock_repo, int *bdberr);
 
+/**
+ * Returns 0 if a commit can skip queueing its page lsns because no
+ * snapshot transaction is registered (lazy_pglogs)
+ *
+ */
+int bdb_osql_trn_pglogs_needed(void);
+
 /**
  * Returns the first log
  *
@@ -38,6 +38,11 @@ int bdb_queuedb_get(bdb_state_type *bdb_state, int consumer,
                     struct bdb_queue_cursor *fndcursor, unsigned int *epoch,
                     int *bdberr);
 
+int bdb_queuedb_get_batch(bdb_state_type *bdb_state, int consumer,
+                          const struct bdb_queue_cursor *prevcursor, int max,
+                          void **fnd, size_t *fnddtalen, int *nfnd,
+                          int *bdberr);
+
 int bdb_queuedb_consume(bdb_state_type *bdb_state, tran_type *tran,
                         int consumer, const void *prevfnd, int *bdberr);
 
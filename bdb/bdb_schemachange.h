@@ -45,6 +45,8 @@ typedef enum scdone {
     lua_sfunc,
     lua_afunc,
     rename_table,
+    rowcount,
+    zstd_dict,
 } scdone_t;
 
 int bdb_llog_scdone_tran(bdb_state_type *bdb_state, scdone_t type,
@@ -299,10 +299,236 @@ int bdb_count_int(bdb_state_type *bdb_state, int *bdberr)
 
 int bdb_count(bdb_state_type *bdb_state, int *bdberr)
 {
+    int64_t count;
     int ret;
     BDB_READLOCK("bdb_count");
 
-    ret = bdb_count_int(bdb_state, bdberr);
+    if (bdb_rowcount(bdb_state, &count) == 0)
+        ret = count;
+    else
+        ret = bdb_count_int(bdb_state, bdberr);
     BDB_RELLOCK();
     return ret;
 }
+
+/* Maintained row counts.
+ *
+ * A table can have its row count kept in llmeta so that counting it does not
+ * have to walk the table.  Data record adds and deletes done under a
+ * transaction are tallied per table on the transaction (see ll_dta_add and
+ * ll_dta_del), folded into the parent when a child commits, and written to
+ * llmeta under the top level transaction just before it commits.  The llmeta
+ * record is therefore updated atomically with the rows, is replicated with
+ * them and survives recovery.  Only tables flagged with rowcount_tracked are
+ * tallied; the flag is loaded from llmeta when a table is opened and reloaded
+ * on replicants when a count is enabled or disabled on the master.
+ *
+ * Rowlocks physical transactions are not tallied, so counts are neither
+ * enabled nor trusted while rowlocks is on, and enabling rowlocks drops every
+ * maintained count (see exec_rowlocks_enable). */
+
+extern int gbl_rowlocks;
+
+struct bdb_rowcount_delta {
+    bdb_state_type *bdb_state;
+    int64_t delta;
+};
+
+void bdb_rowcount_track(bdb_state_type *bdb_state, tran_type *tran, int delta)
+{
+    struct bdb_rowcount_delta *d;
+    int i;
+
+    for (i = 0; i < tran->n_rowcount_deltas; i++) {
+        d = &tran->rowcount_deltas[i];
+        if (d->bdb_state == bdb_state) {
+            d->delta += delta;
+            return;
+        }
+    }
+
+    if (tran->n_rowcount_deltas == tran->alloc_rowcount_deltas) {
+        int alloc = tran->alloc_rowcount_deltas * 2;
+        if (alloc == 0)
+            alloc = 4;
+        d = realloc(tran->rowcount_deltas, alloc * sizeof(*d));
+        if (d == NULL) {
+            logmsg(LOGMSG_FATAL, "%s: can't allocate %d deltas\n", __func__,
+                   alloc);
+            abort();
+        }
+        tran->rowcount_deltas = d;
+        tran->alloc_rowcount_deltas = alloc;
+    }
+    d = &tran->rowcount_deltas[tran->n_rowcount_deltas++];
+    d->bdb_state = bdb_state;
+    d->delta = delta;
+}
+
+void bdb_rowcount_discard(tran_type *tran)
+{
+    free(tran->rowcount_deltas);
+    tran->rowcount_deltas = NULL;
+    tran->n_rowcount_deltas = 0;
+    tran->alloc_rowcount_deltas = 0;
+}
+
+/* a child committed: its changes now belong to the parent */
+void bdb_rowcount_merge(tran_type *child)
+{
+    int i;
+
+    for (i = 0; i < child->n_rowcount_deltas; i++) {
+        struct bdb_rowcount_delta *d = &child->rowcount_deltas[i];
+        if (d->delta)
+            bdb_rowcount_track(d->bdb_state, child->parent, d->delta);
+    }
+    bdb_rowcount_discard(child);
+}
+
+/* Write the pending changes of a top level transaction to llmeta.  On error
+ * the changes are kept; the caller is expected to abort the transaction. */
+int bdb_rowcount_flush(tran_type *tran, int *bdberr)
+{
+    int i, rc;
+
+    *bdberr = BDBERR_NOERROR;
+
+    for (i = 0; i < tran->n_rowcount_deltas; i++) {
+        struct bdb_rowcount_delta *d = &tran->rowcount_deltas[i];
+        if (d->delta == 0 || !d->bdb_state->rowcount_tracked)
+            continue;
+        rc = bdb_add_rowcount(d->bdb_state->name, tran, d->delta, bdberr);
+        if (rc)
+            return rc;
+    }
+    bdb_rowcount_discard(tran);
+    return 0;
+}
+
+/* count the data records of a table by walking every stripe */
+static int64_t bdb_count_dta_int(bdb_state_type *bdb_state, tran_type *tran,
+                                 int *bdberr)
+{
+    unsigned char keymax[sizeof(unsigned long long)];
+    const size_t buffer_length = 1024 * 1024;
+    DBT dbt_key, dbt_data;
+    int64_t count = 0;
+    void *buffer;
+    DBC *dbcp;
+    int stripe;
+    int rc;
+
+    buffer = mymalloc(buffer_length);
+    if (!buffer) {
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+
+    for (stripe = 0; stripe < bdb_state->attr->dtastripe; stripe++) {
+        DB *dbp = bdb_state->dbp_data[0][stripe];
+
+        rc = dbp->cursor(dbp, tran ? tran->tid : NULL, &dbcp, 0);
+        if (rc != 0) {
+            *bdberr = (rc == DB_LOCK_DEADLOCK || rc == DB_REP_HANDLE_DEAD)
+                          ? BDBERR_DEADLOCK
+                          : BDBERR_MISC;
+            count = -1;
+            break;
+        }
+
+        bzero(&dbt_key, sizeof(dbt_key));
+        bzero(&dbt_data, sizeof(dbt_data));
+        dbt_key.data = keymax;
+        dbt_key.ulen = sizeof(keymax);
+        dbt_key.flags = DB_DBT_USERMEM;
+        dbt_data.data = buffer;
+        dbt_data.ulen = buffer_length;
+        dbt_data.flags = DB_DBT_USERMEM;
+
+        while ((rc = dbcp->c_get(dbcp, &dbt_key, &dbt_data,
+                                 DB_MULTIPLE_KEY | DB_NEXT)) == 0) {
+            void *ptr, *keyptr, *dataptr;
+            size_t keylen, datalen;
+            for (DB_MULTIPLE_INIT(ptr, &dbt_data);;) {
+                DB_MULTIPLE_KEY_NEXT(ptr, &dbt_data, keyptr, keylen, dataptr,
+                                     datalen);
+                if (!dataptr)
+                    break;
+                count++;
+            }
+        }
+        dbcp->c_close(dbcp);
+
+        if (rc != DB_NOTFOUND) {
+            if (rc == DB_LOCK_DEADLOCK || rc == DB_REP_HANDLE_DEAD) {
+                *bdberr = BDBERR_DEADLOCK;
+            } else {
+                logmsg(LOGMSG_ERROR, "%s: stripe %d c_get %d %s\n", __func__,
+                       stripe, rc, db_strerror(rc));
+                *bdberr = BDBERR_MISC;
+            }
+            count = -1;
+            break;
+        }
+    }
+
+    myfree(buffer);
+    return count;
+}
+
+/* Start (or stop) maintaining the row count of a table.  The caller holds the
+ * table write lock in "tran", so no writer can slip in between the count and
+ * the moment the table is flagged. */
+int bdb_rowcount_enable(bdb_state_type *bdb_state, tran_type *tran, int enable,
+                        int *bdberr)
+{
+    int64_t count;
+    int rc;
+
+    if (!enable) {
+        rc = bdb_del_rowcount(bdb_state->name, tran, bdberr);
+        if (rc == 0)
+            bdb_state->rowcount_tracked = 0;
+        return rc;
+    }
+
+    if (gbl_rowlocks) {
+        logmsg(LOGMSG_ERROR, "%s: no row counts with rowlocks\n", __func__);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    count = bdb_count_dta_int(bdb_state, tran, bdberr);
+    if (count < 0)
+        return -1;
+
+    rc = bdb_set_rowcount(bdb_state->name, tran, count, bdberr);
+    if (rc)
+        return rc;
+
+    bdb_state->rowcount_tracked = 1;
+    logmsg(LOGMSG_INFO, "table %s: maintaining row count, %lld rows\n",
+           bdb_state->name, (long long)count);
+    return 0;
+}
+
+/* refresh the rowcount_tracked flag from llmeta */
+void bdb_rowcount_load(bdb_state_type *bdb_state, tran_type *tran)
+{
+    int64_t count;
+    int bdberr;
+
+    bdb_state->rowcount_tracked =
+        (bdb_get_rowcount(bdb_state->name, tran, &count, &bdberr) == 0);
+}
+
+/* Return 0 and the maintained row count if the table has one. */
+int bdb_rowcount(bdb_state_type *bdb_state, int64_t *count)
+{
+    int bdberr;
+
+    if (!bdb_state->rowcount_tracked || gbl_rowlocks)
+        return -1;
+    return bdb_get_rowcount(bdb_state->name, NULL, count, &bdberr);
+}
@@ -3443,6 +3443,10 @@ int bdb_transfer_pglogs_to_queues(void *bdb_state, void *pglogs,
         return rc;
     }
 
+    /* lazy_pglogs: still publish the commit, which AS OF waits on */
+    if (!bdb_osql_trn_pglogs_needed())
+        nkeys = 0;
+
     bdb_update_pglogs_fileid_queues(bdb_state, logical_tranid,
                                     is_logical_commit, logical_commit_lsn, gen,
                                     keylist, nkeys);
@@ -3858,6 +3862,10 @@ int bdb_transfer_txn_pglogs(void *bdb_state, void *pglogs_hashtbl,
         }
     }
 
+    /* lazy_pglogs: no snapshot reader to queue the pages for */
+    if (!bdb_osql_trn_pglogs_needed())
+        return 0;
+
     if ((rc = transfer_txn_pglogs_to_queues(bdb_state, logical_tranid,
                                             pglogs_hashtbl, commit_lsn)) != 0)
         abort();
@@ -8857,10 +8865,42 @@ static int bdb_cursor_collattrlen(bdb_cursor_ifn_t *cur)
 
 struct count_arg {
     DB *db;
+    bdb_state_type *state;
+    bdb_stripe_scan_f fn; /* NULL if only counting */
+    void *fnarg;
+    volatile int *stop; /* set by whichever stripe's callback stops first */
+    int stopped;
     int64_t count;
     int rc;
 };
 
+static int db_scan_rec(struct count_arg *arg, uint8_t *key, uint32_t keylen,
+                       uint8_t *dta, uint32_t dtalen, void *buf)
+{
+    unsigned long long genid = 0;
+    void *freeptr = NULL;
+    struct odh odh;
+    int rc;
+
+    if (keylen >= sizeof(genid))
+        memcpy(&genid, key, sizeof(genid));
+    rc = bdb_unpack(arg->state, dta, dtalen, buf, MAXRECSZ, &odh, &freeptr);
+    if (rc) {
+        arg->rc = rc;
+        if (freeptr)
+            free(freeptr);
+        return 1;
+    }
+    if (arg->fn(arg->fnarg, genid, odh.recptr, odh.length, odh.csc2vers)) {
+        arg->stopped = 1;
+        arg->rc = DB_NOTFOUND;
+        rc = 1;
+    }
+    if (freeptr)
+        free(freeptr);
+    return rc;
+}
+
 static void *db_count(void *varg)
 {
     int rc;
@@ -8876,83 +8916,151 @@ static void *db_count(void *varg)
     v.ulen = 128 * 1024;
     v.flags = DB_DBT_USERMEM;
 
+    void *unpackbuf = NULL;
+    if (arg->fn && (unpackbuf = malloc(MAXRECSZ)) == NULL) {
+        arg->rc = ENOMEM;
+        return NULL;
+    }
+
     DB *db = arg->db;
     DBC *dbc;
     if ((rc = db->cursor(db, NULL, &dbc, 0)) != 0) {
         arg->rc = rc;
+        free(unpackbuf);
         return NULL;
     }
     int64_t count = 0;
-    while ((rc = dbc->c_get(dbc, &k, &v, DB_NEXT | DB_MULTIPLE_KEY)) == 0) {
+    int done = 0;
+    while (!done &&
+           (rc = dbc->c_get(dbc, &k, &v, DB_NEXT | DB_MULTIPLE_KEY)) == 0) {
         uint8_t *kk, *vv;
         uint32_t ks, vs;
         void *bulk;
+        if (arg->stop && *arg->stop) {
+            rc = DB_NOTFOUND;
+            break;
+        }
         DB_MULTIPLE_INIT(bulk, &v);
         DB_MULTIPLE_KEY_NEXT(bulk, &v, kk, ks, vv, vs);
         while (bulk) {
             ++count;
+            if (arg->fn && db_scan_rec(arg, kk, ks, vv, vs, unpackbuf)) {
+                if (arg->stop)
+                    *arg->stop = 1;
+                done = 1;
+                break;
+            }
             DB_MULTIPLE_KEY_NEXT(bulk, &v, kk, ks, vv, vs);
         }
     }
     dbc->c_close(dbc);
-    arg->rc = rc;
+    free(unpackbuf);
+    if (!done)
+        arg->rc = rc;
     arg->count = count;
     return NULL;
 }
 
-int gbl_parallel_count = 0;
-int bdb_direct_count(bdb_cursor_ifn_t *cur, int ixnum, int64_t *rcnt)
+/* Run db_count on every stripe, one thread each if 'parallel' is set.
+ * Every thread is joined before returning, whatever the outcome. */
+static int db_count_stripes(struct count_arg *args, int stripes, int parallel)
 {
-    int64_t count = 0;
-    int parallel_count;
-    bdb_state_type *state = cur->impl->state;
-    DB **db;
-    int stripes;
     pthread_attr_t attr;
-    if (ixnum < 0) { // data
-        db = state->dbp_data[0];
-        stripes = state->attr->dtastripe;
-        parallel_count = gbl_parallel_count;
+    pthread_t thds[stripes];
+    int started[stripes];
+    int rc = 0;
+    void *ret;
+
+    if (parallel) {
         // max page 64K
         // allocate twice that + 4K, in case page compressed "really" well
+        size_t stacksz = 132 * 1024;
+        // the scan callback converts rows to the current schema, which
+        // allocas buffers of its own on top of the page buffer
+        if (args[0].fn)
+            stacksz += 256 * 1024;
         pthread_attr_init(&attr);
 #ifdef PTHREAD_STACK_MIN
-        pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN + 132 * 1024);
+        pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN + stacksz);
 #endif
-    } else { // index
-        db = &state->dbp_ix[ixnum];
-        stripes = 1;
-        parallel_count = 0;
     }
-    struct count_arg args[stripes];
-    pthread_t thds[stripes];
     for (int i = 0; i < stripes; ++i) {
-        args[i].db = db[i];
-        if (parallel_count) {
-            pthread_create(&thds[i], &attr, db_count, &args[i]);
-        } else {
+        started[i] = parallel &&
+                     pthread_create(&thds[i], &attr, db_count, &args[i]) == 0;
+        if (!started[i]) {
             db_count(&args[i]);
         }
     }
-    int rc = 0;
-    void *ret;
     for (int i = 0; i < stripes; ++i) {
-        if (parallel_count) {
+        if (started[i]) {
             pthread_join(thds[i], &ret);
         }
+        if (rc) {
+            continue;
+        }
         if (args[i].rc == DB_LOCK_DEADLOCK) {
             rc = BDBERR_DEADLOCK;
-            break;
         } else if (args[i].rc != DB_NOTFOUND) {
             rc = -1;
-            break;
         }
-        rc = 0;
-        count += args[i].count;
     }
-    if (parallel_count) {
+    if (parallel) {
         pthread_attr_destroy(&attr);
     }
-    if (rc == 0) *rcnt = count;
+    return rc;
+}
+
+int gbl_parallel_count = 0;
+int bdb_direct_count(bdb_cursor_ifn_t *cur, int ixnum, int64_t *rcnt)
+{
+    int64_t count = 0;
+    int parallel_count;
+    bdb_state_type *state = cur->impl->state;
+    DB **db;
+    int stripes;
+    if (ixnum < 0) { // data
+        db = state->dbp_data[0];
+        stripes = state->attr->dtastripe;
+        parallel_count = gbl_parallel_count;
+    } else { // index
+        db = &state->dbp_ix[ixnum];
+        stripes = 1;
+        parallel_count = 0;
+    }
+    struct count_arg args[stripes];
+    memset(args, 0, sizeof(args));
+    for (int i = 0; i < stripes; ++i) {
+        args[i].db = db[i];
+        args[i].state = state;
+    }
+    int rc = db_count_stripes(args, stripes, parallel_count);
+    if (rc == 0) {
+        for (int i = 0; i < stripes; ++i)
+            count += args[i].count;
+        *rcnt = count;
+    }
+    return rc;
+}
+
+int bdb_stripe_scan(bdb_cursor_ifn_t *cur, bdb_stripe_scan_f fn, void **fnargs,
+                    int parallel)
+{
+    bdb_state_type *state = cur->impl->state;
+    int stripes = state->attr->dtastripe;
+    struct count_arg args[stripes];
+    volatile int stop = 0;
+    int rc;
+
+    memset(args, 0, sizeof(args));
+    for (int i = 0; i < stripes; ++i) {
+        args[i].db = state->dbp_data[0][i];
+        args[i].state = state;
+        args[i].fn = fn;
+        args[i].fnarg = fnargs[i];
+        args[i].stop = &stop;
+    }
+    rc = db_count_stripes(args, stripes, parallel);
+    if (rc == 0 && stop)
+        rc = 1;
     return rc;
 }
@@ -163,6 +163,8 @@ static void log_stats(FILE *out, bdb_state_type *bdb_state)
     prn_stat(st_disk_offset);
     prn_stat(st_maxcommitperflush);
     prn_stat(st_mincommitperflush);
+    prn_stat(st_gc_flushes);
+    prn_stat(st_gc_commits);
     prn_stat(st_regsize);
     prn_stat(st_region_wait);
     prn_stat(st_region_nowait);
@@ -204,7 +206,7 @@ int bdb_get_lock_counters(bdb_state_type *bdb_state, int64_t *deadlocks, int64_t
 }
 
 int bdb_get_bpool_counters(bdb_state_type *bdb_state, int64_t *bpool_hits,
-                           int64_t *bpool_misses)
+                           int64_t *bpool_misses, int64_t *bpool_ghost_hits)
 {
     int rc;
     DB_MPOOL_STAT *mpool_stats;
@@ -216,6 +218,8 @@ int bdb_get_bpool_counters(bdb_state_type *bdb_state, int64_t *bpool_hits,
 
     *bpool_hits = mpool_stats->st_cache_hit;
     *bpool_misses = mpool_stats->st_cache_miss;
+    if (bpool_ghost_hits)
+        *bpool_ghost_hits = mpool_stats->st_ghost_hits;
 
     free(mpool_stats);
     return 0;
@@ -381,6 +385,11 @@ static void rep_stats(FILE *out, bdb_state_type *bdb_state)
             gbl_rep_rowlocks_multifile);
     logmsgf(LOGMSG_USER, out, "txn deadlocked: %ld\n",
             gbl_rep_trans_deadlocked);
+    prn_stat(st_txns_partitioned);
+    prn_stat(st_page_queues);
+    prn_stat(st_apply_ms);
+    prn_stat(st_apply_ms_max);
+    prn_stat(st_apply_lag);
     prn_lstat(lc_cache_hits);
     prn_lstat(lc_cache_misses);
     prn_stat(lc_cache_size);
@@ -413,6 +422,20 @@ void bdb_get_rep_stats(bdb_state_type *bdb_state,
     free(rep_stats);
 }
 
+void bdb_get_rep_apply_lag(bdb_state_type *bdb_state, int64_t *lag,
+                           int64_t *apply_ms)
+{
+    DB_REP_STAT *rep_stats;
+
+    if (bdb_state->parent)
+        bdb_state = bdb_state->parent;
+
+    bdb_state->dbenv->rep_stat(bdb_state->dbenv, &rep_stats, 0);
+    *lag = rep_stats->st_apply_lag;
+    *apply_ms = rep_stats->st_apply_ms;
+    free(rep_stats);
+}
+
 static char *genid_format_str(int format)
 {
     if (format == LLMETA_GENID_48BIT)
@@ -524,6 +547,8 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     prn_lstat(st_page_pf_in_late);
     prn_lstat(st_page_in);
     prn_lstat(st_page_out);
+    prn_lstat(st_page_in_compressed);
+    prn_lstat(st_page_out_compressed);
     prn_lstat(st_ro_merges);
     prn_lstat(st_rw_merges);
     prn_lstat(st_ro_evict);
@@ -552,6 +577,9 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
     prn_lstat(st_alloc_max_pages);
     prn_lstat(st_ckp_pages_sync);
     prn_lstat(st_ckp_pages_skip);
+    prn_lstat(st_ghost_hits);
+    prn_lstat(st_hot_promotes);
+    prn_lstat(st_cold_evicts);
 
     if (extra) {
         bdb_state->dbenv->memp_dump_region(bdb_state->dbenv, "A", out);
@@ -569,6 +597,10 @@ static void cache_stats(FILE *out, bdb_state_type *bdb_state, int extra)
             logmsgf(LOGMSG_USER, out, "  st_page_create: %"PRId64"\n", (*i)->st_page_create);
             logmsgf(LOGMSG_USER, out, "  st_page_in    : %"PRId64"\n", (*i)->st_page_in);
             logmsgf(LOGMSG_USER, out, "  st_page_out   : %"PRId64"\n", (*i)->st_page_out);
+            if ((*i)->st_page_in_compressed || (*i)->st_page_out_compressed) {
+                logmsgf(LOGMSG_USER, out, "  st_page_in_compressed : %"PRId64"\n", (*i)->st_page_in_compressed);
+                logmsgf(LOGMSG_USER, out, "  st_page_out_compressed: %"PRId64"\n", (*i)->st_page_out_compressed);
+            }
         }
 
         free(fsp);
@@ -985,6 +1017,9 @@ void bdb_lock_stats_me(bdb_state_type *bdb_state, FILE *out)
 }
 
 extern int __memp_dump_region(DB_ENV *dbenv, const char *area, FILE *fp);
+extern int __memp_repl_bench(FILE *out, const char *dir, int cachemb,
+                             int scanpct, int nops);
+extern int __log_commit_bench(FILE *out, const char *dir, int secs);
 
 void bdb_dump_cache(bdb_state_type *bdb_state, FILE *out)
 {
@@ -1259,6 +1294,9 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
         " activelocks    - dump all active locks",
         " truncrepdb     - truncate repdb",
         " dumpcache      - dump berkeley cache",
+        " mpoolbench [mb] [scan%] [ops] - compare buffer replacement policies "
+        "on a mixed point-lookup/scan workload",
+        " logbench [secs] - commits/sec with and without log group commit",
         "*attr           - dump attributes",
         " setattr name # - set value of attribute to #",
         " setskip # 1/0  - mark node # as coherent (1) or incoherent (0)",
@@ -1268,7 +1306,11 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
         " llmeta         - dump llmeta information",
         " freepages      - dump free page counts",
         " lccache        - lsn collection cache commands",
-        " temptable      - temptable status", "*help           - this",
+        " temptable      - temptable status",
+        " temptblbench [rows] - temp table insert/find/next rates, berkdb vs "
+        "in-memory",
+        " temptblspilltest - check scans across an in-memory temp table spill",
+        "*help           - this",
         "NB '*' means you can run the command via stat e.g.",
         "'send mydb stat bdb cluster'"};
     static char *safecmds[] = {
@@ -1374,6 +1416,21 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
         cache_info(out, bdb_state);
     else if (tokcmp(tok, ltok, "cachestatall") == 0)
         cache_stats(out, bdb_state, 1);
+    else if (tokcmp(tok, ltok, "mpoolbench") == 0) {
+        int cachemb, scanpct, nops;
+        tok = segtok(line, lline, &st, &ltok);
+        cachemb = ltok ? toknum(tok, ltok) : 0;
+        tok = segtok(line, lline, &st, &ltok);
+        scanpct = ltok ? toknum(tok, ltok) : -1;
+        tok = segtok(line, lline, &st, &ltok);
+        nops = ltok ? toknum(tok, ltok) : 0;
+        __memp_repl_bench(out, bdb_state->tmpdir, cachemb, scanpct, nops);
+    }
+    else if (tokcmp(tok, ltok, "logbench") == 0) {
+        tok = segtok(line, lline, &st, &ltok);
+        __log_commit_bench(out, bdb_state->tmpdir,
+                           ltok ? toknum(tok, ltok) : 0);
+    }
     else if (tokcmp(tok, ltok, "repstat") == 0)
         rep_stats(out, bdb_state);
     else if (tokcmp(tok, ltok, "bdbstate") == 0)
@@ -1568,6 +1625,17 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
 
         bdb_temp_table_insert_test(bdb_state, recsz, maxins);
     } 
+    else if (tokcmp(tok, ltok, "temptblbench") == 0) {
+        extern int bdb_temp_table_bench(bdb_state_type *, FILE *, int);
+        tok = segtok(line, lline, &st, &ltok);
+        bdb_temp_table_bench(bdb_state, out, ltok ? toknum(tok, ltok) : 0);
+    }
+    else if (tokcmp(tok, ltok, "temptblspilltest") == 0) {
+        extern int bdb_temp_table_spill_test(bdb_state_type *, FILE *);
+        int nfail = bdb_temp_table_spill_test(bdb_state, out);
+        logmsgf(LOGMSG_USER, out, "temptblspilltest %s\n",
+                nfail ? "failed" : "passed");
+    }
     else if (tokcmp(tok, ltok, "reptrcy") == 0) {
         logmsg(LOGMSG_USER, "turning on replication trace\n");
         bdb_state->rep_trace = 1;
@@ -54,7 +54,7 @@
 
 static int bdb_lite_exact_fetch_int(bdb_state_type *bdb_state, tran_type *tran,
                                     void *key, void *fnddta, int maxlen,
-                                    int *fndlen, int *bdberr)
+                                    int *fndlen, u_int32_t flags, int *bdberr)
 {
     int rc, outrc = 0, ixlen;
     DBT dbt_key, dbt_data;
@@ -80,7 +80,7 @@ static int bdb_lite_exact_fetch_int(bdb_state_type *bdb_state, tran_type *tran,
     dbt_data.flags |= DB_DBT_USERMEM;
 
     rc = bdb_state->dbp_data[0][0]->get(bdb_state->dbp_data[0][0], tid,
-                                        &dbt_key, &dbt_data, 0);
+                                        &dbt_key, &dbt_data, flags);
 
     if (rc == 0) {
         *fndlen = dbt_data.size;
@@ -109,7 +109,23 @@ int bdb_lite_exact_fetch_tran(bdb_state_type *bdb_state, tran_type *tran,
 
     BDB_READLOCK("bdb_lite_exact_fetch_tran");
     rc = bdb_lite_exact_fetch_int(bdb_state, tran, key, fnddta, maxlen, fndlen,
-                                  bdberr);
+                                  0, bdberr);
+    BDB_RELLOCK();
+
+    return rc;
+}
+
+/* like bdb_lite_exact_fetch_tran, but write locks the record right away so a
+ * following update in the same transaction doesn't have to upgrade */
+int bdb_lite_exact_fetch_rmw_tran(bdb_state_type *bdb_state, tran_type *tran,
+                                  void *key, void *fnddta, int maxlen,
+                                  int *fndlen, int *bdberr)
+{
+    int rc;
+
+    BDB_READLOCK("bdb_lite_exact_fetch_rmw_tran");
+    rc = bdb_lite_exact_fetch_int(bdb_state, tran, key, fnddta, maxlen, fndlen,
+                                  DB_RMW, bdberr);
     BDB_RELLOCK();
 
     return rc;
@@ -122,7 +138,7 @@ int bdb_lite_exact_fetch(bdb_state_type *bdb_state, void *key, void *fnddta,
 
     BDB_READLOCK("bdb_lite_exact_fetch");
     rc = bdb_lite_exact_fetch_int(bdb_state, NULL /*tran*/, key, fnddta, maxlen,
-                                  fndlen, bdberr);
+                                  fndlen, 0, bdberr);
     BDB_RELLOCK();
 
     return rc;
@@ -231,6 +231,11 @@ int ll_dta_add(bdb_state_type *bdb_state, unsigned long long genid, DB *dbp,
                 abort();
         }
 
+        /* rowlocks physical transactions are not tallied, see count.c */
+        if (!outrc && dtafile == 0 && bdb_state->rowcount_tracked &&
+            !tran->logical_tran)
+            bdb_rowcount_track(bdb_state, tran, 1);
+
         /* Grab row locks surrounding the record we are modifying.  This
            protects
            us against dirty reads and undeleted records. */
@@ -407,6 +412,10 @@ int ll_dta_del(bdb_state_type *bdb_state, tran_type *tran, int rrn,
 
         rc = dbcp->c_close(dbcp);
 
+        if (!rc && dtafile == 0 && bdb_state->rowcount_tracked &&
+            !tran->logical_tran)
+            bdb_rowcount_track(bdb_state, tran, -1);
+
         if (!rc && add_snapisol_logging(bdb_state)) {
             tran_type *parent = (tran->parent) ? tran->parent : tran;
             DBT dbt_tbl = {0};
@@ -160,7 +160,13 @@ typedef enum {
     LLMETA_TABLE_USER_SCHEMA = 44,
     LLMETA_USER_PASSWORD_HASH = 45,
     LLMETA_FVER_FILE_TYPE_QDB = 46, /* file version for a dbqueue */
-    LLMETA_TABLE_NUM_SC_DONE = 47
+    LLMETA_TABLE_NUM_SC_DONE = 47,
+    LLMETA_TABLE_ROWCOUNT = 48, /* maintained row count for a table
+                                   key = 48 + TABLENAME[32] */
+    LLMETA_ZSTD_DICT = 49,      /* trained zstd dictionary
+                                   key = 49 + DICTID */
+    LLMETA_TABLE_ZSTD_DICT = 50 /* dictionary new rows of a table use
+                                   key = 50 + TABLENAME[32] */
 } llmetakey_t;
 
 struct llmeta_file_type_key {
@@ -5970,6 +5976,30 @@ int bdb_llmeta_print_record(bdb_state_type *bdb_state, void *key, int keylen,
                "LLMETA_TABLE_VERSION table=\"%s\" version=\"%lu\"\n", tblname,
                flibc_ntohll(version));
         } break;
+    case LLMETA_TABLE_ROWCOUNT: {
+        char tblname[LLMETA_TBLLEN + 1];
+        buf_no_net_get(&(tblname), sizeof(tblname), p_buf_key + sizeof(int),
+                       p_buf_end_key);
+        long long count = flibc_ntohll(*(unsigned long long *)data);
+        logmsg(LOGMSG_USER, "LLMETA_TABLE_ROWCOUNT table=\"%s\" count=%lld\n",
+               tblname, count);
+        } break;
+    case LLMETA_ZSTD_DICT: {
+        unsigned int dictid;
+        buf_get(&dictid, sizeof(dictid), p_buf_key + sizeof(int),
+                p_buf_end_key);
+        logmsg(LOGMSG_USER, "LLMETA_ZSTD_DICT id=%u size=%d\n", dictid,
+               datalen);
+        } break;
+    case LLMETA_TABLE_ZSTD_DICT: {
+        char tblname[LLMETA_TBLLEN + 1];
+        unsigned int dictid;
+        buf_no_net_get(&(tblname), sizeof(tblname), p_buf_key + sizeof(int),
+                       p_buf_end_key);
+        buf_get(&dictid, sizeof(dictid), data, (uint8_t *)data + datalen);
+        logmsg(LOGMSG_USER, "LLMETA_TABLE_ZSTD_DICT table=\"%s\" id=%u\n",
+               tblname, dictid);
+        } break;
         case LLMETA_GENID_FORMAT: {
             uint64_t genid_format;
             genid_format = flibc_htonll(*(unsigned long long *)data);
@@ -7364,6 +7394,368 @@ int bdb_table_version_delete(bdb_state_type *bdb_state, tran_type *tran,
     return 0;
 }
 
+static int llmeta_rowcount_key(const char *tblname, char *key, int *bdberr)
+{
+    struct llmeta_sane_table_version rowcount_key;
+
+    if (!llmeta_bdb_state) {
+        *bdberr = BDBERR_DBEMPTY;
+        return -1;
+    }
+    if (strlen(tblname) + 1 > sizeof(rowcount_key.tblname)) {
+        logmsg(LOGMSG_ERROR, "%s: tablename too long \"%s\"\n", __func__,
+               tblname);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    bzero(&rowcount_key, sizeof(rowcount_key));
+    rowcount_key.file_type = LLMETA_TABLE_ROWCOUNT;
+    strncpy(rowcount_key.tblname, tblname, sizeof(rowcount_key.tblname));
+
+    if (!llmeta_sane_table_version_put(&rowcount_key, (uint8_t *)key,
+                                       (uint8_t *)key + LLMETA_IXLEN)) {
+        logmsg(LOGMSG_ERROR, "%s: llmeta_sane_table_version_put returns NULL\n",
+               __func__);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ *  Fetch the maintained row count for table "tblname".
+ *  Returns 0 and sets *count if the table has one; if not, returns -1 with
+ *  *bdberr set to BDBERR_FETCH_DTA.
+ *
+ */
+int bdb_get_rowcount(const char *tblname, tran_type *tran, int64_t *count,
+                     int *bdberr)
+{
+    char key[LLMETA_IXLEN] = {0};
+    unsigned long long tmp;
+    int fndlen;
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    if (llmeta_rowcount_key(tblname, key, bdberr))
+        return -1;
+
+    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, &tmp,
+                                   sizeof(tmp), &fndlen, bdberr);
+    if (rc || *bdberr != BDBERR_NOERROR)
+        return -1;
+    if (fndlen != sizeof(tmp)) {
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+
+    *count = flibc_ntohll(tmp);
+    return 0;
+}
+
+/**
+ *  Store the row count for table "tblname", replacing any previous value.
+ *
+ */
+int bdb_set_rowcount(const char *tblname, tran_type *tran, int64_t count,
+                     int *bdberr)
+{
+    char key[LLMETA_IXLEN] = {0};
+    unsigned long long tmp;
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    if (!tran) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    if (llmeta_rowcount_key(tblname, key, bdberr))
+        return -1;
+
+    rc = bdb_lite_exact_del(llmeta_bdb_state, tran, key, bdberr);
+    if (rc && *bdberr != BDBERR_DEL_DTA)
+        return rc;
+
+    tmp = flibc_htonll(count);
+    return bdb_lite_add(llmeta_bdb_state, tran, &tmp, sizeof(tmp), key, bdberr);
+}
+
+/**
+ *  Add "delta" to the row count of table "tblname".  This is a no-op if the
+ *  table does not have a maintained row count.  The record is fetched write
+ *  locked, so concurrent committers queue on it instead of deadlocking on a
+ *  read to write lock upgrade.
+ *
+ */
+int bdb_add_rowcount(const char *tblname, tran_type *tran, int64_t delta,
+                     int *bdberr)
+{
+    char key[LLMETA_IXLEN] = {0};
+    unsigned long long tmp;
+    int fndlen;
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    if (!tran) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    if (llmeta_rowcount_key(tblname, key, bdberr))
+        return -1;
+
+    rc = bdb_lite_exact_fetch_rmw_tran(llmeta_bdb_state, tran, key, &tmp,
+                                       sizeof(tmp), &fndlen, bdberr);
+    if (rc || *bdberr != BDBERR_NOERROR) {
+        if (*bdberr == BDBERR_FETCH_DTA) {
+            *bdberr = BDBERR_NOERROR;
+            return 0;
+        }
+        return -1;
+    }
+    if (fndlen != sizeof(tmp)) {
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+
+    return bdb_set_rowcount(tblname, tran, (int64_t)flibc_ntohll(tmp) + delta,
+                            bdberr);
+}
+
+/**
+ *  Remove the row count for table "tblname", if there is one.
+ *
+ */
+int bdb_del_rowcount(const char *tblname, tran_type *tran, int *bdberr)
+{
+    char key[LLMETA_IXLEN] = {0};
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    if (!tran) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    if (llmeta_rowcount_key(tblname, key, bdberr))
+        return -1;
+
+    rc = bdb_lite_exact_del(llmeta_bdb_state, tran, key, bdberr);
+    if (rc && *bdberr == BDBERR_DEL_DTA) {
+        *bdberr = BDBERR_NOERROR;
+        rc = 0;
+    }
+    return rc;
+}
+
+struct llmeta_zstd_dict_key {
+    int file_type;
+    unsigned int dictid;
+};
+
+enum { LLMETA_ZSTD_DICT_KEY_LEN = 4 + 4 };
+
+BB_COMPILE_TIME_ASSERT(llmeta_zstd_dict_key_len,
+                       sizeof(struct llmeta_zstd_dict_key) ==
+                           LLMETA_ZSTD_DICT_KEY_LEN);
+
+static uint8_t *llmeta_zstd_dict_key_put(const struct llmeta_zstd_dict_key *k,
+                                         uint8_t *p_buf,
+                                         const uint8_t *p_buf_end)
+{
+    if (p_buf_end < p_buf || LLMETA_ZSTD_DICT_KEY_LEN > (p_buf_end - p_buf))
+        return NULL;
+    p_buf = buf_put(&k->file_type, sizeof(k->file_type), p_buf, p_buf_end);
+    p_buf = buf_put(&k->dictid, sizeof(k->dictid), p_buf, p_buf_end);
+    return p_buf;
+}
+
+/**
+ *  Find the highest zstd dictionary id in use, 0 if there is none.
+ *  Ids are shared by all tables so that a row can be decompressed no matter
+ *  which table it was written to, or what that table is called now.
+ *
+ */
+int bdb_get_zstd_dict_highest(tran_type *tran, unsigned int *dictid,
+                              int *bdberr)
+{
+    struct llmeta_zstd_dict_key k = {LLMETA_ZSTD_DICT, UINT_MAX};
+    char key[LLMETA_IXLEN] = {0};
+    char fndkey[LLMETA_IXLEN] = {0};
+    int numfnd = 0;
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    *dictid = 0;
+    if (!llmeta_bdb_state) {
+        *bdberr = BDBERR_DBEMPTY;
+        return -1;
+    }
+    llmeta_zstd_dict_key_put(&k, (uint8_t *)key, (uint8_t *)key + LLMETA_IXLEN);
+
+    rc = bdb_lite_fetch_keys_bwd_tran(llmeta_bdb_state, tran, key, fndkey, 1,
+                                      &numfnd, bdberr);
+    if (rc || *bdberr != BDBERR_NOERROR) {
+        if (*bdberr != BDBERR_FETCH_DTA)
+            return -1;
+        *bdberr = BDBERR_NOERROR;
+        return 0;
+    }
+    if (numfnd && memcmp(key, fndkey, sizeof(int)) == 0)
+        buf_get(dictid, sizeof(*dictid), (uint8_t *)fndkey + sizeof(int),
+                (uint8_t *)fndkey + LLMETA_ZSTD_DICT_KEY_LEN);
+    return 0;
+}
+
+/**
+ *  Fetch zstd dictionary "dictid".  On success *dict is malloc'd and must be
+ *  freed by the caller.
+ *
+ */
+int bdb_get_zstd_dict(tran_type *tran, unsigned int dictid, void **dict,
+                      int *dictlen, int *bdberr)
+{
+    struct llmeta_zstd_dict_key k = {LLMETA_ZSTD_DICT, dictid};
+    char key[LLMETA_IXLEN] = {0};
+
+    *bdberr = BDBERR_NOERROR;
+    if (!llmeta_bdb_state) {
+        *bdberr = BDBERR_DBEMPTY;
+        return -1;
+    }
+    llmeta_zstd_dict_key_put(&k, (uint8_t *)key, (uint8_t *)key + LLMETA_IXLEN);
+    return bdb_lite_exact_var_fetch_tran(llmeta_bdb_state, tran, key, dict,
+                                         dictlen, bdberr);
+}
+
+/**
+ *  Store zstd dictionary "dictid".  Dictionaries are never replaced: rows
+ *  written with them may live for ever.
+ *
+ */
+int bdb_put_zstd_dict(tran_type *tran, unsigned int dictid, const void *dict,
+                      int dictlen, int *bdberr)
+{
+    struct llmeta_zstd_dict_key k = {LLMETA_ZSTD_DICT, dictid};
+    char key[LLMETA_IXLEN] = {0};
+
+    *bdberr = BDBERR_NOERROR;
+    if (!tran || dictid == 0) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    llmeta_zstd_dict_key_put(&k, (uint8_t *)key, (uint8_t *)key + LLMETA_IXLEN);
+    return bdb_lite_add(llmeta_bdb_state, tran, (void *)dict, dictlen, key,
+                        bdberr);
+}
+
+static int llmeta_table_zstd_dict_key(const char *tblname, char *key,
+                                      int *bdberr)
+{
+    struct llmeta_sane_table_version dict_key;
+
+    if (!llmeta_bdb_state) {
+        *bdberr = BDBERR_DBEMPTY;
+        return -1;
+    }
+    if (strlen(tblname) + 1 > sizeof(dict_key.tblname)) {
+        logmsg(LOGMSG_ERROR, "%s: tablename too long \"%s\"\n", __func__,
+               tblname);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    bzero(&dict_key, sizeof(dict_key));
+    dict_key.file_type = LLMETA_TABLE_ZSTD_DICT;
+    strncpy(dict_key.tblname, tblname, sizeof(dict_key.tblname));
+
+    if (!llmeta_sane_table_version_put(&dict_key, (uint8_t *)key,
+                                       (uint8_t *)key + LLMETA_IXLEN)) {
+        logmsg(LOGMSG_ERROR, "%s: llmeta_sane_table_version_put returns NULL\n",
+               __func__);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ *  Fetch the id of the dictionary new rows of "tblname" are compressed with.
+ *  Returns -1 with *bdberr set to BDBERR_FETCH_DTA if the table has none.
+ *
+ */
+int bdb_get_table_zstd_dict(const char *tblname, tran_type *tran,
+                            unsigned int *dictid, int *bdberr)
+{
+    char key[LLMETA_IXLEN] = {0};
+    unsigned int tmp;
+    int fndlen;
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    if (llmeta_table_zstd_dict_key(tblname, key, bdberr))
+        return -1;
+
+    rc = bdb_lite_exact_fetch_tran(llmeta_bdb_state, tran, key, &tmp,
+                                   sizeof(tmp), &fndlen, bdberr);
+    if (rc || *bdberr != BDBERR_NOERROR)
+        return -1;
+    if (fndlen != sizeof(tmp)) {
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+    *dictid = ntohl(tmp);
+    return 0;
+}
+
+int bdb_set_table_zstd_dict(const char *tblname, tran_type *tran,
+                            unsigned int dictid, int *bdberr)
+{
+    char key[LLMETA_IXLEN] = {0};
+    unsigned int tmp;
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    if (!tran) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    if (llmeta_table_zstd_dict_key(tblname, key, bdberr))
+        return -1;
+
+    rc = bdb_lite_exact_del(llmeta_bdb_state, tran, key, bdberr);
+    if (rc && *bdberr != BDBERR_DEL_DTA)
+        return rc;
+
+    tmp = htonl(dictid);
+    return bdb_lite_add(llmeta_bdb_state, tran, &tmp, sizeof(tmp), key, bdberr);
+}
+
+/**
+ *  Forget the dictionary of table "tblname".  The dictionary itself stays:
+ *  rows compressed with it may have been copied elsewhere.
+ *
+ */
+int bdb_del_table_zstd_dict(const char *tblname, tran_type *tran, int *bdberr)
+{
+    char key[LLMETA_IXLEN] = {0};
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    if (!tran) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    if (llmeta_table_zstd_dict_key(tblname, key, bdberr))
+        return -1;
+
+    rc = bdb_lite_exact_del(llmeta_bdb_state, tran, key, bdberr);
+    if (rc && *bdberr == BDBERR_DEL_DTA) {
+        *bdberr = BDBERR_NOERROR;
+        rc = 0;
+    }
+    return rc;
+}
+
 /**
  *  Select the TABLE VERSION ENTRY for table "bdb_state->name".
  *  If an entry doesn't exist, version 0 is returned
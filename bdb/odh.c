@@ -150,6 +150,8 @@ const char *bdb_algo2compr(int alg)
         return "crle";
     case BDB_COMPRESS_LZ4:
         return "lz4 ";
+    case BDB_COMPRESS_ZSTD:
+        return "zstd";
     default:
         return "????";
     }
@@ -165,6 +167,8 @@ int bdb_compr2algo(const char *a)
         return BDB_COMPRESS_CRLE;
     if (strncasecmp(a, "lz4", 3) == 0)
         return BDB_COMPRESS_LZ4;
+    if (strcasecmp(a, "zstd") == 0)
+        return BDB_COMPRESS_ZSTD;
     return BDB_COMPRESS_NONE;
 }
 
@@ -418,6 +422,16 @@ int bdb_pack(bdb_state_type *bdb_state, const struct odh *odh, void *to,
                 *recsize = rc + ODH_SIZE;
             }
             break;
+
+        case BDB_COMPRESS_ZSTD:
+            if ((rc = bdb_zstd_compress(bdb_state, odh->recptr, odh->length,
+                                        (char *)to + ODH_SIZE,
+                                        odh->length - 1)) <= 0) {
+                alg = BDB_COMPRESS_NONE;
+            } else {
+                *recsize = rc + ODH_SIZE;
+            }
+            break;
         }
 
         if (alg == BDB_COMPRESS_NONE) {
@@ -598,6 +612,15 @@ static int bdb_unpack_updateid(bdb_state_type *bdb_state, const void *from,
                 if (rc != fromlen - ODH_SIZE) {
                     goto err;
                 }
+            } else if (alg == BDB_COMPRESS_ZSTD) {
+                rc = bdb_zstd_decompress((char *)from + ODH_SIZE,
+                                         fromlen - ODH_SIZE, to, odh->length);
+                if (rc != odh->length) {
+                    logmsg(LOGMSG_ERROR,
+                           "%s:ERROR bdb_zstd_decompress rc %d expected %u\n",
+                           __func__, rc, (unsigned)odh->length);
+                    goto err;
+                }
             }
 
             /* Successfully decompressed */
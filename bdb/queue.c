@@ -2038,6 +2038,24 @@ static int bdb_queue_consume_int(bdb_state_type *bdb_state, tran_type *intran,
     return 0;
 }
 
+int bdb_queue_get_batch(bdb_state_type *bdb_state, int consumer,
+                        const struct bdb_queue_cursor *prevcursor, int max,
+                        void **fnd, size_t *fnddtalen, int *nfnd, int *bdberr)
+{
+    int rc;
+
+    if (bdb_state->bdbtype != BDBTYPE_QUEUEDB) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    BDB_READLOCK("bdb_queue_get_batch");
+    rc = bdb_queuedb_get_batch(bdb_state, consumer, prevcursor, max, fnd,
+                               fnddtalen, nfnd, bdberr);
+    BDB_RELLOCK();
+
+    return rc;
+}
+
 /* consume a queue item previously found by bdb_queue_get. */
 int bdb_queue_consume(bdb_state_type *bdb_state, tran_type *tran, int consumer,
                       const void *prevfnd, int *bdberr)
@@ -19,6 +19,7 @@
 #include "bdb_queuedb.h"
 #include "plbitlib.h"
 #include "logmsg.h"
+#include "comdb2_atomic.h"
 
 /* Another implementation of queues.  Don't really "trust" berkeley queues.
  * We've had some issues with
@@ -86,6 +87,93 @@ void bdb_queuedb_init_priv(bdb_state_type *bdb_state)
     qstate->genid = 0;
 }
 
+/* Adds and consumes are tallied on the transaction doing them, folded into
+ * the parent when a child commits, and only reach the queue's stats when the
+ * top level transaction commits, so that a deadlocked and retried or aborted
+ * transaction is not counted. */
+struct bdb_queue_tran_stats {
+    bdb_state_type *bdb_state;
+    uint64_t n_adds;
+    uint64_t n_consumes;
+    uint64_t consume_wait_sec;
+    unsigned max_consume_wait_sec;
+};
+
+/* The stats are best effort: NULL if they can't be allocated */
+static struct bdb_queue_tran_stats *queuedb_tran_stats(bdb_state_type *bdb_state,
+                                                       tran_type *tran)
+{
+    struct bdb_queue_tran_stats *s;
+    int i;
+
+    for (i = 0; i < tran->n_queue_stats; i++) {
+        if (tran->queue_stats[i].bdb_state == bdb_state)
+            return &tran->queue_stats[i];
+    }
+    if (tran->n_queue_stats == tran->alloc_queue_stats) {
+        int alloc = tran->alloc_queue_stats ? tran->alloc_queue_stats * 2 : 2;
+        s = realloc(tran->queue_stats, alloc * sizeof(*s));
+        if (s == NULL)
+            return NULL;
+        tran->queue_stats = s;
+        tran->alloc_queue_stats = alloc;
+    }
+    s = &tran->queue_stats[tran->n_queue_stats++];
+    memset(s, 0, sizeof(*s));
+    s->bdb_state = bdb_state;
+    return s;
+}
+
+void bdb_queuedb_stats_discard(tran_type *tran)
+{
+    free(tran->queue_stats);
+    tran->queue_stats = NULL;
+    tran->n_queue_stats = 0;
+    tran->alloc_queue_stats = 0;
+}
+
+/* a child committed: its adds and consumes now belong to the parent */
+void bdb_queuedb_stats_merge(tran_type *child)
+{
+    struct bdb_queue_tran_stats *c, *p;
+    int i;
+
+    for (i = 0; i < child->n_queue_stats; i++) {
+        c = &child->queue_stats[i];
+        if ((p = queuedb_tran_stats(c->bdb_state, child->parent)) == NULL)
+            continue;
+        p->n_adds += c->n_adds;
+        p->n_consumes += c->n_consumes;
+        p->consume_wait_sec += c->consume_wait_sec;
+        if (c->max_consume_wait_sec > p->max_consume_wait_sec)
+            p->max_consume_wait_sec = c->max_consume_wait_sec;
+    }
+    bdb_queuedb_stats_discard(child);
+}
+
+void bdb_queuedb_stats_commit(tran_type *tran)
+{
+    struct bdb_queue_tran_stats *s;
+    struct bdb_queue_priv *qstate;
+    unsigned max;
+    int i;
+
+    for (i = 0; i < tran->n_queue_stats; i++) {
+        s = &tran->queue_stats[i];
+        if ((qstate = s->bdb_state->qpriv) == NULL)
+            continue;
+        ATOMIC_ADD(qstate->stats.n_adds, s->n_adds);
+        ATOMIC_ADD(qstate->stats.n_consumes, s->n_consumes);
+        ATOMIC_ADD(qstate->stats.consume_wait_sec, s->consume_wait_sec);
+        max = qstate->stats.max_consume_wait_sec;
+        while (s->max_consume_wait_sec > max &&
+               !CAS(qstate->stats.max_consume_wait_sec, max,
+                    s->max_consume_wait_sec))
+            ;
+    }
+    bdb_queuedb_stats_discard(tran);
+}
+
 /* btree, so rely on our usual page size suggester */
 int bdb_queuedb_best_pagesize(int avg_item_sz)
 {
@@ -98,6 +186,7 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
 {
     DB *db;
     struct queuedb_key k;
+    struct bdb_queue_tran_stats *ts;
     int rc;
     DBT dbt_key = {0}, dbt_data = {0};
     uint8_t *p_buf, *p_buf_end;
@@ -184,6 +273,8 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
             }
         }
     }
+    if ((ts = queuedb_tran_stats(bdb_state, tran)) != NULL)
+        ts->n_adds++;
     rc = 0;
 
 done:
@@ -509,15 +600,122 @@ done:
     return rc;
 }
 
+int bdb_queuedb_get_batch(bdb_state_type *bdb_state, int consumer,
+                          const struct bdb_queue_cursor *prevcursor, int max,
+                          void **fnd, size_t *fnddtalen, int *nfnd,
+                          int *bdberr)
+{
+    DB *db = bdb_state->dbp_data[0][0];
+    struct queuedb_key k, fndk;
+    uint8_t key[QUEUEDB_KEY_LEN];
+    DBT dbt_key = {0}, dbt_data = {0};
+    DBC *dbcp;
+    int rc, crc, flag = DB_SET_RANGE;
+    struct bdb_queue_priv *qstate = bdb_state->qpriv;
+
+    *nfnd = 0;
+    if (db == NULL) { // trigger dropped?
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    if (gbl_debug_queuedb)
+        logmsg(LOGMSG_USER, ">> bdb_queuedb_get_batch %s max %d\n",
+               bdb_state->name, max);
+
+    k.consumer = consumer;
+    if (prevcursor)
+        memcpy(&k.genid, prevcursor->genid, sizeof(uint64_t));
+    else
+        k.genid = 0;
+    if (queuedb_key_put(&k, key, key + QUEUEDB_KEY_LEN) == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: failed to encode key for queue %s consumer %d\n",
+               __func__, bdb_state->name, consumer);
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+
+    if ((rc = db->cursor(db, NULL, &dbcp, 0)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s %s cursor rc %d\n", __func__, bdb_state->name,
+               rc);
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+    ATOMIC_ADD(qstate->stats.n_batch_gets, 1);
+
+    /* one cursor walks the consumer's items in key (ie. genid) order */
+    dbt_key.data = key;
+    dbt_key.size = dbt_key.ulen = QUEUEDB_KEY_LEN;
+    dbt_key.flags = DB_DBT_USERMEM;
+    *bdberr = BDBERR_NOERROR;
+    while (*nfnd < max) {
+        dbt_data.data = NULL;
+        dbt_data.flags = DB_DBT_MALLOC;
+        rc = dbcp->c_get(dbcp, &dbt_key, &dbt_data, flag);
+        flag = DB_NEXT;
+        if (rc == DB_NOTFOUND) {
+            break;
+        } else if (rc == DB_LOCK_DEADLOCK) {
+            *bdberr = BDBERR_DEADLOCK;
+            ATOMIC_ADD(qstate->stats.n_get_deadlocks, 1);
+            break;
+        } else if (rc) {
+            logmsg(LOGMSG_ERROR, "%s %s get rc %d\n", __func__, bdb_state->name,
+                   rc);
+            *bdberr = BDBERR_MISC;
+            break;
+        }
+        ATOMIC_ADD(qstate->stats.n_physical_gets, 1);
+        if (queuedb_key_get(&fndk, key, key + dbt_key.size) == NULL ||
+            fndk.consumer != consumer) {
+            /* end of this consumer's items */
+            free(dbt_data.data);
+            break;
+        }
+        if (prevcursor && fndk.genid == k.genid) {
+            /* the previous item, which isn't consumed yet */
+            free(dbt_data.data);
+            continue;
+        }
+        if (dbt_data.size < sizeof(struct bdb_queue_found)) {
+            logmsg(LOGMSG_ERROR, "%s: invalid queue entry size %d in queue %s\n",
+                   __func__, dbt_data.size, bdb_state->name);
+            free(dbt_data.data);
+            *bdberr = BDBERR_MISC;
+            break;
+        }
+        fnd[*nfnd] = dbt_data.data;
+        fnddtalen[*nfnd] = dbt_data.size;
+        ++*nfnd;
+    }
+
+    crc = dbcp->c_close(dbcp);
+    if (crc && *bdberr == BDBERR_NOERROR)
+        *bdberr = (crc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : BDBERR_MISC;
+    if (*bdberr != BDBERR_NOERROR) {
+        while (*nfnd > 0)
+            free(fnd[--*nfnd]);
+        return -1;
+    }
+    if (*nfnd == 0) {
+        ATOMIC_ADD(qstate->stats.n_get_not_founds, 1);
+        *bdberr = BDBERR_FETCH_DTA;
+        return -1;
+    }
+    return 0;
+}
+
 int bdb_queuedb_consume(bdb_state_type *bdb_state, tran_type *tran,
                         int consumer, const void *prevfnd, int *bdberr)
 {
-    struct bdb_queue_found qfnd;
+    struct bdb_queue_found qfnd, item;
+    uint8_t hdr[sizeof(struct bdb_queue_found)];
     uint8_t *p_buf, *p_buf_end;
     struct queuedb_key k;
     uint8_t key[QUEUEDB_KEY_LEN];
     int rc = 0;
     struct bdb_queue_priv *qstate = bdb_state->qpriv;
+    struct bdb_queue_tran_stats *ts;
 
     DBT dbt_key = {0}, dbt_data = {0};
     DBC *dbcp = NULL;
@@ -558,8 +756,12 @@ int bdb_queuedb_consume(bdb_state_type *bdb_state, tran_type *tran,
         fsnapf(stdout, key, QUEUEDB_KEY_LEN);
     }
 
-    /* we don't want to actually fetch the data, just position the cursor */
-    dbt_data.flags = DB_DBT_REALLOC;
+    /* we don't want to actually fetch the data, just position the cursor and
+     * read the item's header for its wait time */
+    dbt_data.data = hdr;
+    dbt_data.ulen = dbt_data.dlen = sizeof(hdr);
+    dbt_data.doff = 0;
+    dbt_data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
     dbt_key.data = key;
     dbt_key.size = QUEUEDB_KEY_LEN;
 
@@ -609,6 +811,17 @@ int bdb_queuedb_consume(bdb_state_type *bdb_state, tran_type *tran,
     if (gbl_debug_queuedb)
         logmsg(LOGMSG_USER, ">> CONSUMED!\n");
 
+    if ((ts = queuedb_tran_stats(bdb_state, tran)) != NULL) {
+        ts->n_consumes++;
+        if (queue_found_get(&item, hdr, hdr + dbt_data.size) && item.epoch) {
+            unsigned now = comdb2_time_epoch();
+            unsigned wait = (now > item.epoch) ? now - item.epoch : 0;
+            ts->consume_wait_sec += wait;
+            if (wait > ts->max_consume_wait_sec)
+                ts->max_consume_wait_sec = wait;
+        }
+    }
+
 /* and we consumed successfully */
 done:
     if (dbcp) {
@@ -625,7 +838,7 @@ done:
     }
     if (dbt_key.data && dbt_key.data != key)
         free(dbt_key.data);
-    if (dbt_data.data)
+    if (dbt_data.data && dbt_data.data != hdr)
         free(dbt_data.data);
     return rc;
 }
@@ -75,6 +75,19 @@ static void net_enque_write_rtn(netinfo_type *netinfo_ptr, void *netstat,
     pthread_mutex_unlock(&n->lock);
 }
 
+static void net_write_rtn(netinfo_type *netinfo_ptr, void *netstat,
+                          int64_t syscalls, int64_t bytes, int64_t copied)
+{
+    net_queue_stat_t *n = (net_queue_stat_t *)netstat;
+    if (n == NULL)
+        return;
+    pthread_mutex_lock(&n->lock);
+    n->write_syscalls += syscalls;
+    n->write_bytes += bytes;
+    n->copied_bytes += copied;
+    pthread_mutex_unlock(&n->lock);
+}
+
 static void net_enque_free(netinfo_type *netinfo_ptr, void *netstat)
 {
     net_queue_stat_t *n = (net_queue_stat_t *)netstat;
@@ -93,6 +106,7 @@ void net_rep_qstat_init(netinfo_type *netinfo_ptr)
     net_register_queue_stat(netinfo_ptr, net_init_queue_stats_rtn,
                             net_start_reader, net_enque_write_rtn,
                             net_clear_queue_stats_rtn, net_enque_free);
+    net_register_queue_stat_write(netinfo_ptr, net_write_rtn);
 }
 
 int rep_qstat_has_allreq(void)
@@ -35,6 +35,11 @@ typedef struct net_queue_stat {
     /* Other counts */
     int64_t unknown_count;
     int64_t total_count;
+
+    /* Writer thread totals; these are not reset when the queue drains */
+    int64_t write_syscalls;
+    int64_t write_bytes;
+    int64_t copied_bytes;
 } net_queue_stat_t;
 
 void net_rep_qstat_init(netinfo_type *netinfo_ptr);
@@ -23,6 +23,7 @@
 #include <string.h>
 #include <strings.h>
 #include <unistd.h>
+#include <sys/time.h>
 #include <assert.h>
 #include <openssl/rand.h>
 
@@ -104,10 +105,49 @@ struct temp_cursor {
     struct temp_list_node *list_cur;
     void *hash_cur;
     unsigned int hash_cur_buk;
+    struct temp_mem_node *mem_node;
+    int keycap; /* room at key/data, in-memory tables only */
+    int datacap;
     LINKC_T(struct temp_cursor) lnk;
 };
 
-enum { TEMP_TABLE_TYPE_BTREE, TEMP_TABLE_TYPE_HASH, TEMP_TABLE_TYPE_LIST };
+enum {
+    TEMP_TABLE_TYPE_BTREE,
+    TEMP_TABLE_TYPE_HASH,
+    TEMP_TABLE_TYPE_LIST,
+    TEMP_TABLE_TYPE_MEM
+};
+
+/*
+ * In-memory sorted temp tables.  A btree temp table starts out as a skiplist
+ * whose nodes are carved out of a private arena, and is copied into its
+ * berkdb btree once the arena grows past temptable_mem_budget bytes.  Deleted
+ * nodes stay linked (so cursors sitting on them can still step off them) and
+ * are unlinked in bulk once they outnumber the live ones.
+ */
+#define TEMP_MEM_MAXLEVEL 16
+#define TEMP_MEM_CHUNK (64 * 1024)
+
+struct temp_mem_node {
+    struct temp_mem_node *prev; /* level 0 only, NULL for the first node */
+    void *data;
+    int keylen;
+    int datalen;
+    int datacap;
+    uint8_t height;
+    uint8_t deleted;
+    struct temp_mem_node *next[/*height*/];
+    /* key follows */
+};
+
+#define TEMP_MEM_KEY(n) ((uint8_t *)&(n)->next[(n)->height])
+
+struct temp_mem_chunk {
+    struct temp_mem_chunk *next;
+    size_t size;
+    size_t used;
+    uint8_t buf[];
+};
 
 struct temp_table {
     DB_ENV *dbenv_temp;
@@ -127,6 +167,15 @@ struct temp_table {
     int max_mem_entries;
     LISTC_T(struct temp_cursor) cursors;
     void *next;
+
+    /* TEMP_TABLE_TYPE_MEM */
+    struct temp_mem_node *mem_head;
+    int mem_level;
+    int mem_ndeleted;
+    unsigned int mem_seed;
+    struct temp_mem_chunk *mem_chunks;
+    size_t mem_bytes;
+    size_t mem_budget;
 };
 
 enum { TMPTBL_PRIORITY, TMPTBL_WAIT };
@@ -238,6 +287,446 @@ done:
     return rc;
 }
 
+static void *temp_mem_alloc(struct temp_table *tbl, size_t sz)
+{
+    struct temp_mem_chunk *c = tbl->mem_chunks;
+    void *p;
+
+    sz = (sz + 7) & ~(size_t)7;
+    if (c == NULL || c->size - c->used < sz) {
+        size_t csz = sz > TEMP_MEM_CHUNK ? sz : TEMP_MEM_CHUNK;
+        c = malloc(offsetof(struct temp_mem_chunk, buf) + csz);
+        if (c == NULL)
+            return NULL;
+        c->size = csz;
+        c->used = 0;
+        c->next = tbl->mem_chunks;
+        tbl->mem_chunks = c;
+        tbl->mem_bytes += csz;
+    }
+    p = c->buf + c->used;
+    c->used += sz;
+    return p;
+}
+
+/* Drop every row; cursors are left unpositioned. */
+static void temp_mem_reset(struct temp_table *tbl)
+{
+    struct temp_mem_chunk *c;
+    struct temp_cursor *cur;
+
+    while ((c = tbl->mem_chunks) != NULL) {
+        tbl->mem_chunks = c->next;
+        free(c);
+    }
+    tbl->mem_bytes = 0;
+    if (tbl->mem_head)
+        memset(tbl->mem_head->next, 0,
+               TEMP_MEM_MAXLEVEL * sizeof(struct temp_mem_node *));
+    tbl->mem_level = 1;
+    tbl->mem_ndeleted = 0;
+    tbl->num_mem_entries = 0;
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk) { cur->mem_node = NULL; }
+}
+
+/*
+ * Switch an empty table with no open cursors between the in-memory engine
+ * (budget > 0) and the plain berkdb btree.
+ */
+static int temp_mem_set_engine(struct temp_table *tbl, size_t budget)
+{
+    if (budget == 0) {
+        temp_mem_reset(tbl);
+        tbl->temp_table_type = TEMP_TABLE_TYPE_BTREE;
+        return 0;
+    }
+    if (tbl->mem_head == NULL) {
+        tbl->mem_head =
+            calloc(1, sizeof(struct temp_mem_node) +
+                          TEMP_MEM_MAXLEVEL * sizeof(struct temp_mem_node *));
+        if (tbl->mem_head == NULL)
+            return ENOMEM;
+        tbl->mem_head->height = TEMP_MEM_MAXLEVEL;
+        tbl->mem_seed = (unsigned int)(uintptr_t)tbl | 1;
+    }
+    temp_mem_reset(tbl);
+    tbl->mem_budget = budget;
+    tbl->temp_table_type = TEMP_TABLE_TYPE_MEM;
+    return 0;
+}
+
+static inline int temp_mem_cmp(struct temp_table *tbl, const void *key,
+                               int keylen, void *unpacked,
+                               struct temp_mem_node *n)
+{
+    /* same argument order as temp_table_compare() */
+    if (unpacked)
+        return -tbl->cmpfunc(NULL, n->keylen, TEMP_MEM_KEY(n), -1, unpacked);
+    return tbl->cmpfunc(tbl->usermem, keylen, key, n->keylen,
+                        TEMP_MEM_KEY(n));
+}
+
+/* First node, live or not, that is >= key; fills in each level's predecessor */
+static struct temp_mem_node *temp_mem_seek(struct temp_table *tbl,
+                                           const void *key, int keylen,
+                                           void *unpacked,
+                                           struct temp_mem_node **update)
+{
+    struct temp_mem_node *x = tbl->mem_head, *n;
+    int lvl;
+
+    for (lvl = tbl->mem_level - 1; lvl >= 0; --lvl) {
+        while ((n = x->next[lvl]) != NULL &&
+               temp_mem_cmp(tbl, key, keylen, unpacked, n) > 0)
+            x = n;
+        if (update)
+            update[lvl] = x;
+    }
+    return x->next[0];
+}
+
+static int temp_mem_height(struct temp_table *tbl)
+{
+    unsigned int r;
+    int h = 1;
+
+    /* xorshift; each level is 1/4 as likely as the one below */
+    r = tbl->mem_seed;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    tbl->mem_seed = r;
+    while (h < TEMP_MEM_MAXLEVEL && (r & 3) == 0) {
+        ++h;
+        r >>= 2;
+    }
+    return h;
+}
+
+static int temp_mem_set_data(struct temp_table *tbl, struct temp_mem_node *n,
+                             const void *data, int dtalen)
+{
+    if (dtalen > n->datacap) {
+        void *p = temp_mem_alloc(tbl, dtalen);
+        if (p == NULL)
+            return ENOMEM;
+        n->data = p;
+        n->datacap = dtalen;
+    }
+    memcpy(n->data, data, dtalen);
+    n->datalen = dtalen;
+    return 0;
+}
+
+/* Insert or overwrite, like a put into a btree without duplicates. */
+static int temp_mem_put(struct temp_table *tbl, const void *key, int keylen,
+                        const void *data, int dtalen, void *unpacked,
+                        struct temp_mem_node **pos)
+{
+    struct temp_mem_node *update[TEMP_MEM_MAXLEVEL];
+    struct temp_mem_node *x;
+    int h, lvl;
+
+    x = temp_mem_seek(tbl, key, keylen, unpacked, update);
+    if (x && temp_mem_cmp(tbl, key, keylen, unpacked, x) == 0) {
+        if (temp_mem_set_data(tbl, x, data, dtalen))
+            return ENOMEM;
+        if (x->deleted) {
+            x->deleted = 0;
+            tbl->mem_ndeleted--;
+            tbl->num_mem_entries++;
+        }
+        *pos = x;
+        return 0;
+    }
+
+    h = temp_mem_height(tbl);
+    x = temp_mem_alloc(tbl, offsetof(struct temp_mem_node, next) +
+                                h * sizeof(struct temp_mem_node *) + keylen +
+                                dtalen);
+    if (x == NULL)
+        return ENOMEM;
+    for (lvl = tbl->mem_level; lvl < h; ++lvl)
+        update[lvl] = tbl->mem_head;
+    if (h > tbl->mem_level)
+        tbl->mem_level = h;
+
+    x->height = h;
+    x->deleted = 0;
+    x->keylen = keylen;
+    memcpy(TEMP_MEM_KEY(x), key, keylen);
+    x->data = TEMP_MEM_KEY(x) + keylen;
+    x->datalen = x->datacap = dtalen;
+    memcpy(x->data, data, dtalen);
+
+    for (lvl = 0; lvl < h; ++lvl) {
+        x->next[lvl] = update[lvl]->next[lvl];
+        update[lvl]->next[lvl] = x;
+    }
+    x->prev = update[0] == tbl->mem_head ? NULL : update[0];
+    if (x->next[0])
+        x->next[0]->prev = x;
+    tbl->num_mem_entries++;
+    *pos = x;
+    return 0;
+}
+
+static int temp_mem_node_in_use(struct temp_table *tbl,
+                                struct temp_mem_node *n)
+{
+    struct temp_cursor *cur;
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        if (cur->mem_node == n)
+            return 1;
+    }
+    return 0;
+}
+
+/* Unlink deleted nodes that no cursor is sitting on. */
+static void temp_mem_purge(struct temp_table *tbl)
+{
+    struct temp_mem_node *last[TEMP_MEM_MAXLEVEL];
+    struct temp_mem_node *x, *nx;
+    int lvl;
+
+    for (lvl = 0; lvl < TEMP_MEM_MAXLEVEL; ++lvl)
+        last[lvl] = tbl->mem_head;
+    for (x = tbl->mem_head->next[0]; x; x = nx) {
+        nx = x->next[0];
+        if (x->deleted && !temp_mem_node_in_use(tbl, x)) {
+            for (lvl = 0; lvl < x->height; ++lvl)
+                last[lvl]->next[lvl] = x->next[lvl];
+            tbl->mem_ndeleted--;
+            continue;
+        }
+        x->prev = last[0] == tbl->mem_head ? NULL : last[0];
+        for (lvl = 0; lvl < x->height; ++lvl)
+            last[lvl] = x;
+    }
+}
+
+static int temp_mem_cursor_set(struct temp_cursor *cur,
+                               struct temp_mem_node *n)
+{
+    cur->mem_node = n;
+    if (n->keylen > cur->keycap) {
+        void *p = realloc(cur->key, n->keylen);
+        if (p == NULL)
+            return ENOMEM;
+        cur->key = p;
+        cur->keycap = n->keylen;
+    }
+    if (n->datalen > cur->datacap) {
+        void *p = realloc(cur->data, n->datalen);
+        if (p == NULL)
+            return ENOMEM;
+        cur->data = p;
+        cur->datacap = n->datalen;
+    }
+    memcpy(cur->key, TEMP_MEM_KEY(n), n->keylen);
+    cur->keylen = n->keylen;
+    memcpy(cur->data, n->data, n->datalen);
+    cur->datalen = n->datalen;
+    cur->valid = 1;
+    return 0;
+}
+
+static struct temp_mem_node *temp_mem_last(struct temp_table *tbl)
+{
+    struct temp_mem_node *x = tbl->mem_head;
+    int lvl;
+
+    for (lvl = tbl->mem_level - 1; lvl >= 0; --lvl)
+        while (x->next[lvl])
+            x = x->next[lvl];
+    return x == tbl->mem_head ? NULL : x;
+}
+
+static int temp_mem_first_last(struct temp_cursor *cur, int *bdberr, int how)
+{
+    struct temp_table *tbl = cur->tbl;
+    struct temp_mem_node *n;
+
+    cur->valid = 0;
+    if (how == DB_FIRST) {
+        for (n = tbl->mem_head->next[0]; n && n->deleted; n = n->next[0])
+            ;
+    } else {
+        for (n = temp_mem_last(tbl); n && n->deleted; n = n->prev)
+            ;
+    }
+    if (n == NULL)
+        return IX_EMPTY;
+    if ((*bdberr = temp_mem_cursor_set(cur, n)) != 0)
+        return -1;
+    return 0;
+}
+
+static int temp_mem_next_prev(struct temp_cursor *cur, int *bdberr, int how)
+{
+    struct temp_table *tbl = cur->tbl;
+    struct temp_mem_node *n = cur->mem_node;
+
+    /* an unpositioned cursor steps onto the first/last row, as in berkdb */
+    if (how == DB_NEXT) {
+        n = n ? n->next[0] : tbl->mem_head->next[0];
+        while (n && n->deleted)
+            n = n->next[0];
+    } else {
+        n = n ? n->prev : temp_mem_last(tbl);
+        while (n && n->deleted)
+            n = n->prev;
+    }
+    if (n == NULL)
+        return IX_PASTEOF;
+    if ((*bdberr = temp_mem_cursor_set(cur, n)) != 0)
+        return -1;
+    return IX_FND;
+}
+
+static int temp_mem_spill_put(struct temp_table *tbl, struct temp_mem_node *n)
+{
+    DBT dkey, ddata;
+
+    memset(&dkey, 0, sizeof(DBT));
+    memset(&ddata, 0, sizeof(DBT));
+    dkey.data = TEMP_MEM_KEY(n);
+    dkey.size = n->keylen;
+    ddata.data = n->data;
+    ddata.size = n->datalen;
+    return tbl->tmpdb->put(tbl->tmpdb, NULL, &dkey, &ddata, 0);
+}
+
+/* Undo a failed spill: the table stays in memory with its cursors */
+static void temp_mem_spill_undo(struct temp_table *tbl,
+                                struct temp_mem_node *upto)
+{
+    struct temp_mem_node *n;
+    struct temp_cursor *cur;
+    DBT dkey;
+
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        if (cur->cur) {
+            cur->cur->c_close(cur->cur);
+            cur->cur = NULL;
+        }
+    }
+    memset(&dkey, 0, sizeof(DBT));
+    for (n = tbl->mem_head->next[0]; n != upto; n = n->next[0]) {
+        dkey.data = TEMP_MEM_KEY(n);
+        dkey.size = n->keylen;
+        tbl->tmpdb->del(tbl->tmpdb, NULL, &dkey, 0);
+    }
+}
+
+/*
+ * Copy the rows into the berkdb btree and switch the table over.  Cursors
+ * get a berkdb cursor on the row they were on.  A deleted row that a cursor
+ * still sits on is copied too and then deleted through that cursor, which
+ * leaves it where a berkdb cursor would be after c_del: next and prev both
+ * step to the live neighbours.
+ */
+static int temp_mem_spill(struct temp_table *tbl, int *bdberr)
+{
+    struct temp_mem_node *n;
+    struct temp_cursor *cur;
+    DBT dkey, ddata;
+    int rc, nrecs = 0;
+
+    for (n = tbl->mem_head->next[0]; n; n = n->next[0]) {
+        if (n->deleted)
+            continue;
+        rc = temp_mem_spill_put(tbl, n);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
+            temp_mem_spill_undo(tbl, n);
+            *bdberr = rc;
+            return -1;
+        }
+        nrecs++;
+    }
+
+    memset(&dkey, 0, sizeof(DBT));
+    memset(&ddata, 0, sizeof(DBT));
+    ddata.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        rc = tbl->tmpdb->cursor(tbl->tmpdb, NULL, &cur->cur, 0);
+        if (rc) {
+            cur->cur = NULL;
+            logmsg(LOGMSG_ERROR, "%s:%d cursor rc %d\n", __FILE__, __LINE__,
+                   rc);
+            goto err;
+        }
+        if ((n = cur->mem_node) == NULL)
+            continue;
+        if (n->deleted && (rc = temp_mem_spill_put(tbl, n)) != 0) {
+            logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
+            goto err;
+        }
+        dkey.data = TEMP_MEM_KEY(n);
+        dkey.size = n->keylen;
+        rc = cur->cur->c_get(cur->cur, &dkey, &ddata, DB_SET);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d c_get rc %d\n", __FILE__, __LINE__,
+                   rc);
+            goto err;
+        }
+    }
+
+    /* every cursor is positioned; now drop the deleted rows under them.
+     * Another cursor on the same row has already seen it go. */
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        if (cur->mem_node == NULL || !cur->mem_node->deleted)
+            continue;
+        rc = cur->cur->c_del(cur->cur, 0);
+        if (rc && rc != DB_KEYEMPTY) {
+            logmsg(LOGMSG_ERROR, "%s:%d c_del rc %d\n", __FILE__, __LINE__,
+                   rc);
+            goto err;
+        }
+    }
+
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        /* berkdb cursors own malloced key/data; ours can be handed over */
+        cur->keycap = cur->datacap = 0;
+        cur->mem_node = NULL;
+    }
+    temp_mem_reset(tbl);
+    tbl->num_mem_entries = nrecs;
+    tbl->temp_table_type = TEMP_TABLE_TYPE_BTREE;
+    return 0;
+
+err:
+    temp_mem_spill_undo(tbl, NULL);
+    *bdberr = rc;
+    return -1;
+}
+
+static int temp_mem_insert(struct temp_table *tbl, struct temp_cursor *cur,
+                           void *key, int keylen, void *data, int dtalen,
+                           void *unpacked, int *bdberr)
+{
+    struct temp_mem_node *pos;
+    int rc;
+
+    rc = temp_mem_put(tbl, key, keylen, data, dtalen, unpacked, &pos);
+    if (rc) {
+        *bdberr = rc;
+        return -1;
+    }
+    /* a berkdb c_put leaves the cursor on the new row */
+    if (cur)
+        cur->mem_node = pos;
+    if (tbl->mem_bytes > tbl->mem_budget)
+        return temp_mem_spill(tbl, bdberr);
+    return 0;
+}
+
 static int bdb_temp_table_init_temp_db(bdb_state_type *bdb_state,
                                        struct temp_table *tbl, int *bdberr)
 {
@@ -341,6 +830,9 @@ static struct temp_table *bdb_temp_table_create_main(bdb_state_type *bdb_state,
     tbl->next = NULL;
     tbl->tmpdb = NULL;
     tbl->cmpfunc = key_memcmp;
+    tbl->mem_head = NULL;
+    tbl->mem_chunks = NULL;
+    tbl->mem_bytes = 0;
 
     rc = db_env_create(&dbenv_temp, 0);
     if (rc != 0) {
@@ -555,6 +1047,11 @@ static struct temp_table *bdb_temp_table_create_type(bdb_state_type *bdb_state,
     table->cmpfunc = key_memcmp;
     table->temp_table_type = temp_table_type;
 
+    /* if this fails the table simply stays a btree */
+    if (temp_table_type == TEMP_TABLE_TYPE_BTREE &&
+        bdb_state->attr->temptable_mem_budget > 0)
+        temp_mem_set_engine(table, bdb_state->attr->temptable_mem_budget);
+
     return table;
 }
 
@@ -611,6 +1108,10 @@ struct temp_cursor *bdb_temp_table_cursor(bdb_state_type *bdb_state,
         rc = 0;
         break;
 
+    case TEMP_TABLE_TYPE_MEM:
+        rc = 0;
+        break;
+
     case TEMP_TABLE_TYPE_BTREE:
         rc = tbl->tmpdb->cursor(tbl->tmpdb, NULL, &cur->cur, 0);
         break;
@@ -645,9 +1146,16 @@ int bdb_temp_table_insert(bdb_state_type *bdb_state, struct temp_cursor *cur,
 {
     DBT dkey, ddata;
     struct temp_table *tbl = cur->tbl;
+    int rc;
 
-    int rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data,
-                                       dtalen, bdberr);
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_MEM) {
+        rc = temp_mem_insert(tbl, cur, key, keylen, data, dtalen, NULL,
+                             bdberr);
+        goto done;
+    }
+
+    rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data, dtalen,
+                                   bdberr);
     if (rc <= 0)
         goto done;
 
@@ -683,6 +1191,21 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
     DBT dkey, ddata;
     int rc = 0;
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEM) {
+        struct temp_mem_node *n = cur->mem_node;
+        if (n == NULL || n->deleted) {
+            *bdberr = DB_KEYEMPTY;
+            return -1;
+        }
+        if ((rc = temp_mem_set_data(cur->tbl, n, data, dtalen)) != 0) {
+            *bdberr = rc;
+            return -1;
+        }
+        if (cur->tbl->mem_bytes > cur->tbl->mem_budget)
+            return temp_mem_spill(cur->tbl, bdberr);
+        return 0;
+    }
+
     if (cur->tbl->temp_table_type != TEMP_TABLE_TYPE_BTREE) {
         logmsg(LOGMSG_ERROR, "bdb_temp_table_update operation "
                         "only supported for btree.\n");
@@ -725,9 +1248,16 @@ int bdb_temp_table_put(bdb_state_type *bdb_state, struct temp_table *tbl,
                        void *unpacked, int *bdberr)
 {
     DBT dkey, ddata;
+    int rc;
+
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_MEM) {
+        rc = temp_mem_insert(tbl, NULL, key, keylen, data, dtalen, unpacked,
+                             bdberr);
+        goto done;
+    }
 
-    int rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data,
-                                       dtalen, bdberr);
+    rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data, dtalen,
+                                   bdberr);
     if (rc <= 0)
         goto done;
 
@@ -800,6 +1330,9 @@ static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEM)
+        return temp_mem_first_last(cur, bdberr, how);
+
     /* if cursor was deleted, need to reopen */
     if (cur->cur == NULL) {
         int rc = cur->tbl->tmpdb->cursor(cur->tbl->tmpdb, NULL, &cur->cur, 0);
@@ -892,6 +1425,9 @@ static int bdb_temp_table_next_prev_norewind(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEM)
+        return temp_mem_next_prev(cur, bdberr, how);
+
     /* if cursor was deleted, need to reopen */
     if (cur->cur == NULL) {
         int rc = cur->tbl->tmpdb->cursor(cur->tbl->tmpdb, NULL, &cur->cur, 0);
@@ -1162,6 +1698,10 @@ int bdb_temp_table_truncate(bdb_state_type *bdb_state, struct temp_table *tbl,
         }
         break;
 
+    case TEMP_TABLE_TYPE_MEM:
+        temp_mem_reset(tbl);
+        break;
+
     case TEMP_TABLE_TYPE_BTREE:
 
         if (tbl->num_mem_entries < 100)
@@ -1383,9 +1923,14 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
         hash_clear(tbl->temp_hash_tbl);
     } break;
 
+    case TEMP_TABLE_TYPE_MEM:
+        temp_mem_reset(tbl);
+        break;
+
     case TEMP_TABLE_TYPE_BTREE:
         break;
     }
+    free(tbl->mem_head);
 
     hash_free(tbl->temp_hash_tbl);
     tbl->temp_hash_tbl = NULL;
@@ -1428,6 +1973,21 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
         goto done;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEM) {
+        struct temp_table *tbl = cur->tbl;
+        if (cur->mem_node == NULL || cur->mem_node->deleted) {
+            *bdberr = DB_KEYEMPTY;
+            return -1;
+        }
+        rc = 0;
+        cur->mem_node->deleted = 1;
+        tbl->mem_ndeleted++;
+        tbl->num_mem_entries--;
+        if (tbl->mem_ndeleted > 64 && tbl->mem_ndeleted > tbl->num_mem_entries)
+            temp_mem_purge(tbl);
+        goto done;
+    }
+
     assert(cur->cur != NULL);
     rc = cur->cur->c_del(cur->cur, 0);
     if (rc) {
@@ -1529,6 +2089,18 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
     else if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         return bdb_temp_table_find_hash(cur, key, keylen);
     }
+    else if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEM) {
+        struct temp_mem_node *n;
+        cur->valid = 0;
+        n = temp_mem_seek(cur->tbl, key, keylen, unpacked, NULL);
+        while (n && n->deleted)
+            n = n->next[0];
+        if (n == NULL) /* find anything at all if possible */
+            return bdb_temp_table_last(bdb_state, cur, bdberr);
+        if ((*bdberr = temp_mem_cursor_set(cur, n)) != 0)
+            return -1;
+        return 0;
+    }
 
     assert(cur->cur != NULL);
 
@@ -1640,6 +2212,17 @@ int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
     else if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         return bdb_temp_table_find_exact_hash(cur, key, keylen);
     }
+    else if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEM) {
+        struct temp_mem_node *n;
+        cur->valid = 0;
+        n = temp_mem_seek(cur->tbl, key, keylen, NULL, NULL);
+        if (n == NULL || n->deleted ||
+            temp_mem_cmp(cur->tbl, key, keylen, NULL, n) != 0)
+            return IX_NOTFND;
+        if ((*bdberr = temp_mem_cursor_set(cur, n)) != 0)
+            return -1;
+        return IX_FND;
+    }
 
     /*pthread_setspecific(cur->tbl->curkey, cur);*/
 
@@ -1720,7 +2303,8 @@ int bdb_temp_table_close_cursor(bdb_state_type *bdb_state,
     struct temp_table *tbl;
     tbl = cur->tbl;
 
-    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE) {
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE ||
+        cur->tbl->temp_table_type == TEMP_TABLE_TYPE_MEM) {
         if (cur->key) {
 #if 0
           printf( "%p Freeing %p\n", cur, cur->key);
@@ -1763,6 +2347,7 @@ inline void bdb_temp_table_reset_datapointers(struct temp_cursor *cur)
     if (cur) {
         cur->datalen = 0;
         cur->data = NULL;
+        cur->datacap = 0;
     }
 }
 
@@ -2003,3 +2588,383 @@ int bdb_temp_table_insert_test(bdb_state_type *bdb_state, int recsz, int maxins)
     rc = bdb_temp_table_close(parent, db, &bdberr);
     return rc;
 }
+
+/* splitmix64 finalizer: a bijection, so distinct i give distinct keys */
+static uint64_t temp_bench_key(uint64_t i)
+{
+    i = (i ^ (i >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    i = (i ^ (i >> 27)) * 0x94d049bb133111ebULL;
+    return i ^ (i >> 31);
+}
+
+static uint64_t temp_bench_usecs(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+static int temp_bench_run(bdb_state_type *bdb_state, FILE *out, int nrows,
+                          size_t budget, const char *engine)
+{
+    struct temp_table *tbl;
+    struct temp_cursor *cur;
+    uint64_t start, ins_us, find_us, next_us, k;
+    uint8_t data[16];
+    int bdberr = 0, rc = 0, i, n;
+
+    tbl = bdb_temp_table_create(bdb_state, &bdberr);
+    if (tbl == NULL)
+        return -1;
+    if ((rc = temp_mem_set_engine(tbl, budget)) != 0 ||
+        (cur = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr)) == NULL) {
+        bdb_temp_table_close(bdb_state, tbl, &bdberr);
+        return -1;
+    }
+    memset(data, 0, sizeof(data));
+
+    start = temp_bench_usecs();
+    for (i = 0; i < nrows && rc == 0; ++i) {
+        k = temp_bench_key(i);
+        rc = bdb_temp_table_insert(bdb_state, cur, &k, sizeof(k), data,
+                                   sizeof(data), &bdberr);
+    }
+    ins_us = temp_bench_usecs() - start;
+
+    start = temp_bench_usecs();
+    for (i = 0; i < nrows && rc == 0; ++i) {
+        k = temp_bench_key((i * 7919ULL) % nrows);
+        if (bdb_temp_table_find_exact(bdb_state, cur, &k, sizeof(k),
+                                      &bdberr) != IX_FND)
+            rc = -1;
+    }
+    find_us = temp_bench_usecs() - start;
+
+    start = temp_bench_usecs();
+    n = 0;
+    if (rc == 0) {
+        rc = bdb_temp_table_first(bdb_state, cur, &bdberr);
+        while (rc == 0) {
+            ++n;
+            rc = bdb_temp_table_next(bdb_state, cur, &bdberr);
+        }
+        rc = (rc == IX_PASTEOF && n == nrows) ? 0 : -1;
+    }
+    next_us = temp_bench_usecs() - start;
+
+    if (rc == 0)
+        logmsgf(LOGMSG_USER, out, "%10d %-8s %12.0f %12.0f %12.0f %8s\n",
+                nrows, engine, ins_us ? nrows * 1e6 / ins_us : 0.0,
+                find_us ? nrows * 1e6 / find_us : 0.0,
+                next_us ? nrows * 1e6 / next_us : 0.0,
+                tbl->temp_table_type == TEMP_TABLE_TYPE_MEM ? "no" : "yes");
+    else
+        logmsgf(LOGMSG_ERROR, out, "%s: %d rows on %s failed bdberr %d\n",
+                __func__, nrows, engine, bdberr);
+
+    bdb_temp_table_close_cursor(bdb_state, cur, &bdberr);
+    bdb_temp_table_close(bdb_state, tbl, &bdberr);
+    return rc;
+}
+
+/*
+ * Insert, point lookup and full scan rates for 1K, 100K and 10M row temp
+ * tables (up to maxrows), on berkdb, on the in-memory engine with no
+ * budget, and on the in-memory engine with the configured budget.
+ */
+int bdb_temp_table_bench(bdb_state_type *bdb_state, FILE *out, int maxrows)
+{
+    static const int sizes[] = {1000, 100000, 10000000};
+    size_t budget;
+    int i;
+
+    if (bdb_state->parent)
+        bdb_state = bdb_state->parent;
+    if (maxrows <= 0)
+        maxrows = 10000000;
+    budget = bdb_state->attr->temptable_mem_budget;
+
+    logmsgf(LOGMSG_USER, out, "%10s %-8s %12s %12s %12s %8s\n", "rows",
+            "engine", "inserts/s", "finds/s", "nexts/s", "spilled");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        if (sizes[i] > maxrows)
+            break;
+        if (temp_bench_run(bdb_state, out, sizes[i], 0, "berkdb") ||
+            temp_bench_run(bdb_state, out, sizes[i], SIZE_MAX, "mem"))
+            return -1;
+        if (budget > 0 &&
+            temp_bench_run(bdb_state, out, sizes[i], budget, "budget"))
+            return -1;
+    }
+    return 0;
+}
+
+/* big-endian, so that key_memcmp orders the keys by i */
+static void temp_spill_test_key(uint8_t *key, int i)
+{
+    key[0] = i >> 24;
+    key[1] = i >> 16;
+    key[2] = i >> 8;
+    key[3] = i;
+}
+
+static int temp_spill_test_row(struct temp_cursor *cur)
+{
+    uint8_t *key = bdb_temp_table_key(cur);
+    return key[0] << 24 | key[1] << 16 | key[2] << 8 | key[3];
+}
+
+static struct temp_table *temp_spill_test_fill(bdb_state_type *bdb_state,
+                                               int nrows)
+{
+    struct temp_table *tbl;
+    struct temp_cursor *cur;
+    uint8_t key[4];
+    int bdberr = 0, rc = 0, i;
+
+    tbl = bdb_temp_table_create(bdb_state, &bdberr);
+    if (tbl == NULL)
+        return NULL;
+    if (temp_mem_set_engine(tbl, SIZE_MAX) ||
+        (cur = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr)) == NULL) {
+        bdb_temp_table_close(bdb_state, tbl, &bdberr);
+        return NULL;
+    }
+    for (i = 0; i < nrows && rc == 0; ++i) {
+        temp_spill_test_key(key, i);
+        rc = bdb_temp_table_insert(bdb_state, cur, key, sizeof(key), key,
+                                   sizeof(key), &bdberr);
+    }
+    bdb_temp_table_close_cursor(bdb_state, cur, &bdberr);
+    if (rc) {
+        bdb_temp_table_close(bdb_state, tbl, &bdberr);
+        return NULL;
+    }
+    return tbl;
+}
+
+static int temp_spill_test_seek(bdb_state_type *bdb_state,
+                                struct temp_cursor *cur, int row)
+{
+    uint8_t key[4];
+    int bdberr = 0;
+
+    temp_spill_test_key(key, row);
+    if (bdb_temp_table_find_exact(bdb_state, cur, key, sizeof(key), &bdberr) !=
+        IX_FND)
+        return -1;
+    return temp_spill_test_row(cur) == row ? 0 : -1;
+}
+
+/* step cur in direction how and expect rows from, from+step, ... then EOF */
+static int temp_spill_test_expect(bdb_state_type *bdb_state,
+                                  struct temp_cursor *cur, int how, int from,
+                                  int to)
+{
+    int bdberr = 0, rc, step = how == DB_NEXT ? 1 : -1, i;
+
+    for (i = from; i != to + step; i += step) {
+        rc = how == DB_NEXT ? bdb_temp_table_next(bdb_state, cur, &bdberr)
+                            : bdb_temp_table_prev(bdb_state, cur, &bdberr);
+        if (rc != IX_FND || temp_spill_test_row(cur) != i)
+            return -1;
+    }
+    rc = how == DB_NEXT ? bdb_temp_table_next(bdb_state, cur, &bdberr)
+                        : bdb_temp_table_prev(bdb_state, cur, &bdberr);
+    return rc == IX_PASTEOF ? 0 : -1;
+}
+
+/*
+ * Scan to row stop, optionally delete it, spill, then finish the scan in the
+ * same direction, and count what is left from a fresh cursor.
+ */
+static int temp_spill_test_scan(bdb_state_type *bdb_state, int how, int stop,
+                                int del)
+{
+    struct temp_table *tbl;
+    struct temp_cursor *cur, *chk;
+    int bdberr = 0, rc = -1, n = 0, nrows = 100, i;
+    int step = how == DB_NEXT ? 1 : -1;
+
+    if ((tbl = temp_spill_test_fill(bdb_state, nrows)) == NULL)
+        return -1;
+    cur = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr);
+    chk = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr);
+    if (cur == NULL || chk == NULL)
+        goto out;
+
+    rc = how == DB_NEXT ? bdb_temp_table_first(bdb_state, cur, &bdberr)
+                        : bdb_temp_table_last(bdb_state, cur, &bdberr);
+    for (i = how == DB_NEXT ? 0 : nrows - 1; rc == IX_FND && i != stop;
+         i += step) {
+        if (temp_spill_test_row(cur) != i)
+            break;
+        rc = how == DB_NEXT ? bdb_temp_table_next(bdb_state, cur, &bdberr)
+                            : bdb_temp_table_prev(bdb_state, cur, &bdberr);
+    }
+    if (rc != IX_FND || temp_spill_test_row(cur) != stop) {
+        rc = -1;
+        goto out;
+    }
+    rc = -1;
+    if ((del && bdb_temp_table_delete(bdb_state, cur, &bdberr)) ||
+        temp_mem_spill(tbl, &bdberr) ||
+        tbl->temp_table_type != TEMP_TABLE_TYPE_BTREE)
+        goto out;
+    if (how == DB_NEXT
+            ? temp_spill_test_expect(bdb_state, cur, DB_NEXT, stop + 1,
+                                     nrows - 1)
+            : temp_spill_test_expect(bdb_state, cur, DB_PREV, stop - 1, 0))
+        goto out;
+
+    rc = bdb_temp_table_first(bdb_state, chk, &bdberr);
+    while (rc == IX_FND) {
+        ++n;
+        rc = bdb_temp_table_next(bdb_state, chk, &bdberr);
+    }
+    rc = (rc == IX_PASTEOF && n == nrows - !!del) ? 0 : -1;
+
+out:
+    if (chk)
+        bdb_temp_table_close_cursor(bdb_state, chk, &bdberr);
+    if (cur)
+        bdb_temp_table_close_cursor(bdb_state, cur, &bdberr);
+    bdb_temp_table_close(bdb_state, tbl, &bdberr);
+    return rc;
+}
+
+/* two cursors on a row deleted before the spill step off it both ways */
+static int temp_spill_test_shared(bdb_state_type *bdb_state)
+{
+    struct temp_table *tbl;
+    struct temp_cursor *c1, *c2;
+    int bdberr = 0, rc = -1;
+
+    if ((tbl = temp_spill_test_fill(bdb_state, 100)) == NULL)
+        return -1;
+    c1 = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr);
+    c2 = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr);
+    if (c1 == NULL || c2 == NULL || temp_spill_test_seek(bdb_state, c1, 50) ||
+        temp_spill_test_seek(bdb_state, c2, 50) ||
+        bdb_temp_table_delete(bdb_state, c1, &bdberr) ||
+        temp_mem_spill(tbl, &bdberr))
+        goto out;
+    if (bdb_temp_table_next(bdb_state, c1, &bdberr) == IX_FND &&
+        temp_spill_test_row(c1) == 51 &&
+        bdb_temp_table_prev(bdb_state, c2, &bdberr) == IX_FND &&
+        temp_spill_test_row(c2) == 49)
+        rc = 0;
+
+out:
+    if (c2)
+        bdb_temp_table_close_cursor(bdb_state, c2, &bdberr);
+    if (c1)
+        bdb_temp_table_close_cursor(bdb_state, c1, &bdberr);
+    bdb_temp_table_close(bdb_state, tbl, &bdberr);
+    return rc;
+}
+
+/* delete every row during a scan; the purge kicks in halfway through */
+static int temp_spill_test_delete_all(bdb_state_type *bdb_state)
+{
+    struct temp_table *tbl;
+    struct temp_cursor *cur;
+    int bdberr = 0, rc, i = 0, nrows = 1000;
+
+    if ((tbl = temp_spill_test_fill(bdb_state, nrows)) == NULL)
+        return -1;
+    if ((cur = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr)) == NULL) {
+        bdb_temp_table_close(bdb_state, tbl, &bdberr);
+        return -1;
+    }
+    rc = bdb_temp_table_first(bdb_state, cur, &bdberr);
+    while (rc == IX_FND && temp_spill_test_row(cur) == i) {
+        if (bdb_temp_table_delete(bdb_state, cur, &bdberr))
+            break;
+        ++i;
+        rc = bdb_temp_table_next(bdb_state, cur, &bdberr);
+    }
+    rc = (rc == IX_PASTEOF && i == nrows &&
+          bdb_temp_table_first(bdb_state, cur, &bdberr) == IX_EMPTY)
+             ? 0
+             : -1;
+    bdb_temp_table_close_cursor(bdb_state, cur, &bdberr);
+    bdb_temp_table_close(bdb_state, tbl, &bdberr);
+    return rc;
+}
+
+/* a scan keeps its place when an insert through another cursor spills */
+static int temp_spill_test_insert(bdb_state_type *bdb_state)
+{
+    struct temp_table *tbl;
+    struct temp_cursor *scan, *ins;
+    uint8_t key[4];
+    int bdberr = 0, rc = -1;
+
+    if ((tbl = temp_spill_test_fill(bdb_state, 100)) == NULL)
+        return -1;
+    tbl->mem_budget = tbl->mem_bytes;
+    scan = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr);
+    ins = bdb_temp_table_cursor(bdb_state, tbl, NULL, &bdberr);
+    if (scan == NULL || ins == NULL || temp_spill_test_seek(bdb_state, scan, 30))
+        goto out;
+    temp_spill_test_key(key, 1000);
+    if (bdb_temp_table_insert(bdb_state, ins, key, sizeof(key), key,
+                              sizeof(key), &bdberr) ||
+        tbl->temp_table_type != TEMP_TABLE_TYPE_BTREE)
+        goto out;
+    rc = temp_spill_test_expect(bdb_state, scan, DB_NEXT, 31, 99);
+    if (rc == 0)
+        rc = (bdb_temp_table_last(bdb_state, scan, &bdberr) == IX_FND &&
+              temp_spill_test_row(scan) == 1000)
+                 ? 0
+                 : -1;
+
+out:
+    if (ins)
+        bdb_temp_table_close_cursor(bdb_state, ins, &bdberr);
+    if (scan)
+        bdb_temp_table_close_cursor(bdb_state, scan, &bdberr);
+    bdb_temp_table_close(bdb_state, tbl, &bdberr);
+    return rc;
+}
+
+/*
+ * Functional checks for the in-memory engine: scans that spill part way
+ * through in either direction, with and without the current row deleted,
+ * and deletes during a scan.  Returns the number of failed cases.
+ */
+int bdb_temp_table_spill_test(bdb_state_type *bdb_state, FILE *out)
+{
+    struct {
+        const char *name;
+        int rc;
+    } cases[7];
+    int i, nfail = 0;
+
+    if (bdb_state->parent)
+        bdb_state = bdb_state->parent;
+
+    cases[0].name = "spill during next";
+    cases[0].rc = temp_spill_test_scan(bdb_state, DB_NEXT, 40, 0);
+    cases[1].name = "spill during prev";
+    cases[1].rc = temp_spill_test_scan(bdb_state, DB_PREV, 60, 0);
+    cases[2].name = "spill on deleted row, next";
+    cases[2].rc = temp_spill_test_scan(bdb_state, DB_NEXT, 40, 1);
+    cases[3].name = "spill on deleted row, prev";
+    cases[3].rc = temp_spill_test_scan(bdb_state, DB_PREV, 60, 1);
+    cases[4].name = "spill with two cursors on deleted row";
+    cases[4].rc = temp_spill_test_shared(bdb_state);
+    cases[5].name = "delete during scan";
+    cases[5].rc = temp_spill_test_delete_all(bdb_state);
+    cases[6].name = "spill on insert during scan";
+    cases[6].rc = temp_spill_test_insert(bdb_state);
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        logmsgf(cases[i].rc ? LOGMSG_ERROR : LOGMSG_USER, out, "%-40s %s\n",
+                cases[i].name, cases[i].rc ? "FAILED" : "ok");
+        if (cases[i].rc)
+            ++nfail;
+    }
+    return nfail;
+}
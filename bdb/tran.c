@@ -1038,6 +1038,10 @@ static int bdb_tran_commit_phys_getlsn_flags(bdb_state_type *bdb_state,
     if (tran->table_version_cache)
         free(tran->table_version_cache);
     tran->table_version_cache = NULL;
+    bdb_rowcount_discard(tran);
+    if (rc == 0)
+        bdb_queuedb_stats_commit(tran);
+    bdb_queuedb_stats_discard(tran);
 
     free(tran);
     return rc;
@@ -1083,6 +1087,8 @@ static int bdb_tran_abort_phys_int(bdb_state_type *bdb_state, tran_type *tran,
     if (tran->table_version_cache)
         free(tran->table_version_cache);
     tran->table_version_cache = NULL;
+    bdb_rowcount_discard(tran);
+    bdb_queuedb_stats_discard(tran);
     free(tran);
     return rc;
 }
@@ -1510,6 +1516,12 @@ static int bdb_tran_commit_with_seqnum_int_int(
     switch (tran->tranclass) {
 
     case TRANCLASS_LOGICAL_NOROWLOCKS:
+        if (tran->n_rowcount_deltas &&
+            bdb_rowcount_flush(tran, bdberr) != 0) {
+            tran->tid->abort(tran->tid);
+            outrc = -1;
+            goto cleanup;
+        }
         flags = (tran->request_ack) ? DB_TXN_REP_ACK : 0;
         rc = tran->tid->commit_getlsn(tran->tid, flags, &lsn, tran);
         if (rc != 0) {
@@ -1542,6 +1554,15 @@ static int bdb_tran_commit_with_seqnum_int_int(
         if (!bdb_state->attr->synctransactions)
             flags |= DB_TXN_NOSYNC;
 
+        /* row count changes of a child go to its parent; the top level
+           transaction writes them out with the rest of its updates */
+        if (tran->n_rowcount_deltas && tran->parent == NULL &&
+            bdb_rowcount_flush(tran, bdberr) != 0) {
+            tran->tid->abort(tran->tid);
+            outrc = -1;
+            goto cleanup;
+        }
+
         if (bdb_osql_trn_repo_lock())
             abort();
 
@@ -1632,6 +1653,10 @@ static int bdb_tran_commit_with_seqnum_int_int(
         /* Set the 'committed-child' flag if this is not the parent. */
         if (tran->parent != NULL) {
             tran->parent->committed_child = 1;
+            if (tran->n_rowcount_deltas)
+                bdb_rowcount_merge(tran);
+            if (tran->n_queue_stats)
+                bdb_queuedb_stats_merge(tran);
         }
 
         break;
@@ -2021,6 +2046,11 @@ cleanup:
     if (tran->table_version_cache)
         free(tran->table_version_cache);
     tran->table_version_cache = NULL;
+    bdb_rowcount_discard(tran);
+    /* a committed child has already handed its stats to the parent */
+    if (outrc == 0 && tran->parent == NULL)
+        bdb_queuedb_stats_commit(tran);
+    bdb_queuedb_stats_discard(tran);
 
     pool_free(tran->rc_pool);
     myfree(tran->rc_list);
@@ -2347,6 +2377,8 @@ cleanup:
     if (tran->table_version_cache)
         free(tran->table_version_cache);
     tran->table_version_cache = NULL;
+    bdb_rowcount_discard(tran);
+    bdb_queuedb_stats_discard(tran);
 
     if (tran->pglogs_queue_hash) {
         hash_for(tran->pglogs_queue_hash, free_pglogs_queue_cursors, NULL);
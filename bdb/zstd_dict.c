@@ -0,0 +1,330 @@
+/*
+   Copyright 2018 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Zstandard compression for records and blobs (BDB_COMPRESS_ZSTD).
+ *
+ * Short rows compress poorly one at a time, so a table can have a dictionary
+ * trained from a sample of its own rows ("zstd train <table>").  Dictionaries
+ * are kept in llmeta under an id that is unique across all tables, and zstd
+ * writes that id into every frame.  A row therefore names the dictionary it
+ * needs: rows written before a table was (re)trained, or with no dictionary
+ * at all, keep decompressing after new rows move on to a newer one.
+ *
+ * Every dictionary is loaded whenever a table picks up its own (at open and
+ * on each scdone, see bdb_zstd_load) and never unloaded; there are only ever
+ * a handful of them.  Rows are decompressed under bdb_unpack with locks held,
+ * so a frame naming a dictionary that isn't loaded fails to decode rather
+ * than fetch it from llmeta there.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zstd.h>
+
+#include "bdb_int.h"
+#include <plhash.h>
+#include <logmsg.h>
+
+/* zstd dictionary header: magic, then the little-endian dictionary id */
+#define ZSTD_DICT_MAGIC 0xEC30A437
+#define ZSTD_DICT_HDRLEN 8
+
+struct zdict {
+    unsigned int id; /* hash key */
+    void *buf;
+    size_t len;
+    ZSTD_DDict *ddict;
+    ZSTD_CDict *cdict; /* made on the first compression with this dict */
+};
+
+static pthread_rwlock_t zdicts_lk = PTHREAD_RWLOCK_INITIALIZER;
+static hash_t *zdicts;
+
+static pthread_once_t zctx_once = PTHREAD_ONCE_INIT;
+static pthread_key_t zcctx_key;
+static pthread_key_t zdctx_key;
+
+static void free_cctx(void *p) { ZSTD_freeCCtx(p); }
+
+static void free_dctx(void *p) { ZSTD_freeDCtx(p); }
+
+static void zctx_init(void)
+{
+    pthread_key_create(&zcctx_key, free_cctx);
+    pthread_key_create(&zdctx_key, free_dctx);
+}
+
+/* contexts are big and expensive to set up; keep one of each per thread */
+static ZSTD_CCtx *get_cctx(void)
+{
+    ZSTD_CCtx *c;
+    pthread_once(&zctx_once, zctx_init);
+    if ((c = pthread_getspecific(zcctx_key)) == NULL) {
+        if ((c = ZSTD_createCCtx()) != NULL)
+            pthread_setspecific(zcctx_key, c);
+    }
+    return c;
+}
+
+static ZSTD_DCtx *get_dctx(void)
+{
+    ZSTD_DCtx *d;
+    pthread_once(&zctx_once, zctx_init);
+    if ((d = pthread_getspecific(zdctx_key)) == NULL) {
+        if ((d = ZSTD_createDCtx()) != NULL)
+            pthread_setspecific(zdctx_key, d);
+    }
+    return d;
+}
+
+static struct zdict *zdict_find(unsigned int id)
+{
+    struct zdict *z = NULL;
+    pthread_rwlock_rdlock(&zdicts_lk);
+    if (zdicts)
+        z = hash_find(zdicts, &id);
+    pthread_rwlock_unlock(&zdicts_lk);
+    return z;
+}
+
+static struct zdict *zdict_load(tran_type *tran, unsigned int id)
+{
+    struct zdict *z, *old;
+    void *buf = NULL;
+    int len, bdberr, rc;
+
+    if ((z = zdict_find(id)) != NULL)
+        return z;
+
+    rc = bdb_get_zstd_dict(tran, id, &buf, &len, &bdberr);
+    if (rc || bdberr != BDBERR_NOERROR) {
+        logmsg(LOGMSG_ERROR, "%s: can't fetch zstd dictionary %u bdberr %d\n",
+               __func__, id, bdberr);
+        free(buf);
+        return NULL;
+    }
+
+    z = calloc(1, sizeof(struct zdict));
+    if (z == NULL) {
+        free(buf);
+        return NULL;
+    }
+    z->id = id;
+    z->buf = buf;
+    z->len = len;
+    z->ddict = ZSTD_createDDict(buf, len);
+    if (z->ddict == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: zstd dictionary %u is corrupt\n", __func__,
+               id);
+        free(buf);
+        free(z);
+        return NULL;
+    }
+
+    pthread_rwlock_wrlock(&zdicts_lk);
+    if (zdicts == NULL)
+        zdicts = hash_init(sizeof(unsigned int));
+    if ((old = hash_find(zdicts, &id)) == NULL)
+        hash_add(zdicts, z);
+    pthread_rwlock_unlock(&zdicts_lk);
+
+    if (old) {
+        ZSTD_freeDDict(z->ddict);
+        free(buf);
+        free(z);
+        return old;
+    }
+    logmsg(LOGMSG_INFO, "loaded zstd dictionary %u, %d bytes\n", id, len);
+    return z;
+}
+
+/* load the dictionaries we don't have yet; ids are handed out in order and
+ * dictionaries are never deleted, so they are 1 to the highest id */
+static void zdict_load_all(tran_type *tran)
+{
+    unsigned int id, highest;
+    int bdberr;
+
+    if (bdb_get_zstd_dict_highest(tran, &highest, &bdberr)) {
+        logmsg(LOGMSG_ERROR, "%s: can't find zstd dictionaries bdberr %d\n",
+               __func__, bdberr);
+        return;
+    }
+    for (id = 1; id <= highest; id++)
+        zdict_load(tran, id);
+}
+
+/* the compression level is the one in effect when the dictionary is first
+ * used to compress */
+static ZSTD_CDict *zdict_cdict(bdb_state_type *bdb_state, struct zdict *z)
+{
+    ZSTD_CDict *c;
+
+    pthread_rwlock_rdlock(&zdicts_lk);
+    c = z->cdict;
+    pthread_rwlock_unlock(&zdicts_lk);
+    if (c)
+        return c;
+
+    c = ZSTD_createCDict(z->buf, z->len, bdb_state->attr->zstd_level);
+    if (c == NULL)
+        return NULL;
+
+    pthread_rwlock_wrlock(&zdicts_lk);
+    if (z->cdict == NULL) {
+        z->cdict = c;
+        c = NULL;
+    }
+    pthread_rwlock_unlock(&zdicts_lk);
+    if (c)
+        ZSTD_freeCDict(c);
+    return z->cdict;
+}
+
+/* Returns the compressed size, or -1 if it doesn't fit in tolen bytes. */
+int bdb_zstd_compress(bdb_state_type *bdb_state, const void *from,
+                      size_t fromlen, void *to, size_t tolen)
+{
+    ZSTD_CCtx *cctx;
+    ZSTD_CDict *cdict = NULL;
+    struct zdict *z;
+    unsigned int id;
+    size_t rc;
+
+    if ((cctx = get_cctx()) == NULL)
+        return -1;
+
+    id = bdb_state->zstd_dictid;
+    if (id && (z = zdict_find(id)) != NULL)
+        cdict = zdict_cdict(bdb_state, z);
+
+    if (cdict)
+        rc = ZSTD_compress_usingCDict(cctx, to, tolen, from, fromlen, cdict);
+    else
+        rc = ZSTD_compressCCtx(cctx, to, tolen, from, fromlen,
+                               bdb_state->attr->zstd_level);
+    if (ZSTD_isError(rc))
+        return -1;
+    return rc;
+}
+
+/* Returns the decompressed size, or -1. */
+int bdb_zstd_decompress(const void *from, size_t fromlen, void *to,
+                        size_t tolen)
+{
+    ZSTD_DCtx *dctx;
+    struct zdict *z;
+    unsigned int id;
+    size_t rc;
+
+    if ((dctx = get_dctx()) == NULL)
+        return -1;
+
+    id = ZSTD_getDictID_fromFrame(from, fromlen);
+    if (id) {
+        if ((z = zdict_find(id)) == NULL) {
+            logmsg(LOGMSG_ERROR, "%s: zstd dictionary %u is not loaded\n",
+                   __func__, id);
+            return -1;
+        }
+        rc = ZSTD_decompress_usingDDict(dctx, to, tolen, from, fromlen,
+                                        z->ddict);
+    } else {
+        rc = ZSTD_decompressDCtx(dctx, to, tolen, from, fromlen);
+    }
+    if (ZSTD_isError(rc)) {
+        logmsg(LOGMSG_ERROR, "%s: dictionary %u: %s\n", __func__, id,
+               ZSTD_getErrorName(rc));
+        return -1;
+    }
+    return rc;
+}
+
+/* pick up the table's dictionary from llmeta, loading any dictionary we
+ * don't have yet; the new. handle of a schema change rewrites rows with the
+ * dictionary of the table it replaces */
+void bdb_zstd_load(bdb_state_type *bdb_state, tran_type *tran)
+{
+    const char *name;
+    unsigned int id = 0;
+    int bdberr;
+
+    zdict_load_all(tran);
+
+    name = bdb_unprepend_new_prefix(bdb_state->name, &bdberr);
+    if (bdb_get_table_zstd_dict(name, tran, &id, &bdberr))
+        id = 0;
+    if (id && zdict_find(id) == NULL)
+        id = 0;
+    bdb_state->zstd_dictid = id;
+}
+
+unsigned int bdb_zstd_dictid(bdb_state_type *bdb_state)
+{
+    return bdb_state->zstd_dictid;
+}
+
+int bdb_zstd_get_dict(unsigned int dictid, const void **dict, size_t *dictlen)
+{
+    struct zdict *z;
+    if ((z = zdict_find(dictid)) == NULL)
+        return -1;
+    *dict = z->buf;
+    *dictlen = z->len;
+    return 0;
+}
+
+/* Store a dictionary from ZDICT_trainFromBuffer() under the next free id and
+ * make it the table's.  Its header is rewritten with that id, which is what
+ * ends up in every frame compressed with it.  The table starts using it once
+ * the transaction commits and bdb_zstd_load() is called. */
+int bdb_zstd_add_dict(bdb_state_type *bdb_state, tran_type *tran, void *dict,
+                      size_t dictlen, unsigned int *dictid, int *bdberr)
+{
+    uint8_t *hdr = dict;
+    unsigned int id;
+    int rc;
+
+    if (dictlen < ZSTD_DICT_HDRLEN ||
+        (hdr[0] | hdr[1] << 8 | hdr[2] << 16 | (uint32_t)hdr[3] << 24) !=
+            ZSTD_DICT_MAGIC) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    rc = bdb_get_zstd_dict_highest(tran, &id, bdberr);
+    if (rc)
+        return rc;
+    ++id;
+
+    hdr[4] = id;
+    hdr[5] = id >> 8;
+    hdr[6] = id >> 16;
+    hdr[7] = id >> 24;
+
+    rc = bdb_put_zstd_dict(tran, id, dict, dictlen, bdberr);
+    if (rc)
+        return rc;
+    rc = bdb_set_table_zstd_dict(bdb_state->name, tran, id, bdberr);
+    if (rc)
+        return rc;
+
+    *dictid = id;
+    return 0;
+}
@@ -5,9 +5,12 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <limits.h>
 
 #include <stdbool.h>
 #include <signal.h>
+#include <sys/time.h>
 #include <logmsg.h>
 
 uint32_t rcache_hits;
@@ -16,8 +19,18 @@ uint32_t rcache_savd;
 uint32_t rcache_invalid;
 uint32_t rcache_collide;
 
+/* Hits by depth below the root; each one is a page fget we didn't do. */
+uint32_t rcache_level_hits[RCACHE_MAX_LEVELS];
+
+/*
+ * Number of btree levels, starting at the root, to keep in the rcache.
+ * 1 caches root pages only.
+ */
+int gbl_rcache_levels = 1;
+
 typedef struct {
 	uint8_t fileid[DB_FILE_ID_LEN];
+	uint32_t pgno;
 	uint16_t gen;
 	uint32_t hitmiss;
 	void *bfpool_pg;
@@ -32,6 +45,9 @@ typedef struct {
 
 static __thread CacheHndl *hndl = NULL;
 
+/* Set by rcache_bench to run its lookups at a given depth. */
+static __thread int levels_override = -1;
+
 void
 rcache_init(size_t count, size_t pgsz)
 {
@@ -63,10 +79,11 @@ rcache_init(size_t count, size_t pgsz)
 }
 
 static inline void
-hash_fileid(void *fileid, uint32_t * crc, uint32_t * hash)
+hash_fileid(void *fileid, uint32_t pgno, uint32_t * crc, uint32_t * hash)
 {
 	*crc = crc32c(fileid, DB_FILE_ID_LEN);
-	*hash = *crc % hndl->count;
+	/* Root pages hash as before; spread a file's inner pages around. */
+	*hash = (*crc ^ ((pgno - 1) * 0x9E3779B1U)) % hndl->count;
 }
 
 void
@@ -78,26 +95,50 @@ rcache_destroy(void)
     }
 }
 
+/*
+ * Return how many levels of a btree this thread may descend through the
+ * cache, 0 if it shouldn't use it at all.
+ */
+int
+rcache_levels(void)
+{
+	extern bool gbl_rcache;
+	int levels;
+
+	if (hndl == NULL)
+		return 0;
+	if (levels_override >= 0)
+		levels = levels_override;
+	else if (gbl_rcache)
+		levels = gbl_rcache_levels;
+	else
+		return 0;
+	if (levels > RCACHE_MAX_LEVELS)
+		levels = RCACHE_MAX_LEVELS;
+	return levels;
+}
+
 int
-rcache_find(DB *dbp, void **cached_pg, void **bfpool_pg,
-    uint16_t * gen, uint32_t * slot_ptr)
+rcache_find(DB *dbp, uint32_t pgno, int depth, void **cached_pg,
+    void **bfpool_pg, uint16_t * gen, uint32_t * slot_ptr)
 {
 	if (hndl == NULL || dbp->pgsize > hndl->pgsz)
 		return -1;
 	uint32_t crc, slot;
 
-	hash_fileid(dbp->fileid, &crc, &slot);
+	hash_fileid(dbp->fileid, pgno, &crc, &slot);
 	if (crc == 0)
 		return -1;
 	CacheSlot *cache = &hndl->slots[slot];
 
-	if (cache->bfpool_pg
+	if (cache->bfpool_pg && cache->pgno == pgno
 	    && memcmp(cache->fileid, dbp->fileid, DB_FILE_ID_LEN) == 0) {
 		*cached_pg = cache->cached_pg;
 		*bfpool_pg = cache->bfpool_pg;
 		*gen = cache->gen;
 		*slot_ptr = slot;
 		++rcache_hits;
+		++rcache_level_hits[depth];
 		if (cache->hitmiss < 256)
 			++cache->hitmiss;
 		return 0;
@@ -107,13 +148,13 @@ rcache_find(DB *dbp, void **cached_pg, void **bfpool_pg,
 }
 
 int
-rcache_save(DB *dbp, void *page, uint16_t gen)
+rcache_save(DB *dbp, uint32_t pgno, void *page, uint16_t gen)
 {
 	if (hndl == NULL || dbp->pgsize > hndl->pgsz)
 		return -1;
 	uint32_t crc, slot;
 
-	hash_fileid(dbp->fileid, &crc, &slot);
+	hash_fileid(dbp->fileid, pgno, &crc, &slot);
 	if (crc == 0)
 		return -1;
 	CacheSlot *cache = &hndl->slots[slot];
@@ -127,6 +168,7 @@ rcache_save(DB *dbp, void *page, uint16_t gen)
 	}
 	cache->hitmiss = 1;
 	cache->bfpool_pg = page;
+	cache->pgno = pgno;
 	cache->gen = gen;
 	memcpy(cache->cached_pg, page, dbp->pgsize);
 	memcpy(cache->fileid, dbp->fileid, DB_FILE_ID_LEN);
@@ -141,3 +183,154 @@ rcache_invalidate(uint32_t slot)
 
 	++rcache_invalid;
 }
+
+/*
+ * Point lookup benchmark.  Loads a btree in a private environment, then runs
+ * the same random lookups with the rcache off, caching root pages only (the
+ * old behaviour), and caching each deeper level in turn.  Reports how many
+ * page gets each lookup needed.
+ */
+#define RCACHE_BENCH_PGSZ 4096
+
+static int
+rcache_bench_run(DB *dbp, DB_ENV *env, int levels, int nrecs, int nlookups,
+    uint64_t *usecs, uint64_t *fgets, uint32_t *hits)
+{
+	DB_MPOOL_STAT *gsp;
+	struct timeval start, end;
+	uint64_t before;
+	unsigned int seed = 1;
+	uint8_t k[8], d[16];
+	DBT key, data;
+	uint32_t hits_before[RCACHE_MAX_LEVELS];
+	int i, rc;
+
+	if ((rc = env->memp_stat(env, &gsp, NULL, DB_STAT_MINIMAL)) != 0)
+		return rc;
+	before = gsp->st_cache_hit + gsp->st_cache_miss;
+	free(gsp);
+	memcpy(hits_before, rcache_level_hits, sizeof(hits_before));
+	levels_override = levels;
+
+	memset(&key, 0, sizeof(key));
+	memset(&data, 0, sizeof(data));
+	key.data = k;
+	key.size = sizeof(k);
+	data.data = d;
+	data.ulen = sizeof(d);
+	data.flags = DB_DBT_USERMEM;
+
+	gettimeofday(&start, NULL);
+	for (i = 0; i < nlookups; ++i) {
+		uint64_t n = rand_r(&seed) % nrecs;
+		int j;
+
+		for (j = 7; j >= 0; --j, n >>= 8)
+			k[j] = n & 0xff;
+		if ((rc = dbp->get(dbp, NULL, &key, &data, 0)) != 0)
+			break;
+	}
+	gettimeofday(&end, NULL);
+	levels_override = -1;
+	if (rc)
+		return rc;
+
+	*usecs = (end.tv_sec - start.tv_sec) * 1000000ULL +
+	    end.tv_usec - start.tv_usec;
+	if ((rc = env->memp_stat(env, &gsp, NULL, DB_STAT_MINIMAL)) != 0)
+		return rc;
+	*fgets = gsp->st_cache_hit + gsp->st_cache_miss - before;
+	free(gsp);
+	*hits = 0;
+	for (i = 0; i < RCACHE_MAX_LEVELS; ++i)
+		*hits += rcache_level_hits[i] - hits_before[i];
+	return 0;
+}
+
+int
+rcache_bench(FILE *out, const char *dir, int nrecs, int nlookups)
+{
+	CacheHndl *saved = hndl;
+	DB_ENV *env = NULL;
+	DB *dbp = NULL;
+	DBT key, data;
+	uint8_t k[8], d[16];
+	char fname[64], path[PATH_MAX];
+	int i, levels, rc;
+
+	if (nrecs <= 0)
+		nrecs = 1000000;
+	if (nlookups <= 0)
+		nlookups = 1000000;
+
+	/* Use a private cache so the numbers aren't skewed by this thread. */
+	hndl = NULL;
+	rcache_init(257, RCACHE_BENCH_PGSZ);
+	if (hndl == NULL) {
+		hndl = saved;
+		return -1;
+	}
+
+	snprintf(fname, sizeof(fname), "_rcache_bench.%d", (int)getpid());
+	if ((rc = db_env_create(&env, 0)) != 0)
+		goto done;
+	if ((rc = env->set_cachesize(env, 0, 256 << 20, 1)) != 0 ||
+	    (rc = env->open(env, dir,
+	    DB_CREATE | DB_PRIVATE | DB_INIT_MPOOL, 0666)) != 0)
+		goto done;
+	if ((rc = db_create(&dbp, env, 0)) != 0 ||
+	    (rc = dbp->set_pagesize(dbp, RCACHE_BENCH_PGSZ)) != 0 ||
+	    (rc = dbp->open(dbp, NULL, fname, NULL, DB_BTREE, DB_CREATE,
+	    0666)) != 0)
+		goto done;
+
+	memset(&key, 0, sizeof(key));
+	memset(&data, 0, sizeof(data));
+	memset(d, 0, sizeof(d));
+	key.data = k;
+	key.size = sizeof(k);
+	data.data = d;
+	data.size = sizeof(d);
+	for (i = 0; i < nrecs; ++i) {
+		uint64_t n = i;
+		int j;
+
+		for (j = 7; j >= 0; --j, n >>= 8)
+			k[j] = n & 0xff;
+		if ((rc = dbp->put(dbp, NULL, &key, &data, 0)) != 0)
+			goto done;
+	}
+
+	logmsgf(LOGMSG_USER, out, "rcache bench: %d records, %d lookups\n",
+	    nrecs, nlookups);
+	logmsgf(LOGMSG_USER, out, "%-8s %10s %12s %12s %12s\n", "levels",
+	    "msec", "lookups/sec", "fgets/lookup", "rcache-hits");
+	for (levels = 0; levels <= RCACHE_MAX_LEVELS; ++levels) {
+		uint64_t usecs, fgets;
+		uint32_t hits;
+
+		/* Warm the cache, then measure. */
+		if ((rc = rcache_bench_run(dbp, env, levels, nrecs, nlookups,
+		    &usecs, &fgets, &hits)) != 0 ||
+		    (rc = rcache_bench_run(dbp, env, levels, nrecs, nlookups,
+		    &usecs, &fgets, &hits)) != 0)
+			goto done;
+		logmsgf(LOGMSG_USER, out, "%-8d %10llu %12.0f %12.2f %12u\n",
+		    levels, (unsigned long long)usecs / 1000,
+		    usecs ? nlookups * 1000000.0 / usecs : 0.0,
+		    (double)fgets / nlookups, hits);
+	}
+
+done:
+	if (rc)
+		logmsgf(LOGMSG_ERROR, out, "%s failed rc %d\n", __func__, rc);
+	if (dbp)
+		dbp->close(dbp, DB_NOSYNC);
+	if (env)
+		env->close(env, 0);
+	snprintf(path, sizeof(path), "%s/%s", dir, fname);
+	unlink(path);
+	rcache_destroy();
+	hndl = saved;
+	return rc;
+}
@@ -1,11 +1,18 @@
 #ifndef INCLUDE_BT_CACHE_H
 #define INCLUDE_BT_CACHE_H
 
+#include <stdio.h>
+
+/* Deepest btree level, counting the root as 1, the rcache will hold. */
+#define RCACHE_MAX_LEVELS 4
+
 struct __db;
-int rcache_find(struct __db *, void **cached_pg, void **bfpool_pg,
-	uint16_t * gen, uint32_t * slot);
-int rcache_save(struct __db *, void *page, uint16_t gen);
+int rcache_levels(void);
+int rcache_find(struct __db *, uint32_t pgno, int depth, void **cached_pg,
+	void **bfpool_pg, uint16_t * gen, uint32_t * slot);
+int rcache_save(struct __db *, uint32_t pgno, void *page, uint16_t gen);
 void rcache_invalidate(uint32_t slot);
+int rcache_bench(FILE *out, const char *dir, int nrecs, int nlookups);
 
 #define GET_BH_GEN(pg) (*(uint16_t *)((uint8_t *)pg - (offsetof(BH, buf) - offsetof(BH, generation))))
 
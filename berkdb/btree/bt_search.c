@@ -346,10 +346,15 @@ __bam_search(dbc, root_pgno, key, flags, stop, recnop, exactp)
 	int adjust, cmp, deloffset, ret, stack;
 	int (*func) __P((DB *, const DBT *, const DBT *));
 	void *cached_pg = NULL;
-	void *bfpool_pg = NULL;
+	struct {
+		void *cached_pg;
+		void *bfpool_pg;
+		uint16_t gen;
+		uint32_t slot;
+	} rc_path[RCACHE_MAX_LEVELS];
+	int rc_npath = 0, rc_levels = 0, depth, ii;
+	bool rc_retry = false;
 	bool save = false;
-	uint16_t gen;
-	uint32_t slot;
 	unsigned int hh;
 	genid_hash *hash = NULL;
 	__genid_pgno *hashtbl = NULL;
@@ -399,14 +404,21 @@ try_again:
 	dbp->pg_hash_stat.n_bt_search++;
 	gettimeofday(&before, NULL);
 
-	extern bool gbl_rcache;
-
-	if (gbl_rcache && pg == 1 && bfpool_pg == NULL &&
-	    lock_mode == DB_LOCK_READ && LF_ISSET(S_FIND)) {
+	/*
+	 * The rcache holds private copies of the top rcache_levels levels of
+	 * the tree.  We descend through them without locking or pinning, and
+	 * check that none of them changed once we have the first real page.
+	 */
+	depth = 0;
+	if (!rc_retry && pg == 1 && lock_mode == DB_LOCK_READ &&
+	    LF_ISSET(S_FIND) && !LF_ISSET(S_STK_ONLY | S_PARENT) &&
+	    (rc_levels = rcache_levels()) > 0) {
 		save = true;
-		if (rcache_find(
-		    dbp, &cached_pg, &bfpool_pg, &gen, &slot) == 0) {
-			h = cached_pg;
+		if (rcache_find(dbp, pg, 0, &rc_path[0].cached_pg,
+		    &rc_path[0].bfpool_pg, &rc_path[0].gen,
+		    &rc_path[0].slot) == 0) {
+			rc_npath = 1;
+			h = cached_pg = rc_path[0].cached_pg;
 			goto got_pg;
 		}
 	}
@@ -540,7 +552,7 @@ hash_backup:
 		uint16_t gen = LSN(h).file + LSN(h).offset;
 
 		GET_BH_GEN(h) = gen;
-		rcache_save(dbp, h, gen);
+		rcache_save(dbp, h->pgno, h, gen);
 	}
 
 	INTERNAL_PTR_CHECK(cp == dbc->internal);
@@ -744,6 +756,17 @@ next:		if (recnop != NULL)
 			lock_mode = stack &&
 			    LF_ISSET(S_WRITE) ? DB_LOCK_WRITE : DB_LOCK_READ;
 
+			if (cached_pg && !stack && depth + 1 < rc_levels &&
+			    rcache_find(dbp, pg, depth + 1,
+			    &rc_path[rc_npath].cached_pg,
+			    &rc_path[rc_npath].bfpool_pg, &rc_path[rc_npath].gen,
+			    &rc_path[rc_npath].slot) == 0) {
+				/* Child is cached too; keep going without it. */
+				h = cached_pg = rc_path[rc_npath++].cached_pg;
+				++depth;
+				continue;
+			}
+
 			if (cached_pg) {
 				/* Used rcache to get here. Don't lck couple. */
 				if ((ret = __db_lget(dbc, 0, pg, lock_mode, 0,
@@ -779,30 +802,55 @@ next:		if (recnop != NULL)
 				 */
 				cached_pg = NULL;
 
-				rcache_invalidate(slot);
+				for (ii = 0; ii < rc_npath; ++ii)
+					rcache_invalidate(rc_path[ii].slot);
+				rc_npath = 0;
+				rc_retry = true;
 				__LPUT(dbc, lock);
 				goto try_again;
 			}
 			goto err;
 		}
+		++depth;
 
 		if (cached_pg) {
-			/* Used rcache and got child page. Validate rcache. */
-			DB_LSN *l1 = &LSN(cached_pg);
-			DB_LSN *l2 = &LSN(bfpool_pg);
+			/*
+			 * Used rcache and got child page. Validate every
+			 * cached page we came through.
+			 */
+			bool valid = true;
 			cached_pg = NULL;
 
-			if (gen == GET_BH_GEN(bfpool_pg)
-			    && memcmp(l1, l2, sizeof(DB_LSN)) == 0 && gen == GET_BH_GEN(bfpool_pg)	//re-check. warm&fuzzy
-			    ) {
-				;
-			} else {
+			for (ii = 0; ii < rc_npath; ++ii) {
+				void *bfpool_pg = rc_path[ii].bfpool_pg;
+				uint16_t gen = rc_path[ii].gen;
+				DB_LSN *l1 = &LSN(rc_path[ii].cached_pg);
+				DB_LSN *l2 = &LSN(bfpool_pg);
+
+				if (gen == GET_BH_GEN(bfpool_pg)
+				    && memcmp(l1, l2, sizeof(DB_LSN)) == 0 && gen == GET_BH_GEN(bfpool_pg)	//re-check. warm&fuzzy
+				    ) {
+					;
+				} else {
+					rcache_invalidate(rc_path[ii].slot);
+					valid = false;
+				}
+			}
+			rc_npath = 0;
+			if (!valid) {
 				__memp_fput(mpf, h, 0);
 				__LPUT(dbc, lock);
-				rcache_invalidate(slot);
+				rc_retry = true;
 				goto try_again;
 			}
 		}
+
+		if (save && depth < rc_levels && TYPE(h) == P_IBTREE) {
+			uint16_t gen = LSN(h).file + LSN(h).offset;
+
+			GET_BH_GEN(h) = gen;
+			rcache_save(dbp, h->pgno, h, gen);
+		}
 	}
 	/* NOTREACHED */
 
@@ -130,6 +130,7 @@ struct __db_env;	typedef struct __db_env DB_ENV;
 struct __db_h_stat;	typedef struct __db_h_stat DB_HASH_STAT;
 struct __db_ilock;	typedef struct __db_ilock DB_LOCK_ILOCK;
 struct __db_lock_stat;	typedef struct __db_lock_stat DB_LOCK_STAT;
+struct __db_lock_part_stat; typedef struct __db_lock_part_stat DB_LOCK_PART_STAT;
 struct __db_lock_u;	typedef struct __db_lock_u DB_LOCK;
 struct __db_lockreq;	typedef struct __db_lockreq DB_LOCKREQ;
 struct __db_log_cursor_stat; typedef struct __db_log_cursor_stat DB_LOGC_STAT;
@@ -499,6 +500,22 @@ struct __db_lock_stat {
 	u_int64_t st_regsize;		/* Region size. */
 };
 
+/* Latch statistics and hash occupancy for one lock table partition. */
+struct __db_lock_part_stat {
+	const char *st_type;		/* "object" or "locker". */
+	u_int32_t st_partition;		/* Partition number. */
+	u_int64_t st_acquired;		/* Times the latch was taken. */
+	u_int64_t st_contended;		/* Times it was already held. */
+	u_int64_t st_wait_us;		/* Total wait for the latch. */
+	u_int64_t st_max_wait_us;	/* Longest wait for the latch. */
+	u_int64_t st_hold_us;		/* Total time the latch was held. */
+	u_int64_t st_max_hold_us;	/* Longest time the latch was held. */
+	u_int32_t st_entries;		/* Objects or lockers hashed here. */
+	u_int32_t st_buckets;		/* Hash buckets in the partition. */
+	u_int32_t st_buckets_used;	/* Non-empty hash buckets. */
+	u_int32_t st_max_chain;		/* Longest hash chain. */
+};
+
 /*
  * DB_LOCK_ILOCK --
  *	Internal DB access method lock.
@@ -695,6 +712,8 @@ struct __db_log_stat {
 	u_int32_t st_ondisk_get;	/* On-disk log_get. */
 	u_int32_t st_inmem_trav;	/* Mem-log steps for partial reads. */
 	u_int32_t st_wrap_copy;		/* Count of wrapped copies. */
+	u_int32_t st_gc_flushes;	/* Group commit flushes. */
+	u_int32_t st_gc_commits;	/* Commits made durable by them. */
 };
 
 /*******************************************************
@@ -852,6 +871,8 @@ struct __db_mpool_stat {
 	u_int64_t st_page_pf_in_late;/* Unaffective prefault requests */
 	u_int64_t st_page_in;		/* Pages read in. */
 	u_int64_t st_page_out;		/* Pages written out. */
+	u_int64_t st_page_in_compressed; /* Pages read in compressed. */
+	u_int64_t st_page_out_compressed; /* Pages written out compressed. */
 	u_int64_t st_ro_merges;		/* Read merges performed. */
 	u_int64_t st_rw_merges;		/* Write merges performed. */
 	u_int64_t st_ro_evict;		/* Clean pages forced from the cache. */
@@ -880,6 +901,9 @@ struct __db_mpool_stat {
 	u_int64_t st_alloc_max_pages;	/* Max checked during allocation. */
 	u_int64_t st_ckp_pages_sync;	/* Number of pages sync'd using perfect ckp. */
 	u_int64_t st_ckp_pages_skip;	/* Number of pages skipped using perfect ckp. */
+	u_int64_t st_ghost_hits;	/* 2q: evicted pages read back in. */
+	u_int64_t st_hot_promotes;	/* 2q: probationary pages made hot. */
+	u_int64_t st_cold_evicts;	/* 2q: probationary pages evicted. */
 };
 
 /* Mpool file statistics structure. */
@@ -896,6 +920,8 @@ struct __db_mpool_fstat {
 	u_int64_t st_page_create;	/* Pages created in the cache. */
 	u_int64_t st_page_in;		/* Pages read in. */
 	u_int64_t st_page_out;		/* Pages written out. */
+	u_int64_t st_page_in_compressed; /* Pages read in compressed. */
+	u_int64_t st_page_out_compressed; /* Pages written out compressed. */
 	u_int64_t st_ro_merges;		/* Read merges performed. */
 	u_int64_t st_rw_merges;		/* Write merges performed. */
 };
@@ -1035,6 +1061,12 @@ struct __db_txn {
 					 * this is a new one */
 	void            *pglogs_hashtbl;
    pthread_mutex_t pglogs_mutex;
+
+	/* Subscribed trigger queues this txn inserted into; their consumers
+	 * are woken once the top-level txn commits and drops its locks. */
+#define	TXN_MAX_TRIGGERS	4
+	struct __db_trigger_subscription *triggers[TXN_MAX_TRIGGERS];
+	u_int32_t	ntriggers;
 };
 
 /*
@@ -1160,6 +1192,12 @@ struct __db_rep_stat {
 	int lc_cache_size;		/* Current size of lc cache */
     uint32_t durable_gen;
     DB_LSN durable_lsn;
+	u_int32_t st_txns_partitioned;	/* Txns applied page-partitioned. */
+	u_int32_t st_page_queues;	/* Extra worker queues they used. */
+	u_int32_t st_apply_ms;		/* Dispatch to applied, last txn. */
+	u_int32_t st_apply_ms_max;	/* Dispatch to applied, worst txn. */
+	int32_t st_apply_lag;		/* Seconds behind master when the
+					   last txn was applied. */
 };
 
 
@@ -2010,6 +2048,8 @@ typedef int (*collect_locks_f)(void *args, int64_t threadid, int32_t lockerid,
         const char *mode, const char *status, const char *table,
         int64_t page, const char *rectype);
 
+typedef int (*collect_lock_parts_f)(void *args, const DB_LOCK_PART_STAT *);
+
 /* Database Environment handle. */
 struct __db_env {
 	/*******************************************************
@@ -2262,6 +2302,8 @@ struct __db_env {
 	int  (*lock_id_set_logical_abort) __P((DB_ENV *, u_int32_t));
 	int  (*lock_stat) __P((DB_ENV *, DB_LOCK_STAT **, u_int32_t));
 	int  (*collect_locks) __P((DB_ENV *, collect_locks_f, void *arg));
+	int  (*collect_lock_partitions)
+		__P((DB_ENV *, collect_lock_parts_f, void *arg));
 	int  (*lock_locker_lockcount)
 		__P((DB_ENV *, u_int32_t id, u_int32_t *nlocks));
 	int  (*lock_locker_pagelockcount)
@@ -2770,10 +2812,13 @@ struct logrecord {
 	DBT rec;
 };
 
+#define	RECOVERY_MAX_PAGES	4
 struct __recovery_record {
 	DBT logdbt;	/* log record to apply */
 	DB_LSN lsn;	/* LSN of log record to apply */
 	int fileid;
+	int npgnos;	/* pages it redoes, -1 if unknown */
+	db_pgno_t pgnos[RECOVERY_MAX_PAGES];
 	LINKC_T(struct __recovery_record) lnk;
 };
 
@@ -2800,6 +2845,10 @@ struct __recovery_processor {
 	unsigned long long context;
 	u_int32_t lockid;
 	struct __recovery_queue **recovery_queues;
+	struct __recovery_queue **page_queues;	/* per-page partitions */
+	int num_page_queues;
+	int32_t commit_timestamp;	/* master's commit time */
+	u_int64_t dispatch_ms;		/* when handed to the processor */
 	void *txninfo;
 	LSN_COLLECTION lc;
 	pool_t *recpool;
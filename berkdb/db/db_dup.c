@@ -22,6 +22,7 @@ static const char revid[] = "$Id: db_dup.c,v 11.36 2003/06/30 17:19:44 bostic Ex
 #include "dbinc/lock.h"
 #include "dbinc/mp.h"
 #include "dbinc/db_am.h"
+#include "dbinc/txn.h"
 #include "dbinc/db_swap.h"
 #include "dbinc/trigger_subscription.h"
 
@@ -189,10 +190,13 @@ __db_pitem_opcode(dbc, pagep, indx, nbytes, hdr, data, opcode)
 
 	dbp = dbc->dbp;
 
-	/* If there is an active Lua trigger/consumer, wake it up. */
+	/*
+	 * If there is an active Lua trigger/consumer, wake it up once this
+	 * insert commits.
+	 */
 	struct __db_trigger_subscription *t = dbp->trigger_subscription;
 	if (t && t->active && (indx & 1)) {
-		pthread_cond_signal(&t->cond);
+		__txn_trigger_event(dbc->txn, t);
 	}
 
 	/*
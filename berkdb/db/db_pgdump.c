@@ -42,6 +42,7 @@ static const char *type2str(int type)
 	case P_QAMMETA: 	return "P_QAMMETA";
 	case P_QAMDATA: 	return "P_QAMDATA";
 	case P_LDUP: 		return "P_LDUP";
+	case P_COMPRESSED: 	return "P_COMPRESSED";
 	case P_PAGETYPE_MAX: 	return "P_PAGETYPE_MAX";
 	default:		return "???";
 	}
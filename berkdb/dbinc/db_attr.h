@@ -29,6 +29,8 @@ BERK_DEF_ATTR(check_applied_lsns_fatal, "Abort if check_applied_lsns fails", BER
 BERK_DEF_ATTR(check_applied_lsns_debug, "Lots of verbose trace for debugging applied LSNs.", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_enabled, "Do scatter gather I/O", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(sgio_max, "Max scatter gather I/O to do at one time", BERK_ATTR_TYPE_INTEGER, 10 * MEGABYTE)
+BERK_DEF_ATTR(memp_sync_chunk_pages, "Split a file's dirty pages into write ranges of about this many pages when flushing the cache (0 = one range per file)", BERK_ATTR_TYPE_INTEGER, 1024)
+BERK_DEF_ATTR(memp_sync_file_inflight, "Max write ranges of one file queued or being written when flushing the cache (0 = no limit)", BERK_ATTR_TYPE_INTEGER, 2)
 BERK_DEF_ATTR(btpf_enabled, "Enables index pages read ahead", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(btpf_wndw_min, "Minimum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 100 )
 BERK_DEF_ATTR(btpf_wndw_max, "Maximum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 1000 )
@@ -60,10 +62,16 @@ BERK_DEF_ATTR(latch_poll_us, "Poll latch this many microseconds before retrying"
 BERK_DEF_ATTR(latch_max_poll, "Poll latch this many times before returning deadlock", BERK_ATTR_TYPE_INTEGER, 5)
 BERK_DEF_ATTR(latch_timed_mutex, "Use a timed mutex", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(log_cursor_cache, "Cache log cursors", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(log_group_commit, "Committers wait for a dedicated thread to flush the log instead of flushing it themselves", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(recovery_processor_poll_interval_us, "Recovery processor wakes this often to check workers", BERK_ATTR_TYPE_INTEGER, 1000)
+BERK_DEF_ATTR(rep_page_partition, "Replicants apply the records of a transaction for one file on several workers, split by page", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(rep_page_partition_min, "Only split files with at least this many records in the transaction", BERK_ATTR_TYPE_INTEGER, 64)
 BERK_DEF_ATTR(lsnerr_logflush, "Flush log on lsn error", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(tracked_locklist_init, "Initial allocation count for tracked locks", BERK_ATTR_TYPE_INTEGER, 10)
 /* This is a placeholder for now */
 BERK_DEF_ATTR(transient_page_reallocation, "Orphaned pages are maintained locally", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(elect_highest_committed_gen, "Bias election by the highest generation in the logfile", BERK_ATTR_TYPE_BOOLEAN, 1)
+BERK_DEF_ATTR(mp_replacement_policy, "Buffer pool replacement policy (0 = lru, 1 = scan-resistant 2q)", BERK_ATTR_TYPE_INTEGER, 0)
+BERK_DEF_ATTR(mp_2q_promote_window, "2q: re-references within this many buffer puts of a page being read in don't make it hot", BERK_ATTR_TYPE_INTEGER, 256)
+BERK_DEF_ATTR(mp_2q_ghost_pct, "2q: size of the evicted-page history as a percentage of the buffers in the cache", BERK_ATTR_TYPE_PERCENT, 50)
 BERK_DEF_ATTR(sync_standalone, "Force a log-sync at commit for standalone instances", BERK_ATTR_TYPE_BOOLEAN, 0)
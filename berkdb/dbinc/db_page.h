@@ -68,7 +68,8 @@ extern "C" {
 #define	P_QAMMETA	10	/* Queue metadata page. */
 #define	P_QAMDATA	11	/* Queue data page. */
 #define	P_LDUP		12	/* Off-page duplicate leaf. */
-#define	P_PAGETYPE_MAX	13
+#define	P_COMPRESSED	13	/* On-disk slot of a compressed page. */
+#define	P_PAGETYPE_MAX	14
 
 /*
  * When we create pages in mpool, we ask mpool to clear some number of bytes
@@ -244,6 +245,19 @@ typedef struct __pg_crypto {
 	 */
 } PG_CRYPTO;
 
+/*
+ * A leaf page written compressed (see mp_compress.c) is stored as a
+ * P_COMPRESSED slot in its usual place in the file: the page header, with
+ * the type changed, then this, then the lz4 compressed page.  The checksum
+ * is crc32c over the whole slot, zero padded to the page size, with the
+ * checksum itself zeroed; unused slot bytes are zeroes or a hole.
+ */
+typedef struct __pg_compressed {
+	u_int8_t	unused[2];		/* 26-27: For alignment */
+	u_int8_t	chksum[4];		/* 28-31: Checksum */
+	u_int8_t	clen[4];		/* 32-35: Compressed length (LE) */
+} PG_COMPRESSED;
+
 typedef struct _db_page {
 	DB_LSN	  lsn;		/* 00-07: Log sequence number. */
 	db_pgno_t pgno;		/* 08-11: Current page number. */
@@ -11,11 +11,15 @@
 #define	_DB_LOCK_H_
 
 #include <assert.h>
+#include <pthread.h>
+#include <time.h>
 
 extern size_t gbl_lk_parts;
 extern size_t gbl_lkr_parts;
 extern size_t gbl_lk_hash;
 extern size_t gbl_lkr_hash;
+extern int gbl_lk_part_stats;
+extern int gbl_lk_part_spin;
 
 #define	DB_LOCK_DEFAULT_N	1000	/* Default # of locks in region. */
 
@@ -70,6 +74,21 @@ static void assert_failed_ ## name(void)	\
 	}					\
 }
 
+/*
+ * Per-partition latch statistics.  Only updated by the thread holding the
+ * partition latch, and only while lk_part_stats is on.
+ */
+typedef struct
+{
+	u_int64_t	acquired;	/* times the latch was taken */
+	u_int64_t	contended;	/* times it was already held */
+	u_int64_t	wait_us;	/* total time spent waiting for it */
+	u_int64_t	max_wait_us;
+	u_int64_t	hold_us;	/* total time it was held */
+	u_int64_t	max_hold_us;
+	u_int64_t	held_at;	/* when the holder took it, 0 if untimed */
+} Comdb2LockPartStat;
+
 #ifdef LOCKMGRDBG
 typedef struct
 {
@@ -80,7 +99,7 @@ typedef struct
 } Comdb2LockDebug;
 
 #ifdef  __x86_64
-#define FLUFF uint8_t fluff[88]
+#define FLUFF uint8_t fluff[32]
 #else
 #define FLUFF uint8_t fluff[1]
 #endif
@@ -90,6 +109,7 @@ typedef struct
 	pthread_mutex_t	mtx;
 	Comdb2LockDebug	lock;
 	Comdb2LockDebug	unlock;
+	Comdb2LockPartStat stat;
 	FLUFF;
 } PthreadMutexWithFluff;
 
@@ -97,9 +117,9 @@ typedef struct
 
 #ifdef  __x86_64
 #  ifdef __APPLE__
-#    define FLUFF uint8_t fluff[128]
+#    define FLUFF uint8_t fluff[72]
 #  else
-#    define FLUFF uint8_t fluff[152]
+#    define FLUFF uint8_t fluff[96]
 #  endif
 #else
 #define FLUFF uint8_t fluff[1]
@@ -108,6 +128,7 @@ typedef struct
 typedef struct
 {
 	pthread_mutex_t	mtx;
+	Comdb2LockPartStat stat;
 	FLUFF;
 } PthreadMutexWithFluff;
 
@@ -407,6 +428,84 @@ do {									\
 #define	UNLOCKREGION(dbenv, lt)
 #endif
 
+static inline u_int64_t
+__lock_part_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((u_int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+/*
+ * Take a lock table partition latch.  With lk_part_spin set, retry a
+ * held latch that many times before blocking on it; with lk_part_stats
+ * set, count and time the acquisition.
+ */
+static inline void
+__lock_part_acquire(PthreadMutexWithFluff *m)
+{
+	Comdb2LockPartStat *st;
+	u_int64_t start, now;
+	int spins, waited;
+
+	if (!gbl_lk_part_stats && !gbl_lk_part_spin) {
+		pthread_mutex_lock(&m->mtx);
+		m->stat.held_at = 0;
+		return;
+	}
+
+	start = waited = 0;
+	if (pthread_mutex_trylock(&m->mtx) != 0) {
+		waited = 1;
+		if (gbl_lk_part_stats)
+			start = __lock_part_now_us();
+		for (spins = gbl_lk_part_spin; spins > 0; --spins) {
+#if defined(__x86_64) || defined(__i386)
+			__asm__ __volatile__("pause");
+#endif
+			if (pthread_mutex_trylock(&m->mtx) == 0)
+				goto locked;
+		}
+		pthread_mutex_lock(&m->mtx);
+	}
+
+locked:
+	st = &m->stat;
+	if (!gbl_lk_part_stats) {
+		st->held_at = 0;
+		return;
+	}
+	now = __lock_part_now_us();
+	st->acquired++;
+	if (waited) {
+		st->contended++;
+		if (start) {
+			st->wait_us += now - start;
+			if (now - start > st->max_wait_us)
+				st->max_wait_us = now - start;
+		}
+	}
+	st->held_at = now;
+}
+
+static inline void
+__lock_part_release(PthreadMutexWithFluff *m)
+{
+	Comdb2LockPartStat *st;
+	u_int64_t held;
+
+	st = &m->stat;
+	if (st->held_at) {
+		held = __lock_part_now_us() - st->held_at;
+		st->hold_us += held;
+		if (held > st->max_hold_us)
+			st->max_hold_us = held;
+		st->held_at = 0;
+	}
+	pthread_mutex_unlock(&m->mtx);
+}
+
 #ifdef LOCKMGRDBG
 #define lock_lockers(region) \
 do { \
@@ -420,7 +519,7 @@ do { \
 #define lock_obj_partition(region, partition)\
 do { \
 	assert((partition) < gbl_lk_parts); \
-	pthread_mutex_lock(&(region)->obj_tab_mtx[(partition)].mtx); \
+	__lock_part_acquire(&(region)->obj_tab_mtx[(partition)]); \
 	(region)->obj_tab_mtx[(partition)].lock.file = __FILE__; \
 	(region)->obj_tab_mtx[(partition)].lock.func = __func__; \
 	(region)->obj_tab_mtx[(partition)].lock.line = __LINE__; \
@@ -430,7 +529,7 @@ do { \
 #define lock_locker_partition(region, partition) \
 do { \
 	assert((partition) < gbl_lkr_parts); \
-	pthread_mutex_lock(&(region)->locker_tab_mtx[(partition)].mtx); \
+	__lock_part_acquire(&(region)->locker_tab_mtx[(partition)]); \
 	(region)->locker_tab_mtx[(partition)].lock.file = __FILE__; \
 	(region)->locker_tab_mtx[(partition)].lock.func = __func__; \
 	(region)->locker_tab_mtx[(partition)].lock.line = __LINE__; \
@@ -462,7 +561,7 @@ do { \
 	(region)->obj_tab_mtx[(partition)].unlock.func = __func__; \
 	(region)->obj_tab_mtx[(partition)].unlock.line = __LINE__; \
 	(region)->obj_tab_mtx[(partition)].unlock.thd  = pthread_self(); \
-	pthread_mutex_unlock(&region->obj_tab_mtx[partition].mtx); \
+	__lock_part_release(&(region)->obj_tab_mtx[(partition)]); \
 } while (0)
 
 #define unlock_locker_partition(region, partition) \
@@ -472,7 +571,7 @@ do { \
 	(region)->locker_tab_mtx[(partition)].unlock.func = __func__; \
 	(region)->locker_tab_mtx[(partition)].unlock.line = __LINE__; \
 	(region)->locker_tab_mtx[(partition)].unlock.thd  = pthread_self(); \
-	pthread_mutex_unlock(&(region)->locker_tab_mtx[(partition)].mtx); \
+	__lock_part_release(&(region)->locker_tab_mtx[(partition)]); \
 } while (0)
 
 #define unlock_detector(region) \
@@ -487,12 +586,12 @@ do { \
 #else // no LOCKMGRDBG
 
 #define lock_lockers(region) pthread_mutex_lock(&(region)->lockers_mtx.mtx)
-#define lock_obj_partition(region, partition) pthread_mutex_lock(&(region)->obj_tab_mtx[(partition)].mtx)
-#define lock_locker_partition(region, partition) pthread_mutex_lock(&(region)->locker_tab_mtx[(partition)].mtx)
+#define lock_obj_partition(region, partition) __lock_part_acquire(&(region)->obj_tab_mtx[(partition)])
+#define lock_locker_partition(region, partition) __lock_part_acquire(&(region)->locker_tab_mtx[(partition)])
 #define lock_detector(region) pthread_mutex_lock(&(region)->dd_mtx.mtx)
 #define unlock_lockers(region) pthread_mutex_unlock(&(region)->lockers_mtx.mtx)
-#define unlock_obj_partition(region, partition) pthread_mutex_unlock(&region->obj_tab_mtx[partition].mtx)
-#define unlock_locker_partition(region, partition) pthread_mutex_unlock(&(region)->locker_tab_mtx[(partition)].mtx)
+#define unlock_obj_partition(region, partition) __lock_part_release(&(region)->obj_tab_mtx[(partition)])
+#define unlock_locker_partition(region, partition) __lock_part_release(&(region)->locker_tab_mtx[(partition)])
 #define unlock_detector(region) pthread_mutex_unlock(&(region)->dd_mtx.mtx)
 
 #endif // LOCKMGRDBG
@@ -105,6 +105,17 @@ struct __db_log {
 	DB_ENV	 *dbenv;		/* Reference to error information. */
 	REGINFO	  reginfo;		/* Region information. */
 
+/* Group commit; these fields are protected by gc_lk. */
+	pthread_mutex_t gc_lk;
+	pthread_cond_t gc_cond;		/* Wakes the flusher. */
+	pthread_cond_t gc_done;		/* Wakes committers after a flush. */
+	pthread_t gc_td;		/* Flusher thread. */
+	int	  gc_running;		/* Flusher thread started. */
+	int	  gc_stop;		/* Flusher thread should exit. */
+	DB_LSN	  gc_want;		/* Highest lsn a committer waits on. */
+	DB_LSN	  gc_synced;		/* Flushed through here (inclusive). */
+	DB_LSN	  gc_failed;		/* Highest lsn of a failed flush. */
+
 #define	DBLOG_RECOVER		0x01	/* We are in recovery. */
 #define	DBLOG_FORCE_OPEN	0x02	/* Force the DB open even if it appears
 					 * to be deleted. */
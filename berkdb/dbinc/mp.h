@@ -67,6 +67,12 @@ struct __db_mpool {
 
 	u_int32_t   nreg;		/* N underlying cache regions. */
 	REGINFO	   *reginfo;		/* Underlying cache regions. */
+
+	/*
+	 * Per-cache 2Q ghost tables, created on first eviction under the
+	 * cache's region lock and not freed until the mpool is closed.
+	 */
+	struct __mp_ghost **ghosts;
 };
 
 /*
@@ -212,6 +218,41 @@ struct __db_mpool_hash {
 #define MPOOL_PRI_INTERNAL  4   /* Internal pages get an additional 25% boost. */
 #define	MPOOL_PRI_VERY_HIGH	1	/* Add number of buffers in pool. */
 
+/*
+ * Buffer replacement policies, selected by the mp_replacement_policy attr.
+ *
+ * MPOOL_REPL_LRU is the historic priority LRU: every unpinned buffer gets
+ * the current lru_count as its priority.
+ *
+ * MPOOL_REPL_2Q is a scan-resistant 2Q built on the same priorities.  A
+ * buffer read into the cache is probationary and is released with its
+ * priority lowered by the number of buffers in the cache, so it sorts
+ * behind every hot buffer referenced during the last pass over the cache.
+ * A probationary buffer becomes hot when it is referenced again outside
+ * of the correlated-reference window (mp_2q_promote_window puts), or when
+ * it is read back in while its page is still in the ghost table of
+ * recently evicted probationary pages.
+ */
+#define	MPOOL_REPL_LRU		0
+#define	MPOOL_REPL_2Q		1
+
+/*
+ * MPOOL_GHOST --
+ *	Non-resident history for the 2Q policy.  This is a lossy, direct-mapped
+ *	table of (mf_offset, pgno) keys: a newer eviction simply overwrites an
+ *	older one in the same slot, which ages the table without any locking.
+ *	Every key is a valid page, so empty slots are marked as such.
+ */
+typedef struct __mp_ghost_slot {
+	u_int64_t key;			/* (mf_offset, pgno). */
+	u_int32_t occupied;		/* Key is an evicted page. */
+} MPOOL_GHOST_SLOT;
+
+typedef struct __mp_ghost {
+	u_int32_t mask;			/* Number of slots - 1. */
+	MPOOL_GHOST_SLOT slots[1];	/* Variable length. */
+} MPOOL_GHOST;
+
 /*
  * MPOOLFILE --
  *	Shared DB_MPOOLFILE information.
@@ -329,9 +370,11 @@ struct __bh {
 #define	BH_TRASH	0x020		/* Page is garbage. */
 #define BH_NOINCR	0x040		/* Don't increment lru_cache. */
 #define BH_PREFAULT	0x080		/* prefault pages */
+#define BH_HOT		0x100		/* 2Q: referenced again while resident. */
 	u_int16_t	flags;
 	u_int16_t	generation;	/* This changes before page changes */
 	u_int32_t	priority;	/* LRU priority. */
+	u_int32_t	admit_lru;	/* lru_count when read into the cache. */
 	SH_TAILQ_ENTRY(__bh) hq;	/* MPOOL hash bucket queue. */
 
 	db_pgno_t pgno;			/* Underlying MPOOLFILE page number. */
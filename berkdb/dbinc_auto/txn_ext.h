@@ -92,6 +92,8 @@ void __txn_remrem __P((DB_ENV *, DB_TXN *, const char *));
 int __txn_lockevent __P((DB_ENV *, DB_TXN *, DB *, DB_LOCK *, u_int32_t));
 void __txn_remlock __P((DB_ENV *, DB_TXN *, DB_LOCK *, u_int32_t));
 int __txn_doevents __P((DB_ENV *, DB_TXN *, int, int));
+void __txn_trigger_event __P((DB_TXN *, struct __db_trigger_subscription *));
+void __txn_trigger_wakeup __P((DB_TXN *, int));
 int __txn_snapshot __P((DB_TXN *));
 int __txn_allocate_ltrans __P((DB_ENV *, unsigned long long, DB_LSN *, LTDESC **));
 int __txn_ltrans_find_lowest_lsn __P((DB_ENV *, DB_LSN *));
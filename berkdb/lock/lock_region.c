@@ -335,6 +335,8 @@ __lock_init(dbenv, lt)
 		pthread_mutex_init(&region->obj_tab_mtx[i].mtx, NULL);
 		bzero(region->obj_tab_mtx[i].fluff,
 		    sizeof(region->obj_tab_mtx[i].fluff));
+		bzero(&region->obj_tab_mtx[i].stat,
+		    sizeof(region->obj_tab_mtx[i].stat));
 		if ((ret = __db_shalloc(lt->reginfo.addr,
 		    region->object_p_size * sizeof(ObjTab), 0, &addr)) != 0) {
 			goto mem_err;
@@ -368,6 +370,8 @@ __lock_init(dbenv, lt)
 		pthread_mutex_init(&region->locker_tab_mtx[i].mtx, NULL);
 		bzero(region->locker_tab_mtx[i].fluff,
 		    sizeof(region->locker_tab_mtx[i].fluff));
+		bzero(&region->locker_tab_mtx[i].stat,
+		    sizeof(region->locker_tab_mtx[i].stat));
 		if ((ret = __db_shalloc(lt->reginfo.addr,
 		    region->locker_p_size * sizeof(LockerTab),
 		    0, &addr)) != 0) {
@@ -823,6 +823,124 @@ __lock_collect_pp(dbenv, func, arg)
 }
 
 
+static void
+__lock_part_stat_fill(sp, type, partition, latch)
+	DB_LOCK_PART_STAT *sp;
+	const char *type;
+	u_int32_t partition;
+	PthreadMutexWithFluff *latch;
+{
+	memset(sp, 0, sizeof(*sp));
+	sp->st_type = type;
+	sp->st_partition = partition;
+	sp->st_acquired = latch->stat.acquired;
+	sp->st_contended = latch->stat.contended;
+	sp->st_wait_us = latch->stat.wait_us;
+	sp->st_max_wait_us = latch->stat.max_wait_us;
+	sp->st_hold_us = latch->stat.hold_us;
+	sp->st_max_hold_us = latch->stat.max_hold_us;
+}
+
+static void
+__lock_part_stat_chain(sp, chain)
+	DB_LOCK_PART_STAT *sp;
+	u_int32_t chain;
+{
+	if (chain == 0)
+		return;
+	sp->st_entries += chain;
+	sp->st_buckets_used++;
+	if (chain > sp->st_max_chain)
+		sp->st_max_chain = chain;
+}
+
+/*
+ * Report latch contention and hash chain lengths for every object and locker
+ * partition, so a hot partition can be told apart from a bad hash spread.
+ */
+static int
+__lock_collect_partitions(dbenv, func, arg)
+	DB_ENV *dbenv;
+	collect_lock_parts_f func;
+	void *arg;
+{
+	DB_LOCKTAB *lt;
+	DB_LOCKREGION *lrp;
+	DB_LOCKER *lip;
+	DB_LOCKOBJ *op;
+	DB_LOCK_PART_STAT st;
+	u_int32_t chain;
+	int i, j;
+
+	lt = dbenv->lk_handle;
+	lrp = lt->reginfo.primary;
+
+	for (i = 0; i < gbl_lk_parts; ++i) {
+		lock_obj_partition(lrp, i);
+		__lock_part_stat_fill(&st, "object", i, &lrp->obj_tab_mtx[i]);
+		st.st_buckets = lrp->object_p_size;
+		for (j = 0; j < lrp->object_p_size; j++) {
+			chain = 0;
+			for (op = SH_TAILQ_FIRST(&lrp->obj_tab[i][j],
+			    __db_lockobj); op != NULL;
+			    op = SH_TAILQ_NEXT(op, links, __db_lockobj))
+				chain++;
+			__lock_part_stat_chain(&st, chain);
+		}
+		unlock_obj_partition(lrp, i);
+		(*func)(arg, &st);
+	}
+
+	for (i = 0; i < gbl_lkr_parts; ++i) {
+		lock_locker_partition(lrp, i);
+		__lock_part_stat_fill(&st, "locker", i,
+		    &lrp->locker_tab_mtx[i]);
+		st.st_buckets = lrp->locker_p_size;
+		for (j = 0; j < lrp->locker_p_size; j++) {
+			chain = 0;
+			for (lip = SH_TAILQ_FIRST(&lrp->locker_tab[i][j],
+			    __db_locker); lip != NULL;
+			    lip = SH_TAILQ_NEXT(lip, links, __db_locker))
+				chain++;
+			__lock_part_stat_chain(&st, chain);
+		}
+		unlock_locker_partition(lrp, i);
+		(*func)(arg, &st);
+	}
+	return (0);
+}
+
+/*
+ * __lock_collect_partitions_pp --
+ *	DB_ENV->collect_lock_partitions pre/post processing.
+ *
+ * PUBLIC: int __lock_collect_partitions_pp __P((DB_ENV *,
+ * PUBLIC:     collect_lock_parts_f, void *));
+ */
+int
+__lock_collect_partitions_pp(dbenv, func, arg)
+	DB_ENV *dbenv;
+	collect_lock_parts_f func;
+	void *arg;
+{
+	int rep_check, ret;
+
+	PANIC_CHECK(dbenv);
+	ENV_REQUIRES_CONFIG(dbenv, dbenv->lk_handle,
+	    "DB_ENV->collect_lock_partitions", DB_INIT_LOCK);
+
+	rep_check = IS_ENV_REPLICATED(dbenv) ? 1 : 0;
+
+	if (rep_check)
+		__env_rep_enter(dbenv);
+	ret = __lock_collect_partitions(dbenv, func, arg);
+
+	if (rep_check)
+		__env_rep_exit(dbenv);
+
+	return (ret);
+}
+
 /*
  * COMDB2 MODIFICATION
  *
@@ -50,6 +50,9 @@ __log_open(dbenv)
 	if ((ret = __os_calloc(dbenv, 1, sizeof(DB_LOG), &dblp)) != 0)
 		return (ret);
 	dblp->dbenv = dbenv;
+	pthread_mutex_init(&dblp->gc_lk, NULL);
+	pthread_cond_init(&dblp->gc_cond, NULL);
+	pthread_cond_init(&dblp->gc_done, NULL);
 
 	/* Join/create the log region. */
 	dblp->reginfo.type = REGION_TYPE_LOG;
@@ -843,6 +846,9 @@ __log_dbenv_refresh(dbenv)
 
 	dblp = dbenv->lg_handle;
 
+	/* Stop the group commit thread before the region goes away. */
+	__log_group_commit_stop(dblp);
+
 	/* We may have opened files as part of XA; if so, close them. */
 	F_SET(dblp, DBLOG_RECOVER);
 	ret = __dbreg_close_files(dbenv);
@@ -870,6 +876,9 @@ __log_dbenv_refresh(dbenv)
 	void *p = R_ADDR(&dblp->reginfo, region->buffer_off);
 	__os_free(dbenv, p);
 
+	pthread_cond_destroy(&dblp->gc_done);
+	pthread_cond_destroy(&dblp->gc_cond);
+	pthread_mutex_destroy(&dblp->gc_lk);
 	__os_free(dbenv, dblp);
 
 	dbenv->lg_handle = NULL;
@@ -44,7 +44,12 @@ static const char revid[] = "$Id: log_put.c,v 11.145 2003/09/13 19:20:39 bostic
 #include <netinet/in.h>
 
 #include "logmsg.h"
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
 #include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 extern unsigned long long get_commit_context(const void *, uint32_t generation);
 extern int bdb_update_startlwm_berk(void *statearg, unsigned long long ltranid,
@@ -57,6 +62,7 @@ static int __log_fill __P((DB_LOG *, DB_LSN *, void *, u_int32_t));
 static int __log_fill_segments __P((DB_LOG *, DB_LSN *, DB_LSN *, void *,
 	u_int32_t));
 static int __log_flush_commit __P((DB_ENV *, const DB_LSN *, u_int32_t));
+static int __log_group_commit __P((DB_LOG *, const DB_LSN *));
 static int __log_newfh __P((DB_LOG *));
 static int __log_put_next __P((DB_ENV *,
 	DB_LSN *, u_int64_t *, DBT *, const DBT *, HDR *, DB_LSN *, int,
@@ -331,6 +337,15 @@ __log_put_int_int(dbenv, lsnp, contextp, udbt, flags, off_context, usr_ptr)
 	 * If a flush is not needed, see if WRITE_NOSYNC was set and we
 	 * need to write out the log buffer.
 	 */
+	if (LF_ISSET(DB_FLUSH) && !LF_ISSET(DB_LOG_CHKPNT) &&
+	    dbenv->attr.log_group_commit) {
+		if (lock_held) {
+			R_UNLOCK(dbenv, &dblp->reginfo);
+			lock_held = 0;
+		}
+		if (__log_group_commit(dblp, &lsn) == 0)
+			LF_CLR(DB_FLUSH);
+	}
 	if (LF_ISSET(DB_FLUSH | DB_LOG_WRNOSYNC)) {
 		if (!lock_held) {
 			R_LOCK(dbenv, &dblp->reginfo);
@@ -957,6 +972,138 @@ __log_flush_commit(dbenv, lsnp, flags)
 	return (ret);
 }
 
+/*
+ * Group commit.
+ *
+ * With the log_group_commit attribute set, a committer doesn't flush the log
+ * itself.  It publishes the lsn it needs on disk, drops the region lock and
+ * sleeps until the flusher thread has synced through it.  The flusher issues
+ * one flush for the highest lsn requested so far, so under load the region
+ * lock and flush mutex are taken once per fsync rather than once per commit,
+ * and waking committers don't pile back onto the region lock.
+ */
+static void *
+__log_group_commit_td(arg)
+	void *arg;
+{
+	DB_ENV *dbenv;
+	DB_LOG *dblp;
+	DB_LSN want;
+	LOG *lp;
+	int ret;
+
+	dblp = (DB_LOG *)arg;
+	dbenv = dblp->dbenv;
+	lp = dblp->reginfo.primary;
+
+	pthread_mutex_lock(&dblp->gc_lk);
+	while (!dblp->gc_stop) {
+		if (log_compare(&dblp->gc_want, &dblp->gc_synced) <= 0) {
+			pthread_cond_wait(&dblp->gc_cond, &dblp->gc_lk);
+			continue;
+		}
+		want = dblp->gc_want;
+		pthread_mutex_unlock(&dblp->gc_lk);
+
+		R_LOCK(dbenv, &dblp->reginfo);
+		ret = __log_flush_int(dblp, &want, 1);
+		R_UNLOCK(dbenv, &dblp->reginfo);
+
+		pthread_mutex_lock(&dblp->gc_lk);
+		/*
+		 * On failure, committers up to want fall back to flushing for
+		 * themselves so that __log_flush_commit can handle the error.
+		 */
+		if (ret != 0)
+			dblp->gc_failed = want;
+		else
+			++lp->stat.st_gc_flushes;
+		dblp->gc_synced = want;
+		pthread_cond_broadcast(&dblp->gc_done);
+	}
+	dblp->gc_running = 0;
+	pthread_cond_broadcast(&dblp->gc_done);
+	pthread_mutex_unlock(&dblp->gc_lk);
+	return (NULL);
+}
+
+/*
+ * __log_group_commit --
+ *	Wait for the flusher thread to make lsnp durable.  Called without the
+ *	region lock.  Returns non-zero if the caller has to flush it itself.
+ */
+static int
+__log_group_commit(dblp, lsnp)
+	DB_LOG *dblp;
+	const DB_LSN *lsnp;
+{
+	LOG *lp;
+	pthread_attr_t attr;
+	int ret;
+
+	lp = dblp->reginfo.primary;
+	ret = 0;
+
+	pthread_mutex_lock(&dblp->gc_lk);
+	if (!dblp->gc_running) {
+		if (dblp->gc_stop) {
+			pthread_mutex_unlock(&dblp->gc_lk);
+			return (-1);
+		}
+		/* Joinable: __log_group_commit_stop waits for it. */
+		pthread_attr_init(&attr);
+		pthread_attr_setstacksize(&attr, PTHREAD_STACK_MIN + 0x20000);
+		ret = pthread_create(&dblp->gc_td, &attr,
+		    __log_group_commit_td, dblp);
+		pthread_attr_destroy(&attr);
+		if (ret != 0) {
+			/* Don't retry on every commit; they flush themselves. */
+			dblp->gc_stop = 1;
+			pthread_mutex_unlock(&dblp->gc_lk);
+			__db_err(dblp->dbenv,
+			    "can't create group commit thread: %s, "
+			    "commits will flush the log themselves",
+			    strerror(ret));
+			return (-1);
+		}
+		dblp->gc_running = 1;
+	}
+	if (log_compare(lsnp, &dblp->gc_want) > 0) {
+		dblp->gc_want = *lsnp;
+		pthread_cond_signal(&dblp->gc_cond);
+	}
+	while (dblp->gc_running && log_compare(lsnp, &dblp->gc_synced) > 0)
+		pthread_cond_wait(&dblp->gc_done, &dblp->gc_lk);
+	if (log_compare(lsnp, &dblp->gc_synced) > 0 ||
+	    log_compare(lsnp, &dblp->gc_failed) <= 0)
+		ret = -1;
+	else
+		++lp->stat.st_gc_commits;
+	pthread_mutex_unlock(&dblp->gc_lk);
+	return (ret);
+}
+
+/*
+ * __log_group_commit_stop --
+ *	Stop the group commit thread, if it was started.
+ *
+ * PUBLIC: void __log_group_commit_stop __P((DB_LOG *));
+ */
+void
+__log_group_commit_stop(dblp)
+	DB_LOG *dblp;
+{
+	int running;
+
+	pthread_mutex_lock(&dblp->gc_lk);
+	running = dblp->gc_running;
+	dblp->gc_stop = 1;
+	pthread_cond_signal(&dblp->gc_cond);
+	pthread_mutex_unlock(&dblp->gc_lk);
+	if (running)
+		pthread_join(dblp->gc_td, NULL);
+}
+
 extern int wait_for_running_transactions(DB_ENV *);
 
 /*
@@ -2273,3 +2420,175 @@ __log_encrypt_record(dbenv, dbt, hdr, orig)
 	}
 	return (0);
 }
+
+/*
+ * Commit throughput benchmark.  Writers append small records with DB_FLUSH to
+ * a private environment as fast as they can, with every writer flushing for
+ * itself and then with group commit, at increasing writer counts.
+ */
+struct log_bench_writer {
+	DB_ENV *env;
+	volatile int *stop;
+	u_int64_t ncommits;
+	int ret;
+};
+
+static void *
+__log_bench_writer(arg)
+	void *arg;
+{
+	struct log_bench_writer *w;
+	u_int8_t rec[64];
+	DB_LSN lsn;
+	DBT dbt;
+
+	w = (struct log_bench_writer *)arg;
+	memset(rec, 0, sizeof(rec));
+	memset(&dbt, 0, sizeof(dbt));
+	dbt.data = rec;
+	dbt.size = sizeof(rec);
+	while (!*w->stop) {
+		if ((w->ret = w->env->log_put(w->env, &lsn, &dbt, DB_FLUSH)) != 0)
+			break;
+		++w->ncommits;
+	}
+	return (NULL);
+}
+
+static int
+__log_bench_run(env, nwriters, secs, commits, syncs)
+	DB_ENV *env;
+	int nwriters, secs;
+	u_int64_t *commits;
+	u_int32_t *syncs;
+{
+	struct log_bench_writer *w;
+	DB_LOG_STAT *sp;
+	pthread_t *tds;
+	volatile int stop;
+	int i, n, ret;
+
+	*commits = 0;
+	if ((ret = env->log_stat(env, &sp, DB_STAT_CLEAR)) != 0)
+		return (ret);
+	free(sp);
+	if ((ret = __os_calloc(env, nwriters, sizeof(*w), &w)) != 0)
+		return (ret);
+	if ((ret = __os_calloc(env, nwriters, sizeof(*tds), &tds)) != 0) {
+		__os_free(env, w);
+		return (ret);
+	}
+
+	stop = 0;
+	for (n = 0; n < nwriters; ++n) {
+		w[n].env = env;
+		w[n].stop = &stop;
+		if ((ret = pthread_create(&tds[n], NULL,
+		    __log_bench_writer, &w[n])) != 0)
+			break;
+	}
+	if (ret == 0)
+		sleep(secs);
+	stop = 1;
+	for (i = 0; i < n; ++i) {
+		pthread_join(tds[i], NULL);
+		*commits += w[i].ncommits;
+		if (w[i].ret != 0 && ret == 0)
+			ret = w[i].ret;
+	}
+	__os_free(env, tds);
+	__os_free(env, w);
+	if (ret != 0)
+		return (ret);
+
+	if ((ret = env->log_stat(env, &sp, 0)) != 0)
+		return (ret);
+	*syncs = sp->st_scount;
+	free(sp);
+	return (0);
+}
+
+static void
+__log_bench_rmdir(dir)
+	const char *dir;
+{
+	char path[PATH_MAX];
+	struct dirent *d;
+	DIR *dh;
+
+	if ((dh = opendir(dir)) != NULL) {
+		while ((d = readdir(dh)) != NULL) {
+			if (strcmp(d->d_name, ".") == 0 ||
+			    strcmp(d->d_name, "..") == 0)
+				continue;
+			snprintf(path, sizeof(path), "%s/%s", dir, d->d_name);
+			unlink(path);
+		}
+		closedir(dh);
+	}
+	rmdir(dir);
+}
+
+/*
+ * __log_commit_bench --
+ *	Measure commits/sec with 1, 8, 64 and 256 writers, with and without
+ *	group commit.
+ *
+ * PUBLIC: int __log_commit_bench __P((FILE *, const char *, int));
+ */
+int
+__log_commit_bench(out, dir, secs)
+	FILE *out;
+	const char *dir;
+	int secs;
+{
+	static const int writers[] = { 1, 8, 64, 256 };
+	DB_ENV *env;
+	u_int64_t commits[2];
+	u_int32_t syncs[2];
+	char home[PATH_MAX];
+	int gc, i, ret, t_ret;
+
+	if (secs <= 0)
+		secs = 2;
+	snprintf(home, sizeof(home), "%s/_logbench.%d", dir, (int)getpid());
+	if (mkdir(home, 0755) != 0) {
+		logmsgf(LOGMSG_ERROR, out, "%s: mkdir %s: %s\n", __func__, home,
+		    strerror(errno));
+		return (errno);
+	}
+
+	if ((ret = db_env_create(&env, 0)) != 0) {
+		__log_bench_rmdir(home);
+		return (ret);
+	}
+	env->attr.warn_on_replicant_log_write = 0;
+	if ((ret = env->set_cachesize(env, 0, 1 << 20, 1)) != 0 ||
+	    (ret = env->open(env, home, DB_CREATE | DB_PRIVATE |
+	    DB_INIT_LOG | DB_INIT_MPOOL | DB_THREAD, 0666)) != 0)
+		goto err;
+
+	logmsgf(LOGMSG_USER, out, "log commit bench: %ds per run\n", secs);
+	logmsgf(LOGMSG_USER, out, "%-8s %14s %12s %14s %12s\n", "writers",
+	    "commits/sec", "syncs/commit", "group/sec", "syncs/commit");
+	for (i = 0; i < sizeof(writers) / sizeof(writers[0]); ++i) {
+		for (gc = 0; gc < 2; ++gc) {
+			env->attr.log_group_commit = gc;
+			if ((ret = __log_bench_run(env, writers[i], secs,
+			    &commits[gc], &syncs[gc])) != 0)
+				goto err;
+		}
+		logmsgf(LOGMSG_USER, out, "%-8d %14.0f %12.3f %14.0f %12.3f\n",
+		    writers[i], (double)commits[0] / secs,
+		    commits[0] ? (double)syncs[0] / commits[0] : 0.0,
+		    (double)commits[1] / secs,
+		    commits[1] ? (double)syncs[1] / commits[1] : 0.0);
+	}
+
+err:	if (ret != 0)
+		logmsgf(LOGMSG_ERROR, out, "%s failed rc %d\n", __func__, ret);
+	if ((t_ret = env->close(env, 0)) != 0 && ret == 0)
+		ret = t_ret;
+	__log_bench_rmdir(home);
+	return (ret);
+}
@@ -354,6 +354,9 @@ found:		if (offsetp != NULL)
 	total_buckets += buckets;
 	buckets = 0;
 
+	/* The cache is full: this is when the 2Q policy needs its history. */
+	__memp_repl_init(dbmp, memreg);
+
 	/*
 	 * Walk the hash buckets and find the next two with potentially useful
 	 * buffers.  Free the buffer with the lowest priority from the buckets'
@@ -545,6 +548,8 @@ found:		if (offsetp != NULL)
 			goto next_hb;
 		}
 
+		__memp_repl_evict(dbmp, memreg, bhp);
+
 		/*
 		 * Check to see if the buffer is the size we're looking for.
 		 * If so, we can simply reuse it.  Else, free the buffer and
@@ -264,6 +264,9 @@ __dir_pgread_multi(dbmfp, pgno, numpages, pages)
 
 		++mfp->stat.st_page_in;
 
+		if ((ret = __memp_pguncompress(dbmfp, pgno, &pages[idx])) != 0)
+			return (ret);
+
 		if ((ret = mfp->ftype == 0 ? 0 :
 			__dir_pg(dbmfp, pgno, &pages[idx], 1)) != 0)
 			return (ret);
@@ -467,12 +470,18 @@ __memp_pgread(dbmfp, hp, bhp, can_create, is_recovery_page)
 	/*
 	 * Temporary files may not yet have been created.  We don't create
 	 * them now, we create them when the pages have to be flushed.
+	 *
+	 * A page written compressed that doesn't expand is treated like one
+	 * that fails its checksum.
 	 */
 	nr = 0;
 	if (dbmfp->fhp != NULL)
-		if ((ret = __os_io(dbenv, DB_IO_READ,
-		    dbmfp->fhp, bhp->pgno, pagesize, bhp->buf, &nr)) != 0)
+		if ((ret = __memp_pgread_slot(dbmfp,
+		    bhp->pgno, bhp->buf, &nr)) != 0) {
+			if (ret == DB_SEARCH_PGCACHE)
+				goto recover_page;
 			goto err;
+		}
 
 	/*
 	 * The page may not exist; if it doesn't, nr may well be 0, but we
@@ -791,7 +800,7 @@ __memp_pgwrite_multi(dbenv, dbmfp, hps, bhps, numpages, wrrec)
 	DB_MPOOL *dbmp;
 	MPOOL *c_mp;
 	u_int32_t n_cache;
-	int ret, i, idx;
+	int ret, i, idx, nrun, compressed;
 
 	mfp = dbmfp == NULL ? NULL : dbmfp->mfp;
 	ret = 0;
@@ -1033,19 +1042,37 @@ __memp_pgwrite_multi(dbenv, dbmfp, hps, bhps, numpages, wrrec)
 
 
 
-	/* Get page offsets. */
-	for (i = 0; i < numpages; i++) {
-		bhp = bhps[i];
-		bparray[i] = bhp->buf;
-	}
+	/*
+	 * Write the pages.  Pages written compressed go out on their own; the
+	 * runs of pages between them are written with a single writev.
+	 */
+	for (i = 0, nrun = 0; i <= numpages; i++) {
+		compressed = 0;
+		if (i < numpages) {
+			bhp = bhps[i];
+			if ((ret = __memp_pgwrite_compressed(dbenv,
+			    dbmfp, bhp, &compressed)) != 0) {
+				__db_err(dbenv, "%s: compressed write failed "
+				    "for page %lu", __memp_fn(dbmfp),
+				    (u_long) bhp->pgno);
+				goto err;
+			}
+			if (!compressed) {
+				bparray[nrun++] = bhp->buf;
+				continue;
+			}
+		}
+		if (nrun == 0)
+			continue;
 
-	/* Write the page. */
-	if ((ret = __os_iov(dbenv, DB_IO_WRITE, dbmfp->fhp,
-		    bhps[0]->pgno, mfp->stat.st_pagesize,
-		    bparray, numpages, &nw)) != 0) {
-		__db_err(dbenv, "%s: writev failed for page %lu",
-		    __memp_fn(dbmfp), (u_long) bhp->pgno);
-		goto err;
+		if ((ret = __os_iov(dbenv, DB_IO_WRITE, dbmfp->fhp,
+			    bhps[i - nrun]->pgno, mfp->stat.st_pagesize,
+			    bparray, nrun, &nw)) != 0) {
+			__db_err(dbenv, "%s: writev failed for page %lu",
+			    __memp_fn(dbmfp), (u_long) bhps[i - 1]->pgno);
+			goto err;
+		}
+		nrun = 0;
 	}
 
 
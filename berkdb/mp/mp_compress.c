@@ -0,0 +1,363 @@
+/*
+   Copyright 2018 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * On-disk compression of btree leaf pages.
+ *
+ * With page_compress on, a leaf page that lz4 compresses into fewer 4K
+ * blocks than the page size is written as a P_COMPRESSED slot (see
+ * PG_COMPRESSED): only the blocks holding the compressed page are written,
+ * and the rest of the slot is punched out of the file.  Pages keep their
+ * place in the file, so the filesystem's extent map is the indirection
+ * from page number to compressed data, and nothing about page allocation,
+ * logging, recovery pages or backups changes.  The cache only ever holds
+ * uncompressed pages: the slot is expanded on read, before pgin checks the
+ * page's own checksum.
+ *
+ * Reads of compressed slots work whether or not page_compress is on.  With
+ * it on, reads start with the first block and only read as much of the
+ * slot as the compressed page takes.
+ */
+
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include "db_int.h"
+#include "dbinc/db_page.h"
+#include "dbinc/mp.h"
+
+#include <crc32c.h>
+#include <lz4.h>
+#include <logmsg.h>
+
+#if LZ4_VERSION_NUMBER < 10701
+#define LZ4_compress_default LZ4_compress_limitedOutput
+#endif
+
+/* Slots are written and read in blocks of this size. */
+#define	MP_COMPRESS_BLKSZ	4096
+#define	MP_COMPRESS_HDRSZ	(SIZEOF_PAGE + sizeof(PG_COMPRESSED))
+
+int gbl_page_compress = 0;
+
+static int punch_unsupported;
+
+struct cbuf {
+	size_t sz;
+	u_int8_t *buf;
+};
+
+static pthread_once_t cbuf_once = PTHREAD_ONCE_INIT;
+static pthread_key_t cbuf_key;
+
+static void
+free_cbuf(p)
+	void *p;
+{
+	struct cbuf *b = p;
+
+	free(b->buf);
+	free(b);
+}
+
+static void
+init_cbuf(void)
+{
+	if (pthread_key_create(&cbuf_key, free_cbuf) != 0)
+		logmsgperror("pthread_key_create");
+}
+
+/* Per-thread scratch space for a slot. */
+static u_int8_t *
+get_cbuf(sz)
+	size_t sz;
+{
+	struct cbuf *b;
+	u_int8_t *p;
+
+	pthread_once(&cbuf_once, init_cbuf);
+	if ((b = pthread_getspecific(cbuf_key)) == NULL) {
+		if ((b = calloc(1, sizeof(struct cbuf))) == NULL)
+			return (NULL);
+		pthread_setspecific(cbuf_key, b);
+	}
+	if (b->sz < sz) {
+		if ((p = realloc(b->buf, sz)) == NULL)
+			return (NULL);
+		b->buf = p;
+		b->sz = sz;
+	}
+	return (b->buf);
+}
+
+/*
+ * Only database files have btree pages, and encrypted pages wouldn't
+ * compress.  A page needs to be at least two blocks to save one.
+ */
+static int
+__memp_can_compress(dbmfp)
+	DB_MPOOLFILE *dbmfp;
+{
+	MPOOLFILE *mfp;
+
+	mfp = dbmfp->mfp;
+	return (mfp->ftype == DB_FTYPE_SET && !F_ISSET(mfp, MP_TEMP) &&
+	    dbmfp->dbenv->crypto_handle == NULL &&
+	    mfp->stat.st_pagesize >= 2 * MP_COMPRESS_BLKSZ);
+}
+
+static size_t
+get_clen(buf)
+	u_int8_t *buf;
+{
+	PG_COMPRESSED *pc;
+
+	pc = (PG_COMPRESSED *)(buf + SIZEOF_PAGE);
+	return ((size_t)pc->clen[0] | (size_t)pc->clen[1] << 8 |
+	    (size_t)pc->clen[2] << 16 | (size_t)pc->clen[3] << 24);
+}
+
+/*
+ * __memp_pguncompress --
+ *	Expand a P_COMPRESSED slot in buf into the page it holds.  Other
+ *	pages are left alone.
+ *
+ * PUBLIC: int __memp_pguncompress __P((DB_MPOOLFILE *, db_pgno_t, u_int8_t *));
+ */
+int
+__memp_pguncompress(dbmfp, pgno, buf)
+	DB_MPOOLFILE *dbmfp;
+	db_pgno_t pgno;
+	u_int8_t *buf;
+{
+	size_t clen, pagesize;
+	u_int8_t *cbuf;
+
+	if (TYPE(buf) != P_COMPRESSED)
+		return (0);
+
+	pagesize = dbmfp->mfp->stat.st_pagesize;
+	clen = get_clen(buf);
+	if (clen > pagesize - MP_COMPRESS_HDRSZ)
+		goto bad;
+	if ((cbuf = get_cbuf(clen)) == NULL)
+		return (ENOMEM);
+	memcpy(cbuf, buf + MP_COMPRESS_HDRSZ, clen);
+
+	/* A torn slot fails here or on the page checksum in pgin. */
+	if (LZ4_decompress_safe((const char *)cbuf, (char *)buf,
+	    (int)clen, (int)pagesize) != (int)pagesize)
+		goto bad;
+	++dbmfp->mfp->stat.st_page_in_compressed;
+	return (0);
+
+bad:	__db_err(dbmfp->dbenv, "%s: page %lu: bad compressed page",
+	    __memp_fn(dbmfp), (u_long)pgno);
+	return (DB_SEARCH_PGCACHE);
+}
+
+/*
+ * Read bytes [from, to) of page pgno into the same place in buf, the first
+ * from bytes being there already.  __os_io_partial only reads from the start
+ * of a page, so address the file in blocks instead; a block number that
+ * doesn't fit a db_pgno_t rereads the page from its start.
+ */
+static int
+__memp_read_rest(dbmfp, pgno, from, to, buf, nrp)
+	DB_MPOOLFILE *dbmfp;
+	db_pgno_t pgno;
+	size_t from, to;
+	u_int8_t *buf;
+	size_t *nrp;
+{
+	size_t bpp, nr;
+	int ret;
+
+	bpp = dbmfp->mfp->stat.st_pagesize / MP_COMPRESS_BLKSZ;
+	if (pgno > (UINT32_MAX - bpp) / bpp)
+		return (__os_io_partial(dbmfp->dbenv, DB_IO_READ, dbmfp->fhp,
+		    pgno, dbmfp->mfp->stat.st_pagesize, to, buf, nrp));
+
+	if ((ret = __os_io_partial(dbmfp->dbenv, DB_IO_READ, dbmfp->fhp,
+	    pgno * bpp + from / MP_COMPRESS_BLKSZ, MP_COMPRESS_BLKSZ,
+	    to - from, buf + from, &nr)) != 0)
+		return (ret);
+	*nrp = from + nr;
+	return (0);
+}
+
+/*
+ * __memp_pgread_slot --
+ *	Read page pgno into buf, expanding it if it was written compressed.
+ *	Sets *nrp like __os_io; a bad compressed page returns
+ *	DB_SEARCH_PGCACHE.
+ *
+ * PUBLIC: int __memp_pgread_slot
+ * PUBLIC:     __P((DB_MPOOLFILE *, db_pgno_t, u_int8_t *, size_t *));
+ */
+int
+__memp_pgread_slot(dbmfp, pgno, buf, nrp)
+	DB_MPOOLFILE *dbmfp;
+	db_pgno_t pgno;
+	u_int8_t *buf;
+	size_t *nrp;
+{
+	DB_ENV *dbenv;
+	size_t len, pagesize;
+	int ret;
+
+	dbenv = dbmfp->dbenv;
+	pagesize = dbmfp->mfp->stat.st_pagesize;
+
+	if (!gbl_page_compress || !__memp_can_compress(dbmfp)) {
+		if ((ret = __os_io(dbenv, DB_IO_READ,
+		    dbmfp->fhp, pgno, pagesize, buf, nrp)) != 0)
+			return (ret);
+		if (*nrp < pagesize)
+			return (0);
+		return (__memp_pguncompress(dbmfp, pgno, buf));
+	}
+
+	/* The first block says how much more there is to read. */
+	if ((ret = __os_io_partial(dbenv, DB_IO_READ, dbmfp->fhp,
+	    pgno, pagesize, MP_COMPRESS_BLKSZ, buf, nrp)) != 0)
+		return (ret);
+	if (*nrp < MP_COMPRESS_BLKSZ)
+		return (0);
+
+	if (TYPE(buf) != P_COMPRESSED)
+		return (__memp_read_rest(dbmfp,
+		    pgno, MP_COMPRESS_BLKSZ, pagesize, buf, nrp));
+
+	len = ALIGN(MP_COMPRESS_HDRSZ + get_clen(buf), MP_COMPRESS_BLKSZ);
+	if (len > pagesize)
+		return (__memp_pguncompress(dbmfp, pgno, buf));
+	if (len > MP_COMPRESS_BLKSZ) {
+		if ((ret = __memp_read_rest(dbmfp,
+		    pgno, MP_COMPRESS_BLKSZ, len, buf, nrp)) != 0)
+			return (ret);
+		if (*nrp < len)
+			return (DB_SEARCH_PGCACHE);
+	}
+	if ((ret = __memp_pguncompress(dbmfp, pgno, buf)) != 0)
+		return (ret);
+	*nrp = pagesize;
+	return (0);
+}
+
+/*
+ * __memp_pgwrite_compressed --
+ *	Write out bhp, which has been through pgout, as a P_COMPRESSED slot
+ *	if page compression is on and it's worth it.  Sets *writtenp if it
+ *	did; otherwise the caller writes the page as usual.
+ *
+ * PUBLIC: int __memp_pgwrite_compressed
+ * PUBLIC:     __P((DB_ENV *, DB_MPOOLFILE *, BH *, int *));
+ */
+int
+__memp_pgwrite_compressed(dbenv, dbmfp, bhp, writtenp)
+	DB_ENV *dbenv;
+	DB_MPOOLFILE *dbmfp;
+	BH *bhp;
+	int *writtenp;
+{
+	PG_COMPRESSED *pc;
+	PAGE *pagep;
+	size_t len, nw, pagesize;
+	u_int32_t chksum;
+	u_int8_t *slot;
+	int clen, ret;
+
+	*writtenp = 0;
+
+	if (!gbl_page_compress || !__memp_can_compress(dbmfp))
+		return (0);
+
+	pagep = (PAGE *)bhp->buf;
+	switch (TYPE(pagep)) {
+	case P_LBTREE:
+	case P_LDUP:
+	case P_LRECNO:
+		break;
+	default:
+		return (0);
+	}
+
+	pagesize = dbmfp->mfp->stat.st_pagesize;
+	if ((slot = get_cbuf(pagesize)) == NULL)
+		return (0);
+
+	/* Only bother if it saves at least one block. */
+	clen = LZ4_compress_default((const char *)bhp->buf,
+	    (char *)slot + MP_COMPRESS_HDRSZ, (int)pagesize,
+	    (int)(pagesize - MP_COMPRESS_BLKSZ - MP_COMPRESS_HDRSZ));
+	if (clen <= 0)
+		return (0);
+	len = ALIGN(MP_COMPRESS_HDRSZ + clen, MP_COMPRESS_BLKSZ);
+
+	memcpy(slot, bhp->buf, SIZEOF_PAGE);
+	((PAGE *)slot)->type = P_COMPRESSED | CRC32C_MASK;
+	pc = (PG_COMPRESSED *)(slot + SIZEOF_PAGE);
+	memset(pc, 0, sizeof(PG_COMPRESSED));
+	pc->clen[0] = clen;
+	pc->clen[1] = clen >> 8;
+	pc->clen[2] = clen >> 16;
+	pc->clen[3] = clen >> 24;
+	memset(slot + MP_COMPRESS_HDRSZ + clen, 0,
+	    pagesize - MP_COMPRESS_HDRSZ - clen);
+	chksum = crc32c(slot, pagesize);
+	memcpy(pc->chksum, &chksum, sizeof(chksum));
+
+	/*
+	 * Without hole punching there is nothing to gain on writes, but the
+	 * slot still saves on reads.
+	 */
+	if (punch_unsupported)
+		len = pagesize;
+
+	if ((ret = __os_io_partial(dbenv, DB_IO_WRITE,
+	    dbmfp->fhp, bhp->pgno, pagesize, len, slot, &nw)) != 0)
+		return (ret);
+	if (nw != len)
+		return (EIO);
+
+	if (len < pagesize && (ret = __os_punchhole(dbenv,
+	    (off_t)bhp->pgno * pagesize + len, pagesize - len,
+	    dbmfp->fhp)) != 0) {
+		if (ret == EOPNOTSUPP && !punch_unsupported) {
+			punch_unsupported = 1;
+			logmsg(LOGMSG_WARN, "%s: %s: can't punch holes, "
+			    "compressed pages will take a whole page on disk\n",
+			    __func__, __memp_fn(dbmfp));
+		}
+		/* Stale bytes in the slot would fail its checksum. */
+		if ((ret = __os_io(dbenv, DB_IO_WRITE,
+		    dbmfp->fhp, bhp->pgno, pagesize, slot, &nw)) != 0)
+			return (ret);
+	}
+
+	++dbmfp->mfp->stat.st_page_out_compressed;
+	*writtenp = 1;
+	return (0);
+}
@@ -386,6 +386,7 @@ retry:	st_hsearch = 0;
 			++mfp->stat.st_cache_lhit;
 
 		++mfp->stat.st_cache_hit;
+		__memp_repl_hit(dbenv, c_mp, bhp);
 
         if (LF_ISSET(DB_MPOOL_PFGET))
             ++c_mp->stat.st_page_pf_in_late;
@@ -723,6 +724,8 @@ alloc:		/*
 				*did_io = 1;
 		}
 
+		__memp_repl_admit(dbmp, n_cache, c_mp, bhp, !extending);
+
 		/* Increment buffer count referenced by MPOOLFILE. */
 		MUTEX_LOCK(dbenv, &mfp->mutex);
 		++mfp->block_cnt;
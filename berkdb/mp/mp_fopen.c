@@ -1447,6 +1447,8 @@ __memp_mf_discard(dbmp, mfp)
 	sp->st_page_create += mfp->stat.st_page_create;
 	sp->st_page_in += mfp->stat.st_page_in;
 	sp->st_page_out += mfp->stat.st_page_out;
+	sp->st_page_in_compressed += mfp->stat.st_page_in_compressed;
+	sp->st_page_out_compressed += mfp->stat.st_page_out_compressed;
 	sp->st_ro_merges += mfp->stat.st_ro_merges;
 	sp->st_rw_merges += mfp->stat.st_rw_merges;
 
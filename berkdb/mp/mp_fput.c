@@ -250,6 +250,9 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 		    TYPE(pgaddr) == P_IBTREE)
 			adjust += c_mp->stat.st_pages / MPOOL_PRI_INTERNAL;
 
+		/* Let the replacement policy have its say. */
+		adjust += __memp_repl_adjust(dbenv, c_mp, bhp);
+
 		if (adjust > 0) {
 			if (UINT32_T_MAX - bhp->priority >= (u_int32_t)adjust)
 				bhp->priority += adjust;
@@ -379,10 +382,13 @@ __memp_reset_lru(dbenv, memreg)
 
 		MUTEX_LOCK(dbenv, &hp->hash_mutex);
 		for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
-		    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh))
+		    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh)) {
 			if (bhp->priority != UINT32_T_MAX &&
 			    bhp->priority > MPOOL_BASE_DECREMENT)
 				bhp->priority -= MPOOL_BASE_DECREMENT;
+			bhp->admit_lru = bhp->admit_lru > MPOOL_BASE_DECREMENT ?
+			    bhp->admit_lru - MPOOL_BASE_DECREMENT : 0;
+		}
 		MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
 	}
 }
@@ -181,6 +181,10 @@ __memp_open(dbenv)
 		dbmp->reginfo[i].primary =
 		    R_ADDR(&dbmp->reginfo[i], dbmp->reginfo[i].rp->primary);
 
+	if ((ret = __os_calloc(dbenv,
+	    dbmp->nreg, sizeof(MPOOL_GHOST *), &dbmp->ghosts)) != 0)
+		goto err;
+
 	/* If the region is threaded, allocate a mutex to lock the handles. */
 	if (F_ISSET(dbenv, DB_ENV_THREAD) &&
 	    (ret = __db_mutex_setup(dbenv, dbmp->reginfo, &dbmp->mutexp,
@@ -204,6 +208,8 @@ err:	if (dbmp->reginfo != NULL && dbmp->reginfo[0].addr != NULL) {
 	}
 	if (dbmp->mutexp != NULL)
 		__db_mutex_free(dbenv, dbmp->reginfo, dbmp->mutexp);
+	if (dbmp->ghosts != NULL)
+		__os_free(dbenv, dbmp->ghosts);
 	__os_free(dbenv, dbmp);
 	return (ret);
 }
@@ -327,6 +333,7 @@ __memp_dbenv_refresh(dbenv)
 		    dbenv, &dbmp->reginfo[i], 0)) != 0 && ret == 0)
 			ret = t_ret;
 
+	__memp_repl_free(dbenv, dbmp);
 	__os_free(dbenv, dbmp->reginfo);
 	__os_free(dbenv, dbmp);
 
@@ -0,0 +1,409 @@
+/*
+ * Buffer replacement policy hooks.
+ *
+ * The eviction loop in __memp_alloc_flags always frees the lowest priority
+ * buffer it can find, and buffers are given a priority when they are
+ * unpinned in __memp_fput.  A replacement policy is therefore expressed as
+ * a handful of hooks that decide which priority a buffer gets, plus the
+ * bookkeeping needed to make that decision.  See the MPOOL_REPL_* comment
+ * in dbinc/mp.h for a description of the policies.
+ */
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+#include "db_int.h"
+#include "dbinc/db_shash.h"
+#include "dbinc/mp.h"
+
+#include <sys/time.h>
+#include "logmsg.h"
+
+#define	MP_GHOST_MIN_SLOTS	1024
+
+#define	MP_GHOST_KEY(mf_offset, pgno)					\
+	(((u_int64_t)(mf_offset) << 32) | (u_int32_t)(pgno))
+
+static inline u_int32_t
+__memp_ghost_slot(g, key)
+	MPOOL_GHOST *g;
+	u_int64_t key;
+{
+	/* Fibonacci hashing; consecutive pages land far apart. */
+	return ((u_int32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & g->mask);
+}
+
+/*
+ * __memp_repl_init --
+ *	Make sure the cache has a ghost table if the 2Q policy is enabled.
+ *	Called with the cache region locked, when the cache is full.
+ *
+ * PUBLIC: void __memp_repl_init __P((DB_MPOOL *, REGINFO *));
+ */
+void
+__memp_repl_init(dbmp, memreg)
+	DB_MPOOL *dbmp;
+	REGINFO *memreg;
+{
+	DB_ENV *dbenv;
+	MPOOL *c_mp;
+	MPOOL_GHOST *g;
+	u_int32_t n_cache, nslots, want;
+
+	dbenv = dbmp->dbenv;
+	n_cache = (u_int32_t)(memreg - dbmp->reginfo);
+	if (dbenv->attr.mp_replacement_policy != MPOOL_REPL_2Q ||
+	    dbmp->ghosts == NULL || dbmp->ghosts[n_cache] != NULL)
+		return;
+
+	c_mp = memreg->primary;
+	want = (u_int32_t)((c_mp->stat.st_pages *
+	    (u_int64_t)dbenv->attr.mp_2q_ghost_pct) / 100);
+	for (nslots = MP_GHOST_MIN_SLOTS; nslots < want; nslots <<= 1)
+		;
+
+	if (__os_calloc(dbenv, 1, sizeof(MPOOL_GHOST) +
+	    (nslots - 1) * sizeof(MPOOL_GHOST_SLOT), &g) != 0)
+		return;
+	g->mask = nslots - 1;
+	dbmp->ghosts[n_cache] = g;
+}
+
+/*
+ * __memp_repl_free --
+ *	Discard the ghost tables.
+ *
+ * PUBLIC: void __memp_repl_free __P((DB_ENV *, DB_MPOOL *));
+ */
+void
+__memp_repl_free(dbenv, dbmp)
+	DB_ENV *dbenv;
+	DB_MPOOL *dbmp;
+{
+	u_int32_t i;
+
+	if (dbmp->ghosts == NULL)
+		return;
+	for (i = 0; i < dbmp->nreg; ++i)
+		if (dbmp->ghosts[i] != NULL)
+			__os_free(dbenv, dbmp->ghosts[i]);
+	__os_free(dbenv, dbmp->ghosts);
+	dbmp->ghosts = NULL;
+}
+
+/*
+ * __memp_repl_admit --
+ *	A buffer was just instantiated for a page.  Record when it came in, and
+ *	if the page was evicted recently while probationary, admit it as hot.
+ *	Called with the hash bucket locked.
+ *
+ * PUBLIC: void __memp_repl_admit __P((DB_MPOOL *,
+ * PUBLIC:     u_int32_t, MPOOL *, BH *, int));
+ */
+void
+__memp_repl_admit(dbmp, n_cache, c_mp, bhp, is_read)
+	DB_MPOOL *dbmp;
+	u_int32_t n_cache;
+	MPOOL *c_mp;
+	BH *bhp;
+	int is_read;
+{
+	MPOOL_GHOST *g;
+	MPOOL_GHOST_SLOT *slot;
+	u_int64_t key;
+
+	bhp->admit_lru = c_mp->lru_count;
+
+	if (!is_read ||
+	    dbmp->dbenv->attr.mp_replacement_policy != MPOOL_REPL_2Q ||
+	    dbmp->ghosts == NULL || (g = dbmp->ghosts[n_cache]) == NULL)
+		return;
+
+	key = MP_GHOST_KEY(bhp->mf_offset, bhp->pgno);
+	slot = &g->slots[__memp_ghost_slot(g, key)];
+	if (slot->occupied && slot->key == key) {
+		slot->occupied = 0;
+		F_SET(bhp, BH_HOT);
+		++c_mp->stat.st_ghost_hits;
+	}
+}
+
+/*
+ * __memp_repl_hit --
+ *	A resident buffer was referenced.  Promote it if this is not part of
+ *	the burst of references that brought it into the cache.  Called with
+ *	the hash bucket locked.
+ *
+ * PUBLIC: void __memp_repl_hit __P((DB_ENV *, MPOOL *, BH *));
+ */
+void
+__memp_repl_hit(dbenv, c_mp, bhp)
+	DB_ENV *dbenv;
+	MPOOL *c_mp;
+	BH *bhp;
+{
+	if (dbenv->attr.mp_replacement_policy != MPOOL_REPL_2Q ||
+	    F_ISSET(bhp, BH_HOT))
+		return;
+
+	if (c_mp->lru_count - bhp->admit_lru >=
+	    (u_int32_t)dbenv->attr.mp_2q_promote_window) {
+		F_SET(bhp, BH_HOT);
+		++c_mp->stat.st_hot_promotes;
+	}
+}
+
+/*
+ * __memp_repl_adjust --
+ *	Return the policy's priority adjustment for a buffer being unpinned.
+ *
+ * PUBLIC: int __memp_repl_adjust __P((DB_ENV *, MPOOL *, BH *));
+ */
+int
+__memp_repl_adjust(dbenv, c_mp, bhp)
+	DB_ENV *dbenv;
+	MPOOL *c_mp;
+	BH *bhp;
+{
+	if (dbenv->attr.mp_replacement_policy != MPOOL_REPL_2Q ||
+	    F_ISSET(bhp, BH_HOT))
+		return (0);
+
+	/*
+	 * Probationary buffers are released a full cache behind the LRU
+	 * counter, so a scan recycles its own buffers instead of the hot set.
+	 */
+	return (-(int)c_mp->stat.st_pages);
+}
+
+/*
+ * __memp_repl_evict --
+ *	A buffer is about to be evicted.  Remember probationary pages so that
+ *	a quick re-read can be recognized.  Called with the hash bucket locked.
+ *
+ * PUBLIC: void __memp_repl_evict __P((DB_MPOOL *, REGINFO *, BH *));
+ */
+void
+__memp_repl_evict(dbmp, memreg, bhp)
+	DB_MPOOL *dbmp;
+	REGINFO *memreg;
+	BH *bhp;
+{
+	MPOOL *c_mp;
+	MPOOL_GHOST *g;
+	MPOOL_GHOST_SLOT *slot;
+	u_int64_t key;
+	u_int32_t n_cache;
+
+	if (dbmp->dbenv->attr.mp_replacement_policy != MPOOL_REPL_2Q ||
+	    F_ISSET(bhp, BH_HOT))
+		return;
+
+	c_mp = memreg->primary;
+	++c_mp->stat.st_cold_evicts;
+
+	n_cache = (u_int32_t)(memreg - dbmp->reginfo);
+	if (dbmp->ghosts == NULL || (g = dbmp->ghosts[n_cache]) == NULL)
+		return;
+	key = MP_GHOST_KEY(bhp->mf_offset, bhp->pgno);
+	slot = &g->slots[__memp_ghost_slot(g, key)];
+	slot->key = key;
+	slot->occupied = 1;
+}
+
+/*
+ * The replacement policy benchmark replays the same mixed workload against
+ * each policy, in a private environment so that the server's own cache is
+ * left alone.  A "hot" file, half the size of the cache, is read with random
+ * point lookups, while a "scan" file, several times the size of the cache,
+ * is read sequentially over and over.  A scan-resistant policy keeps the hot
+ * file resident.
+ */
+struct mp_bench_result {
+	u_int64_t hot_hit, hot_miss;
+	u_int64_t scan_hit, scan_miss;
+	u_int64_t ghost_hits, hot_promotes, cold_evicts;
+	u_int64_t usecs;
+};
+
+#define	MP_BENCH_PGSIZE	4096
+
+static int
+__memp_bench_touch(mpf, pgno, flags)
+	DB_MPOOLFILE *mpf;
+	db_pgno_t pgno;
+	u_int32_t flags;
+{
+	void *p;
+	int ret;
+
+	if ((ret = mpf->get(mpf, &pgno, flags, &p)) != 0)
+		return (ret);
+	return (mpf->put(mpf, p, flags == DB_MPOOL_CREATE ? DB_MPOOL_DIRTY : 0));
+}
+
+static int
+__memp_bench_run(dir, policy, cachemb, scanpct, nops, res)
+	const char *dir;
+	int policy, cachemb, scanpct, nops;
+	struct mp_bench_result *res;
+{
+	DB_ENV *env;
+	DB_MPOOLFILE *hot, *scan;
+	DB_MPOOL_STAT *gsp;
+	DB_MPOOL_FSTAT **fsp, **i;
+	struct timeval start, end;
+	db_pgno_t hot_pages, scan_pages, pg, scan_pos;
+	unsigned int seed;
+	char hotname[64], scanname[64], path[PATH_MAX];
+	int op, ret, t_ret;
+
+	memset(res, 0, sizeof(*res));
+	env = NULL;
+	hot = scan = NULL;
+	snprintf(hotname, sizeof(hotname), "_mpbench_hot.%d", (int)getpid());
+	snprintf(scanname, sizeof(scanname), "_mpbench_scan.%d", (int)getpid());
+
+	scan_pages = (db_pgno_t)(((u_int64_t)cachemb << 20) / MP_BENCH_PGSIZE);
+	hot_pages = scan_pages / 2;
+	scan_pages *= 4;
+
+	if ((ret = db_env_create(&env, 0)) != 0)
+		return (ret);
+	env->attr.mp_replacement_policy = policy;
+	if ((ret = env->set_cachesize(env, 0, cachemb << 20, 1)) != 0 ||
+	    (ret = env->open(env, dir,
+	    DB_CREATE | DB_PRIVATE | DB_INIT_MPOOL, 0666)) != 0)
+		goto err;
+
+	if ((ret = env->memp_fcreate(env, &hot, 0)) != 0 ||
+	    (ret = hot->open(hot, hotname, DB_CREATE, 0666,
+	    MP_BENCH_PGSIZE)) != 0 ||
+	    (ret = env->memp_fcreate(env, &scan, 0)) != 0 ||
+	    (ret = scan->open(scan, scanname, DB_CREATE, 0666,
+	    MP_BENCH_PGSIZE)) != 0)
+		goto err;
+
+	/* Lay both files out on disk, then warm the hot set. */
+	for (pg = 0; pg < scan_pages; ++pg)
+		if ((ret = __memp_bench_touch(scan, pg, DB_MPOOL_CREATE)) != 0)
+			goto err;
+	for (pg = 0; pg < hot_pages; ++pg)
+		if ((ret = __memp_bench_touch(hot, pg, DB_MPOOL_CREATE)) != 0)
+			goto err;
+	if ((ret = env->memp_sync(env, NULL)) != 0)
+		goto err;
+	for (pg = 0; pg < hot_pages; ++pg)
+		if ((ret = __memp_bench_touch(hot, pg, 0)) != 0)
+			goto err;
+
+	if ((ret = env->memp_stat(env, &gsp, NULL, DB_STAT_CLEAR)) != 0)
+		goto err;
+	free(gsp);
+
+	seed = 1;
+	scan_pos = 0;
+	gettimeofday(&start, NULL);
+	for (op = 0; op < nops; ++op) {
+		if ((int)(rand_r(&seed) % 100) < scanpct) {
+			ret = __memp_bench_touch(scan, scan_pos, 0);
+			if (++scan_pos == scan_pages)
+				scan_pos = 0;
+		} else
+			ret = __memp_bench_touch(hot,
+			    (db_pgno_t)(rand_r(&seed) % hot_pages), 0);
+		if (ret != 0)
+			goto err;
+	}
+	gettimeofday(&end, NULL);
+	res->usecs = (end.tv_sec - start.tv_sec) * 1000000ULL +
+	    end.tv_usec - start.tv_usec;
+
+	if ((ret = env->memp_stat(env, &gsp, &fsp, 0)) != 0)
+		goto err;
+	res->ghost_hits = gsp->st_ghost_hits;
+	res->hot_promotes = gsp->st_hot_promotes;
+	res->cold_evicts = gsp->st_cold_evicts;
+	for (i = fsp; i != NULL && *i != NULL; ++i) {
+		if (strstr((*i)->file_name, hotname) != NULL) {
+			res->hot_hit = (*i)->st_cache_hit;
+			res->hot_miss = (*i)->st_cache_miss;
+		} else if (strstr((*i)->file_name, scanname) != NULL) {
+			res->scan_hit = (*i)->st_cache_hit;
+			res->scan_miss = (*i)->st_cache_miss;
+		}
+	}
+	free(fsp);
+	free(gsp);
+
+err:	if (hot != NULL && (t_ret = hot->close(hot, 0)) != 0 && ret == 0)
+		ret = t_ret;
+	if (scan != NULL && (t_ret = scan->close(scan, 0)) != 0 && ret == 0)
+		ret = t_ret;
+	if ((t_ret = env->close(env, 0)) != 0 && ret == 0)
+		ret = t_ret;
+	snprintf(path, sizeof(path), "%s/%s", dir, hotname);
+	unlink(path);
+	snprintf(path, sizeof(path), "%s/%s", dir, scanname);
+	unlink(path);
+	return (ret);
+}
+
+static double
+__memp_bench_pct(hit, miss)
+	u_int64_t hit, miss;
+{
+	return (hit + miss == 0 ? 0.0 : (100.0 * hit) / (hit + miss));
+}
+
+/*
+ * __memp_repl_bench --
+ *	Run the replacement policy benchmark against every policy.
+ *
+ * PUBLIC: int __memp_repl_bench __P((FILE *, const char *, int, int, int));
+ */
+int
+__memp_repl_bench(out, dir, cachemb, scanpct, nops)
+	FILE *out;
+	const char *dir;
+	int cachemb, scanpct, nops;
+{
+	static const char *names[] = { "lru", "2q" };
+	struct mp_bench_result res;
+	int policy, ret;
+
+	if (cachemb <= 0)
+		cachemb = 16;
+	if (scanpct < 0 || scanpct > 100)
+		scanpct = 50;
+	if (nops <= 0)
+		nops = 1000000;
+
+	logmsgf(LOGMSG_USER, out, "mpool bench: %dMB cache, %d%% scan pages, "
+	    "%d ops\n", cachemb, scanpct, nops);
+	logmsgf(LOGMSG_USER, out, "%-6s %10s %10s %10s %10s %10s %10s\n",
+	    "policy", "msec", "hot-hit%", "scan-hit%", "ghost-hits",
+	    "promotes", "cold-evict");
+	for (policy = MPOOL_REPL_LRU; policy <= MPOOL_REPL_2Q; ++policy) {
+		if ((ret = __memp_bench_run(dir,
+		    policy, cachemb, scanpct, nops, &res)) != 0) {
+			logmsgf(LOGMSG_ERROR, out, "%s: policy %s failed %d\n",
+			    __func__, names[policy], ret);
+			return (ret);
+		}
+		logmsgf(LOGMSG_USER, out,
+		    "%-6s %10"PRIu64" %10.2f %10.2f %10"PRIu64" %10"PRIu64
+		    " %10"PRIu64"\n", names[policy], res.usecs / 1000,
+		    __memp_bench_pct(res.hot_hit, res.hot_miss),
+		    __memp_bench_pct(res.scan_hit, res.scan_miss),
+		    res.ghost_hits, res.hot_promotes, res.cold_evicts);
+	}
+	return (0);
+}
@@ -127,6 +127,7 @@ __memp_stat(dbenv, gspp, fspp, flags)
 			sp->st_page_out += c_mp->stat.st_page_out;
 			sp->st_ro_merges += c_mp->stat.st_ro_merges;
 			sp->st_rw_merges += c_mp->stat.st_rw_merges;
+			sp->st_ghost_hits += c_mp->stat.st_ghost_hits;
 			if (LF_ISSET(DB_STAT_MINIMAL))
 				continue;
 			sp->st_ro_evict += c_mp->stat.st_ro_evict;
@@ -170,6 +171,8 @@ __memp_stat(dbenv, gspp, fspp, flags)
 				    c_mp->stat.st_alloc_max_pages;
 			sp->st_ckp_pages_sync += c_mp->stat.st_ckp_pages_sync;
 			sp->st_ckp_pages_skip += c_mp->stat.st_ckp_pages_skip;
+			sp->st_hot_promotes += c_mp->stat.st_hot_promotes;
+			sp->st_cold_evicts += c_mp->stat.st_cold_evicts;
 
 			if (LF_ISSET(DB_STAT_CLEAR)) {
 				dbmp->reginfo[i].rp->mutex.mutex_set_wait = 0;
@@ -205,6 +208,10 @@ __memp_stat(dbenv, gspp, fspp, flags)
 			sp->st_page_create += mfp->stat.st_page_create;
 			sp->st_page_in += mfp->stat.st_page_in;
 			sp->st_page_out += mfp->stat.st_page_out;
+			sp->st_page_in_compressed +=
+			    mfp->stat.st_page_in_compressed;
+			sp->st_page_out_compressed +=
+			    mfp->stat.st_page_out_compressed;
 			sp->st_ro_merges += mfp->stat.st_ro_merges;
 			sp->st_rw_merges += mfp->stat.st_rw_merges;
 			if (fspp == NULL && LF_ISSET(DB_STAT_CLEAR)) {
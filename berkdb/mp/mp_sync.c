@@ -548,6 +548,7 @@ struct writable_range {
 	size_t len;
 
 	struct trickler *t;
+	int *inflight;		/* ranges of this file queued, protected by t->lk */
 };
 
 static struct thdpool *trickle_thdpool;
@@ -1017,6 +1018,8 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 	range->t->written_pages += wrote;
 	range->t->done_pages += ar_cnt;
 	range->t->ret = ret;
+	if (range->inflight)
+		--*range->inflight;
 	pthread_cond_signal(&range->t->wait);
 	pthread_mutex_unlock(&range->t->lk);
 
@@ -1066,6 +1069,85 @@ berk_memp_sync_alarm_ms(int x)
 }
 
 
+/*
+ * __memp_sync_enqueue --
+ *	Hand a range of buffers to the trickle threads, waiting while the
+ *	file already has memp_sync_file_inflight ranges outstanding.  Returns
+ *	non-zero if a writer has failed and no more ranges should be queued.
+ */
+static int
+__memp_sync_enqueue(dbenv, pt, bharray, bhparray, hparray, len, inflight)
+	DB_ENV *dbenv;
+	struct trickler *pt;
+	BH_TRACK *bharray;
+	BH **bhparray;
+	DB_MPOOL_HASH **hparray;
+	int len;
+	int *inflight;
+{
+	struct writable_range *range;
+	int t_ret;
+
+	pthread_mutex_lock(&pt->lk);
+	while (pt->ret == 0 && inflight != NULL &&
+	    dbenv->attr.memp_sync_file_inflight > 0 &&
+	    *inflight >= dbenv->attr.memp_sync_file_inflight)
+		pthread_cond_wait(&pt->wait, &pt->lk);
+	if (pt->ret != 0) {
+		pthread_mutex_unlock(&pt->lk);
+		return (1);
+	}
+	pthread_mutex_unlock(&pt->lk);
+
+	pthread_mutex_lock(&pgpool_lk);
+	range = pool_getablk(pgpool);
+	pthread_mutex_unlock(&pgpool_lk);
+
+	range->bharray = bharray;
+	range->bhparray = bhparray;
+	range->hparray = hparray;
+	range->len = (size_t)len;
+	range->t = pt;
+	range->inflight = inflight;
+
+	/* 
+	 * lame, should block instead, thdpool
+	 *  can't do that yet 
+	 */
+	t_ret = 1;
+	pthread_mutex_lock(&pt->lk);
+	while (pt->ret == 0 && t_ret != 0) {
+		if (inflight)
+			++*inflight;
+		pthread_mutex_unlock(&pt->lk);
+
+		t_ret = thdpool_enqueue(trickle_thdpool,
+		    trickle_do_work, range, 0, NULL);
+		if (t_ret) {
+			pt->nwaits++;
+			poll(NULL, 0, 10);
+		}
+
+		pthread_mutex_lock(&pt->lk);
+		if (t_ret && inflight)
+			--*inflight;
+	}
+
+	/*
+	 * pt->lk is still locked
+	 */
+	if (t_ret == 0) {
+		pt->total_pages += len;
+	} else {
+		pthread_mutex_lock(&pgpool_lk);
+		pool_relablk(pgpool, range);
+		pthread_mutex_unlock(&pgpool_lk);
+	}
+	pthread_mutex_unlock(&pt->lk);
+
+	return (t_ret);
+}
+
 /*
  * __memp_sync_int --
  *	Mpool sync internal function.
@@ -1108,6 +1190,7 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 	DB_LSN oldest_first_dirty_tx_begin_lsn;
 	int accum_sync, accum_skip;
 	BH_TRACK swap;
+	int chunk, nfiles, *inflight;
 
 	/*
 	 *  Perfect checkpoints: If the first dirty LSN is to the right
@@ -1374,94 +1457,51 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 	pthread_cond_init(&pt->wait, NULL);
 
 	/*
-	 * Flush each file by passing it to a thread. This serializes writes
-	 * to a file, which may help throughput and performance.
+	 * Flush each file by passing it to a thread, a few ranges at a time
+	 * for big files.  This mostly serializes writes to a file, which may
+	 * help throughput and performance.
 	 */
 	if (do_parallel &&
 	    (op == DB_SYNC_TRICKLE || op == DB_SYNC_LRU ||
 		op == DB_SYNC_CACHE)) {
 
-		for (i = 1, j = 0; i < ar_cnt; ++i) {
-			if (bharray[j].track_off != bharray[i].track_off) {
-				pthread_mutex_lock(&pgpool_lk);
-				range = pool_getablk(pgpool);
-				pthread_mutex_unlock(&pgpool_lk);
-
-				range->bharray = &bharray[j];
-				range->bhparray = &bhparray[j];
-				range->hparray = &hparray[j];
-				range->len = (size_t) i - j;
-				range->t = pt;
-
-				/* 
-				 * lame, should block instead, thdpool
-				 *  can't do that yet 
-				 */
-				t_ret = 1;
-				pthread_mutex_lock(&pt->lk);
-				while(pt->ret == 0 &&
-				      t_ret != 0) {
-					pthread_mutex_unlock(&pt->lk);
-					
-					t_ret = thdpool_enqueue(trickle_thdpool,
-					    trickle_do_work, range, 0, NULL);
-					if (t_ret) {
-						pt->nwaits++;
-						poll(NULL, 0, 10);
-					}
-					pthread_mutex_lock(&pt->lk);
-				}
-
-				/*
-				 * pt->lk is still locked
-				 */
-				if (t_ret == 0) {
-					pt->total_pages += i - j;
-				}
-				pthread_mutex_unlock(&pt->lk);
-					
-
-				j = i;
-			}
-		}
-
-		if (pt->ret == 0) {
-			pthread_mutex_lock(&pgpool_lk);
-			range = pool_getablk(pgpool);
-			pthread_mutex_unlock(&pgpool_lk);
-
-			range->bharray = &bharray[j];
-			range->bhparray = &bhparray[j];
-			range->hparray = &hparray[j];
-			range->len = (size_t) i - j;
-			range->t = pt;
+		/*
+		 * Large files are cut into several ranges so that they can
+		 * be written by more than one thread.  A range is cut once it
+		 * has memp_sync_chunk_pages pages and the next page is not
+		 * adjacent, so a run that may be written as one I/O is kept
+		 * whole; a range is always cut at 4 times that size, so a
+		 * file whose dirty pages are all adjacent is still spread
+		 * over the pool.
+		 * No more than memp_sync_file_inflight ranges of a file are
+		 * queued or being written at any time.
+		 */
+		chunk = dbenv->attr.memp_sync_chunk_pages;
+		for (i = 1, nfiles = 1; i < ar_cnt; ++i)
+			if (bharray[i - 1].track_off != bharray[i].track_off)
+				++nfiles;
+		/* Without the counters we simply don't bound the ranges. */
+		if (__os_calloc(dbenv, nfiles, sizeof(int), &inflight) != 0)
+			inflight = NULL;
+
+		for (i = 1, j = 0, nfiles = 0; i <= ar_cnt; ++i) {
+			if (i < ar_cnt &&
+			    bharray[j].track_off == bharray[i].track_off &&
+			    (chunk <= 0 || i - j < chunk ||
+			    (i - j < 4 * chunk &&
+			    bharray[i - 1].track_pgno + 1 ==
+			    bharray[i].track_pgno)))
+				continue;
 
-			/* 
-			 * lame, should block instead, thdpool
-			 *  can't do that yet 
-			 */
-			t_ret = 1;
-			pthread_mutex_lock(&pt->lk);
-			while(pt->ret == 0 && t_ret != 0) {
-				pthread_mutex_unlock(&pt->lk);
-
-				t_ret = thdpool_enqueue(trickle_thdpool,
-				    trickle_do_work, range, 0, NULL);
-				if (t_ret) {
-					pt->nwaits++;
-					poll(NULL, 0, 10);
-				}
-			
-				pthread_mutex_lock(&pt->lk);
-			}
+			if (__memp_sync_enqueue(dbenv, pt, &bharray[j],
+			    &bhparray[j], &hparray[j], i - j,
+			    inflight ? &inflight[nfiles] : NULL) != 0)
+				break;
 
-			/*
-			 * pt->lk is still locked
-			 */
-			if (t_ret == 0) {
-				pt->total_pages += i - j;
-			}
-			pthread_mutex_unlock(&pt->lk);
+			if (i < ar_cnt &&
+			    bharray[j].track_off != bharray[i].track_off)
+				++nfiles;
+			j = i;
 		}
 
 		/* wait for writers to finish */
@@ -1472,6 +1512,9 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 		wrote = pt->written_pages;
 		ret = pt->ret;
 		pthread_mutex_unlock(&pt->lk);
+
+		if (inflight != NULL)
+			__os_free(dbenv, inflight);
 	} else {
 		pthread_mutex_lock(&pgpool_lk);
 		range = pool_getablk(pgpool);
@@ -1482,6 +1525,7 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 		range->hparray = hparray;
 		range->len = ar_cnt;
 		range->t = pt;
+		range->inflight = NULL;
 		
 		trickle_do_work(NULL, range, NULL, 0);
 
@@ -14,7 +14,9 @@ static const char revid[] = "$Id: os_falloc.c,v 11.32 2014/09/32 12:27:03 bostic
 
 #ifndef NO_SYSTEM_INCLUDES
 #include <sys/types.h>
+#include <sys/stat.h>
 
+#include <errno.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -60,3 +62,42 @@ __os_fallocate(dbenv, offset, len, fhp)
 
 	return (ret);
 }
+
+/*
+ * __os_punchhole --
+ *	    Free the blocks of len bytes at offset, which then read back as
+ *      zeroes.  The file is first extended to offset + len if it is
+ *      shorter.  Returns 0 on success, __os_get_errno() on fail, and
+ *      EOPNOTSUPP where holes can't be punched.
+ *
+ * PUBLIC: int __os_punchhole __P((DB_ENV *, off_t, off_t, DB_FH *));
+ */
+int
+__os_punchhole(dbenv, offset, len, fhp)
+	DB_ENV *dbenv;
+	off_t offset, len;
+	DB_FH *fhp;
+{
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+	struct stat sb;
+
+	COMPQUIET(dbenv, NULL);
+
+	/* Mode 0 only ever grows the file, so racing writers are safe. */
+	if (fstat(fhp->fd, &sb) == -1)
+		return (__os_get_errno());
+	if (sb.st_size < offset + len &&
+	    syscall(SYS_fallocate, fhp->fd, 0, offset + len - 1, 1) == -1)
+		return (__os_get_errno());
+	if (syscall(SYS_fallocate, fhp->fd,
+	    FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, len) == -1)
+		return (__os_get_errno());
+	return (0);
+#else
+	COMPQUIET(dbenv, NULL);
+	COMPQUIET(offset, 0);
+	COMPQUIET(len, 0);
+	COMPQUIET(fhp, NULL);
+	return (EOPNOTSUPP);
+#endif
+}
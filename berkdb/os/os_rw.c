@@ -1049,6 +1049,65 @@ __berkdb_direct_pwritev(DB_ENV *dbenv,
 	    && ++nretries < dbenv->attr.num_write_retries);
 	return rc;
 }
+
+#ifdef _LINUX_SOURCE
+#include <sys/uio.h>
+
+#define BERKDB_PWRITEV_IOVS 64
+
+/*
+ * Write adjacent pages of a buffered file straight out of the cache with
+ * pwritev instead of one pwrite per page.  Returns the bytes written, or
+ * -1 if the first pwritev failed.
+ */
+static ssize_t
+__berkdb_pwritev(DB_ENV *dbenv,
+    int fd, size_t pagesize, u_int8_t **bufs, size_t nobufs, off_t offset)
+{
+	struct iovec iov[BERKDB_PWRITEV_IOVS];
+	ssize_t rc, done;
+	size_t i, n;
+	int nretries;
+
+	for (done = 0; nobufs > 0; nobufs -= n, bufs += n) {
+		n = nobufs;
+		if (n > BERKDB_PWRITEV_IOVS)
+			n = BERKDB_PWRITEV_IOVS;
+		for (i = 0; i < n; i++) {
+			iov[i].iov_base = bufs[i];
+			iov[i].iov_len = pagesize;
+		}
+
+		nretries = 0;
+		do {
+			rc = pwritev(fd, iov, n, offset + done);
+			if (dbenv->attr.debug_enospc_chance) {
+				int p = rand() % 100;
+
+				if (p < dbenv->attr.debug_enospc_chance) {
+					rc = -1;
+					errno = ENOSPC;
+				}
+			}
+			if (nretries > 0) {
+				logmsg(LOGMSG_ERROR,
+				    "pwritev fd %d sz %d off %ld retry %d\n",
+				    fd, (int)(n * pagesize), offset + done,
+				    nretries);
+				poll(NULL, 0, 10);
+			}
+		} while (rc == -1 && errno == ENOSPC
+		    && ++nretries < dbenv->attr.num_write_retries);
+
+		if (rc == -1)
+			return (done ? done : -1);
+		done += rc;
+		if (rc != (ssize_t)(n * pagesize))
+			break;
+	}
+	return (done);
+}
+#endif
 #endif
 
 /*
@@ -1069,7 +1128,9 @@ __os_iov(dbenv, op, fhp, pgno, pagesize, bufs, nobufs, niop)
 {
 	int ret, i;
 	db_pgno_t c_pgno;
-	size_t single_niop, max_niop, max_bufs;
+	u_int8_t **c_bufs;
+	ssize_t done;
+	size_t single_niop, max_niop, max_bufs, n, left;
 	struct timespec s, rem;
 	int rc;
 
@@ -1093,10 +1154,21 @@ __os_iov(dbenv, op, fhp, pgno, pagesize, bufs, nobufs, niop)
 		}
 	}
 
-	if (!F_ISSET(fhp, DB_FH_DIRECT))
-		goto slow;
 	if (nobufs == 1)
 		goto slow;
+	if (!F_ISSET(fhp, DB_FH_DIRECT)) {
+		/* Buffered files only get vectored writes. */
+#ifdef _LINUX_SOURCE
+		if (op != DB_IO_WRITE || DB_GLOBAL(j_write) != NULL)
+			goto slow;
+#ifdef HAVE_FILESYSTEM_NOTZERO
+		if (__os_fs_notzero())
+			goto slow;
+#endif
+#else
+		goto slow;
+#endif
+	}
 
 	if (op == DB_IO_WRITE && dbenv->attr.check_zero_lsn_writes
 	    && (dbenv->open_flags & DB_INIT_TXN)) {
@@ -1142,22 +1214,31 @@ __os_iov(dbenv, op, fhp, pgno, pagesize, bufs, nobufs, niop)
 		if (__berkdb_read_alarm_ms)
 			x1 = bb_berkdb_fasttime();
 
+		/*
+		 * Stop at the first short read; the per-page path below
+		 * starts over from the original bufs and pgno.
+		 */
 		c_pgno = pgno;
+		c_bufs = bufs;
+		left = nobufs;
 		do {
-			single_niop = __berkdb_direct_preadv(fhp->fd,
+			n = left < max_bufs ? left : max_bufs;
+			done = __berkdb_direct_preadv(fhp->fd,
 			    pagesize,
-			    bufs, max_bufs, (off_t)(c_pgno * pagesize));
-			*niop += single_niop;
-			c_pgno += max_bufs;
-			bufs += max_bufs;
-
-			if (nobufs < (*niop / pagesize) + max_bufs)
-				max_bufs = nobufs % max_bufs;
+			    c_bufs, n, (off_t)c_pgno * pagesize);
 
 			if (__berkdb_num_read_ios)
 				(*__berkdb_num_read_ios)++;
 
-		} while (single_niop > 0 && *niop < nobufs * pagesize);
+			if (done <= 0)
+				break;
+			*niop += done;
+			if (done != (ssize_t)(n * pagesize))
+				break;
+			c_pgno += n;
+			c_bufs += n;
+			left -= n;
+		} while (left > 0);
 
 		if (__berkdb_read_alarm_ms) {
 			x2 = bb_berkdb_fasttime();
@@ -1196,24 +1277,37 @@ __os_iov(dbenv, op, fhp, pgno, pagesize, bufs, nobufs, niop)
 		if (__berkdb_write_alarm_ms)
 			x1 = bb_berkdb_fasttime();
 
+		/* As for reads: a short or failed write goes page by page. */
 		c_pgno = pgno;
+		c_bufs = bufs;
+		left = nobufs;
 		do {
-			single_niop = __berkdb_direct_pwritev(dbenv,
+			n = left < max_bufs ? left : max_bufs;
+#ifdef _LINUX_SOURCE
+			if (!F_ISSET(fhp, DB_FH_DIRECT))
+				done = __berkdb_pwritev(dbenv,
+				    fhp->fd,
+				    pagesize,
+				    c_bufs, n, (off_t)c_pgno * pagesize);
+			else
+#endif
+			done = __berkdb_direct_pwritev(dbenv,
 			    fhp->fd,
 			    pagesize,
-			    bufs, max_bufs, (off_t)(c_pgno * pagesize));
-			*niop += single_niop;
-			c_pgno += max_bufs;
-			bufs += max_bufs;
-
-			if (nobufs < (*niop / pagesize) + max_bufs)
-				max_bufs = nobufs % max_bufs;
+			    c_bufs, n, (off_t)c_pgno * pagesize);
 
 			if (__berkdb_num_write_ios)
 				(*__berkdb_num_write_ios)++;
 
-
-		} while (single_niop != 0 && *niop < nobufs * pagesize);
+			if (done <= 0)
+				break;
+			*niop += done;
+			if (done != (ssize_t)(n * pagesize))
+				break;
+			c_pgno += n;
+			c_bufs += n;
+			left -= n;
+		} while (left > 0);
 
 
 		if (__berkdb_write_alarm_ms) {
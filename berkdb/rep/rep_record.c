@@ -3963,6 +3963,236 @@ logical_record_file_affinity(int rectype)
 	}
 }
 
+/*
+ * Offsets into a log record, after type + txnid + prev_lsn.  See the
+ * autogenerated read routines for btree.src and db.src.
+ */
+#define	REC_HDR_SZ	(sizeof(u_int32_t) + sizeof(u_int32_t) + sizeof(DB_LSN))
+#define	REC_PGNO(dbt, off, pgno)	\
+	LOGCOPY_32(&(pgno), (u_int8_t *)(dbt)->data + REC_HDR_SZ + (off))
+
+/*
+ * Fill in the pages a record redoes and return how many there are.  Returns
+ * 0 for records that don't touch a page, and -1 for records whose pages we
+ * don't track: their file is then applied by a single worker, as before.
+ */
+static int
+__rep_record_pages(rectype, dbt, pgnos)
+	u_int32_t rectype;
+	DBT *dbt;
+	db_pgno_t *pgnos;
+{
+	int n;
+
+	switch (rectype) {
+	case DB___db_addrem:
+		/* opcode, fileid, pgno */
+		REC_PGNO(dbt, 8, pgnos[0]);
+		return (1);
+	case DB___bam_adj:
+	case DB___bam_cadjust:
+	case DB___bam_cdel:
+	case DB___bam_repl:
+	case DB___bam_prefix:
+	case DB___db_ovref:
+		/* fileid, pgno */
+		REC_PGNO(dbt, 4, pgnos[0]);
+		return (1);
+	case DB___bam_split:
+		/* fileid, left, llsn, right, rlsn, indx, npgno, nlsn, root */
+		REC_PGNO(dbt, 4, pgnos[0]);
+		REC_PGNO(dbt, 16, pgnos[1]);
+		n = 2;
+		REC_PGNO(dbt, 32, pgnos[n]);
+		if (pgnos[n] != PGNO_INVALID)
+			n++;
+		REC_PGNO(dbt, 44, pgnos[n]);
+		if (pgnos[n] != PGNO_INVALID)
+			n++;
+		return (n);
+	case DB___db_pg_alloc:
+		/* fileid, meta_lsn, meta_pgno, page_lsn, pgno */
+		REC_PGNO(dbt, 12, pgnos[0]);
+		REC_PGNO(dbt, 24, pgnos[1]);
+		return (2);
+	case DB___db_pg_free:
+	case DB___db_pg_freedata:
+		/* fileid, pgno, meta_lsn, meta_pgno */
+		REC_PGNO(dbt, 4, pgnos[0]);
+		REC_PGNO(dbt, 16, pgnos[1]);
+		return (2);
+	case DB___bam_curadj:
+	case DB___bam_rcuradj:
+		return (0);
+	default:
+		return (-1);
+	}
+}
+
+struct rep_page_map {
+	db_pgno_t *pgnos;
+	int *nodes;
+	int *parent;
+	u_int32_t mask;
+	int nnodes;
+};
+
+static int
+__rep_page_node(map, pgno)
+	struct rep_page_map *map;
+	db_pgno_t pgno;
+{
+	u_int32_t h;
+
+	for (h = (pgno * 0x9E3779B1U) & map->mask; map->nodes[h] >= 0;
+		h = (h + 1) & map->mask) {
+		if (map->pgnos[h] == pgno)
+			return map->nodes[h];
+	}
+	map->pgnos[h] = pgno;
+	map->nodes[h] = map->nnodes;
+	map->parent[map->nnodes] = map->nnodes;
+	return map->nnodes++;
+}
+
+static int
+__rep_page_root(map, node)
+	struct rep_page_map *map;
+	int node;
+{
+	while (map->parent[node] != node) {
+		map->parent[node] = map->parent[map->parent[node]];
+		node = map->parent[node];
+	}
+	return node;
+}
+
+/*
+ * Split a file's queue into up to nparts queues that share no pages, so that
+ * workers can redo them concurrently.  Records that touch a common page
+ * (directly, or through a split or page allocation linking their pages) stay
+ * on one queue, in lsn order, so every page still sees its records in page
+ * lsn order.  Records with no page follow the record before them.  Extra
+ * queues are appended to queues; returns 1 if the queue was split.
+ */
+static int
+__rep_partition_queue(rp, rq, nparts, npq, queues)
+	struct __recovery_processor *rp;
+	struct __recovery_queue *rq;
+	int nparts;
+	int *npq;
+	void *queues;
+{
+	LISTC_T(struct __recovery_record) tmp;
+	LISTC_T(struct __recovery_queue) *out = queues;
+	struct __recovery_queue **parts;
+	struct __recovery_record *rr;
+	struct rep_page_map map;
+	int *part, i, next, npages, b, root, split;
+	u_int32_t sz;
+
+	npages = 0;
+	LISTC_FOR_EACH(&rq->records, rr, lnk) {
+		if (rr->npgnos < 0)
+			return 0;
+		npages += rr->npgnos;
+	}
+	if (npages < 2)
+		return 0;
+
+	/* Make sure there are enough spare queues. */
+	if (*npq + nparts - 1 > rp->num_page_queues) {
+		int n = *npq + nparts - 1;
+
+		parts = realloc(rp->page_queues, n * sizeof(*parts));
+		if (parts == NULL)
+			return 0;
+		rp->page_queues = parts;
+		for (i = rp->num_page_queues; i < n; i++) {
+			if ((parts[i] = malloc(sizeof(**parts))) == NULL)
+				return 0;
+			parts[i]->processor = rp;
+			parts[i]->used = 0;
+			listc_init(&parts[i]->records,
+				offsetof(struct __recovery_record, lnk));
+			rp->num_page_queues = i + 1;
+		}
+	}
+
+	for (sz = 1; sz < 2 * npages; sz <<= 1)
+		;
+	map.mask = sz - 1;
+	map.nnodes = 0;
+	map.pgnos = malloc(sz * sizeof(db_pgno_t));
+	map.nodes = malloc(sz * sizeof(int));
+	map.parent = malloc(npages * sizeof(int));
+	part = malloc(npages * sizeof(int));
+	parts = malloc(nparts * sizeof(*parts));
+	if (map.pgnos == NULL || map.nodes == NULL || map.parent == NULL ||
+		part == NULL || parts == NULL) {
+		split = 0;
+		goto done;
+	}
+	memset(map.nodes, 0xff, sz * sizeof(int));
+	memset(part, 0xff, npages * sizeof(int));
+
+	/* Join the pages each record touches. */
+	LISTC_FOR_EACH(&rq->records, rr, lnk) {
+		if (rr->npgnos == 0)
+			continue;
+		root = __rep_page_root(&map, __rep_page_node(&map,
+			rr->pgnos[0]));
+		for (i = 1; i < rr->npgnos; i++) {
+			int r = __rep_page_root(&map,
+				__rep_page_node(&map, rr->pgnos[i]));
+			if (r != root)
+				map.parent[r] = root;
+		}
+	}
+
+	parts[0] = rq;
+	for (i = 1; i < nparts; i++)
+		parts[i] = rp->page_queues[*npq + i - 1];
+
+	/* Deal out each set of pages, round robin. */
+	listc_init(&tmp, offsetof(struct __recovery_record, lnk));
+	while ((rr = listc_rtl(&rq->records)) != NULL)
+		listc_abl(&tmp, rr);
+	b = next = 0;
+	while ((rr = listc_rtl(&tmp)) != NULL) {
+		if (rr->npgnos > 0) {
+			root = __rep_page_root(&map, __rep_page_node(&map,
+				rr->pgnos[0]));
+			if (part[root] < 0)
+				part[root] = next++ % nparts;
+			b = part[root];
+		}
+		listc_abl(&parts[b]->records, rr);
+	}
+
+	/* Keep the queues we used at the front of page_queues. */
+	split = 0;
+	for (i = 1, b = *npq; i < nparts; i++) {
+		if (parts[i]->records.count == 0)
+			continue;
+		rp->page_queues[*npq + i - 1] = rp->page_queues[b];
+		rp->page_queues[b++] = parts[i];
+		parts[i]->fileid = rq->fileid;
+		listc_abl(out, parts[i]);
+		rp->num_busy_workers++;
+		split = 1;
+	}
+	*npq = b;
+
+done:
+	free(map.pgnos);
+	free(map.nodes);
+	free(map.parent);
+	free(part);
+	free(parts);
+	return split;
+}
+
 #include <stdlib.h>
 
 int gbl_processor_thd_poll;
@@ -3983,7 +4213,7 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	DB_ENV *dbenv;
 	int ret, t_ret, last_fileid = -1;
 	DB_LSN *lsnp;
-	int j;
+	int j, partition;
 	LISTC_T(struct __recovery_queue) queues;
 
 	DB_REP *db_rep;
@@ -4072,9 +4302,14 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	/* First, bucket records per queue. */
 	data_dbt.flags = DB_DBT_REALLOC;
 
+	partition = dbenv->attr.rep_page_partition &&
+	    !(dbenv->flags & DB_ENV_ROWLOCKS) &&
+	    dbenv->num_recovery_worker_threads > 1;
+
 	for (i = 0; i < rp->lc.nlsns; i++) {
 		int fileid;
 		u_int32_t rectype;
+		DBT *recdbt;
 
 		lsnp = &rp->lc.array[i].lsn;
 
@@ -4088,16 +4323,12 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 					(u_long)lsnp->file, (u_long)lsnp->offset);
 				goto err;
 			}
-			LOGCOPY_32(&rectype, data_dbt.data);
-			fileid =
-				(int)file_id_for_recovery_record(dbenv, NULL,
-				rectype, &data_dbt);
-		} else {
-			LOGCOPY_32(&rectype, rp->lc.array[i].rec.data);
-			fileid =
-				(int)file_id_for_recovery_record(dbenv, NULL,
-				rectype, &rp->lc.array[i].rec);
-		}
+			recdbt = &data_dbt;
+		} else
+			recdbt = &rp->lc.array[i].rec;
+		LOGCOPY_32(&rectype, recdbt->data);
+		fileid = (int)file_id_for_recovery_record(dbenv, NULL,
+			rectype, recdbt);
 
 		if (fileid >= 0) {
 			last_fileid = fileid;
@@ -4143,6 +4374,8 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 			rr->logdbt.data = NULL;
 		rr->lsn = *lsnp;
 		rr->fileid = fileid;
+		rr->npgnos = partition && fileid != 0 ?
+			__rep_record_pages(rectype, recdbt, rr->pgnos) : -1;
 
 		listc_abl(&rp->recovery_queues[fileid]->records, rr);
 	}
@@ -4151,6 +4384,26 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 		gbl_rep_rowlocks_multifile++;
 	}
 
+	/* Split big per-file queues into independent sets of pages. */
+	if (partition) {
+		int nqueues, npq = 0, split = 0;
+
+		nqueues = listc_size(&queues);
+		for (i = 0; i < nqueues; i++) {
+			rq = listc_rtl(&queues);
+			if (rq->fileid != 0 && rq->records.count >=
+				dbenv->attr.rep_page_partition_min)
+				split |= __rep_partition_queue(rp, rq,
+					dbenv->num_recovery_worker_threads,
+					&npq, &queues);
+			listc_abl(&queues, rq);
+		}
+		if (split) {
+			rep->stat.st_txns_partitioned++;
+			rep->stat.st_page_queues += npq;
+		}
+	}
+
 	/* Handle inline. */
 	if (listc_size(&queues) <= 1) {
 		inline_worker = 1;
@@ -4296,7 +4549,16 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	/* cleanup - similar to __rep_process_txn */
 err:
 	if (ret == 0) {
+		u_int32_t apply_ms;
+
 		rep->stat.st_txns_applied++;
+		apply_ms = comdb2_time_epochms() - rp->dispatch_ms;
+		rep->stat.st_apply_ms = apply_ms;
+		if (apply_ms > rep->stat.st_apply_ms_max)
+			rep->stat.st_apply_ms_max = apply_ms;
+		if (rp->commit_timestamp)
+			rep->stat.st_apply_lag =
+				comdb2_time_epoch() - rp->commit_timestamp;
 		if (dbenv->attr.check_applied_lsns) {
 			__rep_check_applied_lsns(dbenv, &rp->lc, 0);
 		}
@@ -4838,6 +5100,9 @@ err1:
 		 * We don't hold the rep mutex, and could miscount if we race.
 		 */
 		rep->stat.st_txns_applied++;
+		if (timestamp)
+			rep->stat.st_apply_lag =
+				comdb2_time_epoch() - timestamp;
 	}
 
 	if (dbenv->attr.log_applied_lsns)
@@ -5029,7 +5294,7 @@ __rep_process_txn_concurrent_int(dbenv, rctl, rec, ltrans, ctrllsn, maxlsn,
 	DB_LSN prev_commit_lsn;
 {
 	DBT data_dbt, *lock_dbt, *rowlock_dbt, lsn_lock_dbt;
-	int32_t timestamp;
+	int32_t timestamp = 0;
 	DB_LOCKREQ req, *lvp;
 	DB_LOGC *logc;
 	DB_LSN prev_lsn, *lsnp;
@@ -5504,6 +5769,8 @@ bad_resize:	;
 		data_dbt.data = NULL;
 	}
 	rp->commit_lsn = ctrllsn;
+	rp->commit_timestamp = timestamp;
+	rp->dispatch_ms = comdb2_time_epochms();
 	rp->has_logical_commit = 0;
 	rp->has_schema_lock = 0;
 	if (rp->ltrans) {
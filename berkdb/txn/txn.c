@@ -396,6 +396,7 @@ __txn_xa_begin(dbenv, txn)
 	txn->txnid = TXN_INVALID;
 	txn->tid = 0;
 	txn->cursors = 0;
+	txn->ntriggers = 0;
 	memset(&txn->lock_timeout, 0, sizeof(db_timeout_t));
 	memset(&txn->expire, 0, sizeof(db_timeout_t));
 
@@ -1850,6 +1851,10 @@ __txn_end(txnp, is_commit)
 	if (txnp->parent != NULL)
 		TAILQ_REMOVE(&txnp->parent->kids, txnp, klinks);
 
+	/* Locks are gone: wake consumers of queues this txn inserted into. */
+	if (txnp->ntriggers != 0)
+		__txn_trigger_wakeup(txnp, is_commit);
+
 	/* Free the space. */
 	while ((lr = STAILQ_FIRST(&txnp->logs)) != NULL) {
 		STAILQ_REMOVE(&txnp->logs, lr, __txn_logrec, links);
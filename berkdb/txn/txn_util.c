@@ -23,6 +23,7 @@ static const char revid[] = "$Id: txn_util.c,v 11.25 2003/12/03 14:33:07 bostic
 #include "dbinc/mp.h"
 #include "dbinc/txn.h"
 #include "dbinc/db_am.h"
+#include "dbinc/trigger_subscription.h"
 
 typedef struct __txn_event TXN_EVENT;
 struct __txn_event {
@@ -324,3 +325,62 @@ dofree:
 
 	return (ret);
 }
+
+/*
+ * __txn_trigger_event --
+ *	Note that txn inserted into a queue a Lua trigger/consumer is
+ * subscribed to.  The consumer is woken when the top-level txn commits,
+ * after its page locks are released, so that it finds the new item on
+ * the first try instead of blocking on it or missing the wakeup.
+ *
+ * PUBLIC: void __txn_trigger_event __P((DB_TXN *,
+ * PUBLIC:     struct __db_trigger_subscription *));
+ */
+void
+__txn_trigger_event(txn, t)
+	DB_TXN *txn;
+	struct __db_trigger_subscription *t;
+{
+	u_int32_t i;
+
+	if (txn != NULL) {
+		while (txn->parent != NULL)
+			txn = txn->parent;
+		for (i = 0; i < txn->ntriggers; i++)
+			if (txn->triggers[i] == t)
+				return;
+		if (txn->ntriggers < TXN_MAX_TRIGGERS) {
+			txn->triggers[txn->ntriggers++] = t;
+			return;
+		}
+	}
+
+	/* Non-transactional, or too many queues: wake it up right away. */
+	pthread_cond_signal(&t->cond);
+}
+
+/*
+ * __txn_trigger_wakeup --
+ *	Signal the consumers noted by __txn_trigger_event.  The signal is
+ * sent under the subscription lock, which the consumer holds from its
+ * queue read until it waits, so a commit is never lost in between.
+ *
+ * PUBLIC: void __txn_trigger_wakeup __P((DB_TXN *, int));
+ */
+void
+__txn_trigger_wakeup(txn, is_commit)
+	DB_TXN *txn;
+	int is_commit;
+{
+	struct __db_trigger_subscription *t;
+	u_int32_t i;
+
+	for (i = 0; is_commit && i < txn->ntriggers; i++) {
+		t = txn->triggers[i];
+		pthread_mutex_lock(&t->lock);
+		if (t->active)
+			pthread_cond_signal(&t->cond);
+		pthread_mutex_unlock(&t->lock);
+	}
+	txn->ntriggers = 0;
+}
@@ -0,0 +1,10 @@
+include(${CMAKE_MODULE_PATH}/pkg_helper.cmake)
+find_pkg_for_comdb2(ZSTD
+  "zstd.h"
+  "zstd"
+  "${ZSTD_ROOT_DIR}"
+  ""
+  ZSTD_INCLUDE_DIR
+  ZSTD_LIBRARY
+)
+mark_as_advanced(ZSTD_INCLUDE_DIR ZSTD_LIBRARY)
@@ -22,6 +22,11 @@
 #include <arpa/nameser_compat.h>
 #include "comdb2rle.h"
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRLE_SIMD
+#include <immintrin.h>
+#endif
+
 #ifndef BYTE_ORDER
 #   error "BYTE_ORDER not defined"
 #endif
@@ -234,65 +239,223 @@ static uint32_t space_reqd(uint32_t r, uint32_t s)
            (s > 1 ? (varint_need(s) + s) : s);
 }
 
-/* Check if 'sz' bytes repeat */
-static uint32_t repeats(Data in, uint32_t sz, uint32_t *r_)
+/*
+ * The scans and the run expansion below come in scalar, SSE2 and AVX2
+ * flavours.  The best one the cpu has is picked on first use; they all
+ * give the same answers, so the encoding doesn't depend on the machine.
+ */
+
+/* Number of leading bytes that are the same in a and b (which may overlap) */
+static size_t mismatch_scalar(const uint8_t *a, const uint8_t *b, size_t n)
 {
-    uint32_t r;
-    r = *r_ = 0;
-    if (in.sz < (sz * 2))
-        return 0;
-    uint8_t *bp, *bx, bt;
-    uint16_t *wp, word;
-    switch (sz) {
-    case 1:
-        bt = *in.dt;        // 1st byte
-        bp = in.dt + sz;    // byte ptr
-        bx = in.dt + in.sz; // byte ptr max
-#ifndef _SUN_SOURCE
-        if (in.sz > 16) {
-            size_t qz = in.sz - in.sz % 8; // # of quads
-            uint64_t qw;
-            memset(&qw, bt, sizeof(qw));             // 1st quad
-            uint64_t *qp = (uint64_t *)in.dt;        // quad ptr
-            uint64_t *qx = (uint64_t *)(in.dt + qz); // quad ptr max
-            while (qp < qx && *qp == qw)
-                ++qp;
-            if ((uint8_t *)qp != in.dt) {
-                if (qp < qx) // last quad != 1st
-                    --qp;
-                bp = (uint8_t *)qp;
-            }
-        }
-#endif
-        // check remainder byte at a time
-        while (bp < bx && *bp == bt)
-            ++bp;
-        r = bp - in.dt - 1;
-        break;
-#ifndef _SUN_SOURCE
-    case 2:
-        word = *(uint16_t *)in.dt;
-        wp = (uint16_t *)(in.dt + sz);
-        in.sz -= (in.sz % sz);
-        while ((in.sz -= sz) != 0 && word == *wp) {
-            ++wp;
-            ++r;
+    size_t i = 0;
+    while (i < n && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+/* Number of bytes just before end which are all c, looking at most n back */
+static size_t run_rev_scalar(const uint8_t *end, size_t n, uint8_t c)
+{
+    size_t i = 0;
+    while (i < n && *(end - 1 - i) == c)
+        ++i;
+    return i;
+}
+
+/* Write total bytes of pattern p of size s, repeated */
+static void expand_scalar(uint8_t *out, const uint8_t *p, uint32_t s,
+                          size_t total)
+{
+    for (uint8_t *end = out + total; out < end; out += s) {
+        switch (s) {
+        case 9:
+            out[8] = p[8];
+            out[7] = p[7];
+            out[6] = p[6];
+            out[5] = p[5];
+        case 5:
+            out[4] = p[4];
+            out[3] = p[3];
+        case 3:
+            out[2] = p[2];
+        case 2:
+            out[1] = p[1];
+        case 1:
+            out[0] = p[0];
+            break;
+        default:
+            memcpy(out, p, s);
+            break;
         }
-        break;
+    }
+}
+
+#ifdef CRLE_SIMD
+static size_t mismatch_sse2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xffff;
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+    return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+static size_t run_rev_sse2(const uint8_t *end, size_t n, uint8_t c)
+{
+    __m128i v = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(end - i - 16));
+        unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(x, v)) ^ 0xffff;
+        if (m) // highest bit is the byte closest to end
+            return i + __builtin_clz(m) - 16;
+    }
+    return i + run_rev_scalar(end - i, n - i, c);
+}
+
+/* Store a block of whole patterns at a time; short runs and wide patterns
+ * aren't worth setting up the block for */
+static void expand_sse2(uint8_t *out, const uint8_t *p, uint32_t s,
+                        size_t total)
+{
+    uint8_t blk[16];
+    size_t step;
+    if (s > sizeof(blk) || total < 64) {
+        expand_scalar(out, p, s, total);
+        return;
+    }
+    for (uint32_t i = 0; i < sizeof(blk); ++i)
+        blk[i] = p[i % s];
+    step = sizeof(blk) - sizeof(blk) % s;
+    __m128i v = _mm_loadu_si128((const __m128i *)blk);
+    while (total >= sizeof(blk)) {
+        _mm_storeu_si128((__m128i *)out, v);
+        out += step;
+        total -= step;
+    }
+    memcpy(out, blk, total);
+}
+
+__attribute__((target("avx2")))
+static size_t mismatch_avx2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        unsigned m = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+    _mm256_zeroupper(); // the sse2 tail isn't vex encoded
+    return i + mismatch_sse2(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t run_rev_avx2(const uint8_t *end, size_t n, uint8_t c)
+{
+    __m256i v = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(end - i - 32));
+        unsigned m = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, v));
+        if (m)
+            return i + __builtin_clz(m);
+    }
+    _mm256_zeroupper();
+    return i + run_rev_sse2(end - i, n - i, c);
+}
+
+__attribute__((target("avx2")))
+static void expand_avx2(uint8_t *out, const uint8_t *p, uint32_t s,
+                        size_t total)
+{
+    uint8_t blk[32];
+    size_t step;
+    if (s > sizeof(blk) || total < 128) {
+        expand_sse2(out, p, s, total);
+        return;
+    }
+    for (uint32_t i = 0; i < sizeof(blk); ++i)
+        blk[i] = p[i % s];
+    step = sizeof(blk) - sizeof(blk) % s;
+    __m256i v = _mm256_loadu_si256((const __m256i *)blk);
+    while (total >= sizeof(blk)) {
+        _mm256_storeu_si256((__m256i *)out, v);
+        out += step;
+        total -= step;
+    }
+    _mm256_zeroupper();
+    memcpy(out, blk, total);
+}
 #endif
-    default:
-        bp = in.dt + sz;
-        in.sz -= (in.sz % sz);
-        while ((in.sz -= sz) != 0) {
-            if (memcmp(in.dt, bp, sz))
-                break;
-            bp += sz;
-            ++r;
-        }
-        break;
+
+static size_t mismatch_init(const uint8_t *, const uint8_t *, size_t);
+static size_t run_rev_init(const uint8_t *, size_t, uint8_t);
+static void expand_init(uint8_t *, const uint8_t *, uint32_t, size_t);
+
+static size_t (*mismatch)(const uint8_t *, const uint8_t *,
+                          size_t) = mismatch_init;
+static size_t (*run_rev)(const uint8_t *, size_t, uint8_t) = run_rev_init;
+static void (*expand)(uint8_t *, const uint8_t *, uint32_t,
+                      size_t) = expand_init;
+
+/* Racing threads all pick the same thing */
+static void crle_select(void)
+{
+#ifdef CRLE_SIMD
+    if (__builtin_cpu_supports("avx2")) {
+        expand = expand_avx2;
+        run_rev = run_rev_avx2;
+        mismatch = mismatch_avx2;
+    } else {
+        expand = expand_sse2;
+        run_rev = run_rev_sse2;
+        mismatch = mismatch_sse2;
     }
-    *r_ = r;
-    return r;
+#else
+    expand = expand_scalar;
+    run_rev = run_rev_scalar;
+    mismatch = mismatch_scalar;
+#endif
+}
+
+static size_t mismatch_init(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    crle_select();
+    return mismatch(a, b, n);
+}
+
+static size_t run_rev_init(const uint8_t *end, size_t n, uint8_t c)
+{
+    crle_select();
+    return run_rev(end, n, c);
+}
+
+static void expand_init(uint8_t *out, const uint8_t *p, uint32_t s,
+                        size_t total)
+{
+    crle_select();
+    expand(out, p, s, total);
+}
+
+/* Check if 'sz' bytes repeat: every byte past the first pattern is the
+ * same as the one 'sz' bytes before it, for as many whole patterns as fit */
+static uint32_t repeats(Data in, uint32_t sz, uint32_t *r_)
+{
+    *r_ = 0;
+    if (in.sz < (sz * 2))
+        return 0;
+    if (in.dt[sz] != in.dt[0]) // most of the time; skip the call
+        return 0;
+    in.sz -= (in.sz % sz);
+    *r_ = mismatch(in.dt + sz, in.dt, in.sz - sz) / sz;
+    return *r_;
 }
 
 /* Look for known pattern of size s at d */
@@ -531,36 +694,12 @@ int decompressComdb2RLE(Comdb2RLE *d)
         uint32_t reqd, s, r;
         if ((reqd = decode(&input, &p, &s, &r)) > output.sz)
             return 1;
-        if (s == 1) {
-            ++r;
-            memset(output.dt, *p, r);
-            output.dt += r;
-            output.sz -= r;
-        } else
-            for (uint32_t i = 0; i <= r; ++i) {
-                switch (s) {
-                case 9:
-                    output.dt[8] = p[8];
-                    output.dt[7] = p[7];
-                    output.dt[6] = p[6];
-                    output.dt[5] = p[5];
-                case 5:
-                    output.dt[4] = p[4];
-                    output.dt[3] = p[3];
-                case 3:
-                    output.dt[2] = p[2];
-                case 2:
-                    output.dt[1] = p[1];
-                case 1:
-                    output.dt[0] = p[0];
-                    break;
-                default:
-                    memcpy(output.dt, p, s);
-                    break;
-                }
-                output.dt += s;
-                output.sz -= s;
-            }
+        if (s == 1)
+            memset(output.dt, *p, reqd);
+        else
+            expand(output.dt, p, s, reqd);
+        output.dt += reqd;
+        output.sz -= reqd;
     }
     d->outsz = output.dt - d->out;
     return 0;
@@ -571,13 +710,10 @@ int decompressComdb2RLE(Comdb2RLE *d)
  * r: output param */
 static int repeats_rev(const Data *input, uint32_t sz, uint32_t *r)
 {
-    uint8_t *first = input->dt - 1; //sentinal -- one before first
-    uint8_t *last = first + sz;
-    uint8_t b = *last--;
+    uint8_t *last = input->dt + sz - 1;
     uint32_t dups = 0;
-    while (last != first && b == *last--) {
-        ++dups;
-    }
+    if (sz > 1 && last[-1] == *last)
+        dups = run_rev(last, sz - 1, *last);
     *r = dups;
     return dups;
 }
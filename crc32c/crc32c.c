@@ -134,6 +134,7 @@ uint32_t crc32c(const uint8_t* buf, uint32_t sz)
 
 /* Helper routines */
 static inline uint32_t crc32c_1024_sse_int(const uint8_t *buf, uint32_t crc);
+static inline uint32_t crc32c_3way_pcl(const uint8_t *buf, uint32_t blk, uint32_t crc, v2di K);
 static inline uint32_t crc32c_until_aligned(const uint8_t **buf, uint32_t *sz, uint32_t crc);
 static inline uint32_t crc32c_8s(const uint8_t *buf, uint32_t sz, uint32_t crc);
 
@@ -206,7 +207,9 @@ static uint32_t crc32c_sse(const uint8_t *buf, uint32_t sz, uint32_t crc)
 
 /*
  * Compute chksum processing 3072 bytes at a time and using
- * PCLMUL for recombination. Use SSE for processing input < 3K.
+ * PCLMUL for recombination. Input < 3K goes through the 1K SSE path,
+ * then is folded with PCLMUL in smaller blocks, and the last < 192 bytes
+ * use a single stream.
  */
 static uint32_t crc32c_sse_pcl(const uint8_t *buf, uint32_t sz, uint32_t crc)
 {
@@ -242,10 +245,70 @@ static uint32_t crc32c_sse_pcl(const uint8_t *buf, uint32_t sz, uint32_t crc)
 		buf += _3K;
 		sz -= _3K;
 	}
-	if (sz) out = crc32c_sse(buf, sz, out);
+	while (sz >= _1K) {
+		out = crc32c_1024_sse_int(buf, out);
+		buf += _1K;
+		sz -= _1K;
+	}
+	/*
+	 * Fold constants for 256 and 64 byte streams:
+	 * K[0] = x^(16 * blk - 32) mod P, K[1] = x^(8 * blk - 32) mod P,
+	 * bit-reflected and shifted left by one like the ones above.
+	 */
+	if (sz >= 768) {
+		const v2di K256 = {0x0dd7e3b0c, 0x0b9e02b86};
+		do {
+			out = crc32c_3way_pcl(buf, 256, out, K256);
+			buf += 768;
+			sz -= 768;
+		} while (sz >= 768);
+	}
+	if (sz >= 192) {
+		const v2di K64 = {0x00d3b6092, 0x09e4addf8};
+		do {
+			out = crc32c_3way_pcl(buf, 64, out, K64);
+			buf += 192;
+			sz -= 192;
+		} while (sz >= 192);
+	}
+	if (sz) out = crc32c_8s(buf, sz, out);
 	return out;
 }
 
+/*
+ * Compute chksum for 3 * blk bytes as three interleaved streams and combine
+ * them with PCLMUL. K[0] shifts the first stream's crc over the other two
+ * blocks, K[1] shifts the second over the third.
+ */
+static inline
+uint32_t crc32c_3way_pcl(const uint8_t *buf, uint32_t blk, uint32_t crc, v2di K)
+{
+	const uint64_t *b1 = (const uint64_t *) &buf[0];
+	const uint64_t *b2 = (const uint64_t *) &buf[blk];
+	const uint64_t *b3 = (const uint64_t *) &buf[blk * 2];
+	const uint32_t last = blk / 8 - 1;
+	uint64_t c1 = crc, c2 = 0, c3 = 0, out;
+	v2di x1 = {0, 0}, x2 = {0, 0};
+	uint32_t i;
+
+	for (i = 0; i < last; ++i) {
+		c1 = _mm_crc32_u64(c1, b1[i]);
+		c2 = _mm_crc32_u64(c2, b2[i]);
+		c3 = _mm_crc32_u64(c3, b3[i]);
+	}
+
+	x1[0] = _mm_crc32_u64(c1, b1[last]);
+	x2[0] = _mm_crc32_u64(c2, b2[last]);
+
+	x1 = _mm_clmulepi64_si128(x1, K, 0x00);
+	x2 = _mm_clmulepi64_si128(x2, K, 0x10);
+	x1 = _mm_xor_si128(x1, x2);
+
+	out = x1[0];
+	out ^= b3[last];
+	return _mm_crc32_u64(c3, out);
+}
+
 /* Compute chksum 1 byte at a time until input is sizeof(intptr) aligned */
 static inline
 uint32_t crc32c_until_aligned(const uint8_t **buf_, uint32_t *sz_, uint32_t crc)
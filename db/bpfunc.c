@@ -24,6 +24,7 @@ static int exec_alias(void *tran, bpfunc_t *func, char *err);
 static int exec_analyze_threshold(void *tran, bpfunc_t *func, char *err);
 static int exec_analyze_coverage(void *tran, bpfunc_t *func, char *err);
 static int exec_rowlocks_enable(void *tran, bpfunc_t *func, char *err);
+static int success_rowlocks_enable(void *tran, bpfunc_t *func, char *err);
 static int exec_genid48_enable(void *tran, bpfunc_t *func, char *err);
 static int exec_set_skipscan(void *tran, bpfunc_t *func, char *err);
 /********************      UTILITIES     ***********************/
@@ -95,6 +96,7 @@ static int prepare_methods(bpfunc_t *func, bpfunc_info *info)
 
     case BPFUNC_ROWLOCKS_ENABLE:
         func->exec = exec_rowlocks_enable;
+        func->success = success_rowlocks_enable;
         break;
 
     case BPFUNC_GENID48_ENABLE:
@@ -502,6 +504,20 @@ static int exec_rowlocks_enable(void *tran, bpfunc_t *func, char *err)
         return -1;
     }
 
+    /* rowlocks writes are not tallied, so drop the maintained row counts
+     * rather than leave them to go stale */
+    if (rl->enable) {
+        int i, bdberr;
+        for (i = 0; i < thedb->num_dbs; i++) {
+            rc = bdb_del_rowcount(thedb->dbs[i]->tablename, tran, &bdberr);
+            if (rc) {
+                logmsg(LOGMSG_ERROR, "%s -- table %s rc %d bdberr %d\n",
+                       __func__, thedb->dbs[i]->tablename, rc, bdberr);
+                return rc;
+            }
+        }
+    }
+
     rc = set_rowlocks(tran, rl->enable);
     if (!rc) {
         struct ireq *iq = (struct ireq *)func->info->iq;
@@ -511,3 +527,14 @@ static int exec_rowlocks_enable(void *tran, bpfunc_t *func, char *err)
     return rc;
 }
 
+static int success_rowlocks_enable(void *tran, bpfunc_t *func, char *err)
+{
+    int i;
+
+    if (!func->arg->rl_enable->enable)
+        return 0;
+    for (i = 0; i < thedb->num_dbs; i++)
+        bdb_rowcount_load(thedb->dbs[i]->handle, NULL);
+    return 0;
+}
+
@@ -1689,6 +1689,8 @@ size_t gbl_lk_parts = 73;
 size_t gbl_lkr_parts = 23;
 size_t gbl_lk_hash = 32;
 size_t gbl_lkr_hash = 16;
+int gbl_lk_part_stats = 0;
+int gbl_lk_part_spin = 0;
 
 char **qdbs = NULL;
 char **sfuncs = NULL;
@@ -4075,7 +4077,7 @@ void *statthd(void *p)
         conn_timeouts = net_get_num_accept_timeouts(thedb->handle_sibling);
 
         bdb_get_bpool_counters(thedb->bdb_env, (int64_t *)&bpool_hits,
-                               (int64_t *)&bpool_misses);
+                               (int64_t *)&bpool_misses, NULL);
 
         bdb_get_lock_counters(thedb->bdb_env, &ndeadlocks, &nlockwaits, NULL);
         diff_deadlocks = ndeadlocks - last_ndeadlocks;
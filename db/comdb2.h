@@ -63,6 +63,7 @@ typedef long long tranid_t;
 #include <epochlib.h>
 #include <fsnapf.h>
 #include <plhash.h>
+#include <arena.h>
 
 #include <list.h>
 #include <queue.h>
@@ -549,6 +550,7 @@ struct summary_nodestats {
     unsigned sql_queries;
     unsigned sql_steps;
     unsigned sql_rows;
+    long long sql_mem_peak;
 };
 
 /* records in sql master db look like this (no appended rrn info) */
@@ -1319,6 +1321,9 @@ struct ireq {
     uint8_t **idxInsert;
     uint8_t **idxDelete;
 
+    /* per-request scratch: index keys, updcols; released with the request */
+    arena_t *arena;
+
     /* osql prefault step index */
     int *osql_step_ix;
 
@@ -1863,6 +1868,13 @@ void reqerrstrhdr(struct ireq *iq, char *format,
 void reqerrstrclr(struct ireq *iq);
 void reqerrstrhdrclr(struct ireq *iq); /* clear error header */
 
+/* per-request scratch memory, freed in one go by ireq_arena_release() */
+void *ireq_arena_alloc(struct ireq *iq, size_t sz);
+void *ireq_arena_calloc(struct ireq *iq, size_t n, size_t sz);
+void ireq_arena_rewind(struct ireq *iq);
+void ireq_arena_release(struct ireq *iq);
+void free_cached_delayed_indexes(struct ireq *iq);
+
 /* internal request forwarding */
 int ireq_forward_to_master(struct ireq *iq, int len);
 
@@ -2276,6 +2288,7 @@ int bt_hash_table(char *table, int szkb);
 int del_bt_hash_table(char *table);
 int stat_bt_hash_table(char *table);
 int stat_bt_hash_table_reset(char *table);
+int rowcount_table(char *table, int enable);
 int fastinit_table(struct dbenv *dbenvin, char *table);
 int add_cmacc_stmt(struct dbtable *db, int alt);
 int add_cmacc_stmt_no_side_effects(struct dbtable *db, int alt);
@@ -2428,6 +2441,9 @@ int dbq_consume_genid(struct ireq *, void *trans, int consumer, const genid_t);
 int dbq_get(struct ireq *iq, int consumer, const struct dbq_cursor *prevcursor,
             void **fnddta, size_t *fnddtalen, size_t *fnddtaoff,
             struct dbq_cursor *fndcursor, unsigned int *epoch);
+int dbq_get_batch(struct ireq *iq, int consumer,
+                  const struct dbq_cursor *prevcursor, int max, void **fnddta,
+                  size_t *fnddtalen, int *nfnd);
 void dbq_get_item_info(const void *fnd, size_t *dtaoff, size_t *dtalen);
 unsigned long long dbq_item_genid(const void *dta);
 typedef int (*dbq_walk_callback_t)(int consumern, size_t item_length,
@@ -2825,6 +2841,7 @@ void nodestats_node_report(FILE *fh, const char *prefix, int disp_rates,
 struct rawnodestats *get_raw_node_stats(const char *task, const char *stack,
                                         char *host, int fd);
 int release_node_stats(const char *task, const char *stack, char *host);
+void nodestats_note_sql_mem(struct rawnodestats *rawnodestats, long long peak);
 struct summary_nodestats *get_nodestats_summary(unsigned *nodes_cnt,
                                                 int disp_rates);
 
@@ -3342,6 +3359,7 @@ extern int __slow_write_ns;
 #include "dbglog.h"
 
 void handle_testcompr(SBUF2 *sb, const char *table);
+int zstd_train_table(const char *table);
 void handle_setcompr(SBUF2 *);
 void handle_rowlocks_enable(SBUF2 *);
 void handle_rowlocks_enable_master_only(SBUF2 *);
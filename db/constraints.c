@@ -121,7 +121,6 @@ out:
     return rc;
 }
 
-void free_cached_idx(uint8_t **cached_idx);
 static int cache_delayed_indexes(struct ireq *iq, unsigned long long genid)
 {
     struct thread_info *thdinfo = NULL;
@@ -133,13 +132,8 @@ static int cache_delayed_indexes(struct ireq *iq, unsigned long long genid)
     int *pixnum;
     int i;
 
-    if (iq->idxInsert || iq->idxDelete) {
-        free_cached_idx(iq->idxInsert);
-        free_cached_idx(iq->idxDelete);
-        free(iq->idxInsert);
-        free(iq->idxDelete);
-        iq->idxInsert = iq->idxDelete = NULL;
-    }
+    /* the previous record's keys are done with */
+    ireq_arena_rewind(iq);
 
     thdinfo = pthread_getspecific(unique_tag_key);
     if (thdinfo == NULL) {
@@ -163,8 +157,8 @@ static int cache_delayed_indexes(struct ireq *iq, unsigned long long genid)
         close_constraint_table_cursor(cur);
         return 0;
     } else {
-        iq->idxInsert = calloc(MAXINDEX, sizeof(uint8_t *));
-        iq->idxDelete = calloc(MAXINDEX, sizeof(uint8_t *));
+        iq->idxInsert = ireq_arena_calloc(iq, MAXINDEX, sizeof(uint8_t *));
+        iq->idxDelete = ireq_arena_calloc(iq, MAXINDEX, sizeof(uint8_t *));
         if (!iq->idxInsert || !iq->idxDelete) {
             logmsg(LOGMSG_ERROR, "%s failed to allocated indexes\n", __func__);
             close_constraint_table_cursor(cur);
@@ -174,7 +168,8 @@ static int cache_delayed_indexes(struct ireq *iq, unsigned long long genid)
 
     while (1) {
         pixnum = (int *)((char *)foundkey + sizeof(unsigned long long));
-        iq->idxInsert[*pixnum] = malloc(getkeysize(iq->usedb, *pixnum));
+        iq->idxInsert[*pixnum] =
+            ireq_arena_alloc(iq, getkeysize(iq->usedb, *pixnum));
         if (iq->idxInsert[*pixnum] == NULL) {
             logmsg(LOGMSG_ERROR, "%s failed to allocated indexes\n", __func__);
             close_constraint_table_cursor(cur);
@@ -193,17 +188,6 @@ static int cache_delayed_indexes(struct ireq *iq, unsigned long long genid)
     return 0;
 }
 
-static inline void free_cached_delayed_indexes(struct ireq *iq)
-{
-    if (iq->idxInsert || iq->idxDelete) {
-        free_cached_idx(iq->idxInsert);
-        free_cached_idx(iq->idxDelete);
-        free(iq->idxInsert);
-        free(iq->idxDelete);
-        iq->idxInsert = iq->idxDelete = NULL;
-    }
-}
-
 int insert_add_op(struct ireq *iq, block_state_t *blkstate, struct dbtable *usedb,
                   const uint8_t *p_buf_req_start, const uint8_t *p_buf_req_end,
                   int optype, int rrn, int ixnum, unsigned long long genid,
@@ -26,6 +26,7 @@
 #include <sys/resource.h>
 
 struct comdb2_metrics_store {
+    int64_t bpool_ghost_hits;
     int64_t bpool_hits;
     int64_t bpool_misses;
     double  cache_hit_rate;
@@ -39,10 +40,16 @@ struct comdb2_metrics_store {
     int64_t lockwaits;
     int64_t memory_ulimit;
     int64_t memory_usage;
+    int64_t osql_batches_rcvd;
+    int64_t osql_batches_sent;
     int64_t preads;
     int64_t pwrites;
+    int64_t rep_apply_lag;
+    int64_t rep_apply_ms;
     int64_t retries;
     int64_t sql_cost;
+    int64_t sql_pushdown_skipped;
+    int64_t sql_stripe_aggs;
     int64_t sql_count;
     int64_t start_time;
     int64_t threads;
@@ -63,6 +70,10 @@ static struct comdb2_metrics_store stats;
   Please keep'em sorted.
 */
 comdb2_metric gbl_metrics[] = {
+    {"bpool_ghost_hits",
+     "Buffer pool misses on pages recently evicted as probationary",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
+     &stats.bpool_ghost_hits, NULL},
     {"bpool_hits", "Buffer pool hits", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.bpool_hits, NULL},
     {"bpool_misses", "Buffer pool misses", STATISTIC_COLLECTION_TYPE_CUMULATIVE,
@@ -100,12 +111,27 @@ comdb2_metric gbl_metrics[] = {
      STATISTIC_COLLECTION_TYPE_LATEST, &stats.memory_ulimit, NULL},
     {"memory_usage", "Address space size", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_LATEST, &stats.memory_usage, NULL},
+    {"osql_batches_rcvd", "Batched osql messages received as master",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
+     &stats.osql_batches_rcvd, NULL},
+    {"osql_batches_sent", "Batched osql messages sent to the master",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
+     &stats.osql_batches_sent, NULL},
     {"preads", "Number of pread()'s", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.preads, NULL},
     {"pwrites", "Number of pwrite()'s", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.pwrites, NULL},
     {"queue_depth", "Request queue depth", STATISTIC_DOUBLE,
      STATISTIC_COLLECTION_TYPE_LATEST, &stats.queue_depth, NULL},
+    {"rep_apply_lag",
+     "Seconds the last transaction applied on this replicant was behind "
+     "its commit on the master",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.rep_apply_lag,
+     NULL},
+    {"rep_apply_ms",
+     "Milliseconds to apply the last replicated transaction once dispatched",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST, &stats.rep_apply_ms,
+     NULL},
     {"retries", "Number of retries", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.retries, NULL},
     {"service_time", "Service time", STATISTIC_DOUBLE,
@@ -114,6 +140,14 @@ comdb2_metric gbl_metrics[] = {
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_cost, NULL},
     {"sql_count", "Number of sql queries executed", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_count, NULL},
+    {"sql_pushdown_skipped",
+     "Rows skipped by WHERE terms checked on the ondisk row",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
+     &stats.sql_pushdown_skipped, NULL},
+    {"sql_stripe_aggs",
+     "Number of queries whose aggregates were computed a stripe at a time",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE,
+     &stats.sql_stripe_aggs, NULL},
     {"start_time", "Server start time", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_LATEST, &stats.start_time, NULL},
     {"threads", "Number of threads", STATISTIC_INTEGER,
@@ -138,6 +172,10 @@ int gbl_metrics_count = sizeof(gbl_metrics) / sizeof(comdb2_metric);
 
 extern int n_commits;
 extern long n_fstrap;
+extern int gbl_osql_batches_sent;
+extern int gbl_osql_batches_rcvd;
+extern int gbl_sql_pushdown_skipped;
+extern int gbl_sql_stripe_aggs;
 
 
 static int64_t refresh_diskspace(struct dbenv *dbenv) {
@@ -180,6 +218,10 @@ int refresh_metrics(void)
     stats.retries = n_retries;
     stats.sql_cost = gbl_nsql_steps + gbl_nnewsql_steps;
     stats.sql_count = gbl_nsql + gbl_nnewsql;
+    stats.osql_batches_sent = gbl_osql_batches_sent;
+    stats.osql_batches_rcvd = gbl_osql_batches_rcvd;
+    stats.sql_pushdown_skipped = gbl_sql_pushdown_skipped;
+    stats.sql_stripe_aggs = gbl_sql_stripe_aggs;
     stats.current_connections = net_get_num_current_non_appsock_accepts(thedb->handle_sibling) + active_appsock_conns;
 
     rc = bdb_get_lock_counters(thedb->bdb_env, &stats.deadlocks,
@@ -191,13 +233,16 @@ int refresh_metrics(void)
     }
 
     rc = bdb_get_bpool_counters(thedb->bdb_env, &stats.bpool_hits,
-                                &stats.bpool_misses);
+                                &stats.bpool_misses, &stats.bpool_ghost_hits);
     if (rc) {
         logmsg(LOGMSG_ERROR, "failed to refresh statistics (%s:%d)\n", __FILE__,
                __LINE__);
         return 1;
     }
 
+    bdb_get_rep_apply_lag(thedb->bdb_env, &stats.rep_apply_lag,
+                          &stats.rep_apply_ms);
+
     pstats = bdb_get_process_stats();
     stats.preads = pstats->n_preads;
     stats.pwrites = pstats->n_pwrites;
@@ -30,6 +30,7 @@
 #include "portmuxapi.h"
 #include "config.h"
 #include "net.h"
+#include <btree/bt_cache.h>
 
 /* Maximum allowable size of the value of tunable. */
 #define MAX_TUNABLE_VALUE_SIZE 512
@@ -62,6 +63,8 @@ extern int gbl_enque_reorder_lookahead;
 extern int gbl_exit_alarm_sec;
 extern int gbl_fdb_track;
 extern int gbl_fdb_track_hints;
+extern int gbl_fdb_push_select;
+extern int gbl_fdb_stream_window;
 extern int gbl_forbid_ulonglong;
 extern int gbl_force_highslot;
 extern int gbl_fdb_allow_cross_classes;
@@ -86,7 +89,17 @@ extern int gbl_net_throttle_percent;
 extern int gbl_nice;
 extern int gbl_notimeouts;
 extern int gbl_watchdog_disable_at_start;
+extern int gbl_osql_batch_bytes;
+extern int gbl_sql_move_batch;
+extern int gbl_sql_pushdown_filters;
+extern int gbl_parallel_agg;
+extern int gbl_lazy_pglogs;
+extern int gbl_sql_stmt_mem_cap;
+extern int gbl_t2t_kernels;
+extern int gbl_lua_trigger_batch;
+extern int gbl_osql_batch_lz4;
 extern int gbl_osql_verify_retries_max;
+extern int gbl_page_compress;
 extern int gbl_page_latches;
 extern int gbl_prefault_udp;
 extern int gbl_print_syntax_err;
@@ -148,6 +161,7 @@ extern int gbl_apply_queue_memory;
 extern int gbl_inmem_repdb_maxlog;
 extern int gbl_inmem_repdb_memory;
 extern int gbl_net_writer_thread_poll_ms;
+extern int gbl_net_writev;
 extern int gbl_max_apply_dequeue;
 extern int gbl_catchup_window_trace;
 extern int gbl_early_ack_trace;
@@ -198,6 +212,8 @@ extern size_t gbl_lk_hash;
 extern size_t gbl_lk_parts;
 extern size_t gbl_lkr_hash;
 extern size_t gbl_lkr_parts;
+extern int gbl_lk_part_stats;
+extern int gbl_lk_part_spin;
 
 extern uint8_t _non_dedicated_subnet;
 
@@ -240,6 +256,7 @@ void seed_genid48(bdb_state_type *bdb_state, uint64_t seed);
 
 #include <stdbool.h>
 extern bool gbl_rcache;
+extern int gbl_rcache_levels;
 
 static char *name = NULL;
 static int ctrace_gzip;
@@ -545,6 +562,16 @@ static int maxcolumns_verify(void *context, void *value)
     return 0;
 }
 
+static int rcache_levels_verify(void *context, void *value)
+{
+    if (*(int *)value < 0 || *(int *)value > RCACHE_MAX_LEVELS) {
+        logmsg(LOGMSG_ERROR, "rcache_levels must be between 0 and %d\n",
+               RCACHE_MAX_LEVELS);
+        return 1;
+    }
+    return 0;
+}
+
 static int loghist_update(void *context, void *value)
 {
     comdb2_tunable *tunable = (comdb2_tunable *)context;
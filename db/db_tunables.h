@@ -445,6 +445,16 @@ REGISTER_TUNABLE("foreign_db_allow_cross_class", NULL, TUNABLE_BOOLEAN,
 REGISTER_TUNABLE("foreign_db_resolve_local", NULL, TUNABLE_BOOLEAN,
                  &gbl_fdb_resolve_local, READONLY | NOARG | READEARLY, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_push_select",
+                 "Run selects over a single remote table that aggregate, "
+                 "group, or have a limit on the remote database. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_fdb_push_select, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("fdb_stream_window",
+                 "Most rows a remote sql stream sends before flushing them to "
+                 "the cursor; 1 sends every row on its own. (Default: 256)",
+                 TUNABLE_INTEGER, &gbl_fdb_stream_window, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("fullrecovery", "Attempt to run database "
                                  "recovery from the beginning of "
                                  "available logs. (Default : off)",
@@ -540,6 +550,16 @@ REGISTER_TUNABLE("lk_hash", NULL, TUNABLE_INTEGER, &gbl_lk_hash,
                  READONLY | READEARLY, NULL, lk_verify, NULL, NULL);
 REGISTER_TUNABLE("lk_part", NULL, TUNABLE_INTEGER, &gbl_lk_parts,
                  READONLY | READEARLY, NULL, lk_verify, NULL, NULL);
+REGISTER_TUNABLE("lk_part_spin",
+                 "Retry a busy lock table partition latch this many times "
+                 "before blocking on it. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_lk_part_spin, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("lk_part_stats",
+                 "Count and time lock table partition latch acquisitions; see "
+                 "comdb2_locks_contention. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_lk_part_stats, NOARG, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("lkr_hash", NULL, TUNABLE_INTEGER, &gbl_lkr_hash,
                  READONLY | READEARLY, NULL, lk_verify, NULL, NULL);
 REGISTER_TUNABLE("lkr_part", NULL, TUNABLE_INTEGER, &gbl_lkr_parts,
@@ -619,6 +639,11 @@ REGISTER_TUNABLE("max_lua_instructions",
                  "procedure is looping and kill it. (Default: 10000)",
                  TUNABLE_INTEGER, &gbl_max_lua_instructions, READONLY, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("lua_trigger_batch",
+                 "Maximum number of queued events a Lua trigger runs and "
+                 "consumes in one transaction per wakeup. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_lua_trigger_batch, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("max_num_compact_pages_per_txn", NULL, TUNABLE_INTEGER,
                  &gbl_max_num_compact_pages_per_txn, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("maxq",
@@ -811,6 +836,16 @@ REGISTER_TUNABLE("osql_bkoff_netsend", NULL, TUNABLE_INTEGER,
                  &gbl_osql_bkoff_netsend, READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("osql_bkoff_netsend_lmt", NULL, TUNABLE_INTEGER,
                  &gbl_osql_bkoff_netsend_lmt, READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("osql_batch_bytes",
+                 "Replicants pack the ops of a transaction into messages of up "
+                 "to this many bytes; 0 sends one message per op. Every node "
+                 "must understand batches before this is set. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_osql_batch_bytes, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("osql_batch_lz4",
+                 "Compress batched osql messages with lz4. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_osql_batch_lz4, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("osql_blockproc_timeout_sec", NULL, TUNABLE_INTEGER,
                  &gbl_osql_blockproc_timeout_sec, READONLY, NULL, NULL, NULL,
                  NULL);
@@ -856,6 +891,11 @@ REGISTER_TUNABLE("page_compact_target_ff", NULL, TUNABLE_DOUBLE,
 REGISTER_TUNABLE("page_compact_thresh_ff", NULL, TUNABLE_DOUBLE,
                  &gbl_pg_compact_thresh, READONLY | NOARG, NULL, NULL,
                  page_compact_thresh_ff_update, NULL);
+REGISTER_TUNABLE("page_compress",
+                 "Write btree leaf pages of 8K and up lz4 compressed, in as "
+                 "few 4K blocks as they fit. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_page_compress, NOARG, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("page_latches",
                  "If set, in rowlocks mode, will acquire fast latches on pages "
                  "instead of full locks. (Default: off)",
@@ -905,6 +945,11 @@ REGISTER_TUNABLE("rangextlim", NULL, TUNABLE_INTEGER, &gbl_rangextunit,
 REGISTER_TUNABLE(
     "rcache", "Keep a lookaside cache of root pages for B-trees. (Default: on)",
     TUNABLE_BOOLEAN, &gbl_rcache, READONLY | NOARG, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("rcache_levels",
+                 "Number of B-tree levels, starting at the root, kept in the "
+                 "rcache, at most 4. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_rcache_levels, 0, NULL,
+                 rcache_levels_verify, NULL, NULL);
 REGISTER_TUNABLE("reallearly",
                  "Acknowledge as soon as a commit record is seen by the "
                  "replicant (before it's applied). This effectively makes "
@@ -1016,6 +1061,31 @@ REGISTER_TUNABLE("sqlsortermem", "Maximum amount of memory to be "
                  NULL, NULL);
 REGISTER_TUNABLE("sqlsortermult", NULL, TUNABLE_INTEGER, &gbl_sqlite_sortermult,
                  READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_move_batch",
+                 "Table and index scans redo access, lock and statement checks "
+                 "only every this many rows. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_sql_move_batch, NOZERO, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_pushdown_filters",
+                 "Check simple column-vs-constant WHERE terms on the ondisk row "
+                 "during full table and index scans. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sql_pushdown_filters, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("parallel_agg",
+                 "Compute count/sum/min/max of a whole table with a thread per "
+                 "data stripe. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_parallel_agg, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("lazy_pglogs",
+                 "Only queue the page lsns for snapshot transactions while one "
+                 "is running; AS OF can then only go back to when the last one "
+                 "started. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_lazy_pglogs, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_stmt_mem_cap",
+                 "Megabytes of sqlite heap one statement may use before it "
+                 "spills or fails; 0 for no cap. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_stmt_mem_cap, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE("sql_time_threshold",
                  "Sets the threshold time in ms after which queries are "
                  "reported as running a long time. (Default: 5000 ms)",
@@ -1059,6 +1129,10 @@ REGISTER_TUNABLE("test_sc_resume_race",
                  "Test race between schemachange resume and blockprocessor",
                  TUNABLE_BOOLEAN, &gbl_test_sc_resume_race, READONLY, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("t2t_kernels",
+                 "Compile ondisk -> key and old version -> ondisk record "
+                 "conversions once per schema. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_t2t_kernels, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("throttlesqloverlog",
                  "On a full queue of SQL requests, dump the current thread "
                  "pool this often (in secs). (Default: 5sec)",
@@ -1365,6 +1439,11 @@ REGISTER_TUNABLE("net_writer_poll_ms",
                  "Poll time for net writer thread.  (Default: 1000)",
                  TUNABLE_INTEGER, &gbl_net_writer_thread_poll_ms,
                  EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("net_writev",
+                 "Net writer threads send queued messages in batches with "
+                 "writev instead of copying them through the socket buffer.  "
+                 "(Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_net_writev, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("inmem_repdb_maxlog",
                  "Maximum records for in-memory replist.  "
                  "(Default: 10000)",
@@ -1023,6 +1023,14 @@ static void dbqueue_stat_thread_int(struct dbtable *db, int fullstat, int walk_q
                bdbstats->n_old_way_frags_consumed);
 
         if (db->dbtype == DBTYPE_QUEUEDB) {
+            logmsg(LOGMSG_USER, "  bdb queuedb        add %llu con %llu "
+                                "batch gets %u\n",
+                   (unsigned long long)bdbstats->n_adds,
+                   (unsigned long long)bdbstats->n_consumes,
+                   bdbstats->n_batch_gets);
+            logmsg(LOGMSG_USER, "  bdb consume wait   total %llus max %us\n",
+                   (unsigned long long)bdbstats->consume_wait_sec,
+                   bdbstats->max_consume_wait_sec);
             pthread_rwlock_rdlock(&db->consumer_lk);
             maxconsumers = 1;
         }
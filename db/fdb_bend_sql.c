@@ -45,6 +45,9 @@ extern int blockproc2sql_error(int rc, const char *func, int line);
 
 static void init_sqlclntstate(struct sqlclntstate *clnt, char *cid, int isuuid);
 
+/* most rows a remote sql stream sends in one write */
+int gbl_fdb_stream_window = 256;
+
 int fdb_appsock_work(const char *cid, struct sqlclntstate *clnt, int version,
                      enum run_sql_flags flags, char *sql, int sqllen,
                      char *trim_key, int trim_keylen, SBUF2 *sb)
@@ -98,7 +101,7 @@ int fdb_svc_cursor_open_sql(char *tid, char *cid, int code_release, int version,
  *
  */
 int fdb_svc_sql_row(SBUF2 *sb, char *cid, char *row, int rowlen, int ret,
-                    int isuuid)
+                    int isuuid, int nogenid)
 {
     /* NOTE: we assume everything required is embedded in the sqlite row
        including genid and datacopy fields - as generated by select
@@ -106,8 +109,9 @@ int fdb_svc_sql_row(SBUF2 *sb, char *cid, char *row, int rowlen, int ret,
     int rc;
     unsigned long long genid = 0;
 
-    /* we know that genid is the last column ! */
-    if (ret == IX_FND || ret == IX_FNDMORE) {
+    /* we know that genid is the last column ! (unless this is a select
+       pushed down whole, see FDB_RUN_SQL_NOGENID) */
+    if ((ret == IX_FND || ret == IX_FNDMORE) && !nogenid) {
         genid = *(unsigned long long *)(row + rowlen - sizeof(genid));
         genid = flibc_htonll(genid);
     }
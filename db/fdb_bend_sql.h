@@ -32,7 +32,7 @@ int fdb_appsock_work(const char *cid, struct sqlclntstate *clnt, int version,
  *
  */
 int fdb_svc_sql_row(SBUF2 *sb, char *cid, char *row, int rowlen, int rc,
-                    int isuuid);
+                    int isuuid, int nogenid);
 
 /**
  * For requests where we want to avoid a dedicated genid lookup socket, this
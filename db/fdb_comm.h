@@ -42,7 +42,9 @@ enum run_sql_flags {
         1, /* special schema request, instructs sender to mark all indexes as
               covered indexes */
     FDB_RUN_SQL_TRIM =
-        2 /* remote trimms data using the provided key as boundary condition */
+        2, /* remote trimms data using the provided key as boundary condition */
+    FDB_RUN_SQL_NOGENID =
+        3 /* a select pushed down whole, its rows don't end with a genid */
 };
 
 union fdb_msg;
@@ -25,6 +25,7 @@
 #include <assert.h>
 #include <alloca.h>
 #include <poll.h>
+#include <unistd.h>
 
 #include <rtcpu.h>
 #include <list.h>
@@ -61,6 +62,7 @@ extern int gbl_expressions_indexes;
 
 int gbl_fdb_track = 0;
 int gbl_fdb_track_times = 0;
+int gbl_fdb_push_select = 1;
 
 struct fdb_tbl;
 struct fdb;
@@ -166,6 +168,9 @@ typedef struct fcon_tag {
 
 enum fdb_cur_stream_state { FDB_CUR_IDLE = 0, FDB_CUR_STREAMING = 1 };
 
+/* read buffer of a remote cursor socket */
+#define FDB_STREAM_BUFSZ (64 * 1024)
+
 struct fdb_cursor {
     char *cid;             /* identity of cursor id */
     char *tid;             /* transaction id owning cursor */
@@ -2066,6 +2071,7 @@ static int _fdb_remote_reconnect(fdb_t *fdb, SBUF2 **psb, char *host)
     int rc = FDB_NOERR;
     static uint64_t old = 0ULL;
     uint64_t now, then;
+    int fd;
 
     if (gbl_fdb_track) {
         logmsg(LOGMSG_USER, "Using node %s\n", host);
@@ -2104,6 +2110,15 @@ static int _fdb_remote_reconnect(fdb_t *fdb, SBUF2 **psb, char *host)
     /* we don't want timeouts so we can cache sockets on the source side...  */
     sbuf2settimeout(sb, 0, 0);
 
+    /* rows are streamed back in batches, read them in large chunks */
+    fd = sbuf2fileno(sb);
+    if (sbuf2setbufsize(sb, FDB_STREAM_BUFSZ)) {
+        logmsg(LOGMSG_ERROR, "%s: malloc error\n", __func__);
+        close(fd);
+        *psb = NULL;
+        return FDB_ERR_MALLOC;
+    }
+
     return FDB_NOERR;
 }
 
@@ -2607,6 +2622,39 @@ static char *_build_run_sql_from_hint(BtCursor *pCur, Mem *m, int ncols,
     int columnsDescLen = 0;
     int using_col_filter = 0;
 
+    /* a select pushed down whole by the planner runs as it is; there is no
+     * scan of the table to fall back on */
+    if (fdbc->hint && ((Expr *)fdbc->hint)->op == TK_SELECT) {
+        char *select;
+
+        if (pCur->bt->fdb->server_version < FDB_VER_PUSH_SELECT) {
+            /* planned before the remote was downgraded */
+            logmsg(LOGMSG_ERROR, "%s: remote db %s can't run a pushed down "
+                                 "select, protocol %d\n",
+                   __func__, pCur->bt->fdb->dbname,
+                   pCur->bt->fdb->server_version);
+            *error = 1;
+            return NULL;
+        }
+        select = sqlite3ExprDescribeAtRuntime(pCur->vdbe, fdbc->hint);
+        if (!select) {
+            logmsg(LOGMSG_ERROR, "%s: failed to describe pushed down select\n",
+                   __func__);
+            *error = 1;
+            return NULL;
+        }
+        sql = strdup(select);
+        sqlite3DbFree(sqlitedb, select);
+        if (!sql) {
+            logmsg(LOGMSG_ERROR, "%s: malloc error\n", __func__);
+            return NULL;
+        }
+        *p_sqllen = strlen(sql) + 1;
+        if (gbl_fdb_track)
+            logmsg(LOGMSG_USER, "Build [%d] \"%s\"\n", *p_sqllen, sql);
+        return sql;
+    }
+
     if (!fdbc->ent) {
         tableName = "sqlite_master";
     } else {
@@ -2925,6 +2973,7 @@ static int fdb_cursor_reopen(BtCursor *pCur)
     int rc;
     fdb_tran_t *tran;
     int need_ssl = 0;
+    void *hint;
 
     thd = pthread_getspecific(query_info_key);
 
@@ -2935,6 +2984,7 @@ static int fdb_cursor_reopen(BtCursor *pCur)
     clnt = thd->clnt;
     tran = pCur->fdbc->impl->trans;
     need_ssl = pCur->fdbc->impl->need_ssl;
+    hint = pCur->fdbc->impl->hint; /* set for the rewind we are part of */
 
     if (tran)
         pthread_mutex_lock(&clnt->dtran_mtx);
@@ -2951,6 +3001,7 @@ static int fdb_cursor_reopen(BtCursor *pCur)
         rc = clnt->fdb_state.xerr.errval;
         goto done;
     }
+    pCur->fdbc->impl->hint = hint;
 
 done:
     if (tran)
@@ -3002,6 +3053,8 @@ static int fdb_cursor_move_sql(BtCursor *pCur, int how)
                 sql = _build_run_sql_from_hint(
                     pCur, NULL, 0, (how == CLAST) ? OP_Prev : OP_Next, &sqllen,
                     &error);
+                if (fdbc->hint && ((Expr *)fdbc->hint)->op == TK_SELECT)
+                    flags = FDB_RUN_SQL_NOGENID;
             }
 
             if (!sql) {
@@ -3021,7 +3074,9 @@ static int fdb_cursor_move_sql(BtCursor *pCur, int how)
         }
 
         if (!rc) {
-            /* otherwise.read row */
+            /* otherwise.read row; until the last one comes, the remote side
+               is pushing rows and the socket can't go back to the pool */
+            fdbc->streaming = FDB_CUR_STREAMING;
             rc = fdb_recv_row(fdbc->msg, fdbc->cid, fdbc->fcon.sock.sb);
 
             if (rc != IX_FND && rc != IX_FNDMORE && rc != IX_NOTFND &&
@@ -3082,6 +3137,8 @@ static int fdb_cursor_move_sql(BtCursor *pCur, int how)
 
                 return rc;
             }
+            if (rc != IX_FNDMORE)
+                fdbc->streaming = FDB_CUR_IDLE;
         }
 
         end_rpc = osql_log_time();
@@ -3231,6 +3288,7 @@ static int fdb_cursor_find_sql_common(BtCursor *pCur, Mem *key, int nfields,
 
         if (!rc) {
             /* otherwise.read row */
+            fdbc->streaming = FDB_CUR_STREAMING;
             rc = fdb_recv_row(fdbc->msg, fdbc->cid, fdbc->fcon.sock.sb);
 
             if (rc != IX_FND && rc != IX_FNDMORE && rc != IX_NOTFND &&
@@ -3277,8 +3335,8 @@ static int fdb_cursor_find_sql_common(BtCursor *pCur, Mem *key, int nfields,
             if (rc == IX_NOTFND) {
                 rc = IX_EMPTY;
             }
-            if (rc == IX_FNDMORE) {
-                fdbc->streaming = FDB_CUR_STREAMING;
+            if (rc != IX_FNDMORE) {
+                fdbc->streaming = FDB_CUR_IDLE;
             }
         }
 
@@ -4558,6 +4616,18 @@ int fdb_table_exists(int rootpage)
     return 0;
 }
 
+/* the remote runs a pushed down select, and sends its rows without a genid,
+   only from FDB_VER_PUSH_SELECT on */
+int fdb_push_select_ok(int rootpage)
+{
+    fdb_tbl_ent_t *ent;
+
+    if (!gbl_fdb_push_select)
+        return 0;
+    ent = get_fdb_tbl_ent_by_rootpage(rootpage);
+    return ent && ent->tbl->fdb->server_version >= FDB_VER_PUSH_SELECT;
+}
+
 /**
  * Lock a remote table schema cache
  *
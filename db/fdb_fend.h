@@ -68,8 +68,9 @@
 #define FDB_VER_SOURCE_ID 2
 #define FDB_VER_WR_NAMES 3
 #define FDB_VER_SSL 4
+#define FDB_VER_PUSH_SELECT 5
 
-#define FDB_VER FDB_VER_SSL
+#define FDB_VER FDB_VER_PUSH_SELECT
 
 /* cc2 ftw */
 #define fdb_ver_encoded(ver) (-(ver + 1))
@@ -404,5 +405,11 @@ int fdb_get_remote_version(const char *dbname, const char *table,
 
 int fdb_table_exists(int rootpage);
 
+/**
+ * Can a select over the remote table at "rootpage" be run there whole
+ *
+ */
+int fdb_push_select_ok(int rootpage);
+
 #endif
 
@@ -4312,6 +4312,9 @@ int backend_open(struct dbenv *dbenv)
             bdb_handle_dbp_add_hash(d->handle, bthashsz);
         }
 
+        bdb_rowcount_load(d->handle, NULL);
+        bdb_zstd_load(d->handle, NULL);
+
         /* now tell bdb what the flags are - CRUCIAL that this is done
          * before any records are read/written from/to these tables. */
         set_bdb_option_flags(d, d->odh, d->inplace_updates,
@@ -5516,6 +5519,44 @@ retry:
     return rc;
 }
 
+int dbq_get_batch(struct ireq *iq, int consumer,
+                  const struct dbq_cursor *prevcursor, int max, void **fnddta,
+                  size_t *fnddtalen, int *nfnd)
+{
+    int bdberr;
+    void *bdb_handle;
+    int retries = 0;
+    int rc;
+    bdb_handle = get_bdb_handle_ireq(iq, AUXDB_NONE);
+    if (!bdb_handle)
+        return ERR_NO_AUXDB;
+
+retry:
+    iq->gluewhere = "bdb_queue_get_batch";
+    rc = bdb_queue_get_batch(bdb_handle, consumer,
+                             (const struct bdb_queue_cursor *)prevcursor, max,
+                             fnddta, fnddtalen, nfnd, &bdberr);
+    iq->gluewhere = "bdb_queue_get_batch done";
+    if (rc != 0) {
+        if (bdberr == BDBERR_DEADLOCK) {
+            iq->retries++;
+            if (++retries < gbl_maxretries) {
+                n_retries++;
+                poll(0, 0, (rand() % 500 + 10));
+                goto retry;
+            }
+            logmsg(LOGMSG_ERROR, "*ERROR* bdb_queue_get_batch too much contention "
+                                 "%d count %d\n",
+                   bdberr, retries);
+            return ERR_INTERNAL;
+        } else if (bdberr == BDBERR_FETCH_DTA) {
+            return IX_NOTFND;
+        }
+        return map_unhandled_bdb_rcode("bdb_queue_get_batch", bdberr, 0);
+    }
+    return rc;
+}
+
 unsigned long long dbq_item_genid(const void *dta)
 {
     return bdb_queue_item_genid(dta);
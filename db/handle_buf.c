@@ -573,6 +573,7 @@ static void *thd_req(void *vthd)
                 pool_free(thd->iq->vfy_genid_pool);
                 thd->iq->vfy_genid_pool = NULL;
             }
+            ireq_arena_release(thd->iq);
             if (thd->iq->sorese.osqllog) {
                 sbuf2close(thd->iq->sorese.osqllog);
                 thd->iq->sorese.osqllog = NULL;
@@ -832,6 +833,45 @@ int handled_queue;
 
 int q_reqs_len(void) { return q_reqs.count; }
 
+/* Index keys and update columns handed to us for each osql op live here
+   rather than in a calloc/malloc per key; the arena is created on first use
+   and its chunks are kept until the request is done. */
+#define IREQ_ARENA_CHUNK (2 * MAXINDEX * sizeof(uint8_t *) + 4096)
+
+void *ireq_arena_alloc(struct ireq *iq, size_t sz)
+{
+    if (iq->arena == NULL && (iq->arena = arena_init(IREQ_ARENA_CHUNK)) == NULL)
+        return NULL;
+    return arena_alloc(iq->arena, sz);
+}
+
+void *ireq_arena_calloc(struct ireq *iq, size_t n, size_t sz)
+{
+    if (iq->arena == NULL && (iq->arena = arena_init(IREQ_ARENA_CHUNK)) == NULL)
+        return NULL;
+    return arena_calloc(iq->arena, n, sz);
+}
+
+/* the cached keys point into the arena, so only drop them */
+void free_cached_delayed_indexes(struct ireq *iq)
+{
+    iq->idxInsert = iq->idxDelete = NULL;
+}
+
+/* everything allocated so far is dead */
+void ireq_arena_rewind(struct ireq *iq)
+{
+    free_cached_delayed_indexes(iq);
+    arena_rewind(iq->arena);
+}
+
+void ireq_arena_release(struct ireq *iq)
+{
+    free_cached_delayed_indexes(iq);
+    arena_free(iq->arena);
+    iq->arena = NULL;
+}
+
 static int init_ireq(struct dbenv *dbenv, struct ireq *iq, SBUF2 *sb,
                      uint8_t *p_buf, const uint8_t *p_buf_end, int debug,
                      char *frommach, int frompid, char *fromtask, int qtype,
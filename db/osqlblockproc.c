@@ -615,6 +615,44 @@ const char *osql_reqtype_str(int type)
     }
 }
 
+/* Called with store_mtx held when a sorese session receives its first op but
+ * already has rows; drops the lock and tells the replicant to retry */
+static int osql_bplog_broken_first_row(blocksql_tran_t *tran,
+                                       unsigned long long rqid,
+                                       const char *host)
+{
+    /* lets make sure that the temp table is empty since commit retries will
+     * use same rqid*/
+    sorese_info_t sorese_info = {0};
+    struct errstat generr = {0};
+    int rc;
+
+    logmsg(LOGMSG_ERROR, "%s Broken transaction, received first seq row but "
+            "session already has rows?\n",
+            __func__);
+
+    sorese_info.rqid = rqid;
+    sorese_info.host = host;
+    sorese_info.type = -1; /* I don't need it */
+
+    generr.errval = RC_INTERNAL_RETRY;
+    strncpy(generr.errstr,
+            "malformed transaction, received duplicated first row",
+            sizeof(generr.errstr));
+
+    if ((rc = pthread_mutex_unlock(&tran->store_mtx))) {
+        logmsg(LOGMSG_ERROR, "pthread_mutex_unlock: error code %d\n", rc);
+    }
+
+    rc = osql_comm_signal_sqlthr_rc(&sorese_info, &generr,
+            RC_INTERNAL_RETRY);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "Failed to signal replicant rc=%d\n", rc);
+    }
+
+    return -1;
+}
+
 /**
  * Inserts the op in the iq oplog
  * If sql processing is local, this is called by sqlthread
@@ -663,37 +701,8 @@ int osql_bplog_saveop(osql_sess_t *sess, char *rpl, int rplen,
         return rc;
     }
 
-    if (seq == 0 && osql_session_is_sorese(sess) && tran->rows > 0) {
-        /* lets make sure that the temp table is empty since commit retries will
-         * use same rqid*/
-        sorese_info_t sorese_info = {0};
-        struct errstat generr = {0};
-
-        logmsg(LOGMSG_ERROR, "%s Broken transaction, received first seq row but "
-                "session already has rows?\n",
-                __func__);
-
-        sorese_info.rqid = rqid;
-        sorese_info.host = host;
-        sorese_info.type = -1; /* I don't need it */
-
-        generr.errval = RC_INTERNAL_RETRY;
-        strncpy(generr.errstr,
-                "malformed transaction, received duplicated first row",
-                sizeof(generr.errstr));
-
-        if ((rc = pthread_mutex_unlock(&tran->store_mtx))) {
-            logmsg(LOGMSG_ERROR, "pthread_mutex_unlock: error code %d\n", rc);
-        }
-
-        rc = osql_comm_signal_sqlthr_rc(&sorese_info, &generr,
-                RC_INTERNAL_RETRY);
-        if (rc) {
-            logmsg(LOGMSG_ERROR, "Failed to signal replicant rc=%d\n", rc);
-        }
-
-        return -1;
-    }
+    if (seq == 0 && osql_session_is_sorese(sess) && tran->rows > 0)
+        return osql_bplog_broken_first_row(tran, rqid, host);
 
 #if 0 
    printf("%s: rqid=%llx Saving op type=%d\n", __func__, rqid, ntohl(*((int*)rpl)));
@@ -761,6 +770,69 @@ int osql_bplog_saveop(osql_sess_t *sess, char *rpl, int rplen,
     return 0;
 }
 
+/**
+ * Inserts a batch of ops, none of them a done, in the iq oplog under a single
+ * acquisition of the store lock; the ops get sequence numbers seq and up
+ * Returns 0 if success
+ *
+ */
+int osql_bplog_saveops(osql_sess_t *sess, char **ops, int *oplens, int nops,
+                       unsigned long long rqid, uuid_t uuid,
+                       unsigned long long seq, const char *host)
+{
+    blocksql_tran_t *tran = (blocksql_tran_t *)osql_sess_getbptran(sess);
+    if (!tran || !tran->db) {
+        /* see osql_bplog_saveop */
+        return 0;
+    }
+
+    oplog_key_t key;
+    int rc = 0, rc_op = 0;
+    int bdberr;
+    int i;
+
+    for (i = 0; i < nops; i++) {
+        int type = 0;
+        buf_get(&type, sizeof(type), ops[i], ops[i] + oplens[i]);
+        if (type == OSQL_SCHEMACHANGE) sess->iq->tranddl = 1;
+    }
+
+    assert (sess->rqid == rqid);
+
+    if ((rc = pthread_mutex_lock(&tran->store_mtx))) {
+        logmsg(LOGMSG_ERROR, "pthread_mutex_lock: error code %d\n", rc);
+        return rc;
+    }
+
+    if (seq == 0 && osql_session_is_sorese(sess) && tran->rows > 0)
+        return osql_bplog_broken_first_row(tran, rqid, host);
+
+    for (i = 0; i < nops && rc_op == 0; i++) {
+        key.seq = seq + i;
+        rc_op = bdb_temp_table_put(thedb->bdb_env, tran->db, &key, sizeof(key),
+                                   ops[i], oplens[i], NULL, &bdberr);
+        if (rc_op) {
+            logmsg(LOGMSG_ERROR,
+                   "%s: fail to put oplog seq=%llu rc=%d bdberr=%d\n",
+                   __func__, key.seq, rc_op, bdberr);
+            break;
+        }
+        tran->rows++;
+        if (gbl_osqlpfault_threads) {
+            osql_page_prefault(ops[i], oplens[i], &(tran->last_db),
+                               &(osql_session_get_ireq(sess)->osql_step_ix),
+                               rqid, uuid, key.seq);
+        }
+    }
+
+    if ((rc = pthread_mutex_unlock(&tran->store_mtx))) {
+        logmsg(LOGMSG_ERROR, "pthread_mutex_unlock: error code %d\n", rc);
+        return rc;
+    }
+
+    return rc_op;
+}
+
 /**
  * Wakeup the block processor waiting for a completed session
  *
@@ -1172,8 +1244,7 @@ static int process_this_session(
        this will free the eventually allocated buffers */
     free_blob_buffers(blobs, MAXBLOBS);
 
-    if (updCols)
-        free(updCols);
+    /* updCols lives in the request arena */
 
     if (rc != 0 && rc != IX_PASTEOF && rc != IX_EMPTY) {
         reqlog_set_error(iq->reqlogger, "Internal Error", rc);
@@ -111,6 +111,16 @@ int osql_bplog_saveop(osql_sess_t *sess, char *rpl, int rplen,
                       unsigned long long rqid, uuid_t uuid,
                       unsigned long long seq, const char *host);
 
+/**
+ * Inserts a batch of ops, none of them a done, in the iq oplog under a single
+ * acquisition of the store lock; the ops get sequence numbers seq and up
+ * Returns 0 if success
+ *
+ */
+int osql_bplog_saveops(osql_sess_t *sess, char **ops, int *oplens, int nops,
+                       unsigned long long rqid, uuid_t uuid,
+                       unsigned long long seq, const char *host);
+
 /**
  * Wakeup the block processor waiting for a completed session
  *
@@ -48,6 +48,12 @@
 #include "views.h"
 #include "str0.h"
 #include "sc_struct.h"
+#include <lz4.h>
+#include "comdb2_atomic.h"
+
+#if LZ4_VERSION_NUMBER < 10701
+#define LZ4_compress_default LZ4_compress_limitedOutput
+#endif
 
 #define BLKOUT_DEFAULT_DELTA 5
 #define MAX_CLUSTER 16
@@ -184,6 +190,55 @@ static const uint8_t *osqlcomm_poke_uuid_type_get(osql_poke_uuid_t *p_poke_type,
     return p_buf;
 }
 
+/* Header of a NET_OSQL_RPL_BATCH message.  It is followed by nops entries of
+ * { int len; int pad; char op[len]; } each padded to 8 bytes, lz4 compressed
+ * as a whole if flags has OSQL_BATCH_LZ4. */
+typedef struct osql_batch_hdr {
+    int type;   /* net type every op would have been sent with */
+    int flags;
+    int nops;
+    int rawlen; /* length of the packed ops before compression */
+} osql_batch_hdr_t;
+
+enum { OSQL_BATCH_LZ4 = 1 };
+
+enum { OSQLCOMM_BATCH_HDR_TYPE_LEN = 4 + 4 + 4 + 4 };
+
+BB_COMPILE_TIME_ASSERT(osqlcomm_batch_hdr_type_len,
+                       sizeof(osql_batch_hdr_t) == OSQLCOMM_BATCH_HDR_TYPE_LEN);
+
+#define OSQL_BATCH_OP_LEN(len) (8 + (((len) + 7) & ~7))
+
+static uint8_t *osqlcomm_batch_hdr_type_put(const osql_batch_hdr_t *p_hdr,
+                                            uint8_t *p_buf,
+                                            const uint8_t *p_buf_end)
+{
+    if (p_buf_end < p_buf || OSQLCOMM_BATCH_HDR_TYPE_LEN > (p_buf_end - p_buf))
+        return NULL;
+
+    p_buf = buf_put(&(p_hdr->type), sizeof(p_hdr->type), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_hdr->flags), sizeof(p_hdr->flags), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_hdr->nops), sizeof(p_hdr->nops), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_hdr->rawlen), sizeof(p_hdr->rawlen), p_buf, p_buf_end);
+
+    return p_buf;
+}
+
+static const uint8_t *osqlcomm_batch_hdr_type_get(osql_batch_hdr_t *p_hdr,
+                                                  const uint8_t *p_buf,
+                                                  const uint8_t *p_buf_end)
+{
+    if (p_buf_end < p_buf || OSQLCOMM_BATCH_HDR_TYPE_LEN > (p_buf_end - p_buf))
+        return NULL;
+
+    p_buf = buf_get(&(p_hdr->type), sizeof(p_hdr->type), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_hdr->flags), sizeof(p_hdr->flags), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_hdr->nops), sizeof(p_hdr->nops), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_hdr->rawlen), sizeof(p_hdr->rawlen), p_buf, p_buf_end);
+
+    return p_buf;
+}
+
 typedef struct hbeat {
     int dst;
     int src;
@@ -2823,6 +2878,9 @@ static int get_blkout(time_t now, char *nodes[REPMAX], int *nds);
 static int sorese_rcvreq(char *fromhost, void *dtap, int dtalen, int type,
                          int nettype);
 static int netrpl2req(int netrpltype);
+static void net_osql_rpl_batch(void *hndl, void *uptr, char *fromhost,
+                               int usertype, void *dtap, int dtalen,
+                               uint8_t is_tcp);
 
 static void net_osql_rcv_echo_ping(void *hndl, void *uptr, char *fromnode,
                                    int usertype, void *dtap, int dtalen,
@@ -2975,6 +3033,9 @@ int osql_comm_init(struct dbenv *dbenv)
     net_register_handler(tmp->handle_sibling, NET_OSQL_MASTER_CHECKED_UUID,
                          "osql_master_checked_uuid", net_osql_master_checked);
 
+    net_register_handler(tmp->handle_sibling, NET_OSQL_RPL_BATCH,
+                         "osql_rpl_batch", net_osql_rpl_batch);
+
     /* this guy will terminate pending requests */
     net_register_hostdown(tmp->handle_sibling, net_osql_nodedwn);
 
@@ -5787,12 +5848,241 @@ out:
     return rc;
 }
 
+/* Batched offload stream.  With osql_batch_bytes set, a replicant packs the
+   ops of a session into NET_OSQL_RPL_BATCH messages of up to that many bytes
+   instead of sending one net message per op; the done (or xerr) op closes the
+   batch.  Masters that predate NET_OSQL_RPL_BATCH drop it, so this stays off
+   until the whole cluster understands it. */
+int gbl_osql_batch_bytes = 0;
+int gbl_osql_batch_lz4 = 0;
+int gbl_osql_batches_sent = 0; /* replicant: batches flushed to a master */
+int gbl_osql_batches_rcvd = 0; /* master: batches received */
+
+typedef struct osql_batch {
+    const char *host;
+    int type;
+    unsigned long long rqid;
+    uuid_t uuid;
+    int nops;
+    int nodelay;
+    uint8_t *buf; /* room for the header, then the packed ops */
+    int len;
+    int alloc;
+    char *zbuf;
+    int zalloc;
+} osql_batch_t;
+
+/* ops are sent by the sql thread running the transaction */
+static __thread osql_batch_t osql_batch;
+
+/* frees a thread's batch buffers when the thread exits */
+static pthread_key_t osql_batch_key;
+static pthread_once_t osql_batch_once = PTHREAD_ONCE_INIT;
+
+static void osql_batch_free(void *arg)
+{
+    osql_batch_t *b = arg;
+    free(b->buf);
+    free(b->zbuf);
+    b->buf = NULL;
+    b->zbuf = NULL;
+    b->alloc = 0;
+    b->zalloc = 0;
+}
+
+static void osql_batch_key_init(void)
+{
+    int rc = pthread_key_create(&osql_batch_key, osql_batch_free);
+    if (rc)
+        logmsg(LOGMSG_ERROR, "%s: pthread_key_create rc %d\n", __func__, rc);
+}
+
+/* call before this thread first allocates a batch buffer */
+static void osql_batch_track(osql_batch_t *b)
+{
+    if (b->buf || b->zbuf)
+        return;
+    pthread_once(&osql_batch_once, osql_batch_key_init);
+    pthread_setspecific(osql_batch_key, b);
+}
+
+static int osql_batch_type(int type)
+{
+    switch (type) {
+    case NET_OSQL_SOCK_RPL:
+    case NET_OSQL_SOCK_RPL_UUID:
+    case NET_OSQL_RECOM_RPL:
+    case NET_OSQL_RECOM_RPL_UUID:
+    case NET_OSQL_SNAPISOL_RPL:
+    case NET_OSQL_SNAPISOL_RPL_UUID:
+    case NET_OSQL_SERIAL_RPL:
+    case NET_OSQL_SERIAL_RPL_UUID:
+        return 1;
+    }
+    return 0;
+}
+
+static int osql_batch_flush(void)
+{
+    osql_batch_t *b = &osql_batch;
+    osql_batch_hdr_t hdr = {0};
+    uint8_t *msg = b->buf;
+    int msglen = b->len;
+
+    if (b->nops == 0)
+        return 0;
+
+    hdr.type = b->type;
+    hdr.nops = b->nops;
+    hdr.rawlen = b->len - OSQLCOMM_BATCH_HDR_TYPE_LEN;
+
+    if (gbl_osql_batch_lz4) {
+        int bound = LZ4_compressBound(hdr.rawlen);
+        if (b->zalloc < OSQLCOMM_BATCH_HDR_TYPE_LEN + bound) {
+            osql_batch_track(b);
+            char *z = realloc(b->zbuf, OSQLCOMM_BATCH_HDR_TYPE_LEN + bound);
+            if (z) {
+                b->zbuf = z;
+                b->zalloc = OSQLCOMM_BATCH_HDR_TYPE_LEN + bound;
+            }
+        }
+        if (b->zalloc >= OSQLCOMM_BATCH_HDR_TYPE_LEN + bound) {
+            int zlen = LZ4_compress_default(
+                (char *)b->buf + OSQLCOMM_BATCH_HDR_TYPE_LEN,
+                b->zbuf + OSQLCOMM_BATCH_HDR_TYPE_LEN, hdr.rawlen, bound);
+            if (zlen > 0 && zlen < hdr.rawlen) {
+                hdr.flags |= OSQL_BATCH_LZ4;
+                msg = (uint8_t *)b->zbuf;
+                msglen = OSQLCOMM_BATCH_HDR_TYPE_LEN + zlen;
+            }
+        }
+    }
+    osqlcomm_batch_hdr_type_put(&hdr, msg, msg + OSQLCOMM_BATCH_HDR_TYPE_LEN);
+
+    /* reset first, offload_net_send comes back through osql_batch_add */
+    b->nops = 0;
+    b->len = 0;
+
+    ATOMIC_ADD(gbl_osql_batches_sent, 1);
+    return offload_net_send(b->host, NET_OSQL_RPL_BATCH, msg, msglen,
+                            b->nodelay);
+}
+
+/* Returns 1 if the message was taken care of (sent or batched) with its
+   return code in *rc; 0 if the caller has to send it as it is */
+static int osql_batch_add(const char *host, int usertype, void *data,
+                          int datalen, int nodelay, int ntails, void **tails,
+                          int *tailens, int *rc)
+{
+    osql_batch_t *b = &osql_batch;
+    unsigned long long rqid = 0;
+    uuid_t uuid;
+    uint8_t *p_buf;
+    int eligible, hasuuid, len, i;
+
+    eligible = gbl_osql_batch_bytes > 0 && host && host != gbl_mynode &&
+               osql_batch_type(usertype);
+    if (!eligible && b->nops == 0)
+        return 0;
+
+    hasuuid = osql_nettype_is_uuid(usertype);
+    comdb2uuid_clear(uuid);
+    if (eligible && hasuuid) {
+        osql_uuid_rpl_t hdr;
+        if (osqlcomm_uuid_rpl_type_get(&hdr, data, (uint8_t *)data + datalen)) {
+            rqid = OSQL_RQID_USE_UUID;
+            comdb2uuidcpy(uuid, hdr.uuid);
+        } else
+            eligible = 0;
+    } else if (eligible) {
+        osql_rpl_t hdr;
+        if (osqlcomm_rpl_type_get(&hdr, data, (uint8_t *)data + datalen))
+            rqid = hdr.sid;
+        else
+            eligible = 0;
+    }
+
+    /* anything else this thread sends must not overtake the batched ops */
+    if (b->nops && (!eligible || host != b->host || usertype != b->type ||
+                    rqid != b->rqid || comdb2uuidcmp(uuid, b->uuid))) {
+        if ((*rc = osql_batch_flush()) != 0)
+            return 1;
+    }
+
+    len = datalen;
+    for (i = 0; i < ntails; i++)
+        len += tailens[i];
+
+    /* large ops (blobs) go on their own, after what is batched so far */
+    if (!eligible ||
+        OSQLCOMM_BATCH_HDR_TYPE_LEN + OSQL_BATCH_OP_LEN(len) >
+            gbl_osql_batch_bytes) {
+        if (b->nops && (*rc = osql_batch_flush()) != 0)
+            return 1;
+        return 0;
+    }
+
+    if (b->nops &&
+        b->len + OSQL_BATCH_OP_LEN(len) > gbl_osql_batch_bytes &&
+        (*rc = osql_batch_flush()) != 0)
+        return 1;
+
+    if (b->nops == 0) {
+        b->host = host;
+        b->type = usertype;
+        b->rqid = rqid;
+        comdb2uuidcpy(b->uuid, uuid);
+        b->nodelay = 0;
+        b->len = OSQLCOMM_BATCH_HDR_TYPE_LEN;
+    }
+    if (b->alloc < b->len + OSQL_BATCH_OP_LEN(len)) {
+        int alloc = gbl_osql_batch_bytes;
+        uint8_t *buf;
+        if (alloc < b->len + OSQL_BATCH_OP_LEN(len))
+            alloc = b->len + OSQL_BATCH_OP_LEN(len);
+        osql_batch_track(b);
+        if ((buf = realloc(b->buf, alloc)) == NULL) {
+            /* send what we have and let this one go alone */
+            *rc = osql_batch_flush();
+            return *rc != 0;
+        }
+        b->buf = buf;
+        b->alloc = alloc;
+    }
+
+    p_buf = b->buf + b->len;
+    memset(p_buf, 0, OSQL_BATCH_OP_LEN(len));
+    p_buf = buf_put(&len, sizeof(len), p_buf, b->buf + b->alloc);
+    p_buf += 4;
+    memcpy(p_buf, data, datalen);
+    p_buf += datalen;
+    for (i = 0; i < ntails; i++) {
+        memcpy(p_buf, tails[i], tailens[i]);
+        p_buf += tailens[i];
+    }
+    b->len += OSQL_BATCH_OP_LEN(len);
+    b->nops++;
+    b->nodelay |= nodelay;
+
+    *rc = 0;
+    if (osql_comm_is_done(data, datalen, hasuuid, NULL, NULL))
+        *rc = osql_batch_flush();
+
+    return 1;
+}
+
 /* this wrapper tries to provide a reliable net_send that will prevent loosing
    packets
    due to queue being full */
 static int offload_net_send(const char *host, int usertype, void *data,
                             int datalen, int nodelay)
 {
+    int rc = -1;
+    if (osql_batch_add(host, usertype, data, datalen, nodelay, 0, NULL, NULL,
+                       &rc))
+        return rc;
+    rc = -1;
+
     if (debug_switch_osql_simulate_send_error()) {
         if (rand() % 4 == 0) /*25% chance of failure*/
         {
@@ -5814,7 +6104,6 @@ static int offload_net_send(const char *host, int usertype, void *data,
     int backoff = gbl_osql_bkoff_netsend;
     int total_wait = backoff;
     int unknownerror_retry = 0;
-    int rc = -1;
     int count = 0;
 
     /* remote send */
@@ -5900,6 +6189,11 @@ static int offload_net_send_tails(const char *host, int usertype, void *data,
     int unknownerror_retry = 0;
     int rc = -1;
 
+    if (osql_batch_add(host, usertype, data, datalen, nodelay, ntails, tails,
+                       tailens, &rc))
+        return rc;
+    rc = -1;
+
     while (rc) {
         if (host == gbl_mynode)
             host = NULL;
@@ -6068,6 +6362,111 @@ static void net_osql_rpl(void *hndl, void *uptr, char *fromnode, int usertype,
         stats[netrpl2req(usertype)].rcv_rdndt++;
 }
 
+/* Master side of the batched offload stream.  All ops but a trailing done are
+   loaded into the session's bplog with one call; the done goes through
+   osql_sess_rcvop like any other, so it completes and dispatches the
+   transaction the usual way. */
+static void net_osql_rpl_batch(void *hndl, void *uptr, char *fromhost,
+                               int usertype, void *dtap, int dtalen,
+                               uint8_t is_tcp)
+{
+    osql_batch_hdr_t hdr;
+    const uint8_t *p_buf = dtap;
+    const uint8_t *p_buf_end = p_buf + dtalen;
+    char *raw = NULL;
+    char **ops = NULL;
+    int *oplens = NULL;
+    unsigned long long rqid;
+    uuid_t uuid;
+    int i, rc = 0, found = 0, nops, done;
+
+    if (!(p_buf = osqlcomm_batch_hdr_type_get(&hdr, p_buf, p_buf_end)) ||
+        !osql_batch_type(hdr.type) || hdr.nops <= 0 || hdr.rawlen <= 0) {
+        logmsg(LOGMSG_ERROR, "%s: malformed batch from %s\n", __func__,
+               fromhost);
+        return;
+    }
+    ATOMIC_ADD(gbl_osql_batches_rcvd, 1);
+
+    if (hdr.flags & OSQL_BATCH_LZ4) {
+        raw = malloc(hdr.rawlen);
+        if (raw == NULL ||
+            LZ4_decompress_safe((const char *)p_buf, raw, p_buf_end - p_buf,
+                                hdr.rawlen) != hdr.rawlen) {
+            logmsg(LOGMSG_ERROR, "%s: failed to decompress batch from %s\n",
+                   __func__, fromhost);
+            rc = -1;
+            goto out;
+        }
+        p_buf = (uint8_t *)raw;
+        p_buf_end = p_buf + hdr.rawlen;
+    } else if (p_buf_end - p_buf != hdr.rawlen) {
+        logmsg(LOGMSG_ERROR, "%s: short batch from %s\n", __func__, fromhost);
+        rc = -1;
+        goto out;
+    }
+
+    nops = hdr.nops;
+    ops = malloc(nops * sizeof(char *));
+    oplens = malloc(nops * sizeof(int));
+    if (ops == NULL || oplens == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: failed to allocate %d ops\n", __func__, nops);
+        rc = -1;
+        goto out;
+    }
+    for (i = 0; i < nops; i++) {
+        int len;
+        if (!(p_buf = buf_get(&len, sizeof(len), p_buf, p_buf_end)) ||
+            len <= 0 || OSQL_BATCH_OP_LEN(len) - 4 > p_buf_end - p_buf) {
+            logmsg(LOGMSG_ERROR, "%s: bad op %d of %d from %s\n", __func__, i,
+                   nops, fromhost);
+            rc = -1;
+            goto out;
+        }
+        ops[i] = (char *)p_buf + 4;
+        oplens[i] = len;
+        p_buf += OSQL_BATCH_OP_LEN(len) - 4;
+    }
+
+    if (osql_nettype_is_uuid(hdr.type)) {
+        osql_uuid_rpl_t uuid_rpl;
+        rqid = OSQL_RQID_USE_UUID;
+        if (!osqlcomm_uuid_rpl_type_get(&uuid_rpl, (uint8_t *)ops[0],
+                                        (uint8_t *)ops[0] + oplens[0])) {
+            rc = -1;
+            goto out;
+        }
+        comdb2uuidcpy(uuid, uuid_rpl.uuid);
+    } else {
+        osql_rpl_t rpl;
+        comdb2uuid_clear(uuid);
+        if (!osqlcomm_rpl_type_get(&rpl, (uint8_t *)ops[0],
+                                   (uint8_t *)ops[0] + oplens[0])) {
+            rc = -1;
+            goto out;
+        }
+        rqid = rpl.sid;
+    }
+
+    done = osql_comm_is_done(ops[nops - 1], oplens[nops - 1],
+                             rqid == OSQL_RQID_USE_UUID, NULL, NULL);
+    if (nops > done)
+        rc = osql_sess_rcvops(rqid, uuid, ops, oplens, nops - done, &found);
+    if (done)
+        rc = osql_sess_rcvop(rqid, uuid, ops[nops - 1], oplens[nops - 1],
+                             &found);
+
+out:
+    stats[netrpl2req(hdr.type)].rcv += hdr.nops;
+    if (rc)
+        stats[netrpl2req(hdr.type)].rcv_failed++;
+    if (!found)
+        stats[netrpl2req(hdr.type)].rcv_rdndt++;
+    free(oplens);
+    free(ops);
+    free(raw);
+}
+
 static int check_master(const char *tohost)
 {
 
@@ -6363,7 +6762,6 @@ static inline int is_write_request(int type)
     }
 }
 
-void free_cached_idx(uint8_t **cached_idx);
 
 int start_schema_change_tran_wrapper(const char *tblname,
                                      timepart_sc_arg_t *arg)
@@ -6802,13 +7200,9 @@ int osql_process_packet(struct ireq *iq, unsigned long long rqid, uuid_t uuid,
         rc = del_record(iq, trans, NULL, 0, dt.genid, dt.dk, &err->errcode,
                         &err->ixnum, BLOCK2_DELKL, 0);
 
-        if (iq->idxInsert || iq->idxDelete) {
-            free_cached_idx(iq->idxInsert);
-            free_cached_idx(iq->idxDelete);
-            free(iq->idxInsert);
-            free(iq->idxDelete);
-            iq->idxInsert = iq->idxDelete = NULL;
-        }
+        free_cached_delayed_indexes(iq);
+        if (*updCols == NULL)
+            ireq_arena_rewind(iq);
 
         if (rc != 0) {
             if (rc != RC_INTERNAL_RETRY) {
@@ -6880,13 +7274,9 @@ int osql_process_packet(struct ireq *iq, unsigned long long rqid, uuid_t uuid,
                         dt.dk, BLOCK2_ADDKL, step, addflags,
                         dt.flags); /* do I need this?*/
         free_blob_buffers(blobs, MAXBLOBS);
-        if (iq->idxInsert || iq->idxDelete) {
-            free_cached_idx(iq->idxInsert);
-            free_cached_idx(iq->idxDelete);
-            free(iq->idxInsert);
-            free(iq->idxDelete);
-            iq->idxInsert = iq->idxDelete = NULL;
-        }
+        free_cached_delayed_indexes(iq);
+        if (*updCols == NULL)
+            ireq_arena_rewind(iq);
 
         if (logsb) {
             unsigned long long lclgenid = bdb_genid_to_host_order(genid);
@@ -7025,22 +7415,17 @@ int osql_process_packet(struct ireq *iq, unsigned long long rqid, uuid_t uuid,
                                             collected. */);
 
         free_blob_buffers(blobs, MAXBLOBS);
-        if (iq->idxInsert || iq->idxDelete) {
-            free_cached_idx(iq->idxInsert);
-            free_cached_idx(iq->idxDelete);
-            free(iq->idxInsert);
-            free(iq->idxDelete);
-            iq->idxInsert = iq->idxDelete = NULL;
-        }
+        free_cached_delayed_indexes(iq);
 
         if (*updCols) {
-            free(*updCols);
             *updCols = NULL;
             /* reset blob optimization, just in case; should
                be enabled by a new updCols
              */
             *flags = (*flags) & (!OSQL_PROCESS_FLAGS_BLOB_OPTIMIZATION);
         }
+        /* the keys and updcols of this update were the last users */
+        ireq_arena_rewind(iq);
 
         if (logsb) {
             unsigned long long lclgenid = bdb_genid_to_host_order(genid);
@@ -7100,7 +7485,7 @@ int osql_process_packet(struct ireq *iq, unsigned long long rqid, uuid_t uuid,
                 __func__);
         } else {
             int sz = sizeof(int) * (dt.ncols + 1);
-            *updCols = (int *)malloc(sz);
+            *updCols = (int *)ireq_arena_alloc(iq, sz);
 
             /* reset to the end of the buffer */
             p_buf_end = p_buf + sz;
@@ -7185,17 +7570,17 @@ int osql_process_packet(struct ireq *iq, unsigned long long rqid, uuid_t uuid,
             sbuf2flush(logsb);
         }
         if (!iq->idxInsert && !iq->idxDelete) {
-            iq->idxInsert = calloc(MAXINDEX, sizeof(uint8_t *));
-            iq->idxDelete = calloc(MAXINDEX, sizeof(uint8_t *));
+            iq->idxInsert = ireq_arena_calloc(iq, MAXINDEX, sizeof(uint8_t *));
+            iq->idxDelete = ireq_arena_calloc(iq, MAXINDEX, sizeof(uint8_t *));
             if (!iq->idxInsert || !iq->idxDelete) {
                 logmsg(LOGMSG_ERROR, "%s failed to allocated indexes\n", __func__);
                 return ERR_INTERNAL;
             }
         }
         if (isDelete)
-            iq->idxDelete[dt.ixnum] = pIdx = malloc(dt.nData);
+            iq->idxDelete[dt.ixnum] = pIdx = ireq_arena_alloc(iq, dt.nData);
         else
-            iq->idxInsert[dt.ixnum] = pIdx = malloc(dt.nData);
+            iq->idxInsert[dt.ixnum] = pIdx = ireq_arena_alloc(iq, dt.nData);
         if (pIdx == NULL) {
             logmsg(LOGMSG_ERROR, "%s failed to allocated indexes data, len %d\n",
                     __func__, dt.nData);
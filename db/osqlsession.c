@@ -634,6 +634,74 @@ int osql_sess_rcvop(unsigned long long rqid, uuid_t uuid, void *data,
     return rc_out ? rc_out : rc;
 }
 
+/**
+ * Handles a batch of ops received for session "rqid", none of them a done
+ * It saves all of them in the local bplog at once
+ * Return 0 if success
+ * Set found if the session is found or not
+ *
+ */
+int osql_sess_rcvops(unsigned long long rqid, uuid_t uuid, char **ops,
+                     int *oplens, int nops, int *found)
+{
+    osql_sess_t *sess = NULL;
+    int rc = 0;
+    int rc_out = 0;
+    int is_sorese = 0;
+
+    sess = osql_repository_get(rqid, uuid, 0);
+    if (!sess) {
+        uuidstr_t us;
+        comdb2uuidstr(uuid, us);
+        logmsg(LOGMSG_INFO,
+               "discarding %d packets for %llx %s, session not found\n", nops,
+               rqid, us);
+        *found = 0;
+        return 0;
+    }
+
+    is_sorese = osql_session_is_sorese(sess);
+    *found = 1;
+
+    pthread_mutex_lock(&sess->completed_lock);
+    if (sess->completed || sess->dispatched || sess->terminate) {
+        pthread_mutex_unlock(&sess->completed_lock);
+        if ((rc = osql_repository_put(sess, 0)) != 0) {
+            logmsg(LOGMSG_ERROR,
+                   "%s:%d osql_repository_put failed with rc %d\n", __func__,
+                   __LINE__, rc);
+        }
+        return 0;
+    }
+    pthread_mutex_unlock(&sess->completed_lock);
+
+    rc_out = osql_bplog_saveops(sess, ops, oplens, nops, rqid, uuid, sess->seq,
+                                sess->offhost);
+
+    /* if rc_out, sess is FREED! */
+    if (!rc_out) {
+        pthread_mutex_lock(&sess->completed_lock);
+        if (sess->rqid == rqid || (rqid == OSQL_RQID_USE_UUID &&
+                                   comdb2uuidcmp(sess->uuid, uuid) == 0)) {
+            sess->seq += nops;
+            sess->last_row = time(NULL);
+        }
+        pthread_mutex_unlock(&sess->completed_lock);
+    }
+
+    if ((rc = osql_repository_put(sess, 0)) != 0) {
+        fprintf(stderr, "%s: rc =%d\n", __func__, rc);
+    }
+
+    if (is_sorese && rc_out)
+        return rc_out;
+
+    if (rc || rc_out)
+        sess->terminate = OSQL_TERMINATE;
+
+    return rc_out ? rc_out : rc;
+}
+
 /**
  * Mark the session terminated if the node "arg"
  * machine the provided session "obj",
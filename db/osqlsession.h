@@ -232,6 +232,16 @@ int osql_sess_unlock_complete(osql_sess_t *sess);
 int osql_sess_rcvop(unsigned long long rqid, uuid_t uuid, void *data,
                     int datalen, int *found);
 
+/**
+ * Handles a batch of ops received for session "rqid", none of them a done
+ * It saves all of them in the local bplog at once
+ * Return 0 if success
+ * Set found if the session is found or not
+ *
+ */
+int osql_sess_rcvops(unsigned long long rqid, uuid_t uuid, char **ops,
+                     int *oplens, int nops, int *found);
+
 /**
  * If the node "arg" machine the provided session
  * "obj", mark the session terminated
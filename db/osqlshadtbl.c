@@ -1277,8 +1277,16 @@ int osql_save_dbq_consume(struct sqlclntstate *clnt, const char *spname,
                           genid_t genid)
 {
     shadbq_t *shad = &clnt->osql.shadbq;
+    if (shad->ngenids == shad->alloc) {
+        int alloc = shad->alloc ? shad->alloc * 2 : 1;
+        genid_t *genids = realloc(shad->genids, alloc * sizeof(genid_t));
+        if (genids == NULL)
+            return -1;
+        shad->genids = genids;
+        shad->alloc = alloc;
+    }
     shad->spname = spname;
-    shad->genid = genid;
+    shad->genids[shad->ngenids++] = genid;
     return 0;
 }
 
@@ -2115,9 +2123,9 @@ static int process_local_shadtbl_upd(struct sqlclntstate *clnt, shad_tbl_t *tbl,
 }
 
 /*
-** We can consume only one item at a time (the item at the head of the DBQ).
-** Setting up a shadow tmptbl to store dbq name and one genid, seems a bit
-** overkill. I will just save this info in sqlclntstate.
+** A consumer takes items off the head of its one DBQ, one at a time or a
+** batch at a time. Setting up a shadow tmptbl to store dbq name and genids,
+** seems a bit overkill. I will just save this info in sqlclntstate.
 */
 static int process_local_shadtbl_dbq(struct sqlclntstate *clnt, int *bdberr,
                                      int *crt_nops)
@@ -2127,8 +2135,8 @@ static int process_local_shadtbl_dbq(struct sqlclntstate *clnt, int *bdberr,
         return SQLITE_TOOBIG;
     }
     shadbq_t *shadbq = &clnt->osql.shadbq;
-    if (shadbq->spname && shadbq->genid) {
-        osql_dbq_consume(clnt, shadbq->spname, shadbq->genid);
+    for (int i = 0; shadbq->spname && i < shadbq->ngenids; ++i) {
+        osql_dbq_consume(clnt, shadbq->spname, shadbq->genids[i]);
         ++*crt_nops;
     }
     return SQLITE_OK;
@@ -2325,7 +2333,9 @@ static int delete_record_indexes(BtCursor *pCur, char *pdta, int dtasize,
 static inline void osql_destroy_dbq(osqlstate_t *osql)
 {
     osql->shadbq.spname = NULL;
-    osql->shadbq.genid = 0;
+    free(osql->shadbq.genids);
+    osql->shadbq.genids = NULL;
+    osql->shadbq.ngenids = osql->shadbq.alloc = 0;
 }
 
 /**
@@ -74,6 +74,7 @@ extern int __berkdb_read_alarm_ms;
 #include <sc_stripes.h>
 #include <sc_global.h>
 #include <logmsg.h>
+#include <btree/bt_cache.h>
 
 extern int gbl_exit_alarm_sec;
 extern int gbl_disable_rowlocks_logging;
@@ -2093,13 +2094,23 @@ clipper_usage:
 #ifdef _LINUX_SOURCE
         else if (tokcmp(tok, ltok, "rcache") == 0) {
             extern uint32_t rcache_hits, rcache_miss, rcache_savd,
-                rcache_invalid, rcache_collide;
+                rcache_invalid, rcache_collide,
+                rcache_level_hits[RCACHE_MAX_LEVELS];
+            extern int gbl_rcache_levels;
+            int i;
             logmsg(LOGMSG_ERROR, "rcache enabled:%s\n", YESNO(gbl_rcache));
+            logmsg(LOGMSG_ERROR, "rcache levels:%d\n", gbl_rcache_levels);
             logmsg(LOGMSG_ERROR, "cache hits: %u\n", rcache_hits);
             logmsg(LOGMSG_ERROR, "cache miss: %u\n", rcache_miss);
             logmsg(LOGMSG_ERROR, "cache save: %u\n", rcache_savd);
             logmsg(LOGMSG_ERROR, "cache invd: %u\n", rcache_invalid);
             logmsg(LOGMSG_ERROR, "cache coll: %u\n", rcache_collide);
+            if (rcache_hits + rcache_miss)
+                logmsg(LOGMSG_ERROR, "hit rate  : %.2f%%\n",
+                       100.0 * rcache_hits / (rcache_hits + rcache_miss));
+            for (i = 0; i < RCACHE_MAX_LEVELS; ++i)
+                logmsg(LOGMSG_ERROR, "level %d hits: %u\n", i + 1,
+                       rcache_level_hits[i]);
         }
 #endif
         else if (tokcmp(tok, ltok, "autoanalyze") == 0) {
@@ -2526,6 +2537,58 @@ clipper_usage:
                 return -1;
         }
 
+    } else if (tokcmp(tok, ltok, "rowcount") == 0 ||
+               tokcmp(tok, ltok, "delrowcount") == 0) {
+        char table[MAXTABLELEN];
+        int enable = (tokcmp(tok, ltok, "rowcount") == 0);
+        if (thedb->master != gbl_mynode) {
+            logmsg(LOGMSG_ERROR, "I am not master\n");
+            return -1;
+        }
+
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok == 0) {
+            logmsg(LOGMSG_ERROR, "Expected table name\n");
+            return -1;
+        }
+        if (ltok >= MAXTABLELEN) {
+            logmsg(LOGMSG_ERROR, "Invalid table name: too long (max %d)\n",
+                   MAXTABLELEN);
+            return -1;
+        }
+
+        tokcpy(tok, ltok, table);
+
+        if (rowcount_table(table, enable) != 0)
+            return -1;
+    } else if (tokcmp(tok, ltok, "zstd") == 0) {
+        char table[MAXTABLELEN];
+        tok = segtok(line, lline, &st, &ltok);
+        if (tokcmp(tok, ltok, "train") != 0) {
+            logmsg(LOGMSG_USER, "zstd train <tbl> - Train a compression "
+                                "dictionary for table tbl\n");
+            return -1;
+        }
+        if (thedb->master != gbl_mynode) {
+            logmsg(LOGMSG_ERROR, "I am not master\n");
+            return -1;
+        }
+
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok == 0) {
+            logmsg(LOGMSG_ERROR, "Expected table name\n");
+            return -1;
+        }
+        if (ltok >= MAXTABLELEN) {
+            logmsg(LOGMSG_ERROR, "Invalid table name: too long (max %d)\n",
+                   MAXTABLELEN);
+            return -1;
+        }
+
+        tokcpy(tok, ltok, table);
+
+        if (zstd_train_table(table) != 0)
+            return -1;
     } else if (tokcmp(tok, ltok, "bthashstat") == 0) {
         char table[MAXTABLELEN];
         int szkb;
@@ -4904,6 +4967,18 @@ clipper_usage:
     } else if (tokcmp(tok, ltok, "norcache") == 0) {
         gbl_rcache = false;
        logmsg(LOGMSG_USER, "disabled rcache\n");
+    } else if (tokcmp(tok, ltok, "rcache_bench") == 0) {
+        int nrecs = 0, nlookups = 0;
+        char *dir;
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok)
+            nrecs = toknum(tok, ltok);
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok)
+            nlookups = toknum(tok, ltok);
+        dir = comdb2_location("tmp", NULL);
+        rcache_bench(stdout, dir, nrecs, nlookups);
+        free(dir);
 #endif
     } else if (tokcmp(tok, ltok, "swing") == 0) {
         extern int gbl_master_changes;
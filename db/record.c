@@ -74,7 +74,6 @@ static int check_blob_buffers(struct ireq *iq, blob_buffer_t *blobs,
 static int check_blob_sizes(struct ireq *iq, blob_buffer_t *blobs,
                             int maxblobs);
 
-void free_cached_idx(uint8_t * *cached_idx);
 
 /*
  * Add a record:
@@ -257,13 +256,7 @@ int add_record(struct ireq *iq, void *trans, const uint8_t *p_buf_tag_name,
             }
         }
         if (rebuild_keys) {
-            if (iq->idxInsert || iq->idxDelete) {
-                free_cached_idx(iq->idxInsert);
-                free_cached_idx(iq->idxDelete);
-                free(iq->idxInsert);
-                free(iq->idxDelete);
-                iq->idxInsert = iq->idxDelete = NULL;
-            }
+            free_cached_delayed_indexes(iq);
             ins_keys = -1ULL;
         }
     }
@@ -2374,13 +2367,7 @@ int upd_new_record(struct ireq *iq, void *trans, unsigned long long oldgenid,
             }
         }
         if (rebuild_keys) {
-            if (iq->idxInsert || iq->idxDelete) {
-                free_cached_idx(iq->idxInsert);
-                free_cached_idx(iq->idxDelete);
-                free(iq->idxInsert);
-                free(iq->idxDelete);
-                iq->idxInsert = iq->idxDelete = NULL;
-            }
+            free_cached_delayed_indexes(iq);
             del_keys = -1ULL;
             ins_keys = -1ULL;
         }
@@ -2757,13 +2744,7 @@ int del_new_record(struct ireq *iq, void *trans, unsigned long long genid,
             }
         }
         if (rebuild_keys) {
-            if (iq->idxInsert || iq->idxDelete) {
-                free_cached_idx(iq->idxInsert);
-                free_cached_idx(iq->idxDelete);
-                free(iq->idxInsert);
-                free(iq->idxDelete);
-                iq->idxInsert = iq->idxDelete = NULL;
-            }
+            free_cached_delayed_indexes(iq);
             del_keys = -1ULL;
         }
     }
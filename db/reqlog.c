@@ -2241,6 +2241,21 @@ int release_node_stats(const char *task, const char *stack, char *host)
     return 0;
 }
 
+/* Raise the client's sqlite heap high-water mark; only takes the lock when
+ * the statement beat it */
+void nodestats_note_sql_mem(struct rawnodestats *rawnodestats, long long peak)
+{
+    nodestats_t *nodestats =
+        (nodestats_t *)((char *)rawnodestats - offsetof(nodestats_t, rawtotals));
+
+    if (peak <= nodestats->sql_mem_peak)
+        return;
+    pthread_mutex_lock(&nodestats->mtx);
+    if (peak > nodestats->sql_mem_peak)
+        nodestats->sql_mem_peak = peak;
+    pthread_mutex_unlock(&nodestats->mtx);
+}
+
 typedef struct {
     nodestats_t **list;
     int i;
@@ -2411,6 +2426,7 @@ struct summary_nodestats *get_nodestats_summary(unsigned *nodes_cnt,
         summaries[ii].sql_queries = snap.sql_queries;
         summaries[ii].sql_steps = snap.sql_steps;
         summaries[ii].sql_rows = snap.sql_rows;
+        summaries[ii].sql_mem_peak = nodestats->sql_mem_peak;
 
         for (opcode = 0; opcode < MAXTYPCNT; opcode++) {
             unsigned n = snap.opcode_counts[opcode];
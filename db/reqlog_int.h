@@ -230,6 +230,10 @@ struct nodestats {
     struct rawnodestats raw_buckets[NUM_BUCKETS];
     int bucket_spanms[NUM_BUCKETS];
 
+    /* largest sqlite heap used by one statement (not a counter, so kept out
+     * of rawnodestats) */
+    long long sql_mem_peak;
+
     char mem[1];
 };
 typedef struct nodestats nodestats_t;
@@ -109,7 +109,9 @@ typedef struct fdbtimings {
 
 typedef struct {
     const char *spname;
-    genid_t genid;
+    genid_t *genids; /* consumed so far; more than one with consume_batch */
+    int ngenids;
+    int alloc;
 } shadbq_t;
 
 typedef struct osqlstate {
@@ -565,6 +567,7 @@ struct sqlclntstate {
 
     int planner_effort;
     int osql_max_trans;
+    long long sql_mem_cap; /* statement sqlite heap cap, -1: sql_stmt_mem_cap */
     /* read-set validation */
     CurRangeArr *arr;
     CurRangeArr *selectv_arr;
@@ -747,6 +750,8 @@ struct BtCursor {
     int nmove, nfind, nwrite;
     int nblobs;
     int num_nexts;
+    int move_checks_left; /* moves before the next full check, see
+                             sql_move_batch */
 
     int numblobs;
 
@@ -808,6 +813,9 @@ struct BtCursor {
     unsigned long long col_mask; /* tracking first 63 columns, if bit is set,
                                     column is needed */
 
+    struct cursor_filter *filter; /* hinted predicates checked on the ondisk
+                                     row before sqlite sees it */
+
     unsigned long long keyDdl; /* rowid for side DDL row */
     char *dataDdl;             /* DDL row, cached during CREATE operations */
     int nDataDdl;   /* length of the cached row for DDL instructions */
@@ -782,6 +782,11 @@ void get_one_explain_line(sqlite3 *hndl, strbuf *out, Vdbe *v, int indent,
                        op->p2, op->p1);
         print_cursor_description(out, &cur[op->p1]);
         break;
+    case OP_StripeAgg:
+        strbuf_appendf(out, "R%d = compute %d aggregate(s) by data stripe on ",
+                       op->p2, (op->p4.ai[0] - 1) / 3);
+        print_cursor_description(out, &cur[op->p1]);
+        break;
     case OP_Savepoint:
         strbuf_appendf(
             out, "%s the savepoint named by parameter P4(%s)",
@@ -101,6 +101,7 @@
 #include "eventlog.h"
 
 #include "str0.h"
+#include "comdb2_atomic.h"
 
 unsigned long long get_id(bdb_state_type *);
 
@@ -156,6 +157,8 @@ static int ddguard_bdb_cursor_move(struct sql_thread *thd, BtCursor *pCur,
                                    int flags, int *bdberr, int how,
                                    struct ireq *iq_do_prefault,
                                    int freshcursor);
+/* ddguard_bdb_cursor_move flags */
+#define CURSOR_MOVE_BATCHED 1 /* skip the per-move lock-waiter check */
 static int is_sql_update_mode(int mode);
 static int queryOverlapsCursors(struct sqlclntstate *clnt, BtCursor *pCur);
 
@@ -2115,6 +2118,268 @@ static inline int i64cmp(const i64 *key1, const i64 *key2)
 
 #include "vdbecompare.c"
 
+/* With sql_pushdown_filters on, the planner hints local full scans with their
+ * WHERE terms too, and the simple "column <op> constant" conjuncts are checked
+ * here on the ondisk row or key, so rows that fail them never reach the vdbe
+ * (no key conversion, no column decoding, no blob fetch).  A term is only
+ * kept if comparing the decoded column with the constant gives exactly what
+ * sqlite would compute; everything else is left to the vdbe, which still
+ * evaluates the whole WHERE clause on the rows that pass. */
+int gbl_sql_pushdown_filters = 0;
+int gbl_sql_pushdown_skipped = 0; /* rows the filters kept from the vdbe */
+
+#define CURSOR_FILTER_MAX_TERMS 16
+
+struct cursor_filter_term {
+    int fnum; /* field in pCur->sc */
+    int op;   /* TK_EQ, TK_NE, TK_LT, TK_LE, TK_GT or TK_GE */
+    Mem val;
+};
+
+struct cursor_filter {
+    int nskipped; /* added to gbl_sql_pushdown_skipped when freed */
+    int nterms;
+    struct cursor_filter_term terms[CURSOR_FILTER_MAX_TERMS];
+};
+
+static void cursor_filter_free(BtCursor *pCur)
+{
+    struct cursor_filter *flt = pCur->filter;
+    int i;
+
+    if (!flt)
+        return;
+    for (i = 0; i < flt->nterms; i++)
+        sqlite3VdbeMemRelease(&flt->terms[i].val);
+    if (flt->nskipped)
+        ATOMIC_ADD(gbl_sql_pushdown_skipped, flt->nskipped);
+    free(flt);
+    pCur->filter = NULL;
+}
+
+/* "5 < a" is "a > 5" */
+static int cursor_filter_commute(int op)
+{
+    switch (op) {
+    case TK_LT:
+        return TK_GT;
+    case TK_LE:
+        return TK_GE;
+    case TK_GT:
+        return TK_LT;
+    case TK_GE:
+        return TK_LE;
+    }
+    return op;
+}
+
+static void cursor_filter_add(BtCursor *pCur, struct cursor_filter *flt,
+                              Expr *pExpr, Mem *aMem)
+{
+    Expr *pCol = pExpr->pLeft;
+    Expr *pVal = pExpr->pRight;
+    sqlite3_value *tmp = NULL;
+    struct cursor_filter_term *t;
+    struct field *f;
+    Mem *m = NULL;
+    int op = pExpr->op;
+    int ok = 0;
+
+    if (!pCol || !pVal || ExprHasProperty(pExpr, EP_Collate))
+        return;
+    if (pVal->op == TK_COLUMN) {
+        Expr *swap = pCol;
+        pCol = pVal;
+        pVal = swap;
+        op = cursor_filter_commute(op);
+    }
+    /* the hint has every other cursor's columns turned into registers */
+    if (pCol->op != TK_COLUMN || pCol->iColumn < 0 ||
+        pCol->iColumn >= pCur->sc->nmembers)
+        return;
+    f = &pCur->sc->member[pCol->iColumn];
+    if (f->flags & INDEX_DESCEND)
+        return;
+
+    switch (pVal->op) {
+    case TK_REGISTER:
+        m = &aMem[pVal->iTable];
+        break;
+    case TK_VARIABLE:
+        if (pCur->vdbe && pVal->iColumn > 0 &&
+            pVal->iColumn <= pCur->vdbe->nVar)
+            m = &pCur->vdbe->aVar[pVal->iColumn - 1];
+        break;
+    case TK_INTEGER:
+    case TK_FLOAT:
+    case TK_STRING:
+    case TK_UMINUS:
+        if (sqlite3ValueFromExpr(pCur->sqlite, pVal, SQLITE_UTF8,
+                                 SQLITE_AFF_BLOB, &tmp) == SQLITE_OK)
+            m = tmp;
+        break;
+    }
+    if (!m)
+        goto done;
+
+    switch (f->type) {
+    case SERVER_BINT:
+    case SERVER_UINT:
+    case SERVER_BREAL:
+        /* numeric affinity: a string constant would be converted first */
+        ok = (m->flags & (MEM_Int | MEM_Real)) && !(m->flags & MEM_Null);
+        break;
+    case SERVER_BCSTR:
+        /* a register could carry a collation from a subquery column */
+        ok = pVal->op != TK_REGISTER &&
+             (m->flags & (MEM_Null | MEM_Str | MEM_Int | MEM_Real |
+                          MEM_Blob | MEM_Xor)) == MEM_Str;
+        break;
+    }
+    if (!ok)
+        goto done;
+
+    t = &flt->terms[flt->nterms];
+    t->fnum = pCol->iColumn;
+    t->op = op;
+    sqlite3VdbeMemInit(&t->val, pCur->sqlite, MEM_Null);
+    if (sqlite3VdbeMemCopy(&t->val, m) == SQLITE_OK)
+        flt->nterms++;
+    else
+        sqlite3VdbeMemRelease(&t->val);
+
+done:
+    if (tmp)
+        sqlite3ValueFree(tmp);
+}
+
+static void cursor_filter_build(BtCursor *pCur, struct cursor_filter *flt,
+                                Expr *pExpr, Mem *aMem)
+{
+    if (!pExpr)
+        return;
+
+    switch (pExpr->op) {
+    case TK_AND:
+        cursor_filter_build(pCur, flt, pExpr->pLeft, aMem);
+        cursor_filter_build(pCur, flt, pExpr->pRight, aMem);
+        break;
+    case TK_EQ:
+    case TK_NE:
+    case TK_LT:
+    case TK_LE:
+    case TK_GT:
+    case TK_GE:
+        if (flt->nterms < CURSOR_FILTER_MAX_TERMS)
+            cursor_filter_add(pCur, flt, pExpr, aMem);
+        break;
+    }
+}
+
+/* Called on every OP_CursorHint; register values are taken now, the hint is
+ * reissued each time the loop owning the cursor is restarted. */
+static void cursor_filter_set(BtCursor *pCur, const Expr *pExpr, Mem *aMem)
+{
+    struct sql_thread *thd = pCur->thd;
+    struct cursor_filter *flt;
+
+    cursor_filter_free(pCur);
+
+    if (!gbl_sql_pushdown_filters || !pCur->sc || pCur->is_recording)
+        return;
+    if (pCur->cursor_class != CURSORCLASS_TABLE &&
+        pCur->cursor_class != CURSORCLASS_INDEX)
+        return;
+    /* serializable wants to see every row it read */
+    if (thd && thd->clnt && thd->clnt->dbtran.mode == TRANLEVEL_SERIAL)
+        return;
+
+    flt = calloc(1, sizeof(struct cursor_filter));
+    if (!flt)
+        return;
+    cursor_filter_build(pCur, flt, (Expr *)pExpr, aMem);
+    if (flt->nterms == 0) {
+        free(flt);
+        return;
+    }
+    pCur->filter = flt;
+}
+
+/* A rejected first/last row is skipped like any other in the scan direction */
+static inline int cursor_filter_step(int how)
+{
+    return (how == CFIRST || how == CNEXT) ? CNEXT : CPREV;
+}
+
+/* Return 1 if the ondisk row/key cannot satisfy the hinted WHERE terms */
+static int cursor_filter_reject(BtCursor *pCur, uint8_t *in)
+{
+    struct cursor_filter *flt = pCur->filter;
+    int i, c, ok;
+    Mem m;
+
+    for (i = 0; i < flt->nterms; i++) {
+        struct cursor_filter_term *t = &flt->terms[i];
+
+        memset(&m, 0, sizeof(Mem));
+        if (get_data(pCur, pCur->sc, in, t->fnum, &m, 0, NULL))
+            return 0;
+        /* a comparison with NULL is never true */
+        if (m.flags & MEM_Null) {
+            flt->nskipped++;
+            return 1;
+        }
+
+        c = sqlite3MemCompare(&m, &t->val, NULL);
+        switch (t->op) {
+        case TK_EQ:
+            ok = (c == 0);
+            break;
+        case TK_NE:
+            ok = (c != 0);
+            break;
+        case TK_LT:
+            ok = (c < 0);
+            break;
+        case TK_LE:
+            ok = (c <= 0);
+            break;
+        case TK_GT:
+            ok = (c > 0);
+            break;
+        default:
+            ok = (c >= 0);
+            break;
+        }
+        if (!ok) {
+            flt->nskipped++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int gbl_sql_move_batch = 1;
+
+/* With sql_move_batch > 1 only every sql_move_batch-th next/prev on a table or
+ * index cursor redoes the access checks, sql_tick and the lock-waiter check;
+ * the moves in between, which the bdb cursor mostly serves from its bulk
+ * buffer, only look for a cancelled or timed out statement or one over its
+ * maxcost.  Any other move does the full checks and starts a new batch. */
+static inline int cursor_move_batched(BtCursor *pCur, int how)
+{
+    if ((how != CNEXT && how != CPREV) || gbl_sql_move_batch <= 1) {
+        pCur->move_checks_left = 0;
+        return 0;
+    }
+    if (pCur->move_checks_left > 0) {
+        pCur->move_checks_left--;
+        return 1;
+    }
+    pCur->move_checks_left = gbl_sql_move_batch - 1;
+    return 0;
+}
+
 /**
  * Detects if a cursor is stalling and optimize certain moves
  * Mark done if the move is done
@@ -2123,7 +2388,7 @@ static inline int i64cmp(const i64 *key1, const i64 *key2)
  * are part of a cursor's method function block.
  */
 static int cursor_move_preprop(BtCursor *pCur, int *pRes, int how, int *done,
-                               int uses_bdb_locking)
+                               int uses_bdb_locking, int batched)
 {
     struct sql_thread *thd = pCur->thd;
     int rc = SQLITE_OK;
@@ -2156,13 +2421,24 @@ static int cursor_move_preprop(BtCursor *pCur, int *pRes, int how, int *done,
         break;
     }
 
-    rc = sql_tick(thd, uses_bdb_locking);
+    if (batched) {
+        struct sqlclntstate *clnt = thd->clnt;
+        if (clnt && clnt->stop_this_statement)
+            rc = SQLITE_BUSY;
+        else if (clnt && clnt->statement_timedout)
+            rc = SQLITE_LIMIT;
+        else if (clnt && clnt->limits.maxcost &&
+                 thd->cost > clnt->limits.maxcost)
+            rc = SQLITE_LIMIT;
+    } else {
+        rc = sql_tick(thd, uses_bdb_locking);
+    }
     if (rc) {
         *done = 1;
         return rc;
     }
 
-    if (thd->clnt->is_analyze &&
+    if (!batched && thd->clnt->is_analyze &&
         (gbl_schema_change_in_progress || get_analyze_abort_requested())) {
         if (gbl_schema_change_in_progress)
             logmsg(LOGMSG_ERROR, 
@@ -2270,15 +2546,16 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
     int rrn;
     int done = 0;
     int rc = SQLITE_OK;
+    int batched = cursor_move_batched(pCur, how);
     int outrc = SQLITE_OK;
     uint8_t ver;
     struct sqlclntstate *clnt = thd->clnt;
 
-    if (access_control_check_sql_read(pCur, thd)) {
+    if (!batched && access_control_check_sql_read(pCur, thd)) {
         return SQLITE_ACCESS;
     }
 
-    rc = cursor_move_preprop(pCur, pRes, how, &done, 1);
+    rc = cursor_move_preprop(pCur, pRes, how, &done, 1, batched);
     if (done) {
         return rc;
     }
@@ -2296,13 +2573,15 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
     iq.usedb = pCur->db;
     iq.opcode = OP_FIND;
 
+again:
     outrc = SQLITE_OK;
     *pRes = 0;
     if (thd)
         thd->nmove++;
 
     bdberr = 0;
-    rc = ddguard_bdb_cursor_move(thd, pCur, 0, &bdberr, how, NULL, 0);
+    rc = ddguard_bdb_cursor_move(thd, pCur, batched ? CURSOR_MOVE_BATCHED : 0,
+                                 &bdberr, how, NULL, 0);
     if (bdberr == BDBERR_NOT_DURABLE) {
         return SQLITE_CLIENT_CHANGENODE;
     }
@@ -2356,6 +2635,15 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
             } else {
                 pCur->dtabuf = buf;
             }
+
+            if (pCur->filter && cursor_filter_reject(pCur, pCur->dtabuf)) {
+                how = cursor_filter_step(how);
+                batched = cursor_move_batched(pCur, how);
+                rc = cursor_move_preprop(pCur, pRes, how, &done, 1, batched);
+                if (done)
+                    return rc;
+                goto again;
+            }
         }
     }
 
@@ -2418,14 +2706,15 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
     int bdberr = 0;
     int done = 0;
     int rc = SQLITE_OK;
+    int batched = cursor_move_batched(pCur, how);
     int outrc = SQLITE_OK;
     struct sqlclntstate *clnt = thd->clnt;
 
-    if (access_control_check_sql_read(pCur, thd)) {
+    if (!batched && access_control_check_sql_read(pCur, thd)) {
         return SQLITE_ACCESS;
     }
 
-    rc = cursor_move_preprop(pCur, pRes, how, &done, 1);
+    rc = cursor_move_preprop(pCur, pRes, how, &done, 1, batched);
     if (done) {
         return rc;
     }
@@ -2435,6 +2724,7 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
     iq.usedb = pCur->db;
     iq.opcode = OP_FIND;
 
+again:
     outrc = SQLITE_OK;
     *pRes = 0;
     if (thd)
@@ -2453,7 +2743,8 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
             }
     }
 
-    rc = ddguard_bdb_cursor_move(thd, pCur, 0, &bdberr, how, &iq, 0);
+    rc = ddguard_bdb_cursor_move(thd, pCur, batched ? CURSOR_MOVE_BATCHED : 0,
+                                 &bdberr, how, &iq, 0);
     if (bdberr == BDBERR_NOT_DURABLE) {
         return SQLITE_CLIENT_CHANGENODE;
     }
@@ -2509,6 +2800,15 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
                  */
                 pCur->lastkey = buf;
             }
+
+            if (pCur->filter && cursor_filter_reject(pCur, pCur->lastkey)) {
+                how = cursor_filter_step(how);
+                batched = cursor_move_batched(pCur, how);
+                rc = cursor_move_preprop(pCur, pRes, how, &done, 1, batched);
+                if (done)
+                    return rc;
+                goto again;
+            }
         }
     }
 
@@ -2569,7 +2869,7 @@ static int tmptbl_cursor_move(BtCursor *pCur, int *pRes, int how)
     int done = 0;
     int rc = SQLITE_OK;
 
-    rc = cursor_move_preprop(pCur, pRes, how, &done, 0);
+    rc = cursor_move_preprop(pCur, pRes, how, &done, 0, 0);
     if (done)
         return rc;
 
@@ -2615,7 +2915,7 @@ static int cursor_move_compressed(BtCursor *pCur, int *pRes, int how)
     int done = 0;
     int rc = SQLITE_OK;
 
-    rc = cursor_move_preprop(pCur, pRes, how, &done, 0);
+    rc = cursor_move_preprop(pCur, pRes, how, &done, 0, 0);
     if (done)
         return rc;
 
@@ -2678,7 +2978,7 @@ static int cursor_move_master(BtCursor *pCur, int *pRes, int how)
     /* skip preprop. if we're called from sqlite3_open_serial
      * and if peer_dropped_connection is true, we'll get NO SQL ENGINE and
      * a wasted thread apparently.
-     rc = cursor_move_preprop(pCur, pRes, how, &done, 0);
+     rc = cursor_move_preprop(pCur, pRes, how, &done, 0, 0);
      if (done)
      return rc;
      */
@@ -2755,7 +3055,7 @@ static int cursor_move_remote(BtCursor *pCur, int *pRes, int how)
 
     assert(pCur->fdbc != NULL);
 
-    rc = cursor_move_preprop(pCur, pRes, how, &done, 1);
+    rc = cursor_move_preprop(pCur, pRes, how, &done, 1, 0);
     if (done) {
         return rc;
     }
@@ -6029,6 +6329,8 @@ int sqlite3BtreeCloseCursor(BtCursor *pCur)
     if (pCur->blobs.numcblobs > 0)
         free_blob_status_data(&pCur->blobs);
 
+    cursor_filter_free(pCur);
+
     /* update cursor use counts.  don't lock for now.
      * analyze shouldnt' affect cursor stats */
     if (pCur->db && !clnt->is_analyze) {
@@ -9778,7 +10080,7 @@ static int ddguard_bdb_cursor_move(struct sql_thread *thd, BtCursor *pCur,
         rc = IX_PASTEOF;
     }
 
-    if (*bdberr == 0) {
+    if (*bdberr == 0 && !(flags & CURSOR_MOVE_BATCHED)) {
         int rc2 = cursor_move_postop(pCur);
         if (rc2) {
             logmsg(LOGMSG_ERROR, "cursor_move_postop returned %d\n", rc2);
@@ -9990,6 +10292,17 @@ int sqlite3BtreeCount(BtCursor *pCur, i64 *pnEntry)
         rc = SQLITE_OK;
     } else if (pCur->cursor_count) {
         rc = pCur->cursor_count(pCur, &count);
+    } else if (!pCur->clnt->intrans &&
+               pCur->clnt->dbtran.mode != TRANLEVEL_SNAPISOL &&
+               pCur->clnt->dbtran.mode != TRANLEVEL_SERIAL &&
+               (pCur->cursor_class == CURSORCLASS_TABLE ||
+                (pCur->cursor_class == CURSORCLASS_INDEX &&
+                 !pCur->db->ix_partial)) &&
+               bdb_rowcount(pCur->db->handle, (int64_t *)&count) == 0) {
+        /* maintained row count; every row has an entry in a full index */
+        pCur->nfind++;
+        thd->cost += pCur->find_cost;
+        rc = SQLITE_OK;
     } else if (gbl_direct_count && !pCur->clnt->intrans &&
                pCur->clnt->dbtran.mode != TRANLEVEL_SNAPISOL &&
                pCur->clnt->dbtran.mode != TRANLEVEL_SERIAL &&
@@ -10047,6 +10360,303 @@ int sqlite3BtreeCount(BtCursor *pCur, i64 *pnEntry)
     return rc;
 }
 
+/* With parallel_agg on, the aggregates of a SELECT without WHERE or GROUP BY
+ * (count, and sum/min/max of integer columns) are computed by a thread per
+ * data stripe, each decoding its own rows, and the per-stripe results merged
+ * here.  Anything the threads cannot compute exactly as the vdbe would (an
+ * unsigned value above the int64 range, a sum that overflows) makes us fall
+ * back to the regular aggregate loop. */
+int gbl_parallel_agg = 0;
+int gbl_sql_stripe_aggs = 0; /* queries answered by the stripe threads */
+
+struct stripe_agg_part {
+    i64 cnt; /* non-null values */
+    i64 val; /* sum, min or max */
+};
+
+struct stripe_agg_arg {
+    struct dbtable *db;
+    struct sqlclntstate *clnt;
+    int nagg;
+    const int *agg; /* (function, column, register) triples */
+    struct stripe_agg_part *part;
+    int64_t nrows;
+    uint8_t *buf; /* older version row converted to the current schema */
+    int rc;       /* -1: cannot be done this way, else an sqlite error */
+};
+
+static int stripe_agg_row(void *varg, unsigned long long genid, void *dta,
+                          int dtalen, uint8_t ver)
+{
+    struct stripe_agg_arg *arg = varg;
+    struct schema *sc = arg->db->schema;
+    uint8_t *rec = dta;
+    int i;
+
+#ifdef _LINUX_SOURCE
+    struct field_conv_opts convopts = {.flags = FLD_CONV_LENDIAN};
+#else
+    struct field_conv_opts convopts = {.flags = 0};
+#endif
+
+    if ((++arg->nrows & 0xfff) == 0) {
+        if (arg->clnt->stop_this_statement) {
+            arg->rc = SQLITE_BUSY;
+            return 1;
+        }
+        if (arg->clnt->statement_timedout) {
+            arg->rc = SQLITE_LIMIT;
+            return 1;
+        }
+    }
+
+    if (ver && ver != arg->db->version) {
+        if (dtalen > arg->db->lrl) {
+            arg->rc = -1;
+            return 1;
+        }
+        memcpy(arg->buf, dta, dtalen);
+        vtag_to_ondisk_vermap(arg->db, arg->buf, NULL, ver);
+        rec = arg->buf;
+    }
+
+    for (i = 0; i < arg->nagg; i++) {
+        const int *a = &arg->agg[i * 3];
+        struct stripe_agg_part *p = &arg->part[i];
+        struct field *f;
+        uint8_t *in;
+        i64 v;
+        int null, outdtsz, rc;
+
+        if (a[0] == BTREE_STRIPEAGG_COUNTSTAR)
+            continue;
+        f = &sc->member[a[1]];
+        in = rec + f->offset;
+        if (stype_is_null(in))
+            continue;
+        if (a[0] == BTREE_STRIPEAGG_COUNT) {
+            p->cnt++;
+            continue;
+        }
+        if (f->type == SERVER_BINT)
+            rc = SERVER_BINT_to_CLIENT_INT(in, f->len, NULL, NULL, &v,
+                                           sizeof(v), &null, &outdtsz,
+                                           &convopts, NULL);
+        else
+            rc = SERVER_UINT_to_CLIENT_INT(in, f->len, NULL, NULL, &v,
+                                           sizeof(v), &null, &outdtsz,
+                                           &convopts, NULL);
+        if (rc) {
+            arg->rc = -1;
+            return 1;
+        }
+        if (null)
+            continue;
+        if (p->cnt++ == 0) {
+            p->val = v;
+            continue;
+        }
+        switch (a[0]) {
+        case BTREE_STRIPEAGG_SUM:
+            if (sqlite3AddInt64(&p->val, v)) {
+                arg->rc = -1;
+                return 1;
+            }
+            break;
+        case BTREE_STRIPEAGG_MIN:
+            if (v < p->val)
+                p->val = v;
+            break;
+        case BTREE_STRIPEAGG_MAX:
+            if (v > p->val)
+                p->val = v;
+            break;
+        }
+    }
+    return 0;
+}
+
+/* Can the aggregates be computed by stripe?  count() is fine on any column,
+ * sum/min/max need an integer one. */
+static int stripe_agg_ok(BtCursor *pCur, int nAgg, const int *aAgg)
+{
+    struct sqlclntstate *clnt = pCur->clnt;
+    int i;
+
+    if (!gbl_parallel_agg || pCur->cursor_class != CURSORCLASS_TABLE ||
+        !pCur->db || !pCur->bdbcur || pCur->is_recording || clnt->intrans ||
+        clnt->dbtran.mode == TRANLEVEL_SNAPISOL ||
+        clnt->dbtran.mode == TRANLEVEL_SERIAL)
+        return 0;
+
+    for (i = 0; i < nAgg; i++) {
+        const int *a = &aAgg[i * 3];
+        if (a[0] == BTREE_STRIPEAGG_COUNTSTAR)
+            continue;
+        if (a[1] < 0 || a[1] >= pCur->db->schema->nmembers)
+            return 0;
+        if (a[0] == BTREE_STRIPEAGG_COUNT)
+            continue;
+        switch (pCur->db->schema->member[a[1]].type) {
+        case SERVER_BINT:
+        case SERVER_UINT:
+            break;
+        default:
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ ** Compute the nAgg aggregates described by aAgg[] over the table opened by
+ ** pCur, a stripe at a time.  On success the final values are stored in the
+ ** aMem registers named by aAgg[] and *pDone is set; if it cannot be done
+ ** this way *pDone is left at 0 and SQLITE_OK is returned.
+ */
+int sqlite3BtreeStripeAgg(BtCursor *pCur, int nAgg, const int *aAgg,
+                          Mem *aMem, int *pDone)
+{
+    struct sql_thread *thd = pCur->thd;
+    struct stripe_agg_arg *args = NULL;
+    struct stripe_agg_part *parts = NULL;
+    void **fnargs = NULL;
+    int64_t nrows = 0;
+    int nretries = 0;
+    int max_retries;
+    int stripes;
+    int i, j;
+    int rc = SQLITE_OK;
+
+    *pDone = 0;
+    if (!stripe_agg_ok(pCur, nAgg, aAgg))
+        return SQLITE_OK;
+
+    stripes = get_nr_dtastripe_files(pCur->db->handle);
+    args = calloc(stripes, sizeof(struct stripe_agg_arg));
+    parts = calloc(stripes * nAgg, sizeof(struct stripe_agg_part));
+    fnargs = calloc(stripes, sizeof(void *));
+    if (!args || !parts || !fnargs)
+        goto out;
+    for (i = 0; i < stripes; i++) {
+        if ((args[i].buf = malloc(pCur->db->lrl)) == NULL)
+            goto out;
+    }
+
+    max_retries =
+        gbl_move_deadlk_max_attempt >= 0 ? gbl_move_deadlk_max_attempt : 500;
+    do {
+        memset(parts, 0, stripes * nAgg * sizeof(struct stripe_agg_part));
+        for (i = 0; i < stripes; i++) {
+            args[i].db = pCur->db;
+            args[i].clnt = pCur->clnt;
+            args[i].nagg = nAgg;
+            args[i].agg = aAgg;
+            args[i].part = &parts[i * nAgg];
+            args[i].nrows = 0;
+            args[i].rc = 0;
+            fnargs[i] = &args[i];
+        }
+        rc = bdb_stripe_scan(pCur->bdbcur, stripe_agg_row, fnargs,
+                             gbl_parallel_agg);
+        if (rc == BDBERR_DEADLOCK &&
+            recover_deadlock(thedb->bdb_env, thd, NULL, 0)) {
+            break;
+        }
+    } while (rc == BDBERR_DEADLOCK && nretries++ < max_retries);
+
+    if (rc == BDBERR_DEADLOCK) {
+        rc = SQLITE_DEADLOCK;
+        goto out;
+    }
+    if (rc == 1) {
+        /* stopped: cancelled, timed out, or not computable by stripe */
+        rc = SQLITE_OK;
+        for (i = 0; i < stripes; i++) {
+            if (args[i].rc > 0) {
+                rc = args[i].rc;
+                break;
+            }
+        }
+        goto out;
+    }
+    if (rc) {
+        /* let the regular loop find and report whatever went wrong */
+        rc = SQLITE_OK;
+        goto out;
+    }
+
+    for (i = 0; i < stripes; i++)
+        nrows += args[i].nrows;
+    for (j = 0; j < nAgg; j++) {
+        const int *a = &aAgg[j * 3];
+        struct stripe_agg_part tot = {0};
+
+        for (i = 0; i < stripes; i++) {
+            struct stripe_agg_part *p = &parts[i * nAgg + j];
+            if (p->cnt == 0)
+                continue;
+            if (tot.cnt == 0) {
+                tot = *p;
+                continue;
+            }
+            tot.cnt += p->cnt;
+            switch (a[0]) {
+            case BTREE_STRIPEAGG_SUM:
+                /* overflow: the regular loop raises the error */
+                if (sqlite3AddInt64(&tot.val, p->val))
+                    goto out;
+                break;
+            case BTREE_STRIPEAGG_MIN:
+                if (p->val < tot.val)
+                    tot.val = p->val;
+                break;
+            case BTREE_STRIPEAGG_MAX:
+                if (p->val > tot.val)
+                    tot.val = p->val;
+                break;
+            }
+        }
+
+        switch (a[0]) {
+        case BTREE_STRIPEAGG_COUNTSTAR:
+            sqlite3VdbeMemSetInt64(&aMem[a[2]], nrows);
+            break;
+        case BTREE_STRIPEAGG_COUNT:
+            sqlite3VdbeMemSetInt64(&aMem[a[2]], tot.cnt);
+            break;
+        default:
+            if (tot.cnt)
+                sqlite3VdbeMemSetInt64(&aMem[a[2]], tot.val);
+            else
+                sqlite3VdbeMemSetNull(&aMem[a[2]]);
+            break;
+        }
+    }
+    *pDone = 1;
+    ATOMIC_ADD(gbl_sql_stripe_aggs, 1);
+
+    pCur->nfind++;
+    pCur->nmove += nrows;
+    thd->had_tablescans = 1;
+    thd->cost += pCur->find_cost + (pCur->move_cost * nrows);
+
+out:
+    if (args) {
+        for (i = 0; i < stripes; i++)
+            free(args[i].buf);
+    }
+    free(args);
+    free(parts);
+    free(fnargs);
+
+    reqlog_logf(pCur->bt->reqlogger, REQL_TRACE,
+                "StripeAgg(pCur %d)  = %s done %d\n", pCur->cursorid,
+                sqlite3ErrStr(rc), *pDone);
+
+    return rc;
+}
+
 /*
  ** Return the size of a BtCursor object in bytes.
  **
@@ -10550,13 +11160,18 @@ const char *comdb2_get_sql(void)
 }
 
 int gbl_fdb_track_hints = 0;
-static void sqlite3BtreeCursorHint_Range(BtCursor *pCur, const Expr *pExpr)
+static void sqlite3BtreeCursorHint_Range(BtCursor *pCur, const Expr *pExpr,
+                                         Mem *aMem)
 {
     char *expr = "?no vdbe engine?";
 
-    if (pCur && pCur->bt && pCur->bt->is_remote) {
+    if (pCur && pCur->bt && !pCur->bt->is_remote) {
+        cursor_filter_set(pCur, pExpr, aMem);
+    } else if (pCur && pCur->bt && pCur->bt->is_remote) {
         expr = sqlite3ExprDescribeAtRuntime(pCur->vdbe, pExpr);
-        if (!expr) /* failed hinting, calling sqlite engine will catch it */
+        /* failed hinting, calling sqlite engine will catch it; a pushed down
+         * select has nothing to fall back on, the cursor fails it instead */
+        if (!expr && pExpr->op != TK_SELECT)
             return;
 
         if (pCur->fdbc) {
@@ -10567,7 +11182,7 @@ static void sqlite3BtreeCursorHint_Range(BtCursor *pCur, const Expr *pExpr)
         }
 
         if (gbl_fdb_track_hints)
-            logmsg(LOGMSG_USER, "Hint \"%s\"\n", expr);
+            logmsg(LOGMSG_USER, "Hint \"%s\"\n", expr ? expr : "?");
 
         sqlite3DbFree(pCur->sqlite, expr);
     }
@@ -10602,7 +11217,7 @@ void sqlite3BtreeCursorHint(BtCursor *pCur, int eHintType, ...)
         Expr *expr = va_arg(ap, Expr *);
         Mem *mem = va_arg(ap, struct Mem *);
 
-        sqlite3BtreeCursorHint_Range(pCur, expr);
+        sqlite3BtreeCursorHint_Range(pCur, expr, mem);
 
         break;
     }
@@ -11112,6 +11727,65 @@ int stat_bt_hash_table_reset(char *table)
 
     return 0;
 }
+
+/* Start (enable=1) or stop maintaining the row count of a table.  Counting
+ * is done under the table write lock; replicants pick up the change through
+ * the scdone record. */
+int rowcount_table(char *table, int enable)
+{
+    struct dbtable *db;
+    bdb_state_type *bdb_state;
+    struct ireq iq;
+    tran_type *tran = NULL;
+    int rc, bdberr = 0;
+    int64_t count;
+
+    db = get_dbtable_by_name(table);
+    if (db == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: invalid table %s\n", __func__, table);
+        return -1;
+    }
+
+    bdb_state = (bdb_state_type *)db->handle;
+    init_fake_ireq(thedb, &iq);
+    iq.usedb = db;
+
+    if ((bdb_rowcount(bdb_state, &count) == 0) == (enable != 0)) {
+        logmsg(LOGMSG_WARN, "Table %s %s a maintained row count\n", table,
+               enable ? "already has" : "does not have");
+        return 0;
+    }
+
+    rc = trans_start(&iq, NULL, &tran);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: trans_start rc %d\n", __func__, rc);
+        return -1;
+    }
+    bdb_lock_table_write(bdb_state, tran);
+
+    rc = bdb_rowcount_enable(bdb_state, tran, enable, &bdberr);
+    if (rc == 0)
+        rc = bdb_llog_scdone_tran(bdb_state, rowcount, tran, NULL, &bdberr);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: table %s rc %d bdberr %d\n", __func__,
+               table, rc, bdberr);
+        trans_abort(&iq, tran);
+        bdb_rowcount_load(bdb_state, NULL);
+        return -1;
+    }
+
+    rc = trans_commit(&iq, tran, gbl_mynode);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: trans_commit rc %d\n", __func__, rc);
+        bdb_rowcount_load(bdb_state, NULL);
+        return -1;
+    }
+
+    logmsg(LOGMSG_USER, "%s row count for table %s\n",
+           enable ? "Maintaining" : "Dropped", table);
+    return 0;
+}
+
 /**
  * Retrieve the schema version for table
  *
@@ -153,6 +153,7 @@ extern int gbl_dump_sql_dispatched; /* dump all sql strings dispatched */
 int gbl_dump_fsql_response = 0;
 extern int gbl_time_osql; /* dump timestamps for osql steps */
 extern int gbl_time_fdb;  /* dump timestamps for remote sql */
+extern int gbl_fdb_stream_window;
 extern int gbl_print_syntax_err;
 extern int gbl_max_sqlcache;
 extern int gbl_track_sqlengine_states;
@@ -447,6 +448,67 @@ void sqlite_init_end(void) { in_init = 0; }
 #endif // DEBUG_SQLITE_MEMORY
 
 static __thread comdb2ma sql_mspace = NULL;
+
+/* Sqlite heap held by this thread, and the statement it is running: usage
+   when the statement started, its high-water mark, and the cap it may not
+   grow past (0 for none) */
+static __thread long long sqlmem_used;
+static __thread long long sqlmem_base;
+static __thread long long sqlmem_peak;
+static __thread long long sqlmem_limit;
+static __thread int sqlmem_capped;
+
+int gbl_sql_stmt_mem_cap = 0; /* megabytes */
+
+static void sql_mem_stmt_begin(struct sqlclntstate *clnt)
+{
+    long long cap = clnt->sql_mem_cap >= 0
+                        ? clnt->sql_mem_cap
+                        : gbl_sql_stmt_mem_cap * 1024LL * 1024;
+    sqlmem_base = sqlmem_peak = sqlmem_used;
+    sqlmem_limit = cap > 0 ? sqlmem_used + cap : 0;
+    sqlmem_capped = 0;
+}
+
+static void sql_mem_stmt_end(struct sqlclntstate *clnt)
+{
+    long long peak = sqlmem_peak - sqlmem_base;
+
+    if (clnt->rawnodestats)
+        nodestats_note_sql_mem(clnt->rawnodestats, peak);
+    if (sqlmem_capped)
+        logmsg(LOGMSG_USER,
+               "[%s] statement hit its memory cap of %lld bytes: %s\n",
+               clnt->origin, sqlmem_limit - sqlmem_base, clnt->sql);
+    sqlmem_base = sqlmem_peak = sqlmem_used;
+    sqlmem_limit = 0;
+    sqlmem_capped = 0;
+}
+
+/* Sqlite spills its sorter and page cache earlier once a statement has used
+   three quarters of its cap */
+int sql_mem_nearly_full(void)
+{
+    if (sqlmem_limit == 0)
+        return 0;
+    return (sqlmem_used - sqlmem_base) * 4 >= (sqlmem_limit - sqlmem_base) * 3;
+}
+
+static inline int sql_mem_over_cap(long long grow)
+{
+    if (sqlmem_limit == 0 || sqlmem_used + grow <= sqlmem_limit)
+        return 0;
+    sqlmem_capped = 1;
+    return 1;
+}
+
+static inline void sql_mem_account(long long delta)
+{
+    sqlmem_used += delta;
+    if (sqlmem_used > sqlmem_peak)
+        sqlmem_peak = sqlmem_used;
+}
+
 int sql_mem_init(void *arg)
 {
     if (unlikely(sql_mspace)) {
@@ -485,7 +547,12 @@ static void *sql_mem_malloc(int size)
     if (unlikely(sql_mspace == NULL))
         sql_mem_init(NULL);
 
+    if (sql_mem_over_cap(size))
+        return NULL;
+
     void *out = comdb2_malloc(sql_mspace, size);
+    if (out)
+        sql_mem_account(comdb2_malloc_usable_size(out));
 
 #ifdef DEBUG_SQLITE_MEMORY
     struct blk *b = malloc(sizeof(struct blk));
@@ -518,6 +585,8 @@ static void sql_mem_free(void *mem)
     hash_del(sql_blocks, b);
     free(b);
 #endif
+    if (mem)
+        sqlmem_used -= comdb2_malloc_usable_size(mem);
     comdb2_free(mem);
 }
 
@@ -526,7 +595,15 @@ static void *sql_mem_realloc(void *mem, int size)
     if (unlikely(sql_mspace == NULL))
         sql_mem_init(NULL);
 
+    long long oldsz = mem ? comdb2_malloc_usable_size(mem) : 0;
+    if (size > oldsz && sql_mem_over_cap(size - oldsz))
+        return NULL;
+
     void *out = comdb2_realloc(sql_mspace, mem, size);
+    if (out)
+        sql_mem_account((long long)comdb2_malloc_usable_size(out) - oldsz);
+    else if (size == 0)
+        sqlmem_used -= oldsz; /* comdb2_realloc freed it */
 
 #ifdef DEBUG_SQLITE_MEMORY
     struct blk *b;
@@ -2283,6 +2360,9 @@ static void query_stats_setup(struct sqlthdstate *thd,
     if (clnt->rawnodestats)
         clnt->rawnodestats->sql_queries++;
 
+    /* sqlite heap accounting and cap */
+    sql_mem_stmt_begin(clnt);
+
     /* sql thread stats */
     thd->sqlthd->startms = comdb2_time_epochms();
     thd->sqlthd->stime = comdb2_time_epoch();
@@ -3174,6 +3254,7 @@ static void sqlite_done(struct sqlthdstate *thd, struct sqlclntstate *clnt,
 {
     sqlite3_stmt *stmt = rec->stmt;
 
+    sql_mem_stmt_end(clnt);
     sql_statement_done(thd->sqlthd, thd->logger, clnt, outrc);
 
     if (stmt && !((Vdbe *)stmt)->explain && ((Vdbe *)stmt)->nScan > 1 &&
@@ -4098,6 +4179,7 @@ void reset_clnt(struct sqlclntstate *clnt, SBUF2 *sb, int initial)
     clnt->planner_effort =
         bdb_attr_get(thedb->bdb_attr, BDB_ATTR_PLANNER_EFFORT);
     clnt->osql_max_trans = g_osql_max_trans;
+    clnt->sql_mem_cap = -1;
 
     clnt->arr = NULL;
     clnt->selectv_arr = NULL;
@@ -4611,6 +4693,9 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
     int rc = 0;
     int tmp;
     int sent;
+    int batch = 1;    /* rows to send before the next flush */
+    int nbatched = 0; /* rows sent since the last one */
+    int nogenid = (clnt->fdb_state.flags == FDB_RUN_SQL_NOGENID);
 
     if (!clnt->fdb_state.remote_sql_sb) {
         while ((ret = sqlite3_step(stmt)) == SQLITE_ROW)
@@ -4651,7 +4736,22 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
                 /* now we have the packed sqlite row in Mem->z */
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_FNDMORE,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID,
+                                     nogenid);
+
+                /* rows stream out in batches, the first one a single row so
+                   the cursor can start, then twice as many each time up to
+                   fdb_stream_window rows; the cursor stops us by closing the
+                   socket, which shows when a batch fails to go out */
+                if (!rc && ++nbatched >= batch) {
+                    if (sbuf2flush(clnt->fdb_state.remote_sql_sb) < 0)
+                        rc = -1;
+                    nbatched = 0;
+                    if (batch < gbl_fdb_stream_window)
+                        batch = (2 * batch < gbl_fdb_stream_window)
+                                    ? 2 * batch
+                                    : gbl_fdb_stream_window;
+                }
                 if (rc) {
                     /*
                     fprintf(stderr, "%s: failed to send back sql row\n",
@@ -4691,11 +4791,13 @@ static int execute_sql_query_offload_inner_loop(struct sqlclntstate *clnt,
             if (sent == 1) {
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_FND,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID,
+                                     nogenid);
             } else {
                 rc = fdb_svc_sql_row(clnt->fdb_state.remote_sql_sb, cid, res.z,
                                      res.n, IX_EMPTY,
-                                     clnt->osql.rqid == OSQL_RQID_USE_UUID);
+                                     clnt->osql.rqid == OSQL_RQID_USE_UUID,
+                                     nogenid);
             }
             if (rc) {
                 /*
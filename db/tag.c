@@ -59,6 +59,7 @@
 #include "views.h"
 #include "debug_switches.h"
 #include "logmsg.h"
+#include "sysutil_membar.h"
 
 extern struct dbenv *thedb;
 extern pthread_mutex_t csc2_subsystem_mtx;
@@ -4095,6 +4096,255 @@ static int stag_to_stag_field(const char *inbuf, char *outbuf, int flags,
     return 0;
 }
 
+/* A t2t kernel is a server -> server conversion compiled once for a pair of
+ * schemas.  A field with the same type and size on both sides becomes a
+ * plain copy (adjacent ones merged into a single memcpy).  Every other field
+ * goes through stag_to_stag_field as before.  Kernels hang off the target
+ * schema and are freed with it, so each schema version builds its own. */
+int gbl_t2t_kernels = 1;
+
+enum {
+    T2T_OP_NOTNULL,  /* fail if the source field is null */
+    T2T_OP_FIELD,    /* interpreted, see stag_to_stag_field */
+    T2T_OP_COPY,     /* memcpy of one or more fields */
+    T2T_OP_BYTES,    /* byte array, nulls are normalised */
+    T2T_OP_CSTR,     /* cstring, bytes past the terminator are zeroed */
+    T2T_OP_DATETIME, /* copy, marking old style datetimes as good */
+    T2T_OP_FLIP      /* invert a descending key field */
+};
+
+struct t2t_op {
+    int op;
+    int to_idx;
+    int from_idx;
+    unsigned int from_off;
+    unsigned int to_off;
+    unsigned int len;
+};
+
+struct t2t_kernel {
+    const struct schema *from;
+    unsigned long long from_serial;
+    int by_position;
+    /* Checks and interpreted fields come first, in field order, so that a
+     * failure names the same field the interpreter would.  The copies and
+     * flips cannot fail and only touch their own output bytes. */
+    int nops;
+    struct t2t_op ops[1];
+};
+
+static pthread_mutex_t t2t_kernel_lk = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long long t2t_schema_serial;
+
+static int t2t_kernel_op(const struct schema *from, const struct schema *to,
+                         int to_idx, int from_idx)
+{
+    const struct field *from_field, *to_field = &to->member[to_idx];
+
+    if (from_idx < 0 || to_field->isExpr ||
+        strcasecmp(to_field->name, "comdb2_seqno") == 0)
+        return T2T_OP_FIELD;
+    from_field = &from->member[from_idx];
+    if (from_field->type != to_field->type || from_field->len != to_field->len ||
+        (from_field->flags & INDEX_DESCEND))
+        return T2T_OP_FIELD;
+
+    switch (to_field->type) {
+    case SERVER_BINT:
+    case SERVER_BREAL:
+        return T2T_OP_COPY;
+    case SERVER_BYTEARRAY:
+        return T2T_OP_BYTES;
+    case SERVER_BCSTR:
+        return T2T_OP_CSTR;
+    case SERVER_DATETIME:
+    case SERVER_DATETIMEUS:
+        return T2T_OP_DATETIME;
+    }
+    return T2T_OP_FIELD;
+}
+
+static struct t2t_kernel *t2t_kernel_build(const struct schema *from,
+                                           const struct schema *to,
+                                           int by_position)
+{
+    struct t2t_kernel *k;
+    struct t2t_op *op;
+    int *map, *kind;
+    int i, pass;
+
+    /* at most a check, a move and a flip per field */
+    k = calloc(1, offsetof(struct t2t_kernel, ops) +
+                      3 * (to->nmembers + 1) * sizeof(struct t2t_op));
+    if (k == NULL)
+        return NULL;
+    k->from = from;
+    k->from_serial = from->serial;
+    k->by_position = by_position;
+
+    map = alloca(to->nmembers * sizeof(int));
+    kind = alloca(to->nmembers * sizeof(int));
+    for (i = 0; i < to->nmembers; i++) {
+        if (by_position)
+            map[i] = i < from->nmembers ? i : -1;
+        else
+            map[i] = find_field_idx_in_tag(from, to->member[i].name);
+        kind[i] = t2t_kernel_op(from, to, i, map[i]);
+    }
+
+    for (pass = 0; pass < 3; pass++) {
+        for (i = 0; i < to->nmembers; i++) {
+            const struct field *to_field = &to->member[i];
+            const struct field *from_field =
+                map[i] >= 0 ? &from->member[map[i]] : NULL;
+            int opcode;
+
+            if (pass == 0) {
+                if (kind[i] == T2T_OP_FIELD)
+                    opcode = T2T_OP_FIELD;
+                else if (to_field->flags & NO_NULL)
+                    opcode = T2T_OP_NOTNULL;
+                else
+                    continue;
+            } else if (pass == 1) {
+                if (kind[i] == T2T_OP_FIELD)
+                    continue;
+                opcode = kind[i];
+            } else {
+                if (kind[i] == T2T_OP_FIELD ||
+                    !(to_field->flags & INDEX_DESCEND))
+                    continue;
+                opcode = T2T_OP_FLIP;
+            }
+
+            op = &k->ops[k->nops];
+            if (opcode == T2T_OP_COPY && k->nops > 0 &&
+                op[-1].op == T2T_OP_COPY &&
+                op[-1].from_off + op[-1].len == from_field->offset &&
+                op[-1].to_off + op[-1].len == to_field->offset) {
+                op[-1].len += to_field->len;
+                continue;
+            }
+            op->op = opcode;
+            op->to_idx = i;
+            op->from_idx = map[i];
+            op->from_off = from_field ? from_field->offset : 0;
+            op->to_off = to_field->offset;
+            op->len = to_field->len;
+            k->nops++;
+        }
+    }
+    return k;
+}
+
+/* Find (or compile) the kernel converting from -> to.  Returns NULL if the
+ * conversion should be interpreted. */
+static struct t2t_kernel *t2t_kernel_get(struct schema *from,
+                                         struct schema *to, int by_position)
+{
+    struct t2t_kernel *k;
+    int i;
+
+    for (i = 0; i < T2T_KERNEL_SLOTS && (k = to->kernels[i]) != NULL; i++) {
+        if (k->from == from && k->from_serial == from->serial &&
+            k->by_position == by_position)
+            return k;
+    }
+    if (i == T2T_KERNEL_SLOTS)
+        return NULL;
+
+    pthread_mutex_lock(&t2t_kernel_lk);
+    if (from->serial == 0)
+        from->serial = ++t2t_schema_serial;
+    for (i = 0; i < T2T_KERNEL_SLOTS && (k = to->kernels[i]) != NULL; i++) {
+        if (k->from == from && k->from_serial == from->serial &&
+            k->by_position == by_position)
+            break;
+    }
+    if (i < T2T_KERNEL_SLOTS && k == NULL) {
+        k = t2t_kernel_build(from, to, by_position);
+        /* readers look the slots up without the lock */
+        SYSUTIL_MEMBAR_StoreStore();
+        to->kernels[i] = k;
+    }
+    pthread_mutex_unlock(&t2t_kernel_lk);
+    return k;
+}
+
+static void t2t_kernels_free(struct schema *to)
+{
+    for (int i = 0; i < T2T_KERNEL_SLOTS; i++) {
+        free(to->kernels[i]);
+        to->kernels[i] = NULL;
+    }
+}
+
+static int t2t_kernel_run(const struct t2t_kernel *k, struct schema *fromsch,
+                          struct schema *tosch, const char *inbuf,
+                          char *outbuf, int flags,
+                          struct convert_failure *fail_reason,
+                          blob_buffer_t *inblobs, blob_buffer_t *outblobs,
+                          int maxblobs, const char *tzname)
+{
+    int rec_srt_off = gbl_sort_nulls_correctly ? 0 : 1;
+    const struct t2t_op *op = k->ops, *end = k->ops + k->nops;
+    const char *in;
+    char *out;
+    int rc, len;
+
+    for (; op < end; op++) {
+        in = inbuf + op->from_off;
+        out = outbuf + op->to_off;
+        switch (op->op) {
+        case T2T_OP_NOTNULL:
+            if (stype_is_null(in)) {
+                if (fail_reason) {
+                    fail_reason->target_field_idx = op->to_idx;
+                    fail_reason->source_field_idx = op->from_idx;
+                    fail_reason->reason =
+                        CONVERT_FAILED_NULL_CONSTRAINT_VIOLATION;
+                }
+                return -1;
+            }
+            break;
+        case T2T_OP_FIELD:
+            rc = stag_to_stag_field(inbuf, outbuf, flags, fail_reason, inblobs,
+                                    outblobs, maxblobs, tzname, op->from_idx,
+                                    op->to_idx, fromsch, tosch);
+            if (rc)
+                return rc;
+            break;
+        case T2T_OP_COPY:
+            memcpy(out, in, op->len);
+            break;
+        case T2T_OP_BYTES:
+            if (stype_is_null(in))
+                set_null(out, op->len);
+            else
+                memcpy(out, in, op->len);
+            break;
+        case T2T_OP_CSTR:
+            if (stype_is_null(in)) {
+                set_null(out, op->len);
+                break;
+            }
+            len = cstrlenlim(in + 1, op->len - 1);
+            memcpy(out, in, len + 1);
+            memset(out + len + 1, 0, op->len - len - 1);
+            break;
+        case T2T_OP_DATETIME:
+            memcpy(out, in, op->len);
+            if (*in == 0)
+                bset(out, data_bit);
+            break;
+        case T2T_OP_FLIP:
+            xorbuf(out + rec_srt_off, op->len - rec_srt_off);
+            break;
+        }
+    }
+    return 0;
+}
+
 /*
  * On success only outblobs will be valid, there is no need to free up inblobs.
  * On failure the caller should free inblobs and outblobs.
@@ -4131,6 +4381,14 @@ static int _stag_to_stag_buf_flags_blobs(
     if (strcmp(fromtag, totag) == 0)
         same_tag = 1;
 
+    if (gbl_t2t_kernels) {
+        struct t2t_kernel *k = t2t_kernel_get(fromsch, tosch, same_tag);
+        if (k)
+            return t2t_kernel_run(k, fromsch, tosch, inbuf, outbuf, flags,
+                                  fail_reason, inblobs, outblobs, maxblobs,
+                                  tzname);
+    }
+
     for (int field = 0; field < tosch->nmembers; field++) {
         int field_idx;
 
@@ -4214,13 +4472,19 @@ int stag_to_stag_buf_cachedmap(int tagmap[], struct schema *from,
         maxblobs = 0;
     }
 
-    for (int field = 0; field < to->nmembers; field++) {
-        rc = stag_to_stag_field(inbuf, outbuf, flags, fail_reason, inblobs,
-                                p_newblobs, maxblobs, NULL, tagmap[field],
-                                field, from, to);
+    struct t2t_kernel *k = gbl_t2t_kernels ? t2t_kernel_get(from, to, 0) : NULL;
+    if (k) {
+        rc = t2t_kernel_run(k, from, to, inbuf, outbuf, flags, fail_reason,
+                            inblobs, p_newblobs, maxblobs, NULL);
+    } else {
+        for (int field = 0; field < to->nmembers; field++) {
+            rc = stag_to_stag_field(inbuf, outbuf, flags, fail_reason, inblobs,
+                                    p_newblobs, maxblobs, NULL, tagmap[field],
+                                    field, from, to);
 
-        if (rc)
-            break;
+            if (rc)
+                break;
+        }
     }
 
     if (inblobs) /* if we were given blobs */
@@ -6037,6 +6301,7 @@ void free_tag_schema(struct schema *sc)
             free(sc->member[i].name);
         free(sc->member);
     }
+    t2t_kernels_free(sc);
     free(sc);
 }
 
@@ -6888,6 +7153,7 @@ void freeschema_internals(struct schema *schema)
         free(schema->sqlitetag);
         schema->sqlitetag = NULL;
     }
+    t2t_kernels_free(schema);
 }
 
 void freeschema(struct schema *schema)
@@ -52,6 +52,9 @@ struct field {
     int blob_index; /* index of this blob, -1 for non blobs */
 };
 
+struct t2t_kernel;
+#define T2T_KERNEL_SLOTS 4
+
 /* A schema for a tag or index.  The schema for the .ONDISK tag will have
  * an array of ondisk index schemas too. */
 struct schema {
@@ -71,6 +74,9 @@ struct schema {
     char *sqlitetag;
     int *datacopy;
     char *where;
+    unsigned long long serial; /* tells cached kernels this schema apart from
+                                  one reallocated at the same address */
+    struct t2t_kernel *kernels[T2T_KERNEL_SLOTS]; /* conversions into here */
     LINKC_T(struct schema) lnk;
 };
 
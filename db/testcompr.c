@@ -16,11 +16,18 @@
 
 /*
 ** Estimate the amount of compression that can be achieved. We sample records
-** from the main data file & blobs and compress them using both zlib and rle*.
+** from the main data file & blobs, compress them with every algorithm we
+** have, and time decompressing them back.
 **
 ** send dbname testcompr: print percent of records which will be sampled.
 ** send dbname testcompr NN: Set percent of records which will be sampled.
 **
+** For zstd with a dictionary we use the table's dictionary if it has one,
+** otherwise we train one from a first pass over the same sample.
+**
+** send dbname zstd train <table> trains a dictionary from such a sample and
+** makes it the table's: rows written from then on are compressed with it.
+**
 ** I also use this to test crle. If testcompr is given a special tablename:
 **  $ comdb2sc.tsk dbname testcompr cdb2justcrle
 ** then, only clre compression in performed. Additionally, the compressed
@@ -30,21 +37,25 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
-#include <alloca.h>
 #include <pthread.h>
 #include <math.h>
+#include <time.h>
 
 #include <comdb2.h>
 #include <sbuf2.h>
 #include <sql.h>
 #include <bdb_api.h>
 #include <bdb_fetch.h>
+#include <bdb_schemachange.h>
 
 #include <compress.h>
 #include <zlib.h>
 #include <comdb2rle.h>
 #include <lz4.h>
+#include <zstd.h>
+#include <zdict.h>
 #include <logmsg.h>
 
 #if LZ4_VERSION_NUMBER < 10701
@@ -55,8 +66,17 @@
 int gbl_testcompr_percent = 10;
 int gbl_testcompr_max = 300000;
 
+extern pthread_mutex_t schema_change_in_progress_mutex;
+
 static const size_t genidsz = sizeof(unsigned long long);
 
+/* dictionary training wants ~100 times the dictionary size in samples; zstd
+ * doesn't look past the first 128KB of a sample */
+#define ZDICT_SAMPLES_PER_BYTE 100
+#define ZDICT_MAX_SAMPLES (4 * 1024 * 1024)
+#define ZDICT_MAX_SAMPLESZ (128 * 1024)
+#define ZDICT_MIN_NSAMPLES 10
+
 typedef struct {
     SBUF2 *sb;
     const char *table;
@@ -66,6 +86,8 @@ typedef struct {
 typedef struct {
     uint64_t dtasz;
     uint64_t blobsz;
+    uint64_t decoded;   /* bytes decompressed back, and */
+    uint64_t decode_ns; /* how long that took */
 } SizeEst;
 
 typedef struct {
@@ -77,173 +99,409 @@ typedef struct {
     size_t blob_len[MAXBLOBS];
     void *blob_ptrs[MAXBLOBS];
 
+    /* scratch: compressed, then decompressed */
+    uint8_t *buf;
+    size_t bufsz;
+
+    ZSTD_CCtx *cctx;
+    ZSTD_DCtx *dctx;
+    ZSTD_CDict *cdict;
+    ZSTD_DDict *ddict;
+    unsigned int dictid; /* the table's, or 0 if we trained our own */
+    int zstd_level;
+
+    /* what dictionaries are trained on */
+    char *samples;
+    size_t *samplesz;
+    unsigned int nsamples;
+    size_t samplelen;
+    size_t maxsamplelen;
+
     SizeEst uncompressed;
     SizeEst rle;
     SizeEst zlib;
     SizeEst crle;
     SizeEst lz4;
+    SizeEst zstd;
+    SizeEst zstd_dict;
     char just_crle;
 } CompStruct;
 
-static int blob_compress(CompStruct *comp)
+/* a callback returns nonzero to stop sampling */
+typedef int (*sample_fn)(CompStruct *);
+#define SAMPLE_DONE 1
+
+static uint64_t now_ns(void)
 {
-    struct dbtable *db = comp->db;
-    const int numblobs = db->numblobs;
-    int bdberr = 0;
-    int rc;
-    int i;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-    const int blob_offset = db->nix + 1;
-    char *crledta;
-    char *rledta;
-    char *zlibdta;
-    char *lz4dta;
+static void tally(SizeEst *est, int isblob, size_t sz, size_t decoded,
+                  uint64_t start)
+{
+    if (isblob)
+        est->blobsz += sz;
+    else
+        est->dtasz += sz;
+    if (start) {
+        est->decode_ns += now_ns() - start;
+        est->decoded += decoded;
+    }
+}
 
-    for (i = 0; i < numblobs; ++i) {
-        if (comp->blob_len[i] == 0)
-            continue;
+static void check_decoded(CompStruct *comp, const char *algo, const void *in,
+                          size_t len, const void *out, size_t outlen)
+{
+    if (outlen != len || memcmp(in, out, len)) {
+        logmsg(LOGMSG_ERROR, "%s: unable to decompress\n", algo);
+        if (comp->just_crle)
+            fsnapf(stdout, in, len);
+    }
+}
 
-        /* Uncompress blob + ODH */
-        comp->uncompressed.blobsz += comp->blob_len[i];
+/* Compress a record or a blob every way we know and decompress it back. A
+ * buffer that doesn't shrink is stored as is, costing its length. */
+static int compress_one(CompStruct *comp, uint8_t *in, size_t len, int isblob)
+{
+    uint8_t *out, *dec;
+    uint64_t start;
+    size_t sz;
+    int rc;
 
-        const size_t len = comp->blob_len[i];
-        void *mallocdta = NULL;
-        if (len < 4 * 1024) {
-            lz4dta = crledta = rledta = zlibdta = alloca(len);
-        } else {
-            lz4dta = crledta = rledta = zlibdta = mallocdta = malloc(len);
+    if (comp->bufsz < 2 * len) {
+        free(comp->buf);
+        if ((comp->buf = malloc(2 * len)) == NULL) {
+            comp->bufsz = 0;
+            return -1;
         }
+        comp->bufsz = 2 * len;
+    }
+    out = comp->buf;
+    dec = comp->buf + len;
+
+    if (isblob)
+        comp->uncompressed.blobsz += len;
+    else
+        comp->uncompressed.dtasz += len;
 
-        /* Comdb2 RLE */
-        Comdb2RLE compress = {
-            .in = comp->blob_ptrs[i],
-            .insz = len,
-            .out = (uint8_t *)crledta,
-            .outsz = comp->blob_len[i],
+    /* Comdb2 RLE */
+    Comdb2RLE compress = {
+        .in = in, .insz = len, .out = out, .outsz = len,
+    };
+    if (compressComdb2RLE(&compress) == 0) {
+        Comdb2RLE d = {
+            .in = out, .insz = compress.outsz, .out = dec, .outsz = len,
         };
-        if (compressComdb2RLE(&compress) == 0) {
-            comp->crle.blobsz += compress.outsz;
-        } else {
-            comp->crle.blobsz += comp->blob_len[i];
-        }
+        start = now_ns();
+        rc = decompressComdb2RLE(&d);
+        tally(&comp->crle, isblob, compress.outsz, len, start);
+        check_decoded(comp, "CRLE", in, len, dec, rc ? 0 : d.outsz);
+    } else { /* No CRLE compression */
+        tally(&comp->crle, isblob, len, 0, 0);
+    }
 
-        if (comp->just_crle)
-            goto out;
-
-        /* RLE 8 */
-        int rlesz =
-            rle8_compress(comp->blob_ptrs[i], comp->blob_len[i], rledta, len);
-        if (rlesz > 0) {
-            comp->rle.blobsz += rlesz;
-        } else { /* No RLE compression for this blob */
-            comp->rle.blobsz += comp->blob_len[i];
-        }
+    if (comp->just_crle)
+        return 0;
 
-        /* zlib */
-        Bytef *dest = (Bytef *)zlibdta;
-        uLongf destLen = (uLongf)len;
-        Bytef *source = (Bytef *)comp->blob_ptrs[i];
-        uLong sourceLen = (uLong)comp->blob_len[i];
-        rc = compress2(dest, &destLen, source, sourceLen, 6);
-        if (rc == Z_OK) {
-            comp->zlib.blobsz += destLen;
-        } else { /* No zlib compression for this blob */
-            comp->zlib.blobsz += comp->blob_len[i];
-        }
+    /* RLE 8 */
+    if ((rc = rle8_compress(in, len, out, len)) > 0) {
+        sz = rc;
+        start = now_ns();
+        rc = rle8_decompress(out, sz, dec, len);
+        tally(&comp->rle, isblob, sz, len, start);
+        check_decoded(comp, "RLE8", in, len, dec, rc < 0 ? 0 : rc);
+    } else { /* No RLE compression */
+        tally(&comp->rle, isblob, len, 0, 0);
+    }
 
-        /* LZ4 */
-        if ((rc = LZ4_compress_default(comp->blob_ptrs[i], lz4dta, len,
-                                             comp->blob_len[i])) <= 0) {
-            comp->lz4.blobsz += comp->blob_len[i];
-        } else {
-            comp->lz4.blobsz += rc;
-        }
+    /* zlib */
+    uLongf destLen = (uLongf)len;
+    if (compress2(out, &destLen, in, (uLong)len, 6) == Z_OK && destLen < len) {
+        uLongf declen = (uLongf)len;
+        start = now_ns();
+        rc = uncompress(dec, &declen, out, destLen);
+        tally(&comp->zlib, isblob, destLen, len, start);
+        check_decoded(comp, "zlib", in, len, dec, rc == Z_OK ? declen : 0);
+    } else { /* No zlib compression */
+        tally(&comp->zlib, isblob, len, 0, 0);
+    }
 
-    out:
-        free(comp->blob_ptrs[i]);
-        comp->blob_ptrs[i] = NULL;
-        free(mallocdta);
+    /* LZ4 */
+    if ((rc = LZ4_compress_default((char *)in, (char *)out, len, len)) > 0) {
+        sz = rc;
+        start = now_ns();
+        rc = LZ4_decompress_safe((char *)out, (char *)dec, sz, len);
+        tally(&comp->lz4, isblob, sz, len, start);
+        check_decoded(comp, "LZ4", in, len, dec, rc < 0 ? 0 : rc);
+    } else { /* No LZ4 compression */
+        tally(&comp->lz4, isblob, len, 0, 0);
+    }
+
+    /* zstd */
+    sz = ZSTD_compressCCtx(comp->cctx, out, len, in, len, comp->zstd_level);
+    if (!ZSTD_isError(sz)) {
+        size_t declen;
+        start = now_ns();
+        declen = ZSTD_decompressDCtx(comp->dctx, dec, len, out, sz);
+        tally(&comp->zstd, isblob, sz, len, start);
+        check_decoded(comp, "zstd", in, len, dec,
+                      ZSTD_isError(declen) ? 0 : declen);
+    } else { /* No zstd compression */
+        tally(&comp->zstd, isblob, len, 0, 0);
+    }
+
+    /* zstd with a dictionary */
+    if (comp->cdict == NULL)
+        return 0;
+    sz = ZSTD_compress_usingCDict(comp->cctx, out, len, in, len, comp->cdict);
+    if (!ZSTD_isError(sz)) {
+        size_t declen;
+        start = now_ns();
+        declen = ZSTD_decompress_usingDDict(comp->dctx, dec, len, out, sz,
+                                            comp->ddict);
+        tally(&comp->zstd_dict, isblob, sz, len, start);
+        check_decoded(comp, "zstd+dict", in, len, dec,
+                      ZSTD_isError(declen) ? 0 : declen);
+    } else { /* No zstd compression */
+        tally(&comp->zstd_dict, isblob, len, 0, 0);
     }
     return 0;
 }
 
 static int test_compress(CompStruct *comp)
 {
-    int rc = 0;
-    char buf[2 * MAXLRL];
+    int rc;
+    int i;
 
-    /* Uncompressed */
-    comp->uncompressed.dtasz += comp->fndlen;
+    rc = compress_one(comp, (uint8_t *)comp->fnddta, comp->fndlen, 0);
+    for (i = 0; rc == 0 && i < comp->db->numblobs; ++i) {
+        if (comp->blob_len[i] == 0)
+            continue;
+        rc = compress_one(comp, comp->blob_ptrs[i], comp->blob_len[i], 1);
+    }
+    return rc;
+}
 
-    /* Comdb2 RLE */
-    Comdb2RLE compress = {
-        .in = (uint8_t *)comp->fnddta,
-        .insz = comp->fndlen,
-        .out = (uint8_t *)buf,
-        .outsz = comp->fndlen,
-    };
-    if (compressComdb2RLE(&compress) == 0) {
-        comp->crle.dtasz += compress.outsz;
-
-        if (comp->just_crle) { /* also decompress */
-            uint8_t dbuf[comp->fndlen];
-            Comdb2RLE d = {.in = compress.out,
-                           .insz = compress.outsz,
-                           .out = dbuf,
-                           .outsz = sizeof(dbuf)};
-            if (decompressComdb2RLE(&d) || d.outsz != compress.insz ||
-                memcmp(compress.in, d.out, d.outsz)) {
-                logmsg(LOGMSG_ERROR, "unable to decompress\n");
-                fsnapf(stdout, compress.in, compress.insz);
+static void add_sample(CompStruct *comp, const void *in, size_t len)
+{
+    size_t *samplesz;
+
+    if (len > ZDICT_MAX_SAMPLESZ)
+        len = ZDICT_MAX_SAMPLESZ;
+    if (len == 0 || comp->samplelen + len > comp->maxsamplelen)
+        return;
+    if ((comp->nsamples & 1023) == 0) {
+        samplesz = realloc(comp->samplesz,
+                           (comp->nsamples + 1024) * sizeof(size_t));
+        if (samplesz == NULL)
+            return;
+        comp->samplesz = samplesz;
+    }
+    memcpy(comp->samples + comp->samplelen, in, len);
+    comp->samplesz[comp->nsamples++] = len;
+    comp->samplelen += len;
+}
+
+static int collect_sample(CompStruct *comp)
+{
+    int i;
+
+    add_sample(comp, comp->fnddta, comp->fndlen);
+    for (i = 0; i < comp->db->numblobs; ++i)
+        add_sample(comp, comp->blob_ptrs[i], comp->blob_len[i]);
+
+    /* full, or close enough that a record won't fit */
+    if (comp->samplelen + MAXLRL > comp->maxsamplelen)
+        return SAMPLE_DONE;
+    return 0;
+}
+
+static void free_blobs(CompStruct *comp)
+{
+    int i;
+    for (i = 0; i < MAXBLOBS; ++i) {
+        free(comp->blob_ptrs[i]);
+        comp->blob_ptrs[i] = NULL;
+        comp->blob_len[i] = 0;
+    }
+}
+
+/* Call fn on a sample of comp->db's records, with their blobs: one in every
+ * 100 / gbl_testcompr_percent, and no more than gbl_testcompr_max records
+ * scanned.  Returns -1 if the scan is aborted, or what fn failed with. */
+static int sample_table(CompStruct *comp, sample_fn fn)
+{
+    struct dbtable *db = comp->db;
+    int skip = round(100.0 / gbl_testcompr_percent - 1.0);
+    int blob_pos[MAXBLOBS];
+    size_t blob_offs[MAXBLOBS];
+    struct ireq iq;
+    int ixnum = -1;
+    uint64_t last;
+    uint64_t fndkey;
+    int lastrrn, rrn;
+    unsigned long long lastgenid;
+    const int maxlen = sizeof(comp->fnddta);
+    unsigned long long context = 0;
+    int total = 1;
+    int frc = 0;
+    int rc;
+    int i;
+
+    if (skip >= 100) {
+        skip = 99;
+    } else if (skip < 0) {
+        skip = 0;
+    }
+    for (i = 0; i < MAXBLOBS; ++i) {
+        blob_pos[i] = i;
+    }
+
+    bzero(&iq, sizeof(iq));
+    iq.dbenv = thedb;
+    iq.is_fake = 1;
+    iq.usedb = db;
+    iq.opcode = OP_FIND;
+
+    rc = ix_find_blobs(&iq, ixnum, NULL, 0, &fndkey, &rrn, &comp->genid,
+                       &comp->fnddta, &comp->fndlen, maxlen, db->numblobs,
+                       blob_pos, comp->blob_len, blob_offs, comp->blob_ptrs,
+                       NULL);
+
+    while (rc == IX_FND || rc == IX_FNDMORE) {
+        if (gbl_sc_abort || db->sc_abort) {
+            logmsg(LOGMSG_ERROR, "Abort compression testing %s\n",
+                   db->tablename);
+            frc = -1;
+            break;
+        }
+        frc = fn(comp);
+        free_blobs(comp);
+        if (frc) {
+            break;
+        }
+
+        if (gbl_testcompr_max && total > gbl_testcompr_max) {
+            break;
+        }
+
+        last = fndkey;
+        lastrrn = rrn;
+        lastgenid = comp->genid;
+
+        int j;
+        for (j = 0; j < skip; ++j) {
+            /* Don't fetch any data */
+            rc = ix_next_blobs(&iq, ixnum, NULL, 0, &last, lastrrn, lastgenid,
+                               &fndkey, &rrn, &comp->genid, NULL, NULL, 0, 0,
+                               NULL, NULL, NULL, NULL, NULL, context);
+            if (rc != IX_FND && rc != IX_FNDMORE) {
+                break;
             }
+            last = fndkey;
+            lastrrn = rrn;
+            lastgenid = comp->genid;
+            ++total;
         }
-    } else { /* No CRLE compression for this record */
-        comp->crle.dtasz += comp->fndlen;
-    }
 
-    if (comp->just_crle)
-        goto blob;
+        if (rc != IX_FND && rc != IX_FNDMORE) {
+            break;
+        }
 
-    /* RLE 8 */
-    int rlesz = rle8_compress(comp->fnddta, comp->fndlen, buf, comp->fndlen);
-    if (rlesz > 0) {
-        comp->rle.dtasz += rlesz;
-    } else { /* No RLE compression for this record */
-        comp->rle.dtasz += comp->fndlen;
+        /* Fetch all data */
+        rc = ix_next_blobs(&iq, ixnum, NULL, 0, &last, lastrrn, lastgenid,
+                           &fndkey, &rrn, &comp->genid, &comp->fnddta,
+                           &comp->fndlen, maxlen, db->numblobs, blob_pos,
+                           comp->blob_len, blob_offs, comp->blob_ptrs, NULL,
+                           context);
+        ++total;
     }
+    free_blobs(comp);
+    return frc == SAMPLE_DONE ? 0 : frc;
+}
 
-    /* zlib */
-    Bytef *dest = (Bytef *)buf;
-    Bytef *source = (Bytef *)comp->fnddta;
-    uLong sourceLen = (uLong)comp->fndlen;
-    uLongf destLen = sourceLen;
-    rc = compress2(dest, &destLen, source, sourceLen, 6);
-    if (rc == Z_OK) {
-        comp->zlib.dtasz += destLen;
-    } else { /* No zlib compression for this record */
-        comp->zlib.dtasz += comp->fndlen;
+/* Train a dictionary of up to dictsz bytes on a sample of comp->db. Returns
+ * it, or NULL if the sample is too small to train on. */
+static void *train_dict(CompStruct *comp, size_t dictsz, size_t *dictlen)
+{
+    void *dict = NULL;
+    size_t rc;
+
+    comp->maxsamplelen = dictsz * ZDICT_SAMPLES_PER_BYTE;
+    if (comp->maxsamplelen > ZDICT_MAX_SAMPLES)
+        comp->maxsamplelen = ZDICT_MAX_SAMPLES;
+    comp->samples = malloc(comp->maxsamplelen);
+    if (comp->samples == NULL)
+        goto out;
+
+    if (sample_table(comp, collect_sample))
+        goto out;
+    if (comp->nsamples < ZDICT_MIN_NSAMPLES) {
+        logmsg(LOGMSG_WARN, "%s: only %u samples in %s, need %d\n", __func__,
+               comp->nsamples, comp->db->tablename, ZDICT_MIN_NSAMPLES);
+        goto out;
     }
 
-    /* LZ4 */
-    if ((rc = LZ4_compress_default(comp->fnddta, buf, comp->fndlen,
-                                         comp->fndlen)) <= 0) {
-        comp->lz4.dtasz += comp->fndlen;
-    } else {
-        comp->lz4.dtasz += rc;
+    if ((dict = malloc(dictsz)) == NULL)
+        goto out;
+    rc = ZDICT_trainFromBuffer(dict, dictsz, comp->samples, comp->samplesz,
+                               comp->nsamples);
+    if (ZDICT_isError(rc)) {
+        logmsg(LOGMSG_ERROR, "%s: table %s: %s\n", __func__,
+               comp->db->tablename, ZDICT_getErrorName(rc));
+        free(dict);
+        dict = NULL;
+        goto out;
     }
+    *dictlen = rc;
+
+out:
+    free(comp->samples);
+    free(comp->samplesz);
+    comp->samples = NULL;
+    comp->samplesz = NULL;
+    comp->nsamples = 0;
+    comp->samplelen = 0;
+    return dict;
+}
 
-blob:
-    rc = 0;
-    if (comp->db->numblobs) {
-        rc = blob_compress(comp);
+static size_t zstd_dict_size(void)
+{
+    return bdb_attr_get(thedb->bdb_attr, BDB_ATTR_ZSTDDICTSIZE);
+}
+
+/* zstd+dict uses the table's dictionary, or one trained on the spot */
+static void setup_dict(CompStruct *comp)
+{
+    const void *dict;
+    void *trained = NULL;
+    size_t dictlen;
+
+    comp->dictid = bdb_zstd_dictid(comp->db->handle);
+    if (comp->dictid == 0 ||
+        bdb_zstd_get_dict(comp->dictid, &dict, &dictlen) != 0) {
+        comp->dictid = 0;
+        if ((dict = trained = train_dict(comp, zstd_dict_size(), &dictlen)) ==
+            NULL)
+            return;
+    }
+    comp->cdict = ZSTD_createCDict(dict, dictlen, comp->zstd_level);
+    comp->ddict = ZSTD_createDDict(dict, dictlen);
+    free(trained);
+    if (comp->cdict == NULL || comp->ddict == NULL) {
+        ZSTD_freeCDict(comp->cdict);
+        ZSTD_freeDDict(comp->ddict);
+        comp->cdict = NULL;
+        comp->ddict = NULL;
     }
-    return rc;
 }
 
 static void print_compr_stat(CompStruct *comp, const char *prefix, SizeEst *est)
 {
     char buf[1024];
-    char szbuf[64];
+    char decbuf[64];
     double cmp_dta, cmp_blob;
     double sav_dta, sav_blob;
     struct dbtable *db = comp->db;
@@ -253,8 +511,9 @@ static void print_compr_stat(CompStruct *comp, const char *prefix, SizeEst *est)
         cmp_dta = cmp_blob = 1;
     } else {
         cmp_dta = (double)est->dtasz / comp->uncompressed.dtasz;
-        cmp_blob =
-            db->numblobs ? (double)est->blobsz / comp->uncompressed.blobsz : 1;
+        cmp_blob = db->numblobs && comp->uncompressed.blobsz
+                       ? (double)est->blobsz / comp->uncompressed.blobsz
+                       : 1;
     }
     sav_dta = /*1.0 -*/ cmp_dta;
     sav_blob = /*1.0 -*/ cmp_blob;
@@ -262,8 +521,15 @@ static void print_compr_stat(CompStruct *comp, const char *prefix, SizeEst *est)
     sav_dta *= 100;
     sav_blob *= 100;
 
-    snprintf(buf, sizeof(buf) - 1, "Using %s: Data: %.2f%% Blobs %.2f%%\n",
-             prefix, sav_dta, sav_blob);
+    if (est->decode_ns)
+        snprintf(decbuf, sizeof(decbuf), "%.1f MB/s",
+                 est->decoded * 1000.0 / est->decode_ns);
+    else
+        snprintf(decbuf, sizeof(decbuf), "n/a");
+
+    snprintf(buf, sizeof(buf) - 1,
+             "Using %s: Data: %.2f%% Blobs %.2f%% Decode: %s\n", prefix,
+             sav_dta, sav_blob, decbuf);
     logmsg(LOGMSG_USER, "%s", buf);
     sbuf2printf(comp->sb, ">%s", buf);
 }
@@ -282,43 +548,53 @@ static void compr_stat(CompStruct *comp)
     print_compr_stat(comp, "RLE8", &comp->rle);
     print_compr_stat(comp, "zlib", &comp->zlib);
     print_compr_stat(comp, " LZ4", &comp->lz4);
+    print_compr_stat(comp, "zstd", &comp->zstd);
+    if (comp->cdict == NULL)
+        return;
+    print_compr_stat(comp, "zstd+dict", &comp->zstd_dict);
+    if (comp->dictid)
+        snprintf(buf, sizeof(buf) - 1, "(zstd dictionary %u)\n", comp->dictid);
+    else
+        snprintf(buf, sizeof(buf) - 1,
+                 "(zstd dictionary trained from this sample)\n");
+    logmsg(LOGMSG_USER, "%s", buf);
+    sbuf2printf(comp->sb, ">%s", buf);
+}
+
+static int comp_init(CompStruct *comp)
+{
+    bzero(comp, sizeof(*comp));
+    comp->zstd_level = bdb_attr_get(thedb->bdb_attr, BDB_ATTR_ZSTDLEVEL);
+    comp->cctx = ZSTD_createCCtx();
+    comp->dctx = ZSTD_createDCtx();
+    if (comp->cctx == NULL || comp->dctx == NULL)
+        return -1;
+    return 0;
+}
+
+static void comp_free(CompStruct *comp)
+{
+    ZSTD_freeCDict(comp->cdict);
+    ZSTD_freeDDict(comp->ddict);
+    ZSTD_freeCCtx(comp->cctx);
+    ZSTD_freeDCtx(comp->dctx);
+    free(comp->buf);
 }
 
 static void *handle_comptest_thd(void *_arg)
 {
     CompArg *arg = _arg;
-    CompStruct comp = {0};
-    int compress;
+    CompStruct comp;
     int rc;
     int i;
-    int blob_pos[MAXBLOBS];
-    size_t blob_offs[MAXBLOBS];
-    int skip = round(100.0 / gbl_testcompr_percent - 1.0);
-
-    struct ireq iq;
-    int ixnum = -1;
-    uint64_t last;
-    uint64_t fndkey;
-    int lastrrn, rrn;
-    unsigned long long lastgenid;
-    const int maxlen = sizeof(comp.fnddta);
-    int fndlen;
-    unsigned long long context = 0;
-
-    int total = 1;
-
-    if (skip >= 100) {
-        skip = 99;
-    } else if (skip < 0) {
-        skip = 0;
-    }
 
     backend_thread_event(thedb, BDBTHR_EVENT_START_RDONLY);
+    if (comp_init(&comp)) {
+        ++arg->rc;
+        goto done;
+    }
     comp.sb = arg->sb;
     comp.just_crle = 0;
-    for (i = 0; i < MAXBLOBS; ++i) {
-        blob_pos[i] = i;
-    }
     for (i = 0; i < thedb->num_dbs; i++) {
         struct dbtable *db = thedb->dbs[i];
         if (strcmp(arg->table, "cdb2justcrle") == 0) {
@@ -340,70 +616,26 @@ static void *handle_comptest_thd(void *_arg)
         bzero(&comp.rle, sizeof(comp.rle));
         bzero(&comp.zlib, sizeof(comp.zlib));
         bzero(&comp.lz4, sizeof(comp.lz4));
-
-        iq.dbenv = thedb;
-        iq.is_fake = 1;
-        iq.usedb = db;
-        iq.opcode = OP_FIND;
-
-        rc = ix_find_blobs(&iq, ixnum, NULL, 0, &fndkey, &rrn, &comp.genid,
-                           &comp.fnddta, &comp.fndlen, maxlen, db->numblobs,
-                           blob_pos, comp.blob_len, blob_offs, comp.blob_ptrs,
-                           NULL);
-
-        while (rc == IX_FND || rc == IX_FNDMORE) {
-            if (gbl_sc_abort || db->sc_abort) {
-                logmsg(LOGMSG_ERROR, "Abort compression testing %s\n",
-                       db->tablename);
-                ++arg->rc;
-                break;
-            }
-            rc = test_compress(&comp);
-            if (rc) {
-                logmsg(LOGMSG_ERROR, "Failed compressing %s, rc:%d (%s:%d)\n",
-                       db->tablename, rc, __FILE__, __LINE__);
-                ++arg->rc;
-                break;
-            }
-
-            if (gbl_testcompr_max && total > gbl_testcompr_max) {
-                break;
-            }
-
-            last = fndkey;
-            lastrrn = rrn;
-            lastgenid = comp.genid;
-
-            int j;
-            for (j = 0; j < skip; ++j) {
-                /* Don't fetch any data */
-                rc = ix_next_blobs(&iq, ixnum, NULL, 0, &last, lastrrn,
-                                   lastgenid, &fndkey, &rrn, &comp.genid, NULL,
-                                   NULL, 0, 0, NULL, NULL, NULL, NULL, NULL,
-                                   context);
-                if (rc != IX_FND && rc != IX_FNDMORE) {
-                    break;
-                }
-                last = fndkey;
-                lastrrn = rrn;
-                lastgenid = comp.genid;
-                ++total;
-            }
-
-            if (rc != IX_FND && rc != IX_FNDMORE) {
-                break;
-            }
-
-            /* Fetch all data */
-            rc = ix_next_blobs(&iq, ixnum, NULL, 0, &last, lastrrn, lastgenid,
-                               &fndkey, &rrn, &comp.genid, &comp.fnddta,
-                               &comp.fndlen, maxlen, db->numblobs, blob_pos,
-                               comp.blob_len, blob_offs, comp.blob_ptrs, NULL,
-                               context);
-            ++total;
+        bzero(&comp.zstd, sizeof(comp.zstd));
+        bzero(&comp.zstd_dict, sizeof(comp.zstd_dict));
+        ZSTD_freeCDict(comp.cdict);
+        ZSTD_freeDDict(comp.ddict);
+        comp.cdict = NULL;
+        comp.ddict = NULL;
+
+        if (!comp.just_crle)
+            setup_dict(&comp);
+
+        rc = sample_table(&comp, test_compress);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "Failed compressing %s, rc:%d (%s:%d)\n",
+                   db->tablename, rc, __FILE__, __LINE__);
+            ++arg->rc;
         }
         compr_stat(&comp);
     }
+    comp_free(&comp);
+done:
     sbuf2flush(arg->sb);
     backend_thread_event(thedb, BDBTHR_EVENT_DONE_RDONLY);
     return NULL;
@@ -438,3 +670,105 @@ void handle_testcompr(SBUF2 *sb, const char *table)
     }
 }
 
+typedef struct {
+    struct dbtable *db;
+    void *dict;
+    size_t dictlen;
+} TrainArg;
+
+static void *zstd_train_thd(void *_arg)
+{
+    TrainArg *arg = _arg;
+    CompStruct comp;
+
+    backend_thread_event(thedb, BDBTHR_EVENT_START_RDONLY);
+    if (comp_init(&comp) == 0) {
+        comp.db = arg->db;
+        arg->dict = train_dict(&comp, zstd_dict_size(), &arg->dictlen);
+    }
+    comp_free(&comp);
+    backend_thread_event(thedb, BDBTHR_EVENT_DONE_RDONLY);
+    return NULL;
+}
+
+/* Train a zstd dictionary on a sample of the table's rows and make it the
+ * dictionary the table compresses with.  Rows already written keep the
+ * dictionary they were compressed with.  Replicants pick up the change
+ * through the scdone record. */
+int zstd_train_table(const char *table)
+{
+    TrainArg arg = {0};
+    struct ireq iq;
+    tran_type *tran = NULL;
+    bdb_state_type *bdb_state;
+    unsigned int dictid;
+    pthread_t t;
+    void *thdrc;
+    int rc, bdberr = 0;
+
+    arg.db = get_dbtable_by_name(table);
+    if (arg.db == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: invalid table %s\n", __func__, table);
+        return -1;
+    }
+    bdb_state = arg.db->handle;
+
+    pthread_mutex_lock(&schema_change_in_progress_mutex);
+    if (gbl_schema_change_in_progress) {
+        pthread_mutex_unlock(&schema_change_in_progress_mutex);
+        logmsg(LOGMSG_ERROR, "Schema change already running\n");
+        return -1;
+    }
+    gbl_schema_change_in_progress = 1;
+    pthread_mutex_unlock(&schema_change_in_progress_mutex);
+    gbl_sc_abort = 0;
+    rc = pthread_create(&t, NULL, zstd_train_thd, &arg);
+    if (rc == 0)
+        pthread_join(t, &thdrc);
+    else
+        logmsg(LOGMSG_ERROR, "%s: pthread_create rc %d\n", __func__, rc);
+    pthread_mutex_lock(&schema_change_in_progress_mutex);
+    gbl_schema_change_in_progress = 0;
+    pthread_mutex_unlock(&schema_change_in_progress_mutex);
+
+    if (arg.dict == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: couldn't train a dictionary for %s\n",
+               __func__, table);
+        return -1;
+    }
+
+    init_fake_ireq(thedb, &iq);
+    iq.usedb = arg.db;
+
+    rc = trans_start(&iq, NULL, &tran);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: trans_start rc %d\n", __func__, rc);
+        free(arg.dict);
+        return -1;
+    }
+    bdb_lock_table_write(bdb_state, tran);
+
+    rc = bdb_zstd_add_dict(bdb_state, tran, arg.dict, arg.dictlen, &dictid,
+                           &bdberr);
+    if (rc == 0)
+        rc = bdb_llog_scdone_tran(bdb_state, zstd_dict, tran, NULL, &bdberr);
+    free(arg.dict);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: table %s rc %d bdberr %d\n", __func__,
+               table, rc, bdberr);
+        trans_abort(&iq, tran);
+        return -1;
+    }
+
+    rc = trans_commit(&iq, tran, gbl_mynode);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: trans_commit rc %d\n", __func__, rc);
+        return -1;
+    }
+
+    bdb_zstd_load(bdb_state, NULL);
+    logmsg(LOGMSG_USER,
+           "Table %s compresses with zstd dictionary %u, %zu bytes\n", table,
+           dictid, arg.dictlen);
+    return 0;
+}
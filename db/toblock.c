@@ -2216,6 +2216,7 @@ static int toblock_outer(struct ireq *iq, block_state_t *blkstate)
         memcpy(&blkstate_copy, blkstate, sizeof(block_state_t));
         newiq.thdinfo = NULL;
         newiq.reqlogger = NULL;
+        newiq.arena = NULL;
 
         /* try to give away this buffer to a toblock_prefault_thread*/
         rc = pthread_mutex_lock(&(iq->dbenv->prefault_helper.mutex));
@@ -2294,6 +2295,9 @@ static int toblock_outer(struct ireq *iq, block_state_t *blkstate)
 
         bdb_stripe_done(iq->dbenv->bdb_env);
 
+        /* the transaction is over; keep the chunks for a retry */
+        ireq_arena_rewind(iq);
+
         if (gotlk)
             pthread_rwlock_unlock(&gbl_block_qconsume_lock);
     }
@@ -5584,9 +5588,17 @@ add_blkseq:
         memcpy(p_buf_fstblk, &t, sizeof(int));
 
         if (!rowlocks) {
+            int rcbdberr;
+            /* maintained row counts are written with the rest of the
+             * transaction; a deadlock here retries the whole request */
+            if (parent_trans && bdb_rowcount_flush(parent_trans, &rcbdberr)) {
+                rc = (rcbdberr == BDBERR_DEADLOCK) ? RC_INTERNAL_RETRY
+                                                   : ERR_INTERNAL;
+            }
             // if RC_INTERNAL_RETRY && replicant_can_retry don't add to blkseq
-            if (outrc == ERR_BLOCK_FAILED && err.errcode == ERR_VERIFY &&
-                (iq->have_snap_info && iq->snap_info.replicant_can_retry)) {
+            else if (outrc == ERR_BLOCK_FAILED && err.errcode == ERR_VERIFY &&
+                     (iq->have_snap_info &&
+                      iq->snap_info.replicant_can_retry)) {
                 /* do nothing */
             } else {
                 rc = bdb_blkseq_insert(thedb->bdb_env, parent_trans, bskey,
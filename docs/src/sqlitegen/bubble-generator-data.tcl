@@ -284,8 +284,8 @@ set all_graphs {
       {line IPU OFF}
       {line ISC OFF}
       {line REBUILD}
-      {line REC {or CRLE LZ4 RLE ZLIB}}
-      {line BLOBFIELD {or LZ4 RLE ZLIB}}
+      {line REC {or CRLE LZ4 RLE ZLIB ZSTD}}
+      {line BLOBFIELD {or LZ4 RLE ZLIB ZSTD}}
     } ,} 
   }
 
@@ -77,6 +77,9 @@ void *debug_clnt;
 pthread_mutex_t lua_debug_mutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t lua_debug_cond = PTHREAD_COND_INITIALIZER;
 
+/* Max queue events a trigger runs and consumes in one transaction. */
+int gbl_lua_trigger_batch = 1;
+
 struct tmptbl_info_t {
     int rootpg;
     char *sql;
@@ -126,6 +129,11 @@ typedef struct {
     struct consumer *consumer;
     genid_t genid;
 
+    /* items returned by next_batch(), for consume_batch() */
+    genid_t *batch;
+    int nbatch;
+    int batchsz;
+
     /* signaling from libdb on qdb insert */
     pthread_mutex_t *lock;
     pthread_cond_t *cond;
@@ -642,18 +650,106 @@ static int dbq_pushargs(Lua L, dbconsumer_t *q, struct qfound *f)
     return rc;
 }
 
+// Commits to the queue signal q->cond (see __txn_trigger_wakeup), so this
+// is only how often an idle consumer wakes up to check retry conditions.
 static const int dbq_delay = 1000; // ms
+#define DBQ_MAX_BATCH 1000
+// Read up to max items off the head of the queue with one cursor; push a
+// Lua array of them and remember their genids for consume_batch().
+// Same locking and return codes as dbq_poll_int.
+static int dbq_poll_batch_int(Lua L, dbconsumer_t *q, int max)
+{
+    void *items[max];
+    size_t lens[max];
+    int n = 0;
+    int rc = dbq_get_batch(&q->iq, 0, NULL, max, items, lens, &n);
+    getsp(L)->num_instructions = 0;
+    if (rc == IX_NOTFND) {
+        return 0;
+    }
+    pthread_mutex_unlock(q->lock);
+    if (rc != 0) {
+        return -1;
+    }
+    if (q->batchsz < n) {
+        free(q->batch);
+        q->batch = malloc(max * sizeof(genid_t));
+        if (q->batch == NULL) {
+            q->batchsz = 0;
+            q->nbatch = 0;
+            for (int i = 0; i < n; ++i) {
+                free(items[i]);
+            }
+            return -1;
+        }
+        q->batchsz = max;
+    }
+    q->nbatch = 0;
+    lua_createtable(L, n, 0);
+    for (int i = 0; i < n; ++i) {
+        struct qfound f = {.item = items[i],
+                           .len = lens[i],
+                           .dtaoff = sizeof(struct bdb_queue_found)};
+        if (dbq_pushargs(L, q, &f) != 1) { // frees item
+            while (++i < n) {
+                free(items[i]);
+            }
+            q->nbatch = 0;
+            q->genid = 0;
+            return -1;
+        }
+        q->batch[q->nbatch++] = q->genid;
+        lua_rawseti(L, -2, i + 1);
+    }
+    q->genid = 0; // consume() is for get()
+    return 1;
+}
+
 // Call with q->lock held.
-// Unlocks q->lock on return.
+// Unlocks q->lock on return, unless IX_NOTFND: then the caller can wait on
+// q->cond without missing a wakeup from a commit which raced with the read.
 // Returns  -2:stopped -1:error  0:IX_NOTFND  1:IX_FND
-// If IX_FND will push Lua table on stack.
-static int dbq_poll_int(Lua L, dbconsumer_t *q)
+// If IX_FND will push Lua table on stack (an array of them if max > 0).
+static int dbq_poll_int(Lua L, dbconsumer_t *q, int max)
 {
+    if (max > 0) {
+        return dbq_poll_batch_int(L, q, max);
+    }
     struct qfound f = {0};
     int rc = dbq_get(&q->iq, 0, NULL, (void**)&f.item, &f.len, &f.dtaoff, NULL, NULL);
+    getsp(L)->num_instructions = 0;
+    if (rc == IX_NOTFND) {
+        return 0;
+    }
+    pthread_mutex_unlock(q->lock);
+    if (rc == 0) {
+        return dbq_pushargs(L, q, &f);
+    }
+    return -1;
+}
+
+// Fetch the item queued after prev without waiting; used to fill a batch.
+// Returns  -1:error  0:caught up  1:IX_FND (pushes Lua table on stack)
+static int dbq_next_int(Lua L, dbconsumer_t *q, genid_t prev)
+{
+    struct dbq_cursor cur = {{0}};
+    struct qfound f = {0};
+    int rc;
+    memcpy(cur.cursordata, &prev, sizeof(prev));
+    pthread_mutex_lock(q->lock);
+    if (*q->open) {
+        rc = dbq_get(&q->iq, 0, &cur, (void **)&f.item, &f.len, &f.dtaoff,
+                     NULL, NULL);
+    } else {
+        rc = IX_NOTFND;
+    }
     pthread_mutex_unlock(q->lock);
     getsp(L)->num_instructions = 0;
     if (rc == 0) {
+        if (f.item->genid == prev) { // positioned on prev itself
+            free(f.item);
+            return 0;
+        }
         return dbq_pushargs(L, q, &f);
     }
     if (rc == IX_NOTFND) {
@@ -662,7 +758,7 @@ static int dbq_poll_int(Lua L, dbconsumer_t *q)
     return -1;
 }
 
-static int dbq_poll(Lua L, dbconsumer_t *q, int delay)
+static int dbq_poll(Lua L, dbconsumer_t *q, int delay, int max)
 {
     SP sp = getsp(L);
     while (1) {
@@ -677,7 +773,7 @@ static int dbq_poll(Lua L, dbconsumer_t *q, int delay)
         }
         pthread_mutex_lock(q->lock);
 again:  if (*q->open) {
-            rc = dbq_poll_int(L, q); // call will release q->lock
+            rc = dbq_poll_int(L, q, max); // releases q->lock unless IX_NOTFND
         } else {
             pthread_mutex_unlock(q->lock);
             rc = -2;
@@ -691,12 +787,12 @@ again:  if (*q->open) {
         }
         delay -= dbq_delay;
         if (delay < 0) {
+            pthread_mutex_unlock(q->lock);
             return 0;
         }
         struct timespec ts;
         clock_gettime(CLOCK_REALTIME, &ts);
         ts.tv_sec += (dbq_delay / 1000);
-        pthread_mutex_lock(q->lock);
         if (pthread_cond_timedwait(q->cond, q->lock, &ts) == 0) {
             // was woken up -- try getting from queue
             goto again;
@@ -706,10 +802,10 @@ again:  if (*q->open) {
 }
 
 // this call will block until queue item available
-static int dbconsumer_get_int(Lua L, dbconsumer_t *q)
+static int dbconsumer_get_int(Lua L, dbconsumer_t *q, int max)
 {
     int rc;
-    while ((rc = dbq_poll(L, q, dbq_delay)) == 0)
+    while ((rc = dbq_poll(L, q, dbq_delay, max)) == 0)
         ;
     return rc;
 }
@@ -718,7 +814,22 @@ static int dbconsumer_get(Lua L)
 {
     dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
     int rc;
-    if ((rc = dbconsumer_get_int(L, q)) > 0) return rc;
+    if ((rc = dbconsumer_get_int(L, q, 0)) > 0) return rc;
+    return luaL_error(L, getsp(L)->error);
+}
+
+// Blocks like get() for the first item, then returns it along with up to n-1
+// more which are already queued behind it.
+static int dbconsumer_next_batch(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    lua_Integer n = luaL_checkinteger(L, 2);
+    if (n < 1 || n > DBQ_MAX_BATCH) {
+        return luaL_error(L, "batch size must be between 1 and %d",
+                          DBQ_MAX_BATCH);
+    }
+    int rc;
+    if ((rc = dbconsumer_get_int(L, q, n)) > 0) return rc;
     return luaL_error(L, getsp(L)->error);
 }
 
@@ -729,7 +840,7 @@ static int dbconsumer_poll(Lua L)
     lua_Integer delay; // ms
     lua_number2integer(delay, arg);
     delay += (dbq_delay - delay % dbq_delay); // multiple of dbq_delay
-    int rc = dbq_poll(L, q, delay);
+    int rc = dbq_poll(L, q, delay, 0);
     if (rc >= 0) {
         return rc;
     }
@@ -750,7 +861,18 @@ static int in_parent_trans(SP sp)
     return (sp->in_parent_trans || !sp->make_parent_trans);
 }
 
-static int lua_trigger_impl(Lua L, dbconsumer_t *q)
+static int dbq_consume_genids(struct sqlclntstate *clnt, dbconsumer_t *q,
+                              const genid_t *genids, int n)
+{
+    int rc = 0;
+    for (int i = 0; i < n && rc == 0; ++i) {
+        rc = osql_dbq_consume_logic(clnt, q->info.spname, genids[i]);
+    }
+    return rc;
+}
+
+static int lua_trigger_impl(Lua L, dbconsumer_t *q, const genid_t *genids,
+                            int n)
 {
     SP sp = getsp(L);
     struct sqlclntstate *clnt = sp->clnt;
@@ -762,7 +884,7 @@ static int lua_trigger_impl(Lua L, dbconsumer_t *q)
         clnt->intrans = 1;
     }
     clnt->ctrl_sqlengine = SQLENG_INTRANS_STATE;
-    return osql_dbq_consume_logic(clnt, q->info.spname, q->genid);
+    return dbq_consume_genids(clnt, q, genids, n);
 }
 
 /*
@@ -771,7 +893,8 @@ static int lua_trigger_impl(Lua L, dbconsumer_t *q)
 ** Start a new transaction in either case.
 ** Commit transaction only for (1)
 */
-static int lua_consumer_impl(Lua L, dbconsumer_t *q)
+static int lua_consumer_impl(Lua L, dbconsumer_t *q, const genid_t *genids,
+                             int n)
 {
     int rc = 0;
     SP sp = getsp(L);
@@ -783,7 +906,7 @@ static int lua_consumer_impl(Lua L, dbconsumer_t *q)
         }
         clnt->intrans = 1;
     }
-    if ((rc = osql_dbq_consume_logic(clnt, q->info.spname, q->genid)) != 0) {
+    if ((rc = dbq_consume_genids(clnt, q, genids, n)) != 0) {
         if (start) {
             osql_sock_abort(clnt, OSQL_SOCK_REQ);
         }
@@ -806,8 +929,8 @@ static int dbconsumer_consume_int(Lua L, dbconsumer_t *q)
         return -1;
     }
     enum consumer_t type = consumer_type(q->consumer);
-    int rc = (type == CONSUMER_TYPE_LUA) ? lua_trigger_impl(L, q)
-                                         : lua_consumer_impl(L, q);
+    int rc = (type == CONSUMER_TYPE_LUA) ? lua_trigger_impl(L, q, &q->genid, 1)
+                                         : lua_consumer_impl(L, q, &q->genid, 1);
     q->genid = 0;
     return rc;
 }
@@ -818,6 +941,18 @@ static int dbconsumer_consume(Lua L)
     return push_and_return(L, dbconsumer_consume_int(L, q));
 }
 
+// Consume everything the last next_batch() returned, in one transaction.
+static int dbconsumer_consume_batch(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    if (q->nbatch == 0) {
+        return push_and_return(L, -1);
+    }
+    int rc = lua_consumer_impl(L, q, q->batch, q->nbatch);
+    q->nbatch = 0;
+    return push_and_return(L, rc);
+}
+
 static int db_emit_int(Lua);
 static int dbconsumer_emit(Lua L)
 {
@@ -834,6 +969,8 @@ static int dbconsumer_free(Lua L)
 {
     dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
     luabb_trigger_unregister(q);
+    free(q->batch);
+    q->batch = NULL;
     return 0;
 }
 
@@ -4268,6 +4405,8 @@ static const struct luaL_Reg dbconsumer_funcs[] = {
     {"get", dbconsumer_get},
     {"poll", dbconsumer_poll},
     {"consume", dbconsumer_consume},
+    {"next_batch", dbconsumer_next_batch},
+    {"consume_batch", dbconsumer_consume_batch},
     {"emit", dbconsumer_emit},
     {NULL, NULL}
 };
@@ -6165,6 +6304,33 @@ void lua_func(sqlite3_context *context, int argc, sqlite3_value **argv)
     }
 }
 
+/* Run main() on the event dbconsumer_get/dbq_next just pushed, check that it
+ * returned 0 and consume the event in the open transaction.  *last is set to
+ * the genid of the consumed event. */
+static int run_trigger_event(struct sqlclntstate *clnt, dbconsumer_t *q,
+                             int args, genid_t *last, char **err)
+{
+    SP sp = clnt->sp;
+    Lua L = sp->lua;
+    int rc;
+    if ((rc = run_sp(clnt, args, err)) != 0) {
+        return rc;
+    }
+    if (lua_gettop(L) != 1 || !lua_isnumber(L, 1) ||
+        (rc = lua_tonumber(L, 1)) != 0) {
+        logmsg(LOGMSG_ERROR, "trigger:%s rc:%s\n", sp->spname,
+               lua_tostring(L, 1));
+        *err = strdup("trigger returned bad rc");
+        return rc ? rc : -1;
+    }
+    *last = q->genid;
+    if ((rc = dbconsumer_consume_int(L, q)) != 0) {
+        *err = strdup("trigger failed to consume");
+        return rc;
+    }
+    return 0;
+}
+
 void *exec_trigger(trigger_reg_t *reg)
 {
     char sql[128];
@@ -6197,7 +6363,7 @@ void *exec_trigger(trigger_reg_t *reg)
         }
         SP sp = clnt.sp;
         Lua L = sp->lua;
-        if ((args = dbconsumer_get_int(L, q)) < 0) {
+        if ((args = dbconsumer_get_int(L, q, 0)) < 0) {
             err = strdup(sp->error);
             goto bad;
         }
@@ -6205,7 +6371,8 @@ void *exec_trigger(trigger_reg_t *reg)
             err = strdup(sp->error);
             goto bad;
         }
-        if ((rc = run_sp(&clnt, args, &err)) != 0) {
+        genid_t last;
+        if ((rc = run_trigger_event(&clnt, q, args, &last, &err)) != 0) {
         rollback:
             db_rollback_int(L, &rc);
         bad:
@@ -6216,16 +6383,22 @@ void *exec_trigger(trigger_reg_t *reg)
             }
             break;
         }
-        if (lua_gettop(L) != 1 || !lua_isnumber(L, 1) ||
-            (rc = lua_tonumber(L, 1)) != 0) {
-            logmsg(LOGMSG_ERROR, "trigger:%s rc:%s\n", sp->spname,
-                   lua_tostring(L, 1));
-            err = strdup("trigger returned bad rc");
-            goto rollback;
-        }
-        if ((rc = dbconsumer_consume_int(L, q)) != 0) {
-            err = strdup("trigger failed to consume");
-            goto rollback;
+        // Drain whatever else is already queued into the same transaction.
+        for (int n = 1; n < gbl_lua_trigger_batch; ++n) {
+            lua_settop(L, 0);
+            if ((rc = get_func_by_name(L, "main", &err)) != 0) {
+                goto rollback;
+            }
+            if ((args = dbq_next_int(L, q, last)) == 0) {
+                break;
+            }
+            if (args < 0) {
+                err = strdup(sp->error);
+                goto rollback;
+            }
+            if ((rc = run_trigger_event(&clnt, q, args, &last, &err)) != 0) {
+                goto rollback;
+            }
         }
         if ((rc = commit_sp(L, &err)) != 0) {
             logmsg(LOGMSG_ERROR, "trigger:%s commit failed rc:%d -- %s\n",
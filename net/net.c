@@ -60,6 +60,7 @@
 #include <dirent.h>
 #include <utime.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <poll.h>
 
 #include <bb_oscompat.h>
@@ -141,11 +142,16 @@ static int sbuf2read_wrapper(SBUF2 *sb, char *buf, int nbytes)
     return sbuf2unbufferedread(sb, buf, nbytes);
 }
 
+/* write syscalls issued by this thread; the writer thread diffs this around
+ * each batch to charge them to the host */
+static __thread unsigned long long write_syscalls;
+
 static int sbuf2write_wrapper(SBUF2 *sb, const char *buf, int nbytes)
 {
     if (debug_switch_verbose_sbuf())
         logmsg(LOGMSG_USER, "writing, writing %llu\n", gettmms());
 
+    write_syscalls++;
     return sbuf2unbufferedwrite(sb, buf, nbytes);
 }
 
@@ -1003,6 +1009,59 @@ static ssize_t write_stream(netinfo_type *netinfo_ptr,
     return nwrite;
 }
 
+/* Write a batch of queued messages straight from their write_data nodes with
+ * as few syscalls as the socket allows.  The caller holds write_lock and has
+ * already flushed anything sitting in the sbuf, so ordering is preserved.
+ * iov is consumed in place. */
+static ssize_t writev_stream(netinfo_type *netinfo_ptr,
+                             host_node_type *host_node_ptr, struct iovec *iov,
+                             int niov)
+{
+    int fd = sbuf2fileno(host_node_ptr->sb);
+    ssize_t nwrite, total = 0;
+
+    while (niov > 0) {
+        nwrite = writev(fd, iov, niov);
+        write_syscalls++;
+        if (nwrite < 0) {
+            if (errno == EAGAIN) { /* wait for room in the socket */
+                struct pollfd pol;
+                pol.fd = fd;
+                pol.events = POLLOUT;
+                if (poll(&pol, 1, 1000) < 0 && errno != EINTR)
+                    return -1;
+                if (host_node_ptr->closed)
+                    return -1;
+                if (pol.revents & (POLLERR | POLLHUP | POLLNVAL))
+                    return -1;
+                continue;
+            } else if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (nwrite == 0)
+            return -1;
+
+        total += nwrite;
+        netinfo_ptr->stats.bytes_written += nwrite;
+        host_node_ptr->stats.bytes_written += nwrite;
+
+        /* skip what went out, trim a partially written entry */
+        while (niov > 0 && nwrite >= iov->iov_len) {
+            nwrite -= iov->iov_len;
+            iov++;
+            niov--;
+        }
+        if (niov > 0) {
+            iov->iov_base = (char *)iov->iov_base + nwrite;
+            iov->iov_len -= nwrite;
+        }
+    }
+
+    return total;
+}
+
 #if WITH_SSL
 extern ssl_mode gbl_rep_ssl_mode;
 extern SSL_CTX *gbl_ssl_ctx;
@@ -2459,6 +2518,13 @@ int net_register_queue_stat(netinfo_type *netinfo_ptr, QSTATINITFP *qinit,
     return 0;
 }
 
+int net_register_queue_stat_write(netinfo_type *netinfo_ptr,
+                                  QSTATWRITEFP *qwrite)
+{
+    netinfo_ptr->qstat_write_rtn = qwrite;
+    return 0;
+}
+
 void net_userfunc_iterate(netinfo_type *netinfo_ptr, UFUNCITERFP *uf_iter,
                           void *arg)
 {
@@ -4400,12 +4466,33 @@ void kill_subnet(const char *subnet)
 
 int gbl_net_writer_thread_poll_ms = 1000;
 
+/* messages per writev when gbl_net_writev is set */
+#define NET_WRITEV_MAX_IOV 64
+int gbl_net_writev = 0;
+
+static void free_write_data(host_node_type *host_node_ptr, write_data *ptr)
+{
+    if (ptr->pooled) {
+        Pthread_mutex_lock(&(host_node_ptr->pool_lock));
+        pool_relablk(host_node_ptr->write_pool, ptr);
+        Pthread_mutex_unlock(&(host_node_ptr->pool_lock));
+    } else {
+#ifdef PER_THREAD_MALLOC
+        free(ptr);
+#else
+        comdb2_free(ptr);
+#endif
+    }
+}
+
 static void *writer_thread(void *args)
 {
     netinfo_type *netinfo_ptr;
     host_node_type *host_node_ptr;
     write_data *write_list_ptr, *write_list_back;
-    int rc, flags, maxage;
+    int rc, flags, maxage, batched, niov;
+    unsigned long long syscalls, written, copied;
+    struct iovec iov[NET_WRITEV_MAX_IOV];
     int th_start_time = comdb2_time_epoch();
     struct timespec waittime;
 #ifndef HAS_CLOCK_GETTIME
@@ -4458,6 +4545,24 @@ static void *writer_thread(void *args)
 
             Pthread_mutex_lock(&(host_node_ptr->write_lock));
             start_time = comdb2_time_epoch();
+            syscalls = write_syscalls;
+            written = host_node_ptr->stats.bytes_written;
+            copied = 0;
+            niov = 0;
+
+            /* batch straight from the queued nodes unless the sbuf has to see
+             * the bytes (ssl, or a test write routine) */
+            batched = gbl_net_writev &&
+                      sbuf2getw(host_node_ptr->sb) == sbuf2write_wrapper;
+#if WITH_SSL
+            if (sslio_has_ssl(host_node_ptr->sb))
+                batched = 0;
+#endif
+            if (batched && sbuf2flush(host_node_ptr->sb) < 0)
+                rc = -1;
+
+            /* write_list_back trails write_list_ptr: it is the first node not
+             * yet released */
             while (write_list_ptr != NULL) {
                 /* stop writing if we've hit an error or if we've disconnected
                  */
@@ -4510,26 +4615,37 @@ static void *writer_thread(void *args)
                     /* endianize this */
                     net_wire_header_put(&tmp_wire_hdr, p_buf, p_buf_end);
 
-                    rc = write_stream(
-                        netinfo_ptr, host_node_ptr, host_node_ptr->sb,
-                        write_list_ptr->payload.raw, write_list_ptr->len);
+                    if (batched) {
+                        iov[niov].iov_base = write_list_ptr->payload.raw;
+                        iov[niov].iov_len = write_list_ptr->len;
+                        niov++;
+                    } else {
+                        rc = write_stream(netinfo_ptr, host_node_ptr,
+                                          host_node_ptr->sb,
+                                          write_list_ptr->payload.raw,
+                                          write_list_ptr->len);
+                        if (rc > 0)
+                            copied += rc;
+                    }
                     flags |= write_list_ptr->flags;
                 } else
                     rc = -1;
 
-                write_list_back = write_list_ptr;
                 write_list_ptr = write_list_ptr->next;
 
-                if (write_list_back->pooled) {
-                    Pthread_mutex_lock(&(host_node_ptr->pool_lock));
-                    pool_relablk(host_node_ptr->write_pool, write_list_back);
-                    Pthread_mutex_unlock(&(host_node_ptr->pool_lock));
-                } else {
-#ifdef PER_THREAD_MALLOC
-                    free(write_list_back);
-#else
-                    comdb2_free(write_list_back);
-#endif
+                if (niov == NET_WRITEV_MAX_IOV ||
+                    (niov > 0 && write_list_ptr == NULL)) {
+                    if (rc >= 0 &&
+                        writev_stream(netinfo_ptr, host_node_ptr, iov, niov) < 0)
+                        rc = -1;
+                    niov = 0;
+                }
+
+                /* nodes can go once nothing in the iovec points at them */
+                while (niov == 0 && write_list_back != write_list_ptr) {
+                    write_data *next = write_list_back->next;
+                    free_write_data(host_node_ptr, write_list_back);
+                    write_list_back = next;
                 }
             }
             /* we seem to set nodelay on virtually every message.  try to get
@@ -4544,6 +4660,12 @@ static void *writer_thread(void *args)
             end_time = comdb2_time_epoch();
             Pthread_mutex_unlock(&(host_node_ptr->write_lock));
 
+            if (netinfo_ptr->qstat_write_rtn) {
+                (netinfo_ptr->qstat_write_rtn)(
+                    netinfo_ptr, host_node_ptr->qstat, write_syscalls - syscalls,
+                    host_node_ptr->stats.bytes_written - written, copied);
+            }
+
             diff_time = end_time - start_time;
             if (diff_time >= 2) {
                 /* this is really informational now so I won't use
@@ -67,6 +67,10 @@ typedef void QSTATCLEARFP(struct netinfo_struct *netinfo, void *netstat);
 typedef void QSTATENQUEFP(struct netinfo_struct *netinfo, void *netstat,
                           void *rec, int len);
 typedef void QSTATFREEFP(struct netinfo_struct *netinfo, void *netstat);
+/* called by the writer thread after each batch with the syscalls it took, the
+ * bytes that went out and how many of those were copied through the sbuf */
+typedef void QSTATWRITEFP(struct netinfo_struct *netinfo, void *netstat,
+                          int64_t syscalls, int64_t bytes, int64_t copied);
 
 typedef void QSTATITERFP(struct netinfo_struct *netinfo, void *arg,
                          void *qstat);
@@ -155,6 +159,9 @@ int net_register_queue_stat(netinfo_type *netinfo_ptr, QSTATINITFP *qinit,
                             QSTATREADERFP *reader, QSTATENQUEFP *enque,
                             QSTATCLEARFP *qclear, QSTATFREEFP *qfree);
 
+int net_register_queue_stat_write(netinfo_type *netinfo_ptr,
+                                  QSTATWRITEFP *qwrite);
+
 /* register a callback that you can compare the order of things
    already on the write queue. */
 int net_register_netcmp(netinfo_type *netinfo_ptr, NETCMPFP func);
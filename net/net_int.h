@@ -338,6 +338,7 @@ struct netinfo_struct {
     QSTATENQUEFP *qstat_enque_rtn;
     QSTATCLEARFP *qstat_clear_rtn;
     QSTATFREEFP *qstat_free_rtn;
+    QSTATWRITEFP *qstat_write_rtn;
 
     struct quantize *conntime_all;
     struct quantize *conntime_periodic;
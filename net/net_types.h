@@ -82,6 +82,9 @@ enum {
     NET_AUTHENTICATION_CHECK = 170,
     NET_OSQL_UUID_REQUEST_MAX,
 
+    /* many offload replies of one session in a single message */
+    NET_OSQL_RPL_BATCH = 172,
+
     MAX_USER_TYPE
 };
 
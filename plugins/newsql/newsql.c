@@ -1645,6 +1645,14 @@ static int process_set_commands(struct dbenv *dbenv, struct sqlclntstate *clnt,
                 printf("setting clnt->osql_max_trans to %d\n",
                        clnt->osql_max_trans);
 #endif
+            } else if (strncasecmp(sqlstr, "maxstmtmem", 10) == 0) {
+                sqlstr += 10;
+                long long maxmem = strtoll(sqlstr, &endp, 10);
+                if (endp != sqlstr && maxmem >= 0)
+                    clnt->sql_mem_cap = maxmem * 1024 * 1024;
+                else
+                    logmsg(LOGMSG_ERROR,
+                           "Error: bad value for maxstmtmem %s\n", sqlstr);
             } else if (strncasecmp(sqlstr, "plannereffort", 13) == 0) {
                 sqlstr += 13;
                 int effort = strtol(sqlstr, &endp, 10);
@@ -2597,7 +2597,8 @@ int fdb_bend_send_row(SBUF2 *sb, fdb_msg_t *msg, char *cid,
     msg->dr.datacopylen = datacopylen;
     msg->dr.datacopy = datacopy;
 
-    rc = fdb_msg_write_message(sb, msg, 1);
+    /* more rows of a stream follow; the sender flushes them in batches */
+    rc = fdb_msg_write_message(sb, msg, ret != IX_FNDMORE);
 
     if (gbl_fdb_track) {
         fdb_msg_print_message(sb, msg, "sending msg");
@@ -2740,7 +2741,7 @@ int fdb_bend_run_sql(SBUF2 *sb, fdb_msg_t *msg, svc_callback_arg_t *arg)
             clnt->fdb_state.remote_sql_sb, cid,
             clnt->fdb_state.err.errstr, /* the actual row is the errstr */
             strlen(clnt->fdb_state.err.errstr) + 1, clnt->fdb_state.err.errval,
-            arg->isuuid);
+            arg->isuuid, 0);
         if (rc) {
             logmsg(LOGMSG_ERROR, "%s: fdb_send_rc failed rc=%d\n", __func__, rc);
         }
@@ -3335,7 +3336,7 @@ static int _check_code_release(SBUF2 *sb, char *cid, int code_release,
 
         /* we need to send back a rc code */
         rc = fdb_svc_sql_row(sb, cid, errstr, strlen(errstr) + 1, errval,
-                             isuuid);
+                             isuuid, 0);
         if (rc) {
             logmsg(LOGMSG_ERROR, "%s: fdb_send_rc failed rc=%d\n", __func__,
                    rc);
@@ -790,6 +790,13 @@ int finalize_alter_table(struct ireq *iq, struct schema_change_type *s,
         sc_printf(s, "Reusing version %d for same schema\n", db->tableversion);
     }
 
+    /* the rows were rewritten (or truncated) outside of the counted path */
+    rc = bdb_del_rowcount(db->tablename, transac, &bdberr);
+    if (rc) {
+        sc_errf(s, "Failed deleting row count bdberr %d\n", bdberr);
+        goto failed;
+    }
+
     set_odh_options_tran(db, transac);
 
     if (olddb_bthashsz) {
@@ -175,7 +175,6 @@ static unsigned long long revalidate_new_indexes(struct ireq *iq, struct dbtable
 {
     extern int gbl_partial_indexes;
     extern int gbl_expressions_indexes;
-    void free_cached_idx(uint8_t * *cached_idx);
     unsigned long long ins_keys = -1ULL;
     if ((gbl_partial_indexes && db->ix_partial) ||
         (gbl_expressions_indexes && db->ix_expr)) {
@@ -192,13 +191,8 @@ static unsigned long long revalidate_new_indexes(struct ireq *iq, struct dbtable
             }
         }
         if (rebuild_keys) {
-            if (iq->idxInsert || iq->idxDelete) {
-                free_cached_idx(iq->idxInsert);
-                free_cached_idx(iq->idxDelete);
-                free(iq->idxInsert);
-                free(iq->idxDelete);
-                iq->idxInsert = iq->idxDelete = NULL;
-            }
+            /* the cached keys live in the request arena */
+            free_cached_delayed_indexes(iq);
             ins_keys = -1ULL;
         }
     }
@@ -610,6 +604,32 @@ static int bthash_callback(const char *table)
     }
 }
 
+static int rowcount_callback(const char *table)
+{
+    struct dbtable *db = get_dbtable_by_name(table);
+    if (db == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: unknown table %s\n", __func__, table);
+        return 1;
+    }
+    logmsg(LOGMSG_INFO, "Replicant reloading row count for table: %s\n",
+           table);
+    bdb_rowcount_load(db->handle, NULL);
+    return 0;
+}
+
+static int zstd_dict_callback(const char *table)
+{
+    struct dbtable *db = get_dbtable_by_name(table);
+    if (db == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: unknown table %s\n", __func__, table);
+        return 1;
+    }
+    logmsg(LOGMSG_INFO, "Replicant reloading zstd dictionary for table: %s\n",
+           table);
+    bdb_zstd_load(db->handle, NULL);
+    return 0;
+}
+
 static int replicant_reload_views(const char *name)
 {
     int rc;
@@ -651,6 +671,10 @@ int scdone_callback(bdb_state_type *bdb_state, const char table[], void *arg,
     case lua_afunc: return reload_lua_afuncs();
     case rename_table:
         return reload_rename_table(bdb_state, table, (char *)arg);
+    case rowcount:
+        return rowcount_callback(table);
+    case zstd_dict:
+        return zstd_dict_callback(table);
     default:
         break;
     }
@@ -97,6 +97,16 @@ int finalize_drop_table(struct ireq *iq, struct schema_change_type *s,
         return rc;
     }
 
+    if ((rc = bdb_del_rowcount(db->tablename, tran, &bdberr)) != 0) {
+        sc_errf(s, "Failed deleting row count bdberr %d\n", bdberr);
+        return rc;
+    }
+
+    if ((rc = bdb_del_table_zstd_dict(db->tablename, tran, &bdberr)) != 0) {
+        sc_errf(s, "Failed deleting zstd dictionary bdberr %d\n", bdberr);
+        return rc;
+    }
+
     if ((rc = llmeta_set_tables(tran, thedb)) != 0) {
         sc_errf(s, "Failed to set table names in low level meta\n");
         return rc;
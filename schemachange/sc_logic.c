@@ -838,6 +838,7 @@ int open_temp_db_resume(struct dbtable *db, char *prefix, int resume, int temp,
      * future when we don't change genids on schema change, but right now
      * isn't really needed. */
     bdb_set_blobstripe_genid(db->handle, db->blobstripe_genid);
+    bdb_zstd_load(db->handle, tran);
     free(tmpname);
     return 0;
 }
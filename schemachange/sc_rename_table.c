@@ -56,6 +56,7 @@ int finalize_rename_table(struct ireq *iq, struct schema_change_type *s,
     char *newname = strdup(s->newtable);
     int rc = 0;
     int bdberr = 0;
+    unsigned int dictid;
     char *oldname = NULL;
 
     assert(s->rename);
@@ -77,6 +78,24 @@ int finalize_rename_table(struct ireq *iq, struct schema_change_type *s,
         goto tran_error;
     }
 
+    /* the maintained row count is keyed by name, drop it with the old one */
+    rc = bdb_del_rowcount(db->tablename, tran, &bdberr);
+    if (rc) {
+        sc_errf(s, "Failed deleting row count bdberr %d\n", bdberr);
+        goto tran_error;
+    }
+
+    /* so is the zstd dictionary, which moves to the new name */
+    if (bdb_get_table_zstd_dict(db->tablename, tran, &dictid, &bdberr) == 0) {
+        rc = bdb_del_table_zstd_dict(db->tablename, tran, &bdberr);
+        if (rc == 0)
+            rc = bdb_set_table_zstd_dict(newname, tran, dictid, &bdberr);
+        if (rc) {
+            sc_errf(s, "Failed moving zstd dictionary bdberr %d\n", bdberr);
+            goto tran_error;
+        }
+    }
+
     /* update all associated metadata */
     rc = bdb_rename_table_metadata(db->handle, tran, newname, db->version,
                                    &bdberr);
@@ -942,6 +942,9 @@ int reload_schema(char *table, const char *csc2, tran_type *tran)
         bdb_handle_dbp_add_hash(db->handle, bthashsz);
     }
 
+    bdb_rowcount_load(db->handle, tran);
+    bdb_zstd_load(db->handle, tran);
+
     return 0;
 }
 
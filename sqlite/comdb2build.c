@@ -271,6 +271,8 @@ static void fillTableOption(struct schema_change_type* sc, int opt)
         sc->compress_blobs = BDB_COMPRESS_ZLIB;
     else if (OPT_ON(opt, BLOB_LZ4))
         sc->compress_blobs = BDB_COMPRESS_LZ4;
+    else if (OPT_ON(opt, BLOB_ZSTD))
+        sc->compress_blobs = BDB_COMPRESS_ZSTD;
 
     sc->compress = -1;
     if (OPT_ON(opt, REC_NONE))
@@ -283,6 +285,8 @@ static void fillTableOption(struct schema_change_type* sc, int opt)
         sc->compress = BDB_COMPRESS_ZLIB;
     else if (OPT_ON(opt, REC_LZ4))
         sc->compress = BDB_COMPRESS_LZ4;
+    else if (OPT_ON(opt, REC_ZSTD))
+        sc->compress = BDB_COMPRESS_ZSTD;
 
     if (OPT_ON(opt, FORCE_REBUILD))
         sc->force_rebuild = 1;
@@ -2915,6 +2919,7 @@ static int retrieve_table_options(struct dbtable *table)
     case BDB_COMPRESS_CRLE: table_options |= REC_CRLE; break;
     case BDB_COMPRESS_ZLIB: table_options |= REC_ZLIB; break;
     case BDB_COMPRESS_LZ4: table_options |= REC_LZ4; break;
+    case BDB_COMPRESS_ZSTD: table_options |= REC_ZSTD; break;
     case BDB_COMPRESS_NONE: break;
     default: assert(0);
     }
@@ -2924,6 +2929,7 @@ static int retrieve_table_options(struct dbtable *table)
     case BDB_COMPRESS_CRLE: table_options |= BLOB_CRLE; break;
     case BDB_COMPRESS_ZLIB: table_options |= BLOB_ZLIB; break;
     case BDB_COMPRESS_LZ4: table_options |= BLOB_LZ4; break;
+    case BDB_COMPRESS_ZSTD: table_options |= BLOB_ZSTD; break;
     case BDB_COMPRESS_NONE: break;
     default: assert(0);
     }
@@ -29,6 +29,9 @@
 #define PAGE_ORDER    0x4000
 #define READ_ONLY     0x8000
 
+#define BLOB_ZSTD     0x10000
+#define REC_ZSTD      0x20000
+
 #define REBUILD_ALL     1
 #define REBUILD_DATA    2
 #define REBUILD_BLOB    4
@@ -5086,11 +5086,11 @@ static char *print_mem(Mem *m){
     case MEM_Null:
       return sqlite3_mprintf("null");
     case MEM_Str: 
-      return sqlite3_mprintf("'%.*s'", m->n, m->z);
+      return sqlite3_mprintf("'%.*q'", m->n, m->z);
     case MEM_Int:
       return  sqlite3_mprintf("%lld", m->u.i);
     case MEM_Real:
-      return sqlite3_mprintf("%f", m->u.r);
+      return sqlite3_mprintf("%!.17g", m->u.r);
     case MEM_Blob: {
       char * key = alloca(2*m->n+1);
       int  i;
@@ -5312,6 +5312,13 @@ char * binary_op(int op){
 /* COMDB2 MODIFICATION */
 extern const char* comdb2_get_sql(void);
 
+/* sqlite3ExprDescribe_inner() atRuntime flags */
+#define DESCRIBE_RUNTIME  0x1   /* registers hold their values */
+#define DESCRIBE_TABCOLS  0x2   /* name columns from their table */
+
+static char *describeExprList(Vdbe *, const ExprList *, int, int);
+static char *sqlite3SelectDescribe_inner(Vdbe *, const Select *, int);
+
 static char* sqlite3ExprDescribe_inner(
   Vdbe *v,
   const Expr *pExpr,
@@ -5571,7 +5578,7 @@ static char* sqlite3ExprDescribe_inner(
       return ret;
     }
     case TK_STRING: {
-      return sqlite3_mprintf("'%s'", pExpr->u.zToken);
+      return sqlite3_mprintf("%Q", pExpr->u.zToken);
     }
     case TK_JOIN_KW:
     case TK_DEFAULT: {
@@ -5595,7 +5602,6 @@ static char* sqlite3ExprDescribe_inner(
     case TK_ALL:
     case TK_EXCEPT:
     case TK_INTERSECT:
-    case TK_SELECT:
     case TK_SELECTV:
     case TK_DISTINCT:
     case TK_DOT:
@@ -5631,12 +5637,14 @@ static char* sqlite3ExprDescribe_inner(
       }
       break;
     }
-    case TK_FLOAT: break;
+    case TK_FLOAT: {
+      return sqlite3_mprintf("%s", pExpr->u.zToken);
+    }
     case TK_BLOB: {
       return sqlite3_mprintf("%s", pExpr->u.zToken);
     }
     case TK_REGISTER: {
-      if( atRuntime ){
+      if( atRuntime & DESCRIBE_RUNTIME ){
         /* look into register pExpr->iTable */
         Mem *m;
         m = &v->aMem[pExpr->iTable];
@@ -5706,7 +5714,7 @@ default_prec:
                                dt.dttz_sec, prec, prec, dt.dttz_frac);
       }
       /* default, pass the function remotely */
-      if( pExpr->x.pList->nExpr <= 0 )
+      if( !pExpr->x.pList || pExpr->x.pList->nExpr <= 0 )
         return sqlite3_mprintf(" %s ( )", pExpr->u.zToken);
       char *arg = sqlite3ExprDescribe_inner(v, pExpr->x.pList->a[0].pExpr,
                                             atRuntime);
@@ -5733,13 +5741,33 @@ default_prec:
       return ret;
     }
     case TK_COLUMN: {
-      if( atRuntime ){
+      /* "t.a" references don't keep the column name as their token */
+      if( (atRuntime & DESCRIBE_TABCOLS) && pExpr->pTab ){
+        if( pExpr->iColumn<0 ) return sqlite3_mprintf("rowid");
+        return sqlite3_mprintf("\"%w\"",
+                               pExpr->pTab->aCol[pExpr->iColumn].zName);
+      }
+      if( atRuntime & DESCRIBE_RUNTIME ){
         return sqlite3_mprintf("\"%s\"",  pExpr->u.zToken);
       }else{
         return sqlite3_mprintf("%s",  pExpr->u.zToken);
       }
     }
-    case TK_AGG_FUNCTION:
+    case TK_AGG_FUNCTION: {
+      const ExprList *pList = pExpr->x.pList;
+      char *args;
+      if( !pList || pList->nExpr<=0 ){
+        return sqlite3_mprintf("%s(%s)", pExpr->u.zToken,
+            sqlite3StrICmp(pExpr->u.zToken, "count")==0 ? "*" : "");
+      }
+      args = describeExprList(v, pList, 0, atRuntime);
+      if( !args ) return NULL;
+      return sqlite3_mprintf("%s(%s%z)", pExpr->u.zToken,
+          ExprHasProperty(pExpr, EP_Distinct) ? "DISTINCT " : "", args);
+    }
+    case TK_SELECT: {
+      return sqlite3SelectDescribe_inner(v, pExpr->x.pSelect, atRuntime);
+    }
     case TK_AGG_COLUMN: {
       break;
     }
@@ -5790,6 +5818,93 @@ char* sqlite3ExprDescribe(Vdbe *v, const Expr *pExpr){
 char *sqlite3ExprDescribeAtRuntime(Vdbe *v, const Expr *pExpr){
   return sqlite3ExprDescribe_inner(v, pExpr, 1);
 }
+
+/* COMDB2 MODIFICATION */
+/* "e1, e2, ..." with DESC where it applies if bOrder */
+static char *describeExprList(
+  Vdbe *v,
+  const ExprList *pList,
+  int bOrder,
+  int atRuntime
+){
+  char *ret = NULL;
+  int i;
+
+  for(i=0; i<pList->nExpr; i++){
+    char *e = sqlite3ExprDescribe_inner(v, pList->a[i].pExpr, atRuntime);
+    if( !e ){
+      sqlite3_free(ret);
+      return NULL;
+    }
+    ret = sqlite3_mprintf("%z%s%z%s", ret, i ? ", " : "", e,
+        (bOrder && pList->a[i].sortOrder==SQLITE_SO_DESC) ? " DESC" : "");
+    if( !ret ) return NULL;
+  }
+  return ret;
+}
+
+/* COMDB2 MODIFICATION */
+/* A whole select over one remote table, to run there as it is; see
+** remoteSelectPushdown() for what it can hold */
+static char *sqlite3SelectDescribe_inner(
+  Vdbe *v,
+  const Select *p,
+  int atRuntime
+){
+  char *zCols = 0, *zWhere = 0, *zGroup = 0, *zHaving = 0, *zOrder = 0;
+  char *zLimit = 0, *zOffset = 0, *ret = 0;
+
+  if( p->pPrior || p->pSrc->nSrc!=1 || !p->pSrc->a[0].pTab ){
+    return NULL;
+  }
+  atRuntime |= DESCRIBE_TABCOLS;
+
+  if( (zCols = describeExprList(v, p->pEList, 0, atRuntime))==0 ) goto done;
+  if( p->pWhere &&
+      (zWhere = sqlite3ExprDescribe_inner(v, p->pWhere, atRuntime))==0 ){
+    goto done;
+  }
+  if( p->pGroupBy &&
+      (zGroup = describeExprList(v, p->pGroupBy, 0, atRuntime))==0 ){
+    goto done;
+  }
+  if( p->pHaving &&
+      (zHaving = sqlite3ExprDescribe_inner(v, p->pHaving, atRuntime))==0 ){
+    goto done;
+  }
+  if( p->pOrderBy &&
+      (zOrder = describeExprList(v, p->pOrderBy, 1, atRuntime))==0 ){
+    goto done;
+  }
+  if( p->pLimit &&
+      (zLimit = sqlite3ExprDescribe_inner(v, p->pLimit, atRuntime))==0 ){
+    goto done;
+  }
+  if( p->pOffset &&
+      (zOffset = sqlite3ExprDescribe_inner(v, p->pOffset, atRuntime))==0 ){
+    goto done;
+  }
+
+  ret = sqlite3_mprintf("SELECT %s%s FROM \"%w\"%s%s%s%s%s%s%s%s%s%s%s%s",
+      (p->selFlags & SF_Distinct) ? "DISTINCT " : "", zCols,
+      p->pSrc->a[0].pTab->zName,
+      zWhere ? " WHERE " : "", zWhere ? zWhere : "",
+      zGroup ? " GROUP BY " : "", zGroup ? zGroup : "",
+      zHaving ? " HAVING " : "", zHaving ? zHaving : "",
+      zOrder ? " ORDER BY " : "", zOrder ? zOrder : "",
+      zLimit ? " LIMIT " : "", zLimit ? zLimit : "",
+      zOffset ? " OFFSET " : "", zOffset ? zOffset : "");
+
+done:
+  sqlite3_free(zCols);
+  sqlite3_free(zWhere);
+  sqlite3_free(zGroup);
+  sqlite3_free(zHaving);
+  sqlite3_free(zOrder);
+  sqlite3_free(zLimit);
+  sqlite3_free(zOffset);
+  return ret;
+}
 /*
 ** Validate that no temporary register falls within the range of
 ** iFirst..iLast, inclusive.  This routine is only call from within assert()
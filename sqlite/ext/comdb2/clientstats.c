@@ -55,6 +55,7 @@ enum {
     COLUMN_SQL_QUERIES,
     COLUMN_SQL_STEPS,
     COLUMN_SQL_ROWS,
+    COLUMN_SQL_MEM_PEAK,
 };
 
 static int systblClientStatsConnect(sqlite3 *db, void *pAux, int argc,
@@ -70,7 +71,7 @@ static int systblClientStatsConnect(sqlite3 *db, void *pAux, int argc,
             "\"upds\" INTEGER, \"dels\" INTEGER, \"bsql\" INTEGER, \"recom\" "
             "INTEGER, \"snapisol\" INTEGER, \"serial\" INTEGER, "
             "\"sql_queries\" INTEGER, \"sql_steps\" INTEGER, \"sql_rows\" "
-            "INTEGER)");
+            "INTEGER, \"sql_mem_peak\" INTEGER)");
 
     if (rc == SQLITE_OK) {
         if ((*ppVtab = sqlite3_malloc(sizeof(sqlite3_vtab))) == 0) {
@@ -213,6 +214,9 @@ static int systblClientStatsColumn(sqlite3_vtab_cursor *cur,
     case COLUMN_SQL_ROWS:
         sqlite3_result_int64(ctx, summaries[ii].sql_rows);
         break;
+    case COLUMN_SQL_MEM_PEAK:
+        sqlite3_result_int64(ctx, summaries[ii].sql_mem_peak);
+        break;
     default: assert(0);
     };
 
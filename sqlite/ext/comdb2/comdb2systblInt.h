@@ -38,6 +38,7 @@ const sqlite3_module systblLogicalOpsModule;
 int systblTypeSamplesInit(sqlite3 *db);
 int systblRepNetQueueStatInit(sqlite3 *db);
 int systblActivelocksInit(sqlite3 *db);
+int systblLocksContentionInit(sqlite3 *db);
 int systblNetUserfuncsInit(sqlite3 *db);
 int systblClusterInit(sqlite3 *db);
 
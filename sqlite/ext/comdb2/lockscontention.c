@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "bdb_int.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "cdb2api.h"
+
+typedef struct systable_lockscontention {
+    const char              *type;
+    int64_t                 partition;
+    int64_t                 acquired;
+    int64_t                 contended;
+    int64_t                 wait_us;
+    int64_t                 max_wait_us;
+    int64_t                 hold_us;
+    int64_t                 max_hold_us;
+    int64_t                 entries;
+    int64_t                 buckets;
+    int64_t                 buckets_used;
+    int64_t                 max_chain;
+} systable_lockscontention_t;
+
+typedef struct getlockscontention {
+    int count;
+    int alloc;
+    systable_lockscontention_t *records;
+} getlockscontention_t;
+
+static int collect(void *args, const DB_LOCK_PART_STAT *st)
+{
+    getlockscontention_t *a = (getlockscontention_t *)args;
+    systable_lockscontention_t *l;
+    a->count++;
+    if (a->count >= a->alloc) {
+        if (a->alloc == 0) a->alloc = 128;
+        else a->alloc = a->alloc * 2;
+        a->records = realloc(a->records,
+                             a->alloc * sizeof(systable_lockscontention_t));
+    }
+    l = &a->records[a->count - 1];
+    l->type = st->st_type;
+    l->partition = st->st_partition;
+    l->acquired = st->st_acquired;
+    l->contended = st->st_contended;
+    l->wait_us = st->st_wait_us;
+    l->max_wait_us = st->st_max_wait_us;
+    l->hold_us = st->st_hold_us;
+    l->max_hold_us = st->st_max_hold_us;
+    l->entries = st->st_entries;
+    l->buckets = st->st_buckets;
+    l->buckets_used = st->st_buckets_used;
+    l->max_chain = st->st_max_chain;
+    return 0;
+}
+
+static int get_lockscontention(void **data, int *records)
+{
+    bdb_state_type *bdb_state = thedb->bdb_env;
+    getlockscontention_t a = {0};
+    bdb_state->dbenv->collect_lock_partitions(bdb_state->dbenv, collect, &a);
+    *data = a.records;
+    *records = a.count;
+    return 0;
+}
+
+static void free_lockscontention(void *p, int n)
+{
+    free(p);
+}
+
+int systblLocksContentionInit(sqlite3 *db)
+{
+    return create_system_table(db, "comdb2_locks_contention",
+            get_lockscontention, free_lockscontention,
+            sizeof(systable_lockscontention_t),
+            CDB2_CSTRING, "type", -1, offsetof(systable_lockscontention_t, type),
+            CDB2_INTEGER, "partition", -1, offsetof(systable_lockscontention_t, partition),
+            CDB2_INTEGER, "acquired", -1, offsetof(systable_lockscontention_t, acquired),
+            CDB2_INTEGER, "contended", -1, offsetof(systable_lockscontention_t, contended),
+            CDB2_INTEGER, "wait_us", -1, offsetof(systable_lockscontention_t, wait_us),
+            CDB2_INTEGER, "max_wait_us", -1, offsetof(systable_lockscontention_t, max_wait_us),
+            CDB2_INTEGER, "hold_us", -1, offsetof(systable_lockscontention_t, hold_us),
+            CDB2_INTEGER, "max_hold_us", -1, offsetof(systable_lockscontention_t, max_hold_us),
+            CDB2_INTEGER, "entries", -1, offsetof(systable_lockscontention_t, entries),
+            CDB2_INTEGER, "buckets", -1, offsetof(systable_lockscontention_t, buckets),
+            CDB2_INTEGER, "buckets_used", -1, offsetof(systable_lockscontention_t, buckets_used),
+            CDB2_INTEGER, "max_chain", -1, offsetof(systable_lockscontention_t, max_chain),
+            SYSTABLE_END_OF_FIELDS);
+}
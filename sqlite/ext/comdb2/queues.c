@@ -41,6 +41,10 @@ struct systbl_queues_cursor {
   char          spname[256];
   unsigned long long     depth;
   unsigned long long     age;
+  unsigned long long     enqueued;
+  unsigned long long     consumed;
+  double                 avg_wait;
+  unsigned long long     max_wait;
   int           last_qid;
   int           is_last;
 };
@@ -50,6 +54,10 @@ struct systbl_queues_cursor {
 #define STQUEUE_SPNAME       1
 #define STQUEUE_HEADTIME     2
 #define STQUEUE_DEPTH        3
+#define STQUEUE_ENQUEUED     4
+#define STQUEUE_CONSUMED     5
+#define STQUEUE_AVGWAIT      6
+#define STQUEUE_MAXWAIT      7
 
 static int systblQueuesConnect(
   sqlite3 *db,
@@ -63,7 +71,8 @@ static int systblQueuesConnect(
   int rc;
 
   rc = sqlite3_declare_vtab(db,
-     "CREATE TABLE comdb2_queues(queuename, spname, head_age, depth)");
+     "CREATE TABLE comdb2_queues(queuename, spname, head_age, depth, "
+     "total_enqueued, total_consumed, avg_wait_sec, max_wait_sec)");
   if( rc==SQLITE_OK ){
     pNew = *ppVtab = sqlite3_malloc( sizeof(*pNew) );
     if( pNew==0 ) return SQLITE_NOMEM;
@@ -96,6 +105,11 @@ static void get_stats(struct systbl_queues_cursor *pCur) {
       pCur->age  = comdb2_time_epoch() - stats[0].epoch;
   else
       pCur->age  = 0;
+  pCur->enqueued = bdbstats->n_adds;
+  pCur->consumed = bdbstats->n_consumes;
+  pCur->avg_wait = bdbstats->n_consumes ?
+      (double)bdbstats->consume_wait_sec / bdbstats->n_consumes : 0;
+  pCur->max_wait = bdbstats->max_consume_wait_sec;
 }
 
 
@@ -167,6 +181,22 @@ static int systblQueuesColumn(
       sqlite3_result_int64(ctx, (sqlite3_int64)pCur->age);
       break;
     }
+    case STQUEUE_ENQUEUED: {
+      sqlite3_result_int64(ctx, (sqlite3_int64)pCur->enqueued);
+      break;
+    }
+    case STQUEUE_CONSUMED: {
+      sqlite3_result_int64(ctx, (sqlite3_int64)pCur->consumed);
+      break;
+    }
+    case STQUEUE_AVGWAIT: {
+      sqlite3_result_double(ctx, pCur->avg_wait);
+      break;
+    }
+    case STQUEUE_MAXWAIT: {
+      sqlite3_result_int64(ctx, (sqlite3_int64)pCur->max_wait);
+      break;
+    }
   }
   return SQLITE_OK;
 };
@@ -47,6 +47,9 @@ typedef struct systable_rep_qstat {
     int64_t                 log_fill;
     int64_t                 uncategorized;
     int64_t                 unknown;
+    int64_t                 write_syscalls;
+    int64_t                 write_bytes;
+    int64_t                 copied_bytes;
 } systable_rep_qstat_t;
 
 typedef struct net_get_records {
@@ -84,6 +87,9 @@ static void net_to_systable(struct netinfo_struct *netinfo_ptr, void *arg,
     s->total = n->total_count;
     /* "unknown" messages are net-level */
     s->uncategorized = n->unknown_count;
+    s->write_syscalls = n->write_syscalls;
+    s->write_bytes = n->write_bytes;
+    s->copied_bytes = n->copied_bytes;
     snprintf(s->max_lsn, MAX_LSN_STR, "{%d:%d}", n->max_lsn.file,
             n->max_lsn.offset);
     snprintf(s->min_lsn, MAX_LSN_STR, "{%d:%d}", n->min_lsn.file,
@@ -184,5 +190,8 @@ int systblRepNetQueueStatInit(sqlite3 *db) {
             CDB2_INTEGER, "log_fill", -1, offsetof(systable_rep_qstat_t, log_fill),
             CDB2_INTEGER, "uncategorized", -1, offsetof(systable_rep_qstat_t, uncategorized),
             CDB2_INTEGER, "unknown", -1, offsetof(systable_rep_qstat_t, unknown),
+            CDB2_INTEGER, "write_syscalls", -1, offsetof(systable_rep_qstat_t, write_syscalls),
+            CDB2_INTEGER, "write_bytes", -1, offsetof(systable_rep_qstat_t, write_bytes),
+            CDB2_INTEGER, "copied_bytes", -1, offsetof(systable_rep_qstat_t, copied_bytes),
             SYSTABLE_END_OF_FIELDS);
 }
@@ -275,6 +275,8 @@ int comdb2SystblInit(
     rc = systblRepNetQueueStatInit(db);
   if (rc == SQLITE_OK)
     rc = systblActivelocksInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblLocksContentionInit(db);
   if (rc == SQLITE_OK)
     rc = systblNetUserfuncsInit(db);
   if (rc == SQLITE_OK)
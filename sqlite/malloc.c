@@ -169,8 +169,11 @@ int sqlite3MallocInit(void){
 ** words if the amount of heap used is close to the limit set by
 ** sqlite3_soft_heap_limit().
 */
+/* COMDB2 MODIFICATION: also true when the statement running on this thread
+** is close to its memory cap */
+extern int sql_mem_nearly_full(void);
 int sqlite3HeapNearlyFull(void){
-  return mem0.nearlyFull;
+  return mem0.nearlyFull || sql_mem_nearly_full();
 }
 
 /*
@@ -258,7 +258,7 @@ columnname(A) ::= nm(A) typetoken(Y). {comdb2AddColumn(pParse,&A,&Y);}
   IPU ISC KW LUA LZ4 NONE ODH OFF OP OPTIONS PAGEORDER PARTITION PASSWORD PERIOD
   PROCEDURE PUT REBUILD READ READONLY REC RESERVED RETENTION REVOKE RLE
   ROWLOCKS SCALAR SCHEMACHANGE SKIPSCAN START SUMMARIZE THREADS THRESHOLD TIME
-  TRUNCATE TUNABLE VERSION WRITE DDL USERSCHEMA ZLIB .
+  TRUNCATE TUNABLE VERSION WRITE DDL USERSCHEMA ZLIB ZSTD .
 %wildcard ANY.
 
 
@@ -2044,6 +2044,7 @@ blob_compress_type(A) ::= RLE. {A = BLOB_RLE;}
 //blob_compress_type(A) ::= CRLE. {A = BLOB_CRLE;}
 blob_compress_type(A) ::= ZLIB. {A = BLOB_ZLIB;}
 blob_compress_type(A) ::= LZ4. {A = BLOB_LZ4;}
+blob_compress_type(A) ::= ZSTD. {A = BLOB_ZSTD;}
 
 %type compress_rec {int}
 compress_rec(A) ::= REC rle_compress_type(T). {A = T;}
@@ -2054,6 +2055,7 @@ rle_compress_type(A) ::= RLE. {A = REC_RLE;}
 rle_compress_type(A) ::= CRLE. {A = REC_CRLE;}
 rle_compress_type(A) ::= ZLIB. {A = REC_ZLIB;}
 rle_compress_type(A) ::= LZ4. {A = REC_LZ4;}
+rle_compress_type(A) ::= ZSTD. {A = REC_ZSTD;}
 
 //////////////////// COMDB2 STORED PROCEDURES /////////////////////////////////
 
@@ -4155,6 +4155,119 @@ static Table *isSimpleCount(Select *p, AggInfo *pAggInfo){
   return pTab;
 }
 
+/* COMDB2 MODIFICATION */
+/*
+** The select statement passed as the first argument is an aggregate query
+** without GROUP BY. This function tests if it is of the form:
+**
+**   SELECT <agg>, <agg>, ... FROM <tbl>
+**
+** where every <agg> is count(*), or count(), sum(), min() or max() of a
+** column of <tbl>. Such a query can have its aggregates computed by
+** scanning the data stripes of <tbl> in parallel (see OP_StripeAgg). If
+** it qualifies, the Table object for <tbl> is returned and aAgg[] is
+** filled with a (function, column, register) triple per aggregate.
+** Otherwise 0 is returned.
+*/
+static Table *isSimpleStripeAgg(Select *p, AggInfo *pAggInfo, int *aAgg){
+  Table *pTab;
+  int i;
+
+  assert( !p->pGroupBy );
+
+  if( p->pWhere || p->pHaving || p->op==TK_SELECTV || p->recording
+   || p->pSrc->nSrc!=1 || p->pSrc->a[0].pSelect
+   || pAggInfo->nFunc==0 || pAggInfo->nFunc>BTREE_STRIPEAGG_MAX_AGGS
+  ){
+    return 0;
+  }
+  pTab = p->pSrc->a[0].pTab;
+  if( IsVirtual(pTab) ) return 0;
+
+  /* no bare columns: the loop would be needed to pick their row */
+  for(i=0; i<p->pEList->nExpr; i++){
+    if( p->pEList->a[i].pExpr->op!=TK_AGG_FUNCTION ) return 0;
+  }
+
+  for(i=0; i<pAggInfo->nFunc; i++){
+    struct AggInfo_func *pF = &pAggInfo->aFunc[i];
+    ExprList *pList = pF->pExpr->x.pList;
+    const char *zName = pF->pFunc->zName;
+    Expr *pArg;
+    int op;
+
+    if( pF->iDistinct>=0 || (pF->pExpr->flags&EP_Distinct) ) return 0;
+    if( pList==0 || pList->nExpr==0 ){
+      if( (pF->pFunc->funcFlags&SQLITE_FUNC_COUNT)==0 ) return 0;
+      aAgg[i*3] = BTREE_STRIPEAGG_COUNTSTAR;
+      aAgg[i*3+1] = -1;
+      aAgg[i*3+2] = pF->iMem;
+      continue;
+    }
+    if( pList->nExpr!=1 ) return 0;
+    if( sqlite3StrICmp(zName, "count")==0 ){
+      op = BTREE_STRIPEAGG_COUNT;
+    }else if( sqlite3StrICmp(zName, "sum")==0 ){
+      op = BTREE_STRIPEAGG_SUM;
+    }else if( sqlite3StrICmp(zName, "min")==0 ){
+      op = BTREE_STRIPEAGG_MIN;
+    }else if( sqlite3StrICmp(zName, "max")==0 ){
+      op = BTREE_STRIPEAGG_MAX;
+    }else{
+      return 0;
+    }
+    pArg = pList->a[0].pExpr;
+    if( (pArg->op!=TK_COLUMN && pArg->op!=TK_AGG_COLUMN)
+     || pArg->iTable!=p->pSrc->a[0].iCursor
+     || pArg->iColumn<0 || pArg->iColumn>=pTab->nCol
+    ){
+      return 0;
+    }
+    aAgg[i*3] = op;
+    aAgg[i*3+1] = pArg->iColumn;
+    aAgg[i*3+2] = pF->iMem;
+  }
+
+  return pTab;
+}
+
+/* COMDB2 MODIFICATION */
+/*
+** Code OP_StripeAgg for a query accepted by isSimpleStripeAgg(). The
+** returned label is jumped to if the final aggregate values were stored
+** in the accumulator registers, skipping the regular aggregate loop; the
+** caller resolves it after finalizeAggFunctions().
+*/
+static int codeStripeAgg(Parse *pParse, Table *pTab, AggInfo *pAggInfo,
+                         int *aAgg){
+  Vdbe *v = pParse->pVdbe;
+  const int iDb = sqlite3SchemaToIndex(pParse->db, pTab->pSchema);
+  const int iCsr = pParse->nTab++;
+  const int nInt = pAggInfo->nFunc*3;
+  int regDone;
+  int addrDone;
+  int *ai;
+
+  ai = (int*)sqlite3DbMallocRawNN(pParse->db, sizeof(int)*(nInt+1));
+  if( ai==0 ) return 0;
+  ai[0] = nInt+1;
+  memcpy(&ai[1], aAgg, sizeof(int)*nInt);
+
+  regDone = sqlite3GetTempReg(pParse);
+  addrDone = sqlite3VdbeMakeLabel(v);
+  sqlite3CodeVerifySchema(pParse, iDb);
+  if( iDb!=1 ){
+    sqlite3VdbeAddTable(v, pTab);
+  }
+  sqlite3OpenTable(pParse, iCsr, iDb, pTab, OP_OpenRead);
+  sqlite3VdbeAddOp4(v, OP_StripeAgg, iCsr, regDone, 0, (char*)ai,
+                    P4_INTARRAY);
+  sqlite3VdbeAddOp1(v, OP_Close, iCsr);
+  sqlite3VdbeAddOp2(v, OP_If, regDone, addrDone);
+  sqlite3ReleaseTempReg(pParse, regDone);
+  return addrDone;
+}
+
 /*
 ** If the source-list item passed as an argument was augmented with an
 ** INDEXED BY clause, then try to locate the specified index. If there
@@ -5160,6 +5273,163 @@ static int sql_has_remotes(
   return 0;
 }
 
+/*
+** COMDB2 MODIFICATION
+** Can function pExpr give the same result on the remote database?  It has
+** to be a built-in that the remote has too, and a scalar has to be
+** deterministic: random(), changes(), the date functions and the like
+** aren't, and the comdb2 ones answer for the server they run on.
+*/
+static int remotePushdownFuncOk(sqlite3 *db, Expr *pExpr){
+  static const char *azLocal[] = {
+    "table_version", "partition_info",
+  };
+  ExprList *pList = pExpr->x.pList;
+  FuncDef *pDef;
+  int i;
+
+  /* registered here, the remote db won't have it */
+  if( sqlite3HashFind(&db->aFunc, pExpr->u.zToken) ) return 0;
+  pDef = sqlite3FindFunction(db, pExpr->u.zToken, pList ? pList->nExpr : 0,
+                             ENC(db), 0);
+  if( pDef==0 ) return 0;
+  if( pDef->xFinalize ) return 1;  /* the built-in aggregates all are */
+  if( (pDef->funcFlags & SQLITE_FUNC_CONSTANT)==0 ) return 0;
+  if( sqlite3_strnicmp(pDef->zName, "comdb2_", 7)==0 ) return 0;
+  for(i=0; i<ArraySize(azLocal); i++){
+    if( sqlite3StrICmp(pDef->zName, azLocal[i])==0 ) return 0;
+  }
+  return 1;
+}
+
+/*
+** COMDB2 MODIFICATION
+** Walker callback for remoteSelectPushdown(): clear eCode if the expression
+** can't be run on the remote database as it is.  Only what
+** sqlite3ExprDescribe() can print is allowed.
+*/
+static int remotePushdownCheckExpr(Walker *pWalker, Expr *pExpr){
+  switch( pExpr->op ){
+    case TK_AND: case TK_OR: case TK_NOT:
+    case TK_EQ: case TK_NE: case TK_LT: case TK_LE: case TK_GT: case TK_GE:
+    case TK_IS: case TK_ISNULL: case TK_NOTNULL:
+    case TK_BITAND: case TK_BITOR: case TK_BITNOT:
+    case TK_LSHIFT: case TK_RSHIFT:
+    case TK_PLUS: case TK_MINUS: case TK_STAR: case TK_SLASH: case TK_REM:
+    case TK_CONCAT: case TK_UMINUS: case TK_UPLUS: case TK_CAST:
+    case TK_STRING: case TK_NULL: case TK_INTEGER: case TK_FLOAT:
+    case TK_BLOB: case TK_VARIABLE:
+      break;
+    case TK_IN:
+      if( ExprHasProperty(pExpr, EP_xIsSelect) || pExpr->x.pList->nExpr==0 ){
+        pWalker->eCode = 0;
+      }
+      break;
+    case TK_COLUMN:
+      /* correlated subqueries stay local */
+      if( pExpr->iTable!=pWalker->u.iCur ) pWalker->eCode = 0;
+      break;
+    case TK_AGG_FUNCTION:
+      if( pExpr->op2 ){       /* belongs to an outer query */
+        pWalker->eCode = 0;
+        break;
+      }
+      /* fall through */
+    case TK_FUNCTION:
+      if( !remotePushdownFuncOk(pWalker->pParse->db, pExpr) ){
+        pWalker->eCode = 0;
+      }
+      break;
+    default:
+      pWalker->eCode = 0;
+      break;
+  }
+  return pWalker->eCode ? WRC_Continue : WRC_Abort;
+}
+
+/*
+** COMDB2 MODIFICATION
+** A select over a single remote table that aggregates, groups, picks
+** distinct rows or has a limit is sent to the remote database whole, so
+** only its result rows come back.  The remote cursor gets the select as
+** an OP_CursorHint; the fdb layer runs it instead of a scan of the table,
+** and its result columns are read off the cursor.
+**
+** Returns 1 if the code for p was generated here.
+*/
+static int remoteSelectPushdown(Parse *pParse, Select *p, SelectDest *pDest){
+  extern int fdb_push_select_ok(int rootpage);
+  sqlite3 *db = pParse->db;
+  Vdbe *v = pParse->pVdbe;
+  struct SrcList_item *pItem;
+  Table *pTab;
+  Walker w;
+  Expr *pHint;
+  int iDb, iCur, addrTop, addrCont, addrBrk;
+
+  if( p->recording || p->op==TK_SELECTV || p->pSrc->nSrc!=1 ) return 0;
+  pItem = &p->pSrc->a[0];
+  pTab = pItem->pTab;
+  if( pItem->pSelect || !pTab || IsVirtual(pTab) || pTab->pSelect ) return 0;
+  iDb = sqlite3SchemaToIndex(db, pTab->pSchema);
+  if( iDb<2 || sqlite3_strnicmp(pTab->zName, "sqlite_", 7)==0 ) return 0;
+  /* fdb_push_select is on and the remote's protocol knows how */
+  if( !fdb_push_select_ok(pTab->tnum) ) return 0;
+
+  /* plain scans already get their WHERE clause as a hint */
+  if( (p->selFlags & (SF_Aggregate|SF_Distinct))==0 && !p->pGroupBy
+   && !p->pLimit ){
+    return 0;
+  }
+
+  memset(&w, 0, sizeof(w));
+  w.pParse = pParse;
+  w.xExprCallback = remotePushdownCheckExpr;
+  w.u.iCur = pItem->iCursor;
+  w.eCode = 1;
+  sqlite3WalkExprList(&w, p->pEList);
+  sqlite3WalkExpr(&w, p->pWhere);
+  sqlite3WalkExprList(&w, p->pGroupBy);
+  sqlite3WalkExpr(&w, p->pHaving);
+  sqlite3WalkExprList(&w, p->pOrderBy);
+  sqlite3WalkExpr(&w, p->pLimit);
+  sqlite3WalkExpr(&w, p->pOffset);
+  if( !w.eCode ) return 0;
+
+  pHint = sqlite3PExpr(pParse, TK_SELECT, 0, 0, 0);
+  sqlite3PExprAddSelect(pParse, pHint, sqlite3SelectDup(db, p, 0));
+  if( db->mallocFailed ){
+    sqlite3ExprDelete(db, pHint);
+    return 0;
+  }
+
+  if( pParse->explain==2 ){
+    sqlite3VdbeAddOp4(v, OP_Explain, pParse->iSelectId, 0, 0,
+        sqlite3MPrintf(db, "SCAN REMOTE TABLE %s (WHOLE SELECT)", pTab->zName),
+        P4_DYNAMIC);
+  }
+
+  /* the cursor has as many columns as the select has results */
+  iCur = pItem->iCursor;
+  sqlite3CodeVerifySchema(pParse, iDb);
+  sqlite3TableLock(pParse, iDb, pTab->tnum, 0, pTab->zName);
+  sqlite3VdbeAddOp4Int(v, OP_OpenRead, iCur, pTab->tnum, iDb,
+                       p->pEList->nExpr);
+  sqlite3VdbeAddOp4(v, OP_CursorHint, iCur, 0, 0, (char*)pHint, P4_EXPR);
+  addrBrk = sqlite3VdbeMakeLabel(v);
+  addrCont = sqlite3VdbeMakeLabel(v);
+  addrTop = sqlite3VdbeAddOp2(v, OP_Rewind, iCur, addrBrk); VdbeCoverage(v);
+
+  /* LIMIT and OFFSET were applied remotely, p->iLimit stays 0 */
+  selectInnerLoop(pParse, p, p->pEList, iCur, 0, 0, pDest, addrCont, addrBrk);
+
+  sqlite3VdbeResolveLabel(v, addrCont);
+  sqlite3VdbeAddOp2(v, OP_Next, iCur, addrTop+1); VdbeCoverage(v);
+  sqlite3VdbeResolveLabel(v, addrBrk);
+  sqlite3VdbeAddOp1(v, OP_Close, iCur);
+  return 1;
+}
+
 /*
 ** Generate code for the SELECT statement given in the p argument.  
 **
@@ -5307,6 +5577,13 @@ int sqlite3Select(
   }
 #endif
 
+  /* COMDB2 MODIFICATION */
+  if( remoteSelectPushdown(pParse, p, pDest) ){
+    pEList = p->pEList;
+    rc = pParse->nErr!=0;
+    goto select_end;
+  }
+
   /* Generate code for all sub-queries in the FROM clause
   */
 #if !defined(SQLITE_OMIT_SUBQUERY) || !defined(SQLITE_OMIT_VIEW)
@@ -5988,6 +6265,7 @@ int sqlite3Select(
         **     Refer to code and comments in where.c for details.
         */
         ExprList *pMinMax = 0;
+        int addrStripeAgg = 0;
         u8 flag = WHERE_ORDERBY_NORMAL;
         
         assert( p->pGroupBy==0 );
@@ -6007,6 +6285,17 @@ int sqlite3Select(
           }
         }
   
+        /* COMDB2 MODIFICATION */
+        /* A single min() or max() is left to the loop, which can use an
+        ** index for it. */
+        if( flag==WHERE_ORDERBY_NORMAL ){
+          int aAgg[BTREE_STRIPEAGG_MAX_AGGS*3];
+          Table *pStripeTab = isSimpleStripeAgg(p, &sAggInfo, aAgg);
+          if( pStripeTab ){
+            addrStripeAgg = codeStripeAgg(pParse, pStripeTab, &sAggInfo, aAgg);
+          }
+        }
+
         /* This case runs if the aggregate has no GROUP BY clause.  The
         ** processing is much simpler since there is only a single row
         ** of output.
@@ -6026,6 +6315,9 @@ int sqlite3Select(
         }
         sqlite3WhereEnd(pWInfo);
         finalizeAggFunctions(pParse, &sAggInfo);
+        if( addrStripeAgg ){
+          sqlite3VdbeResolveLabel(v, addrStripeAgg);
+        }
       }
 
       sSort.pOrderBy = 0;
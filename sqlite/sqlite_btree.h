@@ -337,6 +337,17 @@ int sqlite3BtreeCursorIsValid(BtCursor*);
 int sqlite3BtreeCount(BtCursor *, i64 *);
 #endif
 
+/* COMDB2 MODIFICATION */
+/* Aggregates computed by sqlite3BtreeStripeAgg() */
+#define BTREE_STRIPEAGG_COUNTSTAR 1 /* count(*) */
+#define BTREE_STRIPEAGG_COUNT     2 /* count(column) */
+#define BTREE_STRIPEAGG_SUM       3
+#define BTREE_STRIPEAGG_MIN       4
+#define BTREE_STRIPEAGG_MAX       5
+#define BTREE_STRIPEAGG_MAX_AGGS  32
+int sqlite3BtreeStripeAgg(BtCursor *, int nAgg, const int *aAgg,
+                          sqlite3_value *aMem, int *pDone);
+
 #ifdef SQLITE_TEST
 int sqlite3BtreeCursorInfo(BtCursor*, int*, int);
 void sqlite3BtreeCursorList(Btree*);
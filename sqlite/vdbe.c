@@ -3379,6 +3379,35 @@ case OP_Count: {         /* out2 */
 }
 #endif
 
+/* COMDB2 MODIFICATION */
+/* Opcode: StripeAgg P1 P2 * P4 *
+** Synopsis: r[P2]=stripe_agg(P1)
+**
+** P4 is an integer array of (function, column, register) triples, one for
+** each aggregate of a SELECT without WHERE or GROUP BY on the table opened
+** by cursor P1. If the aggregates can be computed by scanning the data
+** stripes of that table in parallel, store their final values in the
+** registers and set register P2 to 1. Otherwise set it to 0 and leave the
+** aggregates to the regular loop.
+*/
+case OP_StripeAgg: {      /* out2 */
+  BtCursor *pCrsr;
+  int *ai;
+  int done;
+
+  assert( p->apCsr[pOp->p1]->eCurType==CURTYPE_BTREE );
+  assert( pOp->p4type==P4_INTARRAY );
+  pCrsr = p->apCsr[pOp->p1]->uc.pCursor;
+  assert( pCrsr );
+  ai = pOp->p4.ai;
+  done = 0;
+  rc = sqlite3BtreeStripeAgg(pCrsr, (ai[0]-1)/3, &ai[1], aMem, &done);
+  if( rc ) goto abort_due_to_error;
+  pOut = out2Prerelease(p, pOp);
+  pOut->u.i = done;
+  break;
+}
+
 /* Opcode: Savepoint P1 * * P4 *
 **
 ** Open, release or rollback the savepoint named by parameter P4, depending
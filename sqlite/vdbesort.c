@@ -1884,8 +1884,25 @@ int sqlite3VdbeSorterWrite(
       if( nNew < nMin ) nNew = nMin;
 
       aNew = sqlite3Realloc(pSorter->list.aMemory, nNew);
+      /* COMDB2 MODIFICATION: if the buffer cannot grow because the statement
+      ** is at its memory cap, write what it holds out as a PMA and reuse it */
+      if( !aNew && pSorter->iMemory ){
+        pSorter->list.szPMA -= nPMA;
+        rc = vdbeSorterFlushPMA(pSorter);
+        pSorter->list.szPMA = nPMA;
+        pSorter->iMemory = 0;
+        if( rc!=SQLITE_OK ) return rc;
+        if( nReq<=pSorter->nMemory ){
+          aNew = pSorter->list.aMemory;
+          nNew = pSorter->nMemory;
+        }else{
+          aNew = sqlite3Realloc(pSorter->list.aMemory, nNew = nReq);
+        }
+      }
       if( !aNew ) return SQLITE_NOMEM_BKPT;
-      pSorter->list.pList = (SorterRecord*)&aNew[iListOff];
+      if( pSorter->list.pList ){
+        pSorter->list.pList = (SorterRecord*)&aNew[iListOff];
+      }
       pSorter->list.aMemory = aNew;
       pSorter->nMemory = nNew;
     }
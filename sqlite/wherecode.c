@@ -895,9 +895,13 @@ static void codeCursorHint(
   if( OptimizationDisabled(db, SQLITE_CursorHints) ) return;
 
   /* COMDB2 MODIFICATIONS */
-  /* we really need to run this only for remote cursors */
-  if (pWInfo->pTabList->a[iLevel].zDatabase == NULL) /* hack, at this point only remcurs have it */
-    return;
+  /* we really need to run this only for remote cursors; local cursors get
+  ** the hint only for full scans, where filtering cannot walk the cursor
+  ** past the end of a range the vdbe would have stopped at */
+  if (pWInfo->pTabList->a[iLevel].zDatabase == NULL){ /* hack, at this point only remcurs have it */
+    extern int gbl_sql_pushdown_filters;
+    if( !gbl_sql_pushdown_filters || pLoop->nLTerm>0 || pEndRange ) return;
+  }
 
   /* COMDB2 MODIFICATION */
   /* I need this Mask since the code lower ignores TERM_CODED !!!!*/
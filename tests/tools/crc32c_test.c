@@ -0,0 +1,157 @@
+/*
+   Copyright 2018 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+/* crc32c.c only logs from crc32c_init; don't drag in the logging library */
+#include <logmsg.h>
+#define logmsg(...)
+#include <crc32c.c> //need access to static funcs
+
+#define MAXSZ (64 * 1024)
+
+typedef uint32_t (*crc_func)(const uint8_t *, uint32_t, uint32_t);
+
+static struct {
+    const char *name;
+    crc_func func;
+} impls[] = {
+    {"software", crc32c_software},
+#ifdef __x86_64__
+    {"sse", crc32c_sse},
+    {"sse_pcl", crc32c_sse_pcl},
+#endif
+};
+
+#define CNT(x) (sizeof(x) / sizeof(x[0]))
+
+static uint8_t *random_buf(size_t sz)
+{
+    uint8_t *buf = malloc(sz);
+    for (size_t i = 0; i < sz; ++i)
+        buf[i] = rand();
+    return buf;
+}
+
+static void check(const char *what, const char *name, uint32_t got,
+                  uint32_t want)
+{
+    if (got != want) {
+        fprintf(stderr, "%s %s got:%08x want:%08x\n", what, name, got, want);
+        abort();
+    }
+}
+
+static void test_well_known()
+{
+    /* RFC 3720 B.4 */
+    uint8_t zeros[32], ones[32], incr[32];
+    memset(zeros, 0, sizeof(zeros));
+    memset(ones, 0xff, sizeof(ones));
+    for (int i = 0; i < sizeof(incr); ++i)
+        incr[i] = i;
+    for (int i = 0; i < CNT(impls); ++i) {
+        check("zeros", impls[i].name, ~impls[i].func(zeros, 32, ~0U),
+              0x8a9136aa);
+        check("ones", impls[i].name, ~impls[i].func(ones, 32, ~0U),
+              0x62a8ab43);
+        check("incr", impls[i].name, ~impls[i].func(incr, 32, ~0U),
+              0x46dd794e);
+    }
+    fprintf(stderr, "passed %s\n", __func__);
+}
+
+/* Every size up to a few blocks of each path, at every alignment */
+static void test_sizes()
+{
+    const uint32_t max = 3 * 3072 + 8;
+    uint8_t *buf = random_buf(max + 8);
+    for (uint32_t off = 0; off < 8; ++off) {
+        for (uint32_t sz = 0; sz <= max; ++sz) {
+            uint32_t want = crc32c_software(buf + off, sz, CRC32C_SEED);
+            for (int i = 1; i < CNT(impls); ++i) {
+                uint32_t got = impls[i].func(buf + off, sz, CRC32C_SEED);
+                if (got != want) {
+                    fprintf(stderr, "%s off:%u sz:%u got:%08x want:%08x\n",
+                            impls[i].name, off, sz, got, want);
+                    abort();
+                }
+            }
+        }
+    }
+    free(buf);
+    fprintf(stderr, "passed %s\n", __func__);
+}
+
+static void test_dispatch()
+{
+    uint8_t *buf = random_buf(MAXSZ);
+    crc32c_init(0);
+    for (uint32_t sz = 1; sz <= MAXSZ; sz <<= 1)
+        check("dispatch", "crc32c", crc32c(buf, sz),
+              crc32c_software(buf, sz, CRC32C_SEED));
+    free(buf);
+    fprintf(stderr, "passed %s\n", __func__);
+}
+
+/* Throughput of each implementation for 64B - 64KB buffers */
+static void bench(size_t total)
+{
+    uint8_t *buf = random_buf(MAXSZ);
+    printf("%8s", "size");
+    for (int i = 0; i < CNT(impls); ++i)
+        printf(" %10s", impls[i].name);
+    printf("   (MB/s)\n");
+    for (uint32_t sz = 64; sz <= MAXSZ; sz <<= 1) {
+        printf("%8u", sz);
+        for (int i = 0; i < CNT(impls); ++i) {
+            struct timeval start, end;
+            size_t n = total / sz;
+            uint32_t crc = 0;
+            gettimeofday(&start, NULL);
+            for (size_t j = 0; j < n; ++j)
+                crc = impls[i].func(buf, sz, crc);
+            gettimeofday(&end, NULL);
+            double secs = (end.tv_sec - start.tv_sec) +
+                          (end.tv_usec - start.tv_usec) / 1000000.0;
+            printf(" %10.0f", secs > 0 ? (n * sz) / secs / (1 << 20) : 0);
+            /* keep the loop from being optimized away */
+            if (crc == 0x5eed)
+                printf("*");
+        }
+        printf("\n");
+    }
+    free(buf);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t total = 64 << 20;
+    if (argc > 1)
+        total = (size_t)atoi(argv[1]) << 20;
+
+    test_well_known();
+    test_sizes();
+    test_dispatch();
+
+    fprintf(stderr, "PASSED ALL TESTS\n");
+
+    bench(total);
+    return EXIT_SUCCESS;
+}
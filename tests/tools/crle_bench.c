@@ -0,0 +1,365 @@
+/*
+   Copyright 2018 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* Compresses and decompresses sets of row images with the scalar, SSE2 and
+ * AVX2 scans (those the cpu has), checks every flavour produces exactly the
+ * bytes the scalar one does, and reports throughput for each. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+#include <sys/time.h>
+#include <comdb2rle.c> //need access to static funcs
+
+#define NROWS 4096
+#define MAXFLDS 32
+#define PASSES 20
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+struct rowset {
+    const char *name;
+    uint32_t rowsz;
+    uint16_t hints[MAXFLDS + 1];
+    uint8_t *rows;
+};
+
+/* ondisk fields: a header byte, then the value (ints big-endian with the
+ * sign bit flipped); cstrings are zero padded */
+static uint8_t *put_int(uint8_t *p, int64_t v, int sz)
+{
+    uint64_t u = (uint64_t)v ^ (1ULL << (sz * 8 - 1));
+    *p++ = 0x08;
+    for (int i = sz - 1; i >= 0; --i)
+        *p++ = u >> (i * 8);
+    return p;
+}
+
+static uint8_t *put_null(uint8_t *p, int sz)
+{
+    *p++ = 0x02;
+    memset(p, 0, sz);
+    return p + sz;
+}
+
+static uint8_t *put_cstr(uint8_t *p, const char *s, int sz)
+{
+    *p++ = 0x08;
+    memset(p, 0, sz);
+    memcpy(p, s, strlen(s) < sz ? strlen(s) : sz - 1);
+    return p + sz;
+}
+
+static uint8_t *put_double(uint8_t *p, double d)
+{
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    u = (u & (1ULL << 63)) ? ~u : u ^ (1ULL << 63);
+    *p++ = 0x08;
+    for (int i = 7; i >= 0; --i)
+        *p++ = u >> (i * 8);
+    return p;
+}
+
+static void add_hint(struct rowset *rs, int *n, int sz)
+{
+    rs->hints[(*n)++] = sz + 1;
+    rs->hints[*n] = 0;
+}
+
+/* an orders table: ids, a few small ints, a nullable column, names and
+ * addresses much shorter than their columns, a price */
+static void make_narrow(struct rowset *rs)
+{
+    int n = 0;
+    rs->name = "narrow";
+    add_hint(rs, &n, 8);  /* id */
+    add_hint(rs, &n, 4);  /* qty */
+    add_hint(rs, &n, 4);  /* status */
+    add_hint(rs, &n, 4);  /* parent, mostly null */
+    add_hint(rs, &n, 32); /* name */
+    add_hint(rs, &n, 64); /* address */
+    add_hint(rs, &n, 8);  /* price */
+    add_hint(rs, &n, 8);  /* flags */
+    rs->rowsz = 0;
+    for (int i = 0; i < n; ++i)
+        rs->rowsz += rs->hints[i];
+    rs->rows = malloc(rs->rowsz * NROWS);
+    for (int i = 0; i < NROWS; ++i) {
+        uint8_t *p = rs->rows + i * rs->rowsz;
+        char s[64];
+        p = put_int(p, 1000000 + i, 8);
+        p = put_int(p, rand() % 10, 4);
+        p = put_int(p, i % 3 == 0 ? -1 : 0, 4);
+        p = (i % 5) ? put_null(p, 4) : put_int(p, i - 1, 4);
+        snprintf(s, sizeof(s), "customer-%d", rand() % 5000);
+        p = put_cstr(p, s, 32);
+        snprintf(s, sizeof(s), "%d %s street", rand() % 999,
+                 (i & 1) ? "main" : "park");
+        p = put_cstr(p, s, 64);
+        p = put_double(p, (rand() % 100000) / 100.0);
+        p = put_int(p, 0, 8);
+    }
+}
+
+/* a wide table of mostly empty columns */
+static void make_wide(struct rowset *rs)
+{
+    int n = 0;
+    rs->name = "wide";
+    add_hint(rs, &n, 8);
+    for (int i = 0; i < 8; ++i)
+        add_hint(rs, &n, 4);
+    add_hint(rs, &n, 512);
+    add_hint(rs, &n, 512);
+    for (int i = 0; i < 4; ++i)
+        add_hint(rs, &n, 8);
+    rs->rowsz = 0;
+    for (int i = 0; i < n; ++i)
+        rs->rowsz += rs->hints[i];
+    rs->rows = malloc(rs->rowsz * NROWS);
+    for (int i = 0; i < NROWS; ++i) {
+        uint8_t *p = rs->rows + i * rs->rowsz;
+        p = put_int(p, i, 8);
+        for (int j = 0; j < 8; ++j)
+            p = (rand() % 4) ? put_null(p, 4) : put_int(p, rand() % 3, 4);
+        p = put_cstr(p, (i % 7) ? "" : "see attached", 512);
+        p = put_cstr(p, "", 512);
+        for (int j = 0; j < 4; ++j)
+            p = put_double(p, j ? 0.0 : i * 1.5);
+    }
+}
+
+/* nothing to find */
+static void make_random(struct rowset *rs)
+{
+    int n = 0;
+    rs->name = "random";
+    for (int i = 0; i < 8; ++i)
+        add_hint(rs, &n, 15);
+    rs->rowsz = 0;
+    for (int i = 0; i < n; ++i)
+        rs->rowsz += rs->hints[i];
+    rs->rows = malloc(rs->rowsz * NROWS);
+    for (int i = 0; i < rs->rowsz * NROWS; ++i)
+        rs->rows[i] = rand();
+}
+
+enum { SCALAR, SSE2, AVX2, NIMPLS };
+static const char *impl_names[] = {"scalar", "sse2", "avx2"};
+
+static int use(int impl)
+{
+    switch (impl) {
+    case SCALAR:
+        mismatch = mismatch_scalar;
+        run_rev = run_rev_scalar;
+        expand = expand_scalar;
+        return 1;
+#ifdef CRLE_SIMD
+    case SSE2:
+        mismatch = mismatch_sse2;
+        run_rev = run_rev_sse2;
+        expand = expand_sse2;
+        return 1;
+    case AVX2:
+        if (!__builtin_cpu_supports("avx2"))
+            return 0;
+        mismatch = mismatch_avx2;
+        run_rev = run_rev_avx2;
+        expand = expand_avx2;
+        return 1;
+#endif
+    }
+    return 0;
+}
+
+struct result {
+    uint8_t *out;    /* compressed rows, rowsz * 2 apart */
+    uint32_t *outsz;
+    double comp, hints, decomp; /* MB/s of row images */
+};
+
+static void run(struct rowset *rs, struct result *res)
+{
+    uint32_t max = rs->rowsz * 2;
+    uint8_t *out = malloc(max * NROWS);
+    uint8_t *hout = malloc(max * NROWS);
+    uint32_t *outsz = malloc(sizeof(uint32_t) * NROWS);
+    uint32_t *houtsz = malloc(sizeof(uint32_t) * NROWS);
+    uint8_t *dec = malloc(rs->rowsz);
+    double mb = (double)rs->rowsz * NROWS * PASSES / (1024 * 1024);
+    double start;
+    int i, pass;
+
+    start = now();
+    for (pass = 0; pass < PASSES; ++pass) {
+        for (i = 0; i < NROWS; ++i) {
+            Comdb2RLE c = {.in = rs->rows + i * rs->rowsz,
+                           .insz = rs->rowsz,
+                           .out = out + i * max,
+                           .outsz = max};
+            if (compressComdb2RLE(&c) != 0)
+                abort();
+            outsz[i] = c.outsz;
+        }
+    }
+    res->comp = mb / (now() - start);
+
+    start = now();
+    for (pass = 0; pass < PASSES; ++pass) {
+        for (i = 0; i < NROWS; ++i) {
+            Comdb2RLE c = {.in = rs->rows + i * rs->rowsz,
+                           .insz = rs->rowsz,
+                           .out = hout + i * max,
+                           .outsz = max};
+            if (compressComdb2RLE_hints(&c, rs->hints) != 0)
+                abort();
+            houtsz[i] = c.outsz;
+        }
+    }
+    res->hints = mb / (now() - start);
+
+    start = now();
+    for (pass = 0; pass < PASSES; ++pass) {
+        for (i = 0; i < NROWS; ++i) {
+            Comdb2RLE d = {.in = (pass & 1 ? hout : out) + i * max,
+                           .insz = (pass & 1 ? houtsz : outsz)[i],
+                           .out = dec,
+                           .outsz = rs->rowsz};
+            if (decompressComdb2RLE(&d) != 0 || d.outsz != rs->rowsz ||
+                memcmp(dec, rs->rows + i * rs->rowsz, rs->rowsz) != 0) {
+                fprintf(stderr, "%s row %d doesn't decompress\n", rs->name,
+                        i);
+                exit(1);
+            }
+        }
+    }
+    res->decomp = mb / (now() - start);
+
+    /* keep the plain and hinted outputs side by side for the comparison */
+    res->out = malloc(max * 2 * NROWS);
+    res->outsz = malloc(sizeof(uint32_t) * 2 * NROWS);
+    memcpy(res->out, out, max * NROWS);
+    memcpy(res->out + max * NROWS, hout, max * NROWS);
+    memcpy(res->outsz, outsz, sizeof(uint32_t) * NROWS);
+    memcpy(res->outsz + NROWS, houtsz, sizeof(uint32_t) * NROWS);
+    free(out);
+    free(hout);
+    free(outsz);
+    free(houtsz);
+    free(dec);
+}
+
+static void same(struct rowset *rs, struct result *a, struct result *b,
+                 const char *impl)
+{
+    uint32_t max = rs->rowsz * 2;
+    for (int i = 0; i < 2 * NROWS; ++i) {
+        if (a->outsz[i] != b->outsz[i] ||
+            memcmp(a->out + i * max, b->out + i * max, a->outsz[i]) != 0) {
+            fprintf(stderr, "%s: %s %srow %d differs from scalar\n",
+                    rs->name, impl, i < NROWS ? "" : "hinted ",
+                    i % NROWS);
+            exit(1);
+        }
+    }
+}
+
+/* long runs of every pattern size, at every alignment */
+static void test_runs(void)
+{
+    uint8_t in[1100], out[1200], dec[1100], ref[1200];
+    uint32_t refsz;
+    for (uint32_t s = 1; s <= 40; ++s) {
+        for (uint32_t len = 1; len < 1000; len += 37) {
+            for (int i = 0; i < sizeof(in); ++i)
+                in[i] = rand();
+            for (int i = 0; i < len; ++i)
+                in[7 + i] = in[7 + i % s];
+            for (int impl = 0; impl < NIMPLS; ++impl) {
+                if (!use(impl))
+                    continue;
+                Comdb2RLE c = {.in = in, .insz = 7 + len + 3, .out = out,
+                               .outsz = sizeof(out)};
+                assert(compressComdb2RLE(&c) == 0);
+                if (impl == SCALAR) {
+                    memcpy(ref, out, c.outsz);
+                    refsz = c.outsz;
+                } else {
+                    assert(c.outsz == refsz);
+                    assert(memcmp(out, ref, refsz) == 0);
+                }
+                for (int dimpl = 0; dimpl < NIMPLS; ++dimpl) {
+                    if (!use(dimpl))
+                        continue;
+                    Comdb2RLE d = {.in = out, .insz = refsz, .out = dec,
+                                   .outsz = sizeof(dec)};
+                    assert(decompressComdb2RLE(&d) == 0);
+                    assert(d.outsz == 7 + len + 3);
+                    assert(memcmp(dec, in, d.outsz) == 0);
+                }
+                use(impl);
+            }
+        }
+    }
+    fprintf(stderr, "passed %s\n", __func__);
+}
+
+int main(int argc, char *argv[])
+{
+    struct rowset sets[3];
+    struct result res[NIMPLS];
+    int i, impl;
+
+    srand(1);
+    test_runs();
+
+    memset(sets, 0, sizeof(sets));
+    make_narrow(&sets[0]);
+    make_wide(&sets[1]);
+    make_random(&sets[2]);
+
+    printf("%-8s %-8s %6s %12s %12s %12s\n", "rows", "scan", "rowsz",
+           "comp MB/s", "hints MB/s", "decomp MB/s");
+    for (i = 0; i < sizeof(sets) / sizeof(sets[0]); ++i) {
+        for (impl = 0; impl < NIMPLS; ++impl) {
+            if (!use(impl))
+                continue;
+            run(&sets[i], &res[impl]);
+            if (impl != SCALAR)
+                same(&sets[i], &res[SCALAR], &res[impl], impl_names[impl]);
+            printf("%-8s %-8s %6u %12.1f %12.1f %12.1f\n", sets[i].name,
+                   impl_names[impl], sets[i].rowsz, res[impl].comp,
+                   res[impl].hints, res[impl].decomp);
+        }
+        for (impl = 0; impl < NIMPLS; ++impl) {
+            if (!use(impl))
+                continue;
+            free(res[impl].out);
+            free(res[impl].outsz);
+        }
+    }
+
+    fprintf(stderr, "PASSED ALL TESTS\n");
+    return EXIT_SUCCESS;
+}
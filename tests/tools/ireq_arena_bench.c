@@ -0,0 +1,189 @@
+/*
+   Copyright 2018 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* Checks the arena, then replays the allocations the block processor makes
+ * for each osql insert with index keys (two MAXINDEX arrays plus one buffer
+ * per key) with malloc/free and with a per-thread arena, for 1 to 64
+ * threads. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#define BUILDING_TOOLS
+#include <arena.c>
+#include <cdb2_constants.h>
+
+#define NKEYS 4
+#define KEYSZ 24
+#define OPS_PER_THREAD 200000
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void test_arena(void)
+{
+    arena_t *a = arena_init(256);
+    unsigned long long nmallocs, nmallocs2;
+    unsigned char *p[64];
+    size_t used;
+    int i, j, nchunks, nchunks2;
+
+    for (i = 0; i < 64; i++) {
+        p[i] = arena_alloc(a, i + 1);
+        assert(((uintptr_t)p[i] & 15) == 0);
+        memset(p[i], i, i + 1);
+    }
+    for (i = 0; i < 64; i++)
+        for (j = 0; j <= i; j++)
+            assert(p[i][j] == i);
+
+    /* bigger than a chunk */
+    p[0] = arena_calloc(a, 1, 10000);
+    for (i = 0; i < 10000; i++)
+        assert(p[0][i] == 0);
+
+    arena_info(a, &used, &nchunks, &nmallocs, NULL);
+    assert(used >= 10000);
+
+    /* the same allocations again don't need malloc */
+    arena_rewind(a);
+    arena_info(a, &used, NULL, NULL, NULL);
+    assert(used == 0);
+    p[0] = arena_calloc(a, 1, 10000);
+    for (i = 1; i < 64; i++)
+        p[i] = arena_alloc(a, i + 1);
+    arena_info(a, NULL, &nchunks2, &nmallocs2, NULL);
+    assert(nchunks2 == nchunks);
+    assert(nmallocs2 == nmallocs);
+
+    arena_free(a);
+    fprintf(stderr, "passed %s\n", __func__);
+}
+
+struct run {
+    int use_arena;
+    unsigned long long nmallocs;
+    unsigned long long nops;
+};
+
+static void *run_malloc(struct run *r)
+{
+    uint8_t **ins, **del;
+    int i, k;
+
+    for (i = 0; i < OPS_PER_THREAD; i++) {
+        ins = calloc(MAXINDEX, sizeof(uint8_t *));
+        del = calloc(MAXINDEX, sizeof(uint8_t *));
+        for (k = 0; k < NKEYS; k++) {
+            ins[k] = malloc(KEYSZ);
+            memset(ins[k], k, KEYSZ);
+        }
+        r->nmallocs += 2 + NKEYS;
+        for (k = 0; k < MAXINDEX; k++)
+            free(ins[k]);
+        free(ins);
+        free(del);
+    }
+    r->nops = OPS_PER_THREAD;
+    return NULL;
+}
+
+static void *run_arena(struct run *r)
+{
+    arena_t *a = arena_init(2 * MAXINDEX * sizeof(uint8_t *) + 4096);
+    uint8_t **ins, **del;
+    int i, k;
+
+    for (i = 0; i < OPS_PER_THREAD; i++) {
+        ins = arena_calloc(a, MAXINDEX, sizeof(uint8_t *));
+        del = arena_calloc(a, MAXINDEX, sizeof(uint8_t *));
+        for (k = 0; k < NKEYS; k++) {
+            ins[k] = arena_alloc(a, KEYSZ);
+            memset(ins[k], k, KEYSZ);
+        }
+        (void)del;
+        arena_rewind(a);
+    }
+    arena_info(a, NULL, NULL, &r->nmallocs, NULL);
+    r->nmallocs++; /* the arena itself */
+    r->nops = OPS_PER_THREAD;
+    arena_free(a);
+    return NULL;
+}
+
+static void *run(void *arg)
+{
+    struct run *r = arg;
+    return r->use_arena ? run_arena(r) : run_malloc(r);
+}
+
+static void bench(int nthreads, int use_arena, double *opspersec,
+                  double *mallocsperop)
+{
+    pthread_t tids[64];
+    struct run runs[64];
+    unsigned long long nmallocs = 0, nops = 0;
+    double start;
+    int i;
+
+    memset(runs, 0, sizeof(runs));
+    start = now();
+    for (i = 0; i < nthreads; i++) {
+        runs[i].use_arena = use_arena;
+        pthread_create(&tids[i], NULL, run, &runs[i]);
+    }
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(tids[i], NULL);
+        nmallocs += runs[i].nmallocs;
+        nops += runs[i].nops;
+    }
+    *opspersec = nops / (now() - start);
+    *mallocsperop = (double)nmallocs / nops;
+}
+
+int main(int argc, char *argv[])
+{
+    int threads[] = {1, 2, 4, 8, 16, 32, 64};
+    int i;
+
+    test_arena();
+
+    printf("%8s %14s %14s %12s %12s\n", "threads", "malloc ops/s",
+           "arena ops/s", "mallocs/op", "arena/op");
+    for (i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        double mops, mper, aops, aper;
+        bench(threads[i], 0, &mops, &mper);
+        bench(threads[i], 1, &aops, &aper);
+        printf("%8d %14.0f %14.0f %12.2f %12.6f\n", threads[i], mops, aops,
+               mper, aper);
+        if (aper >= 1) {
+            fprintf(stderr, "arena did %.2f mallocs per op\n", aper);
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "PASSED ALL TESTS\n");
+    return 0;
+}
@@ -68,7 +68,8 @@ extern "C" {
 #define	P_QAMMETA	10	/* Queue metadata page. */
 #define	P_QAMDATA	11	/* Queue data page. */
 #define	P_LDUP		12	/* Off-page duplicate leaf. */
-#define	P_PAGETYPE_MAX	13
+#define	P_COMPRESSED	13	/* On-disk slot of a compressed page. */
+#define	P_PAGETYPE_MAX	14
 
 /*
  * When we create pages in mpool, we ask mpool to clear some number of bytes
@@ -0,0 +1,150 @@
+/*
+   Copyright 2018 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* HANDS OUT MEMORY FROM A LIST OF CHUNKS, RECLAIMED ALL AT ONCE */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#ifndef BUILDING_TOOLS
+#include "mem_util.h"
+#include "mem_override.h"
+#endif
+
+#define ARENA_ALIGN 16
+#define ARENA_DEFAULT_CHUNK 8192
+
+struct chunkhdr {
+    struct chunkhdr *next;
+    size_t size; /* usable bytes after the header */
+    size_t used;
+    size_t pad; /* keep the data on a 16 byte boundary */
+};
+
+struct arena {
+    size_t chunksz;
+    struct chunkhdr *chunks; /* chunks in use; the head is the one we bump */
+    struct chunkhdr *spare;  /* chunks rewound and not reused yet */
+    int nchunks;
+    size_t used;
+    unsigned long long nmallocs;
+    unsigned long long nallocs;
+};
+
+arena_t *arena_init(size_t chunksz)
+{
+    arena_t *a = calloc(1, sizeof(arena_t));
+    if (a == NULL)
+        return NULL;
+    a->chunksz = chunksz ? chunksz : ARENA_DEFAULT_CHUNK;
+    return a;
+}
+
+static void free_chunks(struct chunkhdr *c)
+{
+    struct chunkhdr *next;
+    for (; c; c = next) {
+        next = c->next;
+        free(c);
+    }
+}
+
+void arena_free(arena_t *a)
+{
+    if (a == NULL)
+        return;
+    free_chunks(a->chunks);
+    free_chunks(a->spare);
+    free(a);
+}
+
+static struct chunkhdr *new_chunk(arena_t *a, size_t sz)
+{
+    struct chunkhdr *c, **pc;
+
+    /* REUSE THE FIRST SPARE THAT IS BIG ENOUGH */
+    for (pc = &a->spare; *pc && (*pc)->size < sz; pc = &(*pc)->next)
+        ;
+    if ((c = *pc) != NULL) {
+        *pc = c->next;
+    } else {
+        size_t size = sz > a->chunksz ? sz : a->chunksz;
+        c = malloc(sizeof(struct chunkhdr) + size);
+        if (c == NULL)
+            return NULL;
+        c->size = size;
+        a->nchunks++;
+        a->nmallocs++;
+    }
+    c->used = 0;
+    c->next = a->chunks;
+    a->chunks = c;
+    return c;
+}
+
+void *arena_alloc(arena_t *a, size_t sz)
+{
+    struct chunkhdr *c = a->chunks;
+    void *p;
+
+    sz = (sz + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (c == NULL || c->size - c->used < sz) {
+        if ((c = new_chunk(a, sz)) == NULL)
+            return NULL;
+    }
+    p = (char *)(c + 1) + c->used;
+    c->used += sz;
+    a->used += sz;
+    a->nallocs++;
+    return p;
+}
+
+void *arena_calloc(arena_t *a, size_t n, size_t sz)
+{
+    void *p = arena_alloc(a, n * sz);
+    if (p)
+        memset(p, 0, n * sz);
+    return p;
+}
+
+void arena_rewind(arena_t *a)
+{
+    struct chunkhdr *c, *next;
+
+    if (a == NULL)
+        return;
+    for (c = a->chunks; c; c = next) {
+        next = c->next;
+        c->next = a->spare;
+        a->spare = c;
+    }
+    a->chunks = NULL;
+    a->used = 0;
+}
+
+void arena_info(arena_t *a, size_t *used, int *nchunks,
+                unsigned long long *nmallocs, unsigned long long *nallocs)
+{
+    if (used)
+        *used = a->used;
+    if (nchunks)
+        *nchunks = a->nchunks;
+    if (nmallocs)
+        *nmallocs = a->nmallocs;
+    if (nallocs)
+        *nallocs = a->nallocs;
+}